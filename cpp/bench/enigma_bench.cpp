@@ -0,0 +1,1169 @@
+// File: enigma_bench.cpp
+// Author: Kris Armstrong
+// Version: 3.0.0
+// Last Modified: 2026-10-14
+// Description: Micro-benchmarks for the key algorithms, SIMD kernels and batch paths, with JSON output.
+// License: MIT
+
+#include "enigma_v300_pure_cpp.h"
+#include "enigma_batch.h"
+#include "enigma_catalog_file.h"
+#include "enigma_engine.h"
+#include "enigma_key_cache.h"
+#include "enigma_output.h"
+#include "enigma_packed.h"
+#include "enigma_range.h"
+#ifdef ENIGMA_HAVE_SERVER
+#include "enigma_server.h"
+#endif
+#include "enigma_simd.h"
+#include "enigma_stats.h"
+#include "enigma_stream.h"
+#include "enigma_thread_pool.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <initializer_list>
+#include <iostream>
+#include <new>
+#include <random>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char** environ;
+#endif
+#ifdef ENIGMA_HAVE_SERVER
+#include <sys/socket.h>
+#include <sys/un.h>
+#endif
+
+#ifndef ENIGMA_BENCH_CLI
+#define ENIGMA_BENCH_CLI ""
+#endif
+
+namespace
+{
+constexpr auto BENCH_VERSION = "3.0.0";
+constexpr size_t SAMPLE_KEYS = 4096; // keys per timed pass of the per-key benchmarks
+constexpr int SAMPLES = 5;
+
+struct Settings
+{
+    bool quick = false;
+    size_t records = 1'000'000;
+    unsigned max_threads = 0; // 0 = hardware threads
+    std::string json_path;
+    std::string cli_path = ENIGMA_BENCH_CLI;
+    std::string compare_cli_path; // second CLI for the startup benchmark
+};
+
+struct Result
+{
+    std::string name;
+    std::string variant;
+    unsigned threads = 1;
+    double ns_per_key = 0;
+    double mb_per_second = 0;        // input bytes, for the batch benchmarks
+    double allocations_per_key = -1; // heap allocations, where measured
+};
+
+// Keeps the optimizer from discarding results it can prove unused.
+volatile uint8_t sink = 0;
+
+using Clock = std::chrono::steady_clock;
+
+double seconds_since(Clock::time_point start)
+{
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// Every operator new in the process, on any thread (see the replacement
+// below), so the batch and server benchmarks can report allocations.
+std::atomic<uint64_t> heap_allocations{0};
+
+// Repeats run() (which processes items keys) until one sample lasts at
+// least min_sample seconds, then reports the fastest of SAMPLES samples.
+// The minimum is the least noisy estimate on a shared machine. With
+// allocations, also reports the heap allocations per item over the
+// samples, after the warm-up runs.
+template <typename Run>
+double best_seconds_per_item(size_t items, double min_sample, Run&& run, double* allocations = nullptr)
+{
+    size_t reps = 1;
+    while (true)
+    {
+        const auto start = Clock::now();
+        for (size_t i = 0; i < reps; ++i) run();
+        if (seconds_since(start) >= min_sample || reps >= (size_t{1} << 30)) break;
+        reps *= 2;
+    }
+    double best = 1e300;
+    const uint64_t allocated_before = heap_allocations.load(std::memory_order_relaxed);
+    for (int sample = 0; sample < SAMPLES; ++sample)
+    {
+        const auto start = Clock::now();
+        for (size_t i = 0; i < reps; ++i) run();
+        best = std::min(best, seconds_since(start) / static_cast<double>(reps * items));
+    }
+    if (allocations)
+    {
+        *allocations = static_cast<double>(heap_allocations.load(std::memory_order_relaxed) - allocated_before) /
+                       static_cast<double>(SAMPLES * reps * items);
+    }
+    return best;
+}
+
+char random_alnum(std::mt19937& rng)
+{
+    const auto value = static_cast<int>(rng() % 36);
+    return static_cast<char>(value < 10 ? '0' + value : 'A' + value - 10);
+}
+
+// Valid plain layouts and keys for each algorithm, one key after another.
+struct KeySet
+{
+    std::vector<char> nettool_plain;
+    std::vector<char> nettool_keys;
+    std::vector<char> enigma2_plain;
+    std::vector<char> enigma2_keys;
+};
+
+KeySet make_keys(std::mt19937& rng)
+{
+    KeySet set;
+    for (size_t k = 0; k < SAMPLE_KEYS; ++k)
+    {
+        std::array<char, enigma::SERIAL_NUMBER_SIZE_ENIGMAC> serial{};
+        for (auto& c : serial) c = static_cast<char>('0' + rng() % 10);
+        const auto nettool = enigma::nettool_option_key(std::string_view(serial.data(), serial.size()),
+                                                        static_cast<int>(rng() % 10));
+        std::array<char, enigma::ENIGMA_C_KEY_LENGTH> plain{};
+        (void)enigma::enigma_c_decrypt(nettool.view(), plain);
+        set.nettool_plain.insert(set.nettool_plain.end(), plain.begin(), plain.end());
+        set.nettool_keys.insert(set.nettool_keys.end(), nettool.key.begin(), nettool.key.end());
+
+        std::array<char, enigma::KEY_LENGTH> layout{};
+        for (auto& c : layout) c = random_alnum(rng);
+        std::array<char, enigma::KEY_LENGTH> key{};
+        (void)enigma::enigma2_c_encrypt(std::string_view(layout.data(), layout.size()), key);
+        set.enigma2_plain.insert(set.enigma2_plain.end(), layout.begin(), layout.end());
+        set.enigma2_keys.insert(set.enigma2_keys.end(), key.begin(), key.end());
+    }
+    return set;
+}
+
+// Transposes count keys of length characters into position-major order.
+template <typename T, typename Convert>
+std::vector<T> to_soa(const std::vector<char>& keys, size_t length, Convert convert)
+{
+    const size_t count = keys.size() / length;
+    std::vector<T> soa(keys.size());
+    for (size_t k = 0; k < count; ++k)
+    {
+        for (size_t p = 0; p < length; ++p) soa[p * count + k] = convert(keys[k * length + p]);
+    }
+    return soa;
+}
+
+// The engines behind the single-key signature, for bench_scalar().
+template <typename Engine, bool Encrypt>
+enigma::Status engine_step(std::string_view input, std::span<char> output) noexcept
+{
+    const std::span<char, Engine::key_length> key(output.data(), Engine::key_length);
+    return Encrypt ? Engine::encrypt(input, key) : Engine::decrypt(input, key);
+}
+
+// Times one of the single-key functions. Taking it as a template argument
+// lets the compiler inline it, as it would in a real caller.
+template <auto Function>
+Result bench_scalar(const char* name, const std::vector<char>& inputs, size_t length, double min_sample,
+                    const char* variant = "scalar")
+{
+    std::array<char, enigma::KEY_LENGTH> output{};
+    const double seconds = best_seconds_per_item(SAMPLE_KEYS, min_sample, [&]
+    {
+        uint8_t accumulated = 0;
+        for (size_t k = 0; k < SAMPLE_KEYS; ++k)
+        {
+            const std::string_view input(inputs.data() + k * length, length);
+            accumulated ^= static_cast<uint8_t>(Function(input, std::span<char>(output.data(), length)));
+            // Every output byte, so no kernel's stores can be dropped as dead.
+            for (size_t i = 0; i < length; ++i) accumulated = static_cast<uint8_t>(accumulated * 31 + output[i]);
+        }
+        sink = sink ^ accumulated;
+    });
+    return {name, variant, 1, seconds * 1e9, 0};
+}
+
+void bench_algorithms(const Settings& settings, std::vector<Result>& results)
+{
+    std::mt19937 rng(12345);
+    const KeySet keys = make_keys(rng);
+    const double min_sample = settings.quick ? 0.002 : 0.02;
+
+    // The text overloads; the packed ones are timed in bench_packed().
+    using Text = enigma::Status (*)(std::string_view, std::span<char>) noexcept;
+    results.push_back(bench_scalar<static_cast<Text>(enigma::enigma_c_encrypt)>(
+        "enigma_c_encrypt", keys.nettool_plain, enigma::ENIGMA_C_KEY_LENGTH, min_sample));
+    results.push_back(bench_scalar<static_cast<Text>(enigma::enigma_c_decrypt)>(
+        "enigma_c_decrypt", keys.nettool_keys, enigma::ENIGMA_C_KEY_LENGTH, min_sample));
+    results.push_back(bench_scalar<static_cast<Text>(enigma::enigma2_c_encrypt)>(
+        "enigma2_c_encrypt", keys.enigma2_plain, enigma::KEY_LENGTH, min_sample));
+    results.push_back(bench_scalar<static_cast<Text>(enigma::enigma2_c_decrypt)>(
+        "enigma2_c_decrypt", keys.enigma2_keys, enigma::KEY_LENGTH, min_sample));
+
+    results.push_back(bench_scalar<engine_step<enigma::NetToolEngine, true>>(
+        "enigma_c_encrypt", keys.nettool_plain, enigma::ENIGMA_C_KEY_LENGTH, min_sample, "engine"));
+    results.push_back(bench_scalar<engine_step<enigma::NetToolEngine, false>>(
+        "enigma_c_decrypt", keys.nettool_keys, enigma::ENIGMA_C_KEY_LENGTH, min_sample, "engine"));
+    results.push_back(bench_scalar<engine_step<enigma::Enigma2Engine, true>>(
+        "enigma2_c_encrypt", keys.enigma2_plain, enigma::KEY_LENGTH, min_sample, "engine"));
+    results.push_back(bench_scalar<engine_step<enigma::Enigma2Engine, false>>(
+        "enigma2_c_decrypt", keys.enigma2_keys, enigma::KEY_LENGTH, min_sample, "engine"));
+
+    // Both NetTool kernels, whichever ENIGMA_WIDE_STEP selects above.
+    results.push_back(bench_scalar<enigma::detail::enigma_c_encrypt_bytewise>(
+        "enigma_c_encrypt", keys.nettool_plain, enigma::ENIGMA_C_KEY_LENGTH, min_sample, "bytewise"));
+    results.push_back(bench_scalar<enigma::detail::enigma_c_encrypt_wide>(
+        "enigma_c_encrypt", keys.nettool_plain, enigma::ENIGMA_C_KEY_LENGTH, min_sample, "wide"));
+    results.push_back(bench_scalar<enigma::detail::enigma_c_decrypt_bytewise>(
+        "enigma_c_decrypt", keys.nettool_keys, enigma::ENIGMA_C_KEY_LENGTH, min_sample, "bytewise"));
+    results.push_back(bench_scalar<enigma::detail::enigma_c_decrypt_wide>(
+        "enigma_c_decrypt", keys.nettool_keys, enigma::ENIGMA_C_KEY_LENGTH, min_sample, "wide"));
+
+    const auto nibble = [](char c) { return static_cast<uint8_t>(enigma::detail::hex_value(c)); };
+    const auto same = [](char c) { return c; };
+    const auto nettool_plain = to_soa<uint8_t>(keys.nettool_plain, enigma::ENIGMA_C_KEY_LENGTH, nibble);
+    const auto nettool_keys = to_soa<uint8_t>(keys.nettool_keys, enigma::ENIGMA_C_KEY_LENGTH, nibble);
+    const auto enigma2_plain = to_soa<char>(keys.enigma2_plain, enigma::KEY_LENGTH, same);
+    const auto enigma2_keys = to_soa<char>(keys.enigma2_keys, enigma::KEY_LENGTH, same);
+    std::vector<uint8_t> nibbles(nettool_plain.size());
+    std::vector<char> chars(enigma2_plain.size());
+    std::vector<uint8_t> checksum_ok(SAMPLE_KEYS);
+
+    for (const auto level : {enigma::SimdLevel::scalar, enigma::SimdLevel::ssse3, enigma::SimdLevel::avx2,
+                             enigma::SimdLevel::avx512, enigma::SimdLevel::neon})
+    {
+        if (!enigma::simd_level_supported(level)) continue;
+        const std::string variant = enigma::simd_level_name(level);
+        const auto time = [&](const char* name, auto&& run)
+        {
+            const double seconds = best_seconds_per_item(SAMPLE_KEYS, min_sample, [&]
+            {
+                run();
+                sink = sink ^ nibbles[SAMPLE_KEYS - 1] ^ static_cast<uint8_t>(chars[SAMPLE_KEYS - 1]);
+            });
+            results.push_back({name, variant, 1, seconds * 1e9, 0});
+        };
+        time("enigma_c_encrypt_soa", [&]
+        {
+            enigma::enigma_c_encrypt_soa(level, nettool_plain.data(), nibbles.data(), enigma::ENIGMA_C_KEY_LENGTH,
+                                         SAMPLE_KEYS);
+        });
+        time("enigma_c_decrypt_soa", [&]
+        {
+            enigma::enigma_c_decrypt_soa(level, nettool_keys.data(), nibbles.data(), enigma::ENIGMA_C_KEY_LENGTH,
+                                         SAMPLE_KEYS);
+        });
+        time("enigma2_c_encrypt_soa", [&]
+        {
+            enigma::enigma2_c_encrypt_soa(level, enigma2_plain.data(), chars.data(), SAMPLE_KEYS);
+        });
+        time("enigma2_c_decrypt_soa", [&]
+        {
+            enigma::enigma2_c_decrypt_soa(level, enigma2_keys.data(), chars.data(), checksum_ok.data(), SAMPLE_KEYS);
+        });
+    }
+}
+
+// Text-to-packed conversions, and the algorithms on the packed forms.
+void bench_packed(const Settings& settings, std::vector<Result>& results)
+{
+    std::mt19937 rng(2468);
+    const KeySet keys = make_keys(rng);
+    const double min_sample = settings.quick ? 0.002 : 0.02;
+    std::vector<char> serials(SAMPLE_KEYS * enigma::SERIAL_NUMBER_SIZE_ENIGMAC);
+    for (auto& c : serials) c = static_cast<char>('0' + rng() % 10);
+
+    std::vector<uint64_t> packed_serials(SAMPLE_KEYS);
+    std::vector<enigma::PackedNetToolKey> nettool(SAMPLE_KEYS);
+    std::vector<enigma::PackedEnigma2Key> enigma2(SAMPLE_KEYS);
+    for (size_t k = 0; k < SAMPLE_KEYS; ++k)
+    {
+        const auto text = [](const std::vector<char>& all, size_t k, size_t length)
+        {
+            return std::string_view(all.data() + k * length, length);
+        };
+        (void)enigma::pack_serial(text(serials, k, enigma::SERIAL_NUMBER_SIZE_ENIGMAC), packed_serials[k]);
+        (void)enigma::pack_nettool_key(text(keys.nettool_keys, k, enigma::ENIGMA_C_KEY_LENGTH), nettool[k]);
+        (void)enigma::pack_enigma2_key(text(keys.enigma2_keys, k, enigma::KEY_LENGTH), enigma2[k]);
+    }
+
+    const auto time = [&](const char* name, const char* variant, auto&& run)
+    {
+        const double seconds = best_seconds_per_item(SAMPLE_KEYS, min_sample, [&]
+        {
+            uint64_t accumulated = 0;
+            for (size_t k = 0; k < SAMPLE_KEYS; ++k) accumulated ^= run(k);
+            sink = sink ^ static_cast<uint8_t>(accumulated);
+        });
+        results.push_back({name, variant, 1, seconds * 1e9, 0});
+    };
+    std::array<char, enigma::MAX_PACKED_SERIAL_DIGITS> out{};
+
+    time("pack_serial", "scalar", [&](size_t k)
+    {
+        uint64_t value = 0;
+        for (size_t d = 0; d < enigma::SERIAL_NUMBER_SIZE_ENIGMAC; ++d)
+        {
+            value = value * 10 + static_cast<uint64_t>(serials[k * enigma::SERIAL_NUMBER_SIZE_ENIGMAC + d] - '0');
+        }
+        return value;
+    });
+    time("pack_serial", "swar", [&](size_t k)
+    {
+        uint64_t value = 0;
+        (void)enigma::pack_serial(std::string_view(serials.data() + k * enigma::SERIAL_NUMBER_SIZE_ENIGMAC,
+                                                   enigma::SERIAL_NUMBER_SIZE_ENIGMAC), value);
+        return value;
+    });
+    time("format_serial", "swar", [&](size_t k)
+    {
+        enigma::format_serial(packed_serials[k], enigma::SERIAL_NUMBER_SIZE_ENIGMAC, out);
+        return static_cast<uint64_t>(out[k % enigma::SERIAL_NUMBER_SIZE_ENIGMAC]);
+    });
+    time("pack_nettool_key", "swar", [&](size_t k)
+    {
+        enigma::PackedNetToolKey key;
+        (void)enigma::pack_nettool_key(std::string_view(keys.nettool_keys.data() + k * enigma::ENIGMA_C_KEY_LENGTH,
+                                                        enigma::ENIGMA_C_KEY_LENGTH), key);
+        return key.nibbles;
+    });
+    time("format_nettool_key", "swar", [&](size_t k)
+    {
+        enigma::format_nettool_key(nettool[k], out);
+        return static_cast<uint64_t>(out[k % enigma::ENIGMA_C_KEY_LENGTH]);
+    });
+    time("pack_enigma2_key", "swar", [&](size_t k)
+    {
+        enigma::PackedEnigma2Key key;
+        (void)enigma::pack_enigma2_key(std::string_view(keys.enigma2_keys.data() + k * enigma::KEY_LENGTH,
+                                                        enigma::KEY_LENGTH), key);
+        return static_cast<uint64_t>(key.symbols[k % enigma::KEY_LENGTH]);
+    });
+    time("format_enigma2_key", "swar", [&](size_t k)
+    {
+        enigma::format_enigma2_key(enigma2[k], out);
+        return static_cast<uint64_t>(out[k % enigma::KEY_LENGTH]);
+    });
+    time("enigma_c_encrypt", "packed", [&](size_t k) { return enigma::enigma_c_encrypt(nettool[k]).nibbles; });
+    time("enigma_c_decrypt", "packed", [&](size_t k) { return enigma::enigma_c_decrypt(nettool[k]).nibbles; });
+    time("enigma2_c_encrypt", "packed", [&](size_t k)
+    {
+        return static_cast<uint64_t>(enigma::enigma2_c_encrypt(enigma2[k]).symbols[k % enigma::KEY_LENGTH]);
+    });
+    time("enigma2_c_decrypt", "packed", [&](size_t k)
+    {
+        enigma::PackedEnigma2Key plain;
+        return static_cast<uint64_t>(enigma::enigma2_c_decrypt(enigma2[k], plain)) ^ plain.symbols[2];
+    });
+}
+
+// SAMPLE_KEYS consecutive serials (the --range CLI path), from scratch with
+// the per-key functions and incrementally with the range cursors.
+void bench_range(const Settings& settings, std::vector<Result>& results)
+{
+    const double min_sample = settings.quick ? 0.002 : 0.02;
+    const auto time = [&](const char* name, const char* variant, auto&& run)
+    {
+        const double seconds = best_seconds_per_item(SAMPLE_KEYS, min_sample, [&] { sink = sink ^ run(); });
+        results.push_back({name, variant, 1, seconds * 1e9, 0});
+    };
+    std::array<char, enigma::MAX_PACKED_SERIAL_DIGITS> serial{};
+    constexpr uint64_t NETTOOL_FIRST = 3330000;
+    constexpr uint64_t ENIGMA2_FIRST = 600000;
+
+    time("nettool_range", "per_key", [&]
+    {
+        uint8_t accumulated = 0;
+        for (uint64_t k = 0; k < SAMPLE_KEYS; ++k)
+        {
+            enigma::format_serial(NETTOOL_FIRST + k, enigma::SERIAL_NUMBER_SIZE_ENIGMAC, serial);
+            const auto key = enigma::nettool_option_key(
+                std::string_view(serial.data(), enigma::SERIAL_NUMBER_SIZE_ENIGMAC), 4);
+            accumulated ^= static_cast<uint8_t>(key.key[k % enigma::ENIGMA_C_KEY_LENGTH]);
+        }
+        return accumulated;
+    });
+    time("nettool_range", "range", [&]
+    {
+        uint8_t accumulated = 0;
+        enigma::NetToolKeyRange range;
+        (void)range.start(NETTOOL_FIRST, 4);
+        for (uint64_t k = 0; k < SAMPLE_KEYS; ++k, range.advance())
+        {
+            accumulated ^= static_cast<uint8_t>(range.key()[k % enigma::ENIGMA_C_KEY_LENGTH]);
+        }
+        return accumulated;
+    });
+    time("enigma2_range", "per_key", [&]
+    {
+        uint8_t accumulated = 0;
+        for (uint64_t k = 0; k < SAMPLE_KEYS; ++k)
+        {
+            enigma::format_serial(ENIGMA2_FIRST + k, enigma::SERIAL_NUMBER_SIZE_ENIGMA2, serial);
+            const auto key = enigma::enigma2_option_key(
+                6963, std::string_view(serial.data(), enigma::SERIAL_NUMBER_SIZE_ENIGMA2), 7);
+            accumulated ^= static_cast<uint8_t>(key.key[k % enigma::KEY_LENGTH]);
+        }
+        return accumulated;
+    });
+    time("enigma2_range", "range", [&]
+    {
+        uint8_t accumulated = 0;
+        enigma::Enigma2KeyRange range;
+        (void)range.start(6963, ENIGMA2_FIRST, 7);
+        for (uint64_t k = 0; k < SAMPLE_KEYS; ++k, range.advance())
+        {
+            accumulated ^= static_cast<uint8_t>(range.key()[k % enigma::KEY_LENGTH]);
+        }
+        return accumulated;
+    });
+}
+
+// generate_keys() on integer serials, as the C ABI and Python module call
+// it, against formatting each serial and generating its key alone.
+void bench_generate_keys(const Settings& settings, std::vector<Result>& results)
+{
+    const double min_sample = settings.quick ? 0.002 : 0.02;
+    std::mt19937_64 rng(31337);
+    std::vector<uint64_t> serials(SAMPLE_KEYS);
+    std::vector<int32_t> options(SAMPLE_KEYS);
+    for (size_t k = 0; k < SAMPLE_KEYS; ++k)
+    {
+        serials[k] = rng() % (enigma::ENIGMA2_MAX_SERIAL + 1);
+        options[k] = static_cast<int32_t>(rng() % 10);
+    }
+    std::vector<char> keys(SAMPLE_KEYS * enigma::KEY_LENGTH);
+    std::array<char, enigma::MAX_PACKED_SERIAL_DIGITS> serial{};
+    const auto time = [&](const char* name, const char* variant, auto&& run)
+    {
+        const double seconds = best_seconds_per_item(SAMPLE_KEYS, min_sample, [&]
+        {
+            run();
+            sink = sink ^ static_cast<uint8_t>(keys[SAMPLE_KEYS - 1]);
+        });
+        results.push_back({name, variant, 1, seconds * 1e9, 0});
+    };
+
+    time("nettool_many", "per_key", [&]
+    {
+        for (size_t k = 0; k < SAMPLE_KEYS; ++k)
+        {
+            enigma::format_serial(serials[k], enigma::SERIAL_NUMBER_SIZE_ENIGMAC, serial);
+            const auto key = enigma::nettool_option_key(
+                std::string_view(serial.data(), enigma::SERIAL_NUMBER_SIZE_ENIGMAC), options[k]);
+            std::copy(key.key.begin(), key.key.end(), keys.begin() + k * enigma::ENIGMA_C_KEY_LENGTH);
+        }
+    });
+    time("nettool_many", "typed_array", [&] { (void)enigma::generate_keys('n', -1, serials, options, keys); });
+    time("enigma2_many", "per_key", [&]
+    {
+        for (size_t k = 0; k < SAMPLE_KEYS; ++k)
+        {
+            enigma::format_serial(serials[k], enigma::SERIAL_NUMBER_SIZE_ENIGMA2, serial);
+            const auto key = enigma::enigma2_option_key(
+                6963, std::string_view(serial.data(), enigma::SERIAL_NUMBER_SIZE_ENIGMA2), options[k]);
+            std::copy(key.key.begin(), key.key.end(), keys.begin() + k * enigma::KEY_LENGTH);
+        }
+    });
+    time("enigma2_many", "typed_array", [&] { (void)enigma::generate_keys('e', 6963, serials, options, keys); });
+}
+
+// A manifest with an even mix of the three record modes.
+std::string make_manifest(size_t records)
+{
+    std::mt19937 rng(54321);
+    std::string manifest;
+    manifest.reserve(records * 22);
+    for (size_t i = 0; i < records; ++i)
+    {
+        const unsigned mode = rng() % 3;
+        manifest.push_back("nel"[mode]);
+        manifest.push_back(',');
+        const size_t digits = mode == 0 ? enigma::SERIAL_NUMBER_SIZE_ENIGMAC : enigma::SERIAL_NUMBER_SIZE_ENIGMA2;
+        for (size_t d = 0; d < digits; ++d) manifest.push_back(static_cast<char>('0' + rng() % 10));
+        manifest.push_back(',');
+        manifest.append(std::to_string(rng() % (mode == 0 ? 10 : 1000)));
+        manifest.push_back('\n');
+    }
+    return manifest;
+}
+
+// Verification records for keys of both algorithms; one in eight asks for
+// the wrong option, so both outcomes are exercised.
+std::string make_verify_manifest(size_t records)
+{
+    std::mt19937 rng(98765);
+    std::string manifest;
+    manifest.reserve(records * 30);
+    for (size_t i = 0; i < records; ++i)
+    {
+        const bool nettool = rng() % 2 == 0;
+        const size_t digits = nettool ? enigma::SERIAL_NUMBER_SIZE_ENIGMAC : enigma::SERIAL_NUMBER_SIZE_ENIGMA2;
+        std::string serial;
+        for (size_t d = 0; d < digits; ++d) serial.push_back(static_cast<char>('0' + rng() % 10));
+        const int option = static_cast<int>(rng() % (nettool ? 10 : 1000));
+        if (nettool) manifest.append(enigma::nettool_option_key(serial, option).view());
+        else manifest.append(enigma::enigma2_option_key(6963, serial, option).view());
+        manifest.push_back(',');
+        manifest.append(serial);
+        manifest.push_back(',');
+        manifest.append(std::to_string(rng() % 8 == 0 ? (option + 1) % 10 : option));
+        manifest.push_back('\n');
+    }
+    return manifest;
+}
+
+std::vector<unsigned> thread_counts(const Settings& settings)
+{
+    const unsigned hardware = std::max(1u, std::thread::hardware_concurrency());
+    const unsigned limit = settings.max_threads ? settings.max_threads : hardware;
+    std::vector<unsigned> counts;
+    for (unsigned threads = 1; threads <= limit; threads *= 2) counts.push_back(threads);
+    if (counts.back() != limit) counts.push_back(limit);
+    return counts;
+}
+
+// parallel_for() over tasks of 16 NetTool keys, then over the same tasks
+// when those in the first thread's starting slice take 16 times as long.
+// Work stealing should keep the skewed run's ns/key close to the uniform
+// one's. ns_per_key is per key encrypted, task overhead included.
+void bench_thread_pool(const Settings& settings, std::vector<Result>& results)
+{
+    constexpr size_t TASKS = 4096;
+    constexpr size_t TASK_KEYS = 16;
+    const double min_sample = settings.quick ? 0.001 : 0.05;
+    std::vector<uint8_t> outputs(TASKS);
+    for (const unsigned threads : thread_counts(settings))
+    {
+        enigma::ThreadPool pool(threads);
+        for (const bool skewed : {false, true})
+        {
+            const size_t heavy = skewed ? TASKS / threads : 0;
+            const size_t keys = TASKS * TASK_KEYS + heavy * TASK_KEYS * 15;
+            const double seconds = best_seconds_per_item(keys, min_sample, [&]
+            {
+                pool.parallel_for(TASKS, [&](size_t task)
+                {
+                    std::array<char, enigma::ENIGMA_C_KEY_LENGTH> plain{'0', '4', '6', '1', '0', '3', '3', '3', '3',
+                                                                        '0', '0', '0'};
+                    std::array<char, enigma::ENIGMA_C_KEY_LENGTH> key{};
+                    uint8_t accumulated = 0;
+                    for (size_t k = 0; k < (task < heavy ? 16 : 1) * TASK_KEYS; ++k)
+                    {
+                        plain.back() = static_cast<char>('0' + (task + k) % 10);
+                        (void)enigma::enigma_c_encrypt(std::string_view(plain.data(), plain.size()), key);
+                        accumulated ^= static_cast<uint8_t>(key[k % key.size()]);
+                    }
+                    outputs[task] = accumulated;
+                });
+                sink = sink ^ outputs[TASKS / 2];
+            });
+            results.push_back({"thread_pool", skewed ? "skewed" : "uniform", threads, seconds * 1e9, 0});
+        }
+    }
+}
+
+void bench_batch(const Settings& settings, std::vector<Result>& results)
+{
+    const size_t records = settings.quick ? std::min<size_t>(settings.records, 20'000) : settings.records;
+    const std::string manifest = make_manifest(records);
+    const double megabytes = static_cast<double>(manifest.size()) / 1e6;
+    const double min_sample = settings.quick ? 0.001 : 0.1;
+
+    for (const unsigned threads : thread_counts(settings))
+    {
+        for (const bool pinned : {false, true})
+        {
+            enigma::ThreadPool pool(threads, pinned);
+            std::vector<std::string> chunk_outputs;
+            double allocations = 0;
+            const double seconds = best_seconds_per_item(records, min_sample, [&]
+            {
+                (void)enigma::generate_batch_parallel(manifest, pool, chunk_outputs);
+            }, &allocations);
+            results.push_back({"generate_batch_parallel", pinned ? "memory_pinned" : "memory", threads, seconds * 1e9,
+                               megabytes / (seconds * static_cast<double>(records)), allocations});
+        }
+    }
+
+    // The same records pulled one at a time through the coroutine stream.
+    std::vector<std::string_view> lines;
+    for (std::string_view rest = manifest; !rest.empty();)
+    {
+        const size_t newline = std::min(rest.find('\n'), rest.size());
+        lines.push_back(rest.substr(0, newline));
+        rest.remove_prefix(std::min(newline + 1, rest.size()));
+    }
+    double stream_allocations = 0;
+    const double stream_seconds = best_seconds_per_item(records, min_sample, [&]
+    {
+        size_t bytes = 0;
+        for (const std::string_view chunk : enigma::stream_batch(lines)) bytes += chunk.size();
+        sink = sink ^ static_cast<uint8_t>(bytes);
+    }, &stream_allocations);
+    results.push_back({"stream_batch", "lines", 1, stream_seconds * 1e9,
+                       megabytes / (stream_seconds * static_cast<double>(records)), stream_allocations});
+
+    const std::string verify_manifest = make_verify_manifest(records);
+    const double verify_megabytes = static_cast<double>(verify_manifest.size()) / 1e6;
+    for (const unsigned threads : thread_counts(settings))
+    {
+        enigma::ThreadPool pool(threads);
+        std::vector<std::string> chunk_outputs;
+        for (const auto format : {enigma::VerifyFormat::tsv, enigma::VerifyFormat::json})
+        {
+            double allocations = 0;
+            const double seconds = best_seconds_per_item(records, min_sample, [&]
+            {
+                (void)enigma::verify_batch_parallel(verify_manifest, pool, chunk_outputs, format);
+            }, &allocations);
+            results.push_back({"verify_batch_parallel", format == enigma::VerifyFormat::tsv ? "tsv" : "json", threads,
+                               seconds * 1e9, verify_megabytes / (seconds * static_cast<double>(records)),
+                               allocations});
+        }
+    }
+
+    // End to end from a file: the library path, then the CLI as a user runs it.
+    const auto path = std::filesystem::temp_directory_path() /
+        ("enigma_bench_" + std::to_string(std::random_device{}()) + ".txt");
+    std::ofstream(path, std::ios::binary).write(manifest.data(), static_cast<std::streamsize>(manifest.size()));
+    const unsigned threads = thread_counts(settings).back();
+
+    if (std::FILE* devnull = std::fopen("/dev/null", "wb"))
+    {
+        const enigma::BatchOptions options{threads};
+        double allocations = 0;
+        const double seconds = best_seconds_per_item(records, min_sample, [&]
+        {
+            (void)enigma::run_batch_file(path.string().c_str(), devnull, options);
+        }, &allocations);
+        results.push_back({"run_batch_file", "file", threads, seconds * 1e9,
+                           megabytes / (seconds * static_cast<double>(records)), allocations});
+        std::fclose(devnull);
+    }
+
+    // Each output format to a real file, through the page cache and with O_DIRECT.
+    auto output_path = path;
+    output_path.replace_extension(".out");
+    for (const auto format : {enigma::KeyFormat::text, enigma::KeyFormat::binary})
+    {
+        for (const bool direct : {false, true})
+        {
+            enigma::BatchOptions options{threads};
+            options.output = format;
+            bool failed = false;
+            double allocations = 0;
+            const double seconds = best_seconds_per_item(records, min_sample, [&]
+            {
+                std::string error;
+                const auto output = enigma::OutputFile::open(output_path.string().c_str(), direct, error);
+                failed = failed || !output || !enigma::run_batch_file(path.string().c_str(), *output, options) ||
+                         !output->close();
+            }, &allocations);
+            if (failed) continue;
+            const std::string variant = std::string(format == enigma::KeyFormat::text ? "text" : "binary") +
+                (direct ? "_direct" : "");
+            results.push_back({"run_batch_output", variant, threads, seconds * 1e9,
+                               megabytes / (seconds * static_cast<double>(records)), allocations});
+        }
+    }
+    std::filesystem::remove(output_path);
+
+    if (!settings.cli_path.empty() && std::filesystem::exists(settings.cli_path))
+    {
+        const std::string command = "\"" + settings.cli_path + "\" --batch \"" + path.string() + "\" --jobs " +
+            std::to_string(threads) + " > /dev/null";
+        bool failed = false;
+        const double seconds = best_seconds_per_item(records, min_sample, [&]
+        {
+            failed = failed || std::system(command.c_str()) != 0;
+        });
+        if (!failed)
+        {
+            results.push_back({"cli_batch_file", "process", threads, seconds * 1e9,
+                               megabytes / (seconds * static_cast<double>(records))});
+        }
+    }
+    std::filesystem::remove(path);
+}
+
+// A repeat-heavy manifest: records drawn from REPEAT_DISTINCT distinct ones,
+// with and without a cache large enough to hold them all. Per record through
+// the batch engine, and one at a time as the server's GEN does.
+void bench_key_cache(const Settings& settings, std::vector<Result>& results)
+{
+    constexpr size_t REPEAT_DISTINCT = 4096;
+    const size_t records = settings.quick ? std::min<size_t>(settings.records, 20'000) : settings.records;
+    const double min_sample = settings.quick ? 0.001 : 0.1;
+    const std::string distinct = make_manifest(REPEAT_DISTINCT);
+    std::vector<std::string_view> lines;
+    for (size_t pos = 0; pos < distinct.size();)
+    {
+        const size_t end = distinct.find('\n', pos);
+        lines.push_back(std::string_view(distinct).substr(pos, end - pos));
+        pos = end + 1;
+    }
+    std::mt19937 rng(4242);
+    std::string manifest;
+    std::vector<std::string_view> requests;
+    for (size_t i = 0; i < records; ++i)
+    {
+        const std::string_view line = lines[rng() % lines.size()];
+        manifest.append(line);
+        manifest.push_back('\n');
+        if (requests.size() < SAMPLE_KEYS) requests.push_back(line);
+    }
+    const double megabytes = static_cast<double>(manifest.size()) / 1e6;
+
+    for (const bool cached : {false, true})
+    {
+        enigma::KeyCache cache(2 * REPEAT_DISTINCT);
+        enigma::KeyCache* const used = cached ? &cache : nullptr;
+        std::string output;
+        double allocations = 0;
+        const double seconds = best_seconds_per_item(records, min_sample, [&]
+        {
+            output.clear();
+            (void)enigma::generate_batch(manifest, output, used);
+        }, &allocations);
+        results.push_back({"generate_batch", cached ? "cached" : "uncached", 1, seconds * 1e9,
+                           megabytes / (seconds * static_cast<double>(records)), allocations});
+
+        enigma::KeyBuffer key{};
+        size_t key_length = 0;
+        double request_allocations = 0;
+        const double per_request = best_seconds_per_item(requests.size(), min_sample, [&]
+        {
+            uint8_t accumulated = 0;
+            for (const auto request : requests)
+            {
+                accumulated ^= static_cast<uint8_t>(enigma::generate_record_key(request, key, key_length, used));
+                accumulated ^= static_cast<uint8_t>(key[0]);
+            }
+            sink = sink ^ accumulated;
+        }, &request_allocations);
+        results.push_back({"generate_record_key", cached ? "cached" : "uncached", 1, per_request * 1e9, 0,
+                           request_allocations});
+    }
+}
+
+// Cost of one instrumentation hook, a counter bump or a scoped timer, plus
+// a volatile store. The variant says whether this build records them
+// (ENIGMA_STATS) or compiles them away, leaving only the store.
+void bench_stats(const Settings& settings, std::vector<Result>& results)
+{
+    const double min_sample = settings.quick ? 0.001 : 0.1;
+    const char* variant = enigma::stats::enabled ? "enabled" : "disabled";
+    const double count = best_seconds_per_item(SAMPLE_KEYS, min_sample, []
+    {
+        for (size_t k = 0; k < SAMPLE_KEYS; ++k)
+        {
+            enigma::stats::count(enigma::stats::Counter::keys_encrypted);
+            sink = sink + 1;
+        }
+    });
+    results.push_back({"stats_count", variant, 1, count * 1e9, 0});
+    const double timer = best_seconds_per_item(SAMPLE_KEYS, min_sample, []
+    {
+        for (size_t k = 0; k < SAMPLE_KEYS; ++k)
+        {
+            const enigma::stats::ScopedTimer scope(enigma::stats::Timer::encrypt_block);
+            sink = sink + 1;
+        }
+    });
+    results.push_back({"stats_timer", variant, 1, timer * 1e9, 0});
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+// Starts path with args and standard output on /dev/null, then waits for
+// it. False if it could not be started or exited with a non-zero status.
+bool run_process(const std::string& path, std::initializer_list<const char*> args)
+{
+    std::vector<char*> argv{const_cast<char*>(path.c_str())};
+    for (const char* arg : args) argv.push_back(const_cast<char*>(arg));
+    argv.push_back(nullptr);
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_addopen(&actions, STDOUT_FILENO, "/dev/null", O_WRONLY, 0);
+    pid_t pid = 0;
+    const int spawned = posix_spawn(&pid, path.c_str(), &actions, nullptr, argv.data(), environ);
+    posix_spawn_file_actions_destroy(&actions);
+    int status = 0;
+    return spawned == 0 && waitpid(pid, &status, 0) == pid && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+// Cold start of one-shot CLI invocations, spawned directly rather than
+// through a shell; ns_per_key is per process here. /bin/true is the cost of
+// spawning any process on this machine. --compare-cli times a second binary,
+// such as the default build next to an ENIGMA_LEAN_CLI one.
+void bench_startup(const Settings& settings, std::vector<Result>& results)
+{
+    const double min_sample = settings.quick ? 0.001 : 0.2;
+    const auto time_process = [&](const char* name, const char* variant, const std::string& path,
+                                  std::initializer_list<const char*> args)
+    {
+        if (path.empty() || !std::filesystem::exists(path)) return;
+        bool failed = false;
+        const double seconds = best_seconds_per_item(1, min_sample, [&]
+        {
+            failed = failed || !run_process(path, args);
+        });
+        if (!failed) results.push_back({name, variant, 1, seconds * 1e9, 0});
+    };
+    time_process("process_spawn", "bin_true", "/bin/true", {});
+    for (const auto& [name, path] : {std::pair{"cli_startup", settings.cli_path},
+                                     std::pair{"cli_startup_compare", settings.compare_cli_path}})
+    {
+        time_process(name, "version", path, {"-V"});
+        time_process(name, "nettool_key", path, {"-n", "0003333016", "4"});
+        time_process(name, "enigma2_key", path, {"-e", "0000607", "7", "6963"});
+    }
+}
+#endif
+
+// Cold catalog load from a file of CATALOG_PRODUCTS products with four
+// options each: parsing the JSON, then mapping the compiled index. ns_per_key
+// is per load here.
+void bench_catalog(const Settings& settings, std::vector<Result>& results)
+{
+    constexpr int CATALOG_PRODUCTS = 2000;
+    std::string json = "{\"products\": [\n";
+    for (int code = 0; code < CATALOG_PRODUCTS; ++code)
+    {
+        json += (code ? ",\n" : "");
+        json += "{\"code\": " + std::to_string(code) + ", \"abbr\": \"P" + std::to_string(code) +
+            "\", \"name\": \"Product " + std::to_string(code) + "\", \"options\": [";
+        for (int option = 0; option < 4; ++option)
+        {
+            json += (option ? ", " : "");
+            json += "{\"code\": " + std::to_string(option) + ", \"desc\": \"Option " + std::to_string(option) + "\"}";
+        }
+        json += "]}";
+    }
+    json += "\n]}\n";
+
+    const auto path = std::filesystem::temp_directory_path() /
+        ("enigma_bench_" + std::to_string(std::random_device{}()) + ".json");
+    std::ofstream(path, std::ios::binary).write(json.data(), static_cast<std::streamsize>(json.size()));
+    const double megabytes = static_cast<double>(json.size()) / 1e6;
+    const double min_sample = settings.quick ? 0.001 : 0.1;
+    std::string error;
+
+    for (const bool use_cache : {false, true})
+    {
+        if (use_cache) (void)enigma::LoadedCatalog::load(path.string(), error); // writes the index
+        bool failed = false;
+        const double seconds = best_seconds_per_item(1, min_sample, [&]
+        {
+            const auto loaded = enigma::LoadedCatalog::load(path.string(), error, use_cache);
+            failed = failed || !loaded || loaded->from_cache() != use_cache;
+        });
+        if (!failed)
+        {
+            results.push_back({"catalog_load", use_cache ? "cache" : "json", 1, seconds * 1e9,
+                               use_cache ? 0 : megabytes / seconds});
+        }
+    }
+    std::filesystem::remove(path);
+    std::filesystem::remove(path.string() + ".cache");
+}
+
+#ifdef ENIGMA_HAVE_SERVER
+// Sends request and reads until replies complete response lines arrive.
+bool round_trip(int fd, const std::string& request, size_t replies, std::string& buffer)
+{
+    if (write(fd, request.data(), request.size()) != static_cast<ssize_t>(request.size())) return false;
+    size_t lines = 0;
+    while (lines < replies)
+    {
+        buffer.resize(64 * 1024);
+        const ssize_t received = read(fd, buffer.data(), buffer.size());
+        if (received <= 0) return false;
+        lines += static_cast<size_t>(std::count(buffer.begin(), buffer.begin() + received, '\n'));
+    }
+    return true;
+}
+
+// Request latency through --serve's server on a Unix socket: p50 and p99
+// of single round trips, then the per-request cost when PIPELINE requests
+// share each write.
+void bench_server(const Settings& settings, std::vector<Result>& results)
+{
+    constexpr size_t PIPELINE = 64;
+    const auto path = std::filesystem::temp_directory_path() /
+        ("enigma_bench_" + std::to_string(std::random_device{}()) + ".sock");
+    std::string error;
+    const auto server = enigma::Server::listen({"unix:" + path.string()}, error);
+    if (!server) return;
+    std::thread serving([&] { server->run(); });
+
+    const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    const std::string name = path.string();
+    std::memcpy(address.sun_path, name.c_str(), std::min(name.size() + 1, sizeof(address.sun_path)));
+    if (connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == 0)
+    {
+        const std::string request = "GEN e,0000607,7,6963\n";
+        std::string buffer;
+        const size_t trips = settings.quick ? 500 : 20'000;
+        std::vector<double> latencies;
+        latencies.reserve(trips);
+        bool failed = false;
+        for (size_t i = 0; i < trips && !failed; ++i)
+        {
+            const auto start = Clock::now();
+            failed = !round_trip(fd, request, 1, buffer);
+            latencies.push_back(seconds_since(start) * 1e9);
+        }
+        if (!failed)
+        {
+            std::sort(latencies.begin(), latencies.end());
+            results.push_back({"server_round_trip", "p50", 1, latencies[latencies.size() / 2], 0});
+            results.push_back({"server_round_trip", "p99", 1, latencies[latencies.size() * 99 / 100], 0});
+        }
+
+        std::string pipelined;
+        for (size_t i = 0; i < PIPELINE; ++i) pipelined += request;
+        double allocations = 0;
+        const double seconds = best_seconds_per_item(PIPELINE, settings.quick ? 0.001 : 0.1, [&]
+        {
+            failed = failed || !round_trip(fd, pipelined, PIPELINE, buffer);
+        }, &allocations);
+        if (!failed) results.push_back({"server_pipelined", "unix", 1, seconds * 1e9, 0, allocations});
+
+        // A fresh connection per request: the server reuses closed
+        // connections, so this is connect, one round trip and close.
+        double connection_allocations = 0;
+        const double per_connection = best_seconds_per_item(1, settings.quick ? 0.001 : 0.1, [&]
+        {
+            const int client = socket(AF_UNIX, SOCK_STREAM, 0);
+            failed = failed || connect(client, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 ||
+                     !round_trip(client, request, 1, buffer);
+            close(client);
+        }, &connection_allocations);
+        if (!failed)
+        {
+            results.push_back({"server_connection", "unix", 1, per_connection * 1e9, 0, connection_allocations});
+        }
+    }
+    close(fd);
+    server->stop();
+    serving.join();
+}
+#endif
+
+void print_table(const std::vector<Result>& results)
+{
+    std::cout << "SIMD level: " << enigma::simd_level_name(enigma::simd_level()) << "\n\n";
+    std::cout << std::left << std::setw(26) << "benchmark" << std::setw(14) << "variant" << std::right
+        << std::setw(8) << "threads" << std::setw(12) << "ns/key" << std::setw(12) << "Mkeys/s" << std::setw(10)
+        << "MB/s" << std::setw(12) << "allocs/key" << "\n";
+    for (const auto& result : results)
+    {
+        std::cout << std::left << std::setw(26) << result.name << std::setw(14) << result.variant << std::right
+            << std::setw(8) << result.threads << std::fixed << std::setprecision(2) << std::setw(12)
+            << result.ns_per_key << std::setw(12) << 1e3 / result.ns_per_key << std::setw(10);
+        if (result.mb_per_second > 0) std::cout << result.mb_per_second;
+        else std::cout << "-";
+        std::cout << std::setw(12);
+        if (result.allocations_per_key >= 0) std::cout << std::setprecision(4) << result.allocations_per_key;
+        else std::cout << "-";
+        std::cout << "\n";
+    }
+}
+
+void write_json(std::ostream& out, const std::vector<Result>& results, const Settings& settings)
+{
+    out << "{\n";
+    out << "  \"version\": \"" << BENCH_VERSION << "\",\n";
+    out << "  \"simd_level\": \"" << enigma::simd_level_name(enigma::simd_level()) << "\",\n";
+    out << "  \"hardware_threads\": " << std::thread::hardware_concurrency() << ",\n";
+    out << "  \"quick\": " << (settings.quick ? "true" : "false") << ",\n";
+    out << "  \"results\": [\n";
+    out << std::setprecision(6);
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const auto& result = results[i];
+        out << "    {\"name\": \"" << result.name << "\", \"variant\": \"" << result.variant << "\", \"threads\": "
+            << result.threads << ", \"ns_per_key\": " << result.ns_per_key << ", \"keys_per_second\": "
+            << 1e9 / result.ns_per_key;
+        if (result.mb_per_second > 0) out << ", \"mb_per_second\": " << result.mb_per_second;
+        if (result.allocations_per_key >= 0) out << ", \"allocations_per_key\": " << result.allocations_per_key;
+        out << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+}
+
+void display_help()
+{
+    std::cout << "Usage: enigma_bench [options]\n"
+        << "  --quick            Short run with small inputs (used by the test suite)\n"
+        << "  --records N        Records in the batch manifest (default 1000000)\n"
+        << "  --max-threads N    Largest thread count for the batch benchmarks (default: hardware threads)\n"
+        << "  --json FILE        Also write results as JSON to FILE (- for stdout)\n"
+        << "  --cli PATH         enigma_v300_pure_cpp binary for the end-to-end and startup benchmarks\n"
+        << "  --compare-cli PATH Second CLI binary to time in the startup benchmark\n"
+        << "  -h, --help         Show this help\n";
+}
+
+bool parse_count(const char* text, size_t& value)
+{
+    char* end = nullptr;
+    const unsigned long long parsed = std::strtoull(text, &end, 10);
+    if (end == text || *end != '\0' || parsed == 0) return false;
+    value = static_cast<size_t>(parsed);
+    return true;
+}
+} // namespace
+
+// Count into heap_allocations. The array and nothrow forms forward to
+// these two.
+void* operator new(size_t size)
+{
+    heap_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* memory = std::malloc(size ? size : 1)) return memory;
+    throw std::bad_alloc();
+}
+
+void* operator new(size_t size, std::align_val_t alignment)
+{
+    heap_allocations.fetch_add(1, std::memory_order_relaxed);
+    const auto align = static_cast<size_t>(alignment);
+    if (void* memory = std::aligned_alloc(align, (size + align - 1) / align * align)) return memory;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* memory, std::align_val_t) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void* memory, size_t, std::align_val_t) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void* memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept
+{
+    std::free(memory);
+}
+
+int main(int argc, char* argv[])
+{
+    Settings settings;
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string_view arg = argv[i];
+        const bool has_value = i + 1 < argc;
+        size_t count = 0;
+        if (arg == "-h" || arg == "--help")
+        {
+            display_help();
+            return 0;
+        }
+        if (arg == "--quick")
+        {
+            settings.quick = true;
+        }
+        else if (arg == "--records" && has_value && parse_count(argv[i + 1], count))
+        {
+            settings.records = count;
+            ++i;
+        }
+        else if (arg == "--max-threads" && has_value && parse_count(argv[i + 1], count))
+        {
+            settings.max_threads = static_cast<unsigned>(count);
+            ++i;
+        }
+        else if (arg == "--json" && has_value)
+        {
+            settings.json_path = argv[++i];
+        }
+        else if (arg == "--cli" && has_value)
+        {
+            settings.cli_path = argv[++i];
+        }
+        else if (arg == "--compare-cli" && has_value)
+        {
+            settings.compare_cli_path = argv[++i];
+        }
+        else
+        {
+            std::cerr << "Error: unknown or incomplete option " << arg << "\n";
+            display_help();
+            return 1;
+        }
+    }
+
+    std::vector<Result> results;
+    bench_algorithms(settings, results);
+    bench_packed(settings, results);
+    bench_range(settings, results);
+    bench_generate_keys(settings, results);
+    bench_thread_pool(settings, results);
+    bench_batch(settings, results);
+    bench_key_cache(settings, results);
+    bench_catalog(settings, results);
+    bench_stats(settings, results);
+#if defined(__unix__) || defined(__APPLE__)
+    bench_startup(settings, results);
+#endif
+#ifdef ENIGMA_HAVE_SERVER
+    bench_server(settings, results);
+#endif
+
+    if (settings.json_path == "-")
+    {
+        write_json(std::cout, results, settings);
+        return 0;
+    }
+    print_table(results);
+    if (!settings.json_path.empty())
+    {
+        std::ofstream json(settings.json_path);
+        write_json(json, results, settings);
+        if (!json)
+        {
+            std::cerr << "Error: cannot write " << settings.json_path << "\n";
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,789 @@
+// File: enigma_diffbench.cpp
+// Author: Kris Armstrong
+// Version: 3.0.0
+// Last Modified: 2026-10-14
+// Description: Differential harness: random valid records through every key path and the C implementation, checked
+//              for bit-exact agreement, with keys/s per variant.
+// License: MIT
+
+#include "enigma_v300_pure_cpp.h"
+#include "enigma_batch.h"
+#include "enigma_engine.h"
+#include "enigma_packed.h"
+#include "enigma_range.h"
+#include "enigma_simd.h"
+
+#ifdef ENIGMA_DIFFBENCH_C_REFERENCE
+#include "enigma_v300_pure_c.h"
+#endif
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace
+{
+constexpr auto DIFFBENCH_VERSION = "3.0.0";
+constexpr size_t SEGMENT_RECORDS = 4096; // records sharing a mode and product
+constexpr size_t MAX_RUN = 64;           // consecutive serials sharing an option
+constexpr size_t BLOCK = 64;             // keys per struct-of-arrays kernel call, as in the batch engine
+
+constexpr std::array<enigma::SimdLevel, 5> SIMD_LEVELS = {enigma::SimdLevel::scalar, enigma::SimdLevel::ssse3,
+                                                          enigma::SimdLevel::avx2, enigma::SimdLevel::avx512,
+                                                          enigma::SimdLevel::neon};
+
+struct Settings
+{
+    bool quick = false;
+    size_t records = 1'000'000; // per algorithm
+    uint32_t seed = 1;
+    std::string json_path;
+};
+
+// One algorithm's random records. Serials come in runs of consecutive values
+// with one option, so the range cursors advance() across digit carries, and
+// every SEGMENT_RECORDS records share a mode and product, as generate_keys()
+// takes them.
+struct Records
+{
+    bool nettool = true;
+    size_t key_length = 0;
+    std::vector<uint64_t> serials;
+    std::vector<int32_t> options;
+    std::vector<char> modes;   // per segment
+    std::vector<int> products; // per segment; unused for NetTool
+    std::vector<size_t> runs;  // first record of each run, then size()
+    std::string batch;         // the records as generate_batch() input
+};
+
+size_t serial_digits(const Records& records)
+{
+    return records.nettool ? enigma::SERIAL_NUMBER_SIZE_ENIGMAC : enigma::SERIAL_NUMBER_SIZE_ENIGMA2;
+}
+
+Records make_records(bool nettool, size_t count, std::mt19937_64& rng)
+{
+    Records records;
+    records.nettool = nettool;
+    records.key_length = nettool ? enigma::ENIGMA_C_KEY_LENGTH : enigma::KEY_LENGTH;
+    records.serials.reserve(count);
+    records.options.reserve(count);
+    const uint64_t max_serial = nettool ? enigma::NETTOOL_MAX_SERIAL : enigma::ENIGMA2_MAX_SERIAL;
+    const int max_option = nettool ? enigma::NETTOOL_MAX_OPTION : enigma::ENIGMA2_MAX_OPTION;
+    const size_t digits = serial_digits(records);
+    std::array<char, enigma::MAX_PACKED_SERIAL_DIGITS> serial_text{};
+
+    for (size_t first = 0; first < count; first += SEGMENT_RECORDS)
+    {
+        const char mode = nettool ? 'n' : (rng() % 2 ? 'e' : 'l');
+        const int product = static_cast<int>(rng() % (enigma::MAX_PRODUCT_CODE + 1));
+        records.modes.push_back(mode);
+        records.products.push_back(product);
+        const size_t last = std::min(count, first + SEGMENT_RECORDS);
+        for (size_t start = first; start < last;)
+        {
+            const size_t run = std::min<size_t>(1 + rng() % MAX_RUN, last - start);
+            uint64_t serial = rng() % (max_serial + 1);
+            if (rng() % 4 == 0)
+            {
+                // End just short of a run of nines, so the run carries through several digits.
+                uint64_t power = 10;
+                for (uint64_t nines = 1 + rng() % (digits - 1); nines > 1; --nines) power *= 10;
+                serial = serial - serial % power + power - 1 - rng() % std::min<uint64_t>(run, power);
+            }
+            serial = std::min(serial, max_serial + 1 - run);
+            const auto option = static_cast<int32_t>(rng() % static_cast<uint64_t>(max_option + 1));
+            records.runs.push_back(start);
+            for (size_t k = 0; k < run; ++k)
+            {
+                records.serials.push_back(serial + k);
+                records.options.push_back(option);
+                enigma::format_serial(serial + k, digits, serial_text);
+                records.batch += mode;
+                records.batch += ',';
+                records.batch.append(serial_text.data(), digits);
+                records.batch += ',';
+                records.batch += std::to_string(option);
+                if (!nettool)
+                {
+                    records.batch += ',';
+                    records.batch += std::to_string(product);
+                }
+                records.batch += '\n';
+            }
+            start += run;
+        }
+    }
+    records.runs.push_back(count);
+    return records;
+}
+
+int record_product(const Records& records, size_t index)
+{
+    return records.products[index / SEGMENT_RECORDS];
+}
+
+// The plain layout encrypt() takes for record index, as nettool_option_key()
+// and enigma2_option_key() build it.
+void plain_layout(const Records& records, size_t index, std::span<char> plain)
+{
+    std::array<char, enigma::MAX_PACKED_SERIAL_DIGITS> serial{};
+    const size_t digits = serial_digits(records);
+    enigma::format_serial(records.serials[index], digits, serial);
+    const std::string_view serial_view(serial.data(), digits);
+    if (records.nettool)
+    {
+        std::array<char, enigma::ENIGMA_C_KEY_LENGTH> layout{};
+        (void)enigma::detail::nettool_plain_key(serial_view, records.options[index], layout);
+        std::copy(layout.begin(), layout.end(), plain.begin());
+    }
+    else
+    {
+        std::array<char, enigma::KEY_LENGTH> layout{};
+        (void)enigma::detail::enigma2_plain_key(record_product(records, index), serial_view, records.options[index],
+                                                 layout);
+        std::copy(layout.begin(), layout.end(), plain.begin());
+    }
+}
+
+// A variant writes one fixed-width result per input to out, all '\0' for an
+// input it rejects.
+struct Variant
+{
+    std::string name;
+    std::function<void(char* out)> run;
+};
+
+// One operation on one algorithm. Every variant must reproduce the first
+// one's output byte for byte.
+struct Check
+{
+    std::string name;
+    size_t count = 0;
+    size_t width = 0;
+    std::vector<Variant> variants;
+    std::function<std::string(size_t index)> describe; // the input of one result, for mismatch reports
+};
+
+struct Result
+{
+    std::string check;
+    std::string variant;
+    size_t keys = 0;
+    size_t mismatches = 0;
+    double ns_per_key = 0;
+};
+
+using Clock = std::chrono::steady_clock;
+
+// Copies generate_batch() output lines, one per record, into fixed-width
+// results; error lines become '\0's.
+void copy_lines(std::string_view lines, size_t width, char* out)
+{
+    while (!lines.empty())
+    {
+        const size_t end = lines.find('\n');
+        const std::string_view line = lines.substr(0, end);
+        if (line.size() == width) std::memcpy(out, line.data(), width);
+        else std::memset(out, 0, width);
+        out += width;
+        lines.remove_prefix(end == std::string_view::npos ? lines.size() : end + 1);
+    }
+}
+
+// The engines behind the single-key signature.
+template <typename Engine, bool Encrypt>
+enigma::Status engine_step(std::string_view input, std::span<char> output) noexcept
+{
+    const std::span<char, Engine::key_length> key(output.data(), Engine::key_length);
+    return Encrypt ? Engine::encrypt(input, key) : Engine::decrypt(input, key);
+}
+
+template <typename Encrypt>
+void encrypt_layouts(const Records& records, char* out, Encrypt&& encrypt)
+{
+    std::array<char, enigma::KEY_LENGTH> plain{};
+    const size_t width = records.key_length;
+    for (size_t k = 0; k < records.serials.size(); ++k, out += width)
+    {
+        plain_layout(records, k, plain);
+        if (encrypt(std::string_view(plain.data(), width), std::span<char>(out, width)) != enigma::Status::ok)
+        {
+            std::memset(out, 0, width);
+        }
+    }
+}
+
+template <typename Decrypt>
+void decrypt_keys(const std::vector<char>& keys, size_t width, char* out, Decrypt&& decrypt)
+{
+    const size_t count = keys.size() / width;
+    for (size_t k = 0; k < count; ++k, out += width)
+    {
+        if (decrypt(std::string_view(keys.data() + k * width, width), std::span<char>(out, width)) !=
+            enigma::Status::ok)
+        {
+            std::memset(out, 0, width);
+        }
+    }
+}
+
+// Runs kernel on BLOCK inputs at a time in position-major order, as the
+// batch engine does: load(k, symbols) fills the positions of input k and
+// store(k, symbols) takes its result.
+template <typename T, typename Load, typename Kernel, typename Store>
+void run_blocks(size_t count, size_t positions, Load&& load, Kernel&& kernel, Store&& store)
+{
+    std::array<T, BLOCK * enigma::KEY_LENGTH> input{};
+    std::array<T, BLOCK * enigma::KEY_LENGTH> output{};
+    std::array<T, enigma::KEY_LENGTH> symbols{};
+    for (size_t first = 0; first < count; first += BLOCK)
+    {
+        const size_t keys = std::min(BLOCK, count - first);
+        for (size_t k = 0; k < keys; ++k)
+        {
+            load(first + k, symbols.data());
+            for (size_t p = 0; p < positions; ++p) input[p * keys + k] = symbols[p];
+        }
+        kernel(input.data(), output.data(), keys);
+        for (size_t k = 0; k < keys; ++k)
+        {
+            for (size_t p = 0; p < positions; ++p) symbols[p] = output[p * keys + k];
+            store(first + k, symbols.data());
+        }
+    }
+}
+
+Check nettool_encrypt(const Records& records, std::string& batch_output)
+{
+    constexpr size_t WIDTH = enigma::ENIGMA_C_KEY_LENGTH;
+    Check check{"nettool_encrypt", records.serials.size(), WIDTH, {}, {}};
+    check.describe = [&records](size_t k)
+    {
+        return "serial " + std::to_string(records.serials[k]) + " option " + std::to_string(records.options[k]);
+    };
+    check.variants.push_back({"bytewise", [&](char* out)
+    {
+        encrypt_layouts(records, out, enigma::detail::enigma_c_encrypt_bytewise);
+    }});
+    check.variants.push_back({"wide", [&](char* out)
+    {
+        encrypt_layouts(records, out, enigma::detail::enigma_c_encrypt_wide);
+    }});
+    check.variants.push_back({"engine", [&](char* out)
+    {
+        encrypt_layouts(records, out, engine_step<enigma::NetToolEngine, true>);
+    }});
+    check.variants.push_back({"packed", [&](char* out)
+    {
+        for (size_t k = 0; k < records.serials.size(); ++k, out += WIDTH)
+        {
+            enigma::PackedNetToolKey key;
+            if (enigma::nettool_option_key(records.serials[k], records.options[k], key) == enigma::Status::ok)
+            {
+                enigma::format_nettool_key(key, std::span<char>(out, WIDTH));
+            }
+            else std::memset(out, 0, WIDTH);
+        }
+    }});
+    check.variants.push_back({"range", [&](char* out)
+    {
+        enigma::NetToolKeyRange range;
+        for (size_t run = 0; run + 1 < records.runs.size(); ++run)
+        {
+            const size_t first = records.runs[run];
+            const size_t last = records.runs[run + 1];
+            const bool started = range.start(records.serials[first], records.options[first]) == enigma::Status::ok;
+            for (size_t k = first; k < last; ++k, out += WIDTH)
+            {
+                if (started && (k == first || range.advance())) std::memcpy(out, range.key().data(), WIDTH);
+                else std::memset(out, 0, WIDTH);
+            }
+        }
+    }});
+    for (const auto level : SIMD_LEVELS)
+    {
+        if (!enigma::simd_level_supported(level)) continue;
+        check.variants.push_back({std::string("soa/") + enigma::simd_level_name(level), [&records, level](char* out)
+        {
+            run_blocks<uint8_t>(records.serials.size(), WIDTH, [&](size_t k, uint8_t* plain)
+            {
+                // The plain layout: 0, the option, then the serial from its lowest digit.
+                plain[0] = 0;
+                plain[1] = static_cast<uint8_t>(records.options[k]);
+                uint64_t serial = records.serials[k];
+                for (size_t p = 2; p < WIDTH; ++p, serial /= 10) plain[p] = static_cast<uint8_t>(serial % 10);
+            }, [&](const uint8_t* input, uint8_t* output, size_t keys)
+            {
+                enigma::enigma_c_encrypt_soa(level, input, output, WIDTH, keys);
+            }, [&](size_t k, const uint8_t* key)
+            {
+                for (size_t p = 0; p < WIDTH; ++p) out[k * WIDTH + p] = enigma::detail::HEX_DIGITS[key[p]];
+            });
+        }});
+    }
+    check.variants.push_back({"generate_keys", [&](char* out)
+    {
+        for (size_t first = 0; first < records.serials.size(); first += SEGMENT_RECORDS)
+        {
+            const size_t count = std::min(SEGMENT_RECORDS, records.serials.size() - first);
+            (void)enigma::generate_keys('n', -1, std::span(records.serials).subspan(first, count),
+                                        std::span(records.options).subspan(first, count),
+                                        std::span<char>(out + first * WIDTH, count * WIDTH));
+        }
+    }});
+    check.variants.push_back({"generate_batch", [&](char* out)
+    {
+        batch_output.clear();
+        (void)enigma::generate_batch(records.batch, batch_output);
+        copy_lines(batch_output, WIDTH, out);
+    }});
+#ifdef ENIGMA_DIFFBENCH_C_REFERENCE
+    check.variants.push_back({"c", [&](char* out)
+    {
+        std::array<char, WIDTH + 1> plain{};
+        std::array<char, WIDTH + 1> key{};
+        for (size_t k = 0; k < records.serials.size(); ++k, out += WIDTH)
+        {
+            plain_layout(records, k, plain);
+            enigma_c_encrypt(plain.data(), key.data(), WIDTH);
+            std::memcpy(out, key.data(), WIDTH);
+        }
+    }});
+#endif
+    return check;
+}
+
+Check nettool_decrypt(const std::vector<char>& keys)
+{
+    constexpr size_t WIDTH = enigma::ENIGMA_C_KEY_LENGTH;
+    Check check{"nettool_decrypt", keys.size() / WIDTH, WIDTH, {}, {}};
+    check.describe = [&keys](size_t k) { return "key " + std::string(keys.data() + k * WIDTH, WIDTH); };
+    check.variants.push_back({"bytewise", [&](char* out)
+    {
+        decrypt_keys(keys, WIDTH, out, enigma::detail::enigma_c_decrypt_bytewise);
+    }});
+    check.variants.push_back({"wide", [&](char* out)
+    {
+        decrypt_keys(keys, WIDTH, out, enigma::detail::enigma_c_decrypt_wide);
+    }});
+    check.variants.push_back({"engine", [&](char* out)
+    {
+        decrypt_keys(keys, WIDTH, out, engine_step<enigma::NetToolEngine, false>);
+    }});
+    check.variants.push_back({"packed", [&](char* out)
+    {
+        decrypt_keys(keys, WIDTH, out, [](std::string_view text, std::span<char> plain)
+        {
+            enigma::PackedNetToolKey key;
+            const enigma::Status status = enigma::pack_nettool_key(text, key);
+            if (status == enigma::Status::ok) enigma::format_nettool_key(enigma::enigma_c_decrypt(key), plain);
+            return status;
+        });
+    }});
+    for (const auto level : SIMD_LEVELS)
+    {
+        if (!enigma::simd_level_supported(level)) continue;
+        check.variants.push_back({std::string("soa/") + enigma::simd_level_name(level), [&, level](char* out)
+        {
+            run_blocks<uint8_t>(keys.size() / WIDTH, WIDTH, [&](size_t k, uint8_t* key)
+            {
+                for (size_t p = 0; p < WIDTH; ++p)
+                {
+                    key[p] = static_cast<uint8_t>(enigma::detail::table_hex_value(keys[k * WIDTH + p]));
+                }
+            }, [&](const uint8_t* input, uint8_t* output, size_t count)
+            {
+                enigma::enigma_c_decrypt_soa(level, input, output, WIDTH, count);
+            }, [&](size_t k, const uint8_t* plain)
+            {
+                for (size_t p = 0; p < WIDTH; ++p) out[k * WIDTH + p] = enigma::detail::HEX_DIGITS[plain[p]];
+            });
+        }});
+    }
+#ifdef ENIGMA_DIFFBENCH_C_REFERENCE
+    check.variants.push_back({"c", [&](char* out)
+    {
+        std::array<char, WIDTH + 1> plain{};
+        for (size_t k = 0; k < keys.size() / WIDTH; ++k, out += WIDTH)
+        {
+            enigma_c_decrypt(keys.data() + k * WIDTH, plain.data(), WIDTH);
+            std::memcpy(out, plain.data(), WIDTH);
+        }
+    }});
+#endif
+    return check;
+}
+
+Check enigma2_encrypt(const Records& records, std::string& batch_output)
+{
+    constexpr size_t WIDTH = enigma::KEY_LENGTH;
+    Check check{"enigma2_encrypt", records.serials.size(), WIDTH, {}, {}};
+    check.describe = [&records](size_t k)
+    {
+        return "product " + std::to_string(record_product(records, k)) + " serial " +
+               std::to_string(records.serials[k]) + " option " + std::to_string(records.options[k]);
+    };
+    using Text = enigma::Status (*)(std::string_view, std::span<char>) noexcept;
+    check.variants.push_back({"text", [&](char* out)
+    {
+        encrypt_layouts(records, out, static_cast<Text>(enigma::enigma2_c_encrypt));
+    }});
+    check.variants.push_back({"engine", [&](char* out)
+    {
+        encrypt_layouts(records, out, engine_step<enigma::Enigma2Engine, true>);
+    }});
+    check.variants.push_back({"packed", [&](char* out)
+    {
+        for (size_t k = 0; k < records.serials.size(); ++k, out += WIDTH)
+        {
+            enigma::PackedEnigma2Key key;
+            if (enigma::enigma2_option_key(record_product(records, k), records.serials[k], records.options[k],
+                                           key) == enigma::Status::ok)
+            {
+                enigma::format_enigma2_key(key, std::span<char>(out, WIDTH));
+            }
+            else std::memset(out, 0, WIDTH);
+        }
+    }});
+    check.variants.push_back({"range", [&](char* out)
+    {
+        enigma::Enigma2KeyRange range;
+        for (size_t run = 0; run + 1 < records.runs.size(); ++run)
+        {
+            const size_t first = records.runs[run];
+            const size_t last = records.runs[run + 1];
+            const bool started = range.start(record_product(records, first), records.serials[first],
+                                             records.options[first]) == enigma::Status::ok;
+            for (size_t k = first; k < last; ++k, out += WIDTH)
+            {
+                if (started && (k == first || range.advance())) std::memcpy(out, range.key().data(), WIDTH);
+                else std::memset(out, 0, WIDTH);
+            }
+        }
+    }});
+    for (const auto level : SIMD_LEVELS)
+    {
+        if (!enigma::simd_level_supported(level)) continue;
+        check.variants.push_back({std::string("soa/") + enigma::simd_level_name(level), [&records, level](char* out)
+        {
+            run_blocks<char>(records.serials.size(), WIDTH, [&](size_t k, char* plain)
+            {
+                plain_layout(records, k, std::span<char>(plain, WIDTH));
+            }, [&](const char* input, char* output, size_t keys)
+            {
+                enigma::enigma2_c_encrypt_soa(level, input, output, keys);
+            }, [&](size_t k, const char* key)
+            {
+                std::memcpy(out + k * WIDTH, key, WIDTH);
+            });
+        }});
+    }
+    check.variants.push_back({"generate_keys", [&](char* out)
+    {
+        for (size_t first = 0; first < records.serials.size(); first += SEGMENT_RECORDS)
+        {
+            const size_t count = std::min(SEGMENT_RECORDS, records.serials.size() - first);
+            (void)enigma::generate_keys(records.modes[first / SEGMENT_RECORDS], record_product(records, first),
+                                        std::span(records.serials).subspan(first, count),
+                                        std::span(records.options).subspan(first, count),
+                                        std::span<char>(out + first * WIDTH, count * WIDTH));
+        }
+    }});
+    check.variants.push_back({"generate_batch", [&](char* out)
+    {
+        batch_output.clear();
+        (void)enigma::generate_batch(records.batch, batch_output);
+        copy_lines(batch_output, WIDTH, out);
+    }});
+#ifdef ENIGMA_DIFFBENCH_C_REFERENCE
+    check.variants.push_back({"c", [&](char* out)
+    {
+        std::array<char, WIDTH + 1> plain{};
+        std::array<char, WIDTH + 1> key{};
+        for (size_t k = 0; k < records.serials.size(); ++k, out += WIDTH)
+        {
+            plain_layout(records, k, plain);
+            enigma2_c_encrypt(plain.data(), key.data());
+            std::memcpy(out, key.data(), WIDTH);
+        }
+    }});
+#endif
+    return check;
+}
+
+Check enigma2_decrypt(const std::vector<char>& keys)
+{
+    constexpr size_t WIDTH = enigma::KEY_LENGTH;
+    Check check{"enigma2_decrypt", keys.size() / WIDTH, WIDTH, {}, {}};
+    check.describe = [&keys](size_t k) { return "key " + std::string(keys.data() + k * WIDTH, WIDTH); };
+    using Text = enigma::Status (*)(std::string_view, std::span<char>) noexcept;
+    check.variants.push_back({"text", [&](char* out)
+    {
+        decrypt_keys(keys, WIDTH, out, static_cast<Text>(enigma::enigma2_c_decrypt));
+    }});
+    check.variants.push_back({"engine", [&](char* out)
+    {
+        decrypt_keys(keys, WIDTH, out, engine_step<enigma::Enigma2Engine, false>);
+    }});
+    check.variants.push_back({"packed", [&](char* out)
+    {
+        decrypt_keys(keys, WIDTH, out, [](std::string_view text, std::span<char> plain)
+        {
+            enigma::PackedEnigma2Key key;
+            enigma::PackedEnigma2Key decrypted;
+            enigma::Status status = enigma::pack_enigma2_key(text, key);
+            if (status == enigma::Status::ok) status = enigma::enigma2_c_decrypt(key, decrypted);
+            if (status == enigma::Status::ok) enigma::format_enigma2_key(decrypted, plain);
+            return status;
+        });
+    }});
+    for (const auto level : SIMD_LEVELS)
+    {
+        if (!enigma::simd_level_supported(level)) continue;
+        check.variants.push_back({std::string("soa/") + enigma::simd_level_name(level), [&, level](char* out)
+        {
+            std::array<uint8_t, BLOCK> checksum_ok{};
+            run_blocks<char>(keys.size() / WIDTH, WIDTH, [&](size_t k, char* key)
+            {
+                std::memcpy(key, keys.data() + k * WIDTH, WIDTH);
+            }, [&](const char* input, char* output, size_t count)
+            {
+                enigma::enigma2_c_decrypt_soa(level, input, output, checksum_ok.data(), count);
+            }, [&](size_t k, const char* plain)
+            {
+                if (checksum_ok[k % BLOCK]) std::memcpy(out + k * WIDTH, plain, WIDTH);
+                else std::memset(out + k * WIDTH, 0, WIDTH);
+            });
+        }});
+    }
+#ifdef ENIGMA_DIFFBENCH_C_REFERENCE
+    check.variants.push_back({"c", [&](char* out)
+    {
+        std::array<char, WIDTH + 1> key{};
+        std::array<char, WIDTH + 1> plain{};
+        for (size_t k = 0; k < keys.size() / WIDTH; ++k, out += WIDTH)
+        {
+            std::memcpy(key.data(), keys.data() + k * WIDTH, WIDTH);
+            enigma2_c_decrypt(key.data(), plain.data());
+            // A failed checksum empties the output; normalise to all '\0'.
+            if (plain[0] == '\0') std::memset(out, 0, WIDTH);
+            else std::memcpy(out, plain.data(), WIDTH);
+        }
+    }});
+#endif
+    return check;
+}
+
+// Runs every variant of check, passes times each, keeping the fastest
+// pass. Mismatches against the first variant are counted per result and
+// the first few are reported on stderr. Returns the first variant's
+// output.
+std::vector<char> run_check(const Check& check, int passes, std::vector<Result>& results)
+{
+    std::vector<char> reference(check.count * check.width);
+    std::vector<char> output(reference.size());
+    for (size_t v = 0; v < check.variants.size(); ++v)
+    {
+        const Variant& variant = check.variants[v];
+        std::vector<char>& out = v == 0 ? reference : output;
+        double best = 1e300;
+        for (int pass = 0; pass < passes; ++pass)
+        {
+            std::fill(out.begin(), out.end(), '\x7f');
+            const auto start = Clock::now();
+            variant.run(out.data());
+            best = std::min(best, std::chrono::duration<double>(Clock::now() - start).count());
+        }
+        Result result{check.name, variant.name, check.count, 0, best * 1e9 / static_cast<double>(check.count)};
+        for (size_t k = 0; k < check.count; ++k)
+        {
+            const char* expected = reference.data() + k * check.width;
+            const char* actual = out.data() + k * check.width;
+            const bool rejected = std::all_of(actual, actual + check.width, [](char c) { return c == '\0'; });
+            // The reference only has to accept the input; the others must match it.
+            if (!rejected && (v == 0 || std::memcmp(expected, actual, check.width) == 0)) continue;
+            if (++result.mismatches > 3) continue;
+            std::cerr << "mismatch: " << check.name << " " << variant.name << " record " << k << " ("
+                << check.describe(k) << "): ";
+            if (v != 0) std::cerr << "expected " << std::string_view(expected, check.width) << ", got ";
+            if (rejected) std::cerr << "an error";
+            else std::cerr << std::string_view(actual, check.width);
+            std::cerr << "\n";
+        }
+        results.push_back(result);
+    }
+    return reference;
+}
+
+void print_table(const std::vector<Result>& results, const Settings& settings)
+{
+    std::cout << "SIMD level: " << enigma::simd_level_name(enigma::simd_level()) << "\n";
+    std::cout << "Records: " << settings.records << " per algorithm, seed " << settings.seed;
+#ifndef ENIGMA_DIFFBENCH_C_REFERENCE
+    std::cout << " (C implementation not built in)";
+#endif
+    std::cout << "\n\n";
+    std::cout << std::left << std::setw(18) << "check" << std::setw(16) << "variant" << std::right << std::setw(12)
+        << "mismatches" << std::setw(12) << "ns/key" << std::setw(12) << "Mkeys/s" << "\n";
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const Result& result = results[i];
+        const bool reference = i == 0 || results[i - 1].check != result.check;
+        std::cout << std::left << std::setw(18) << result.check << std::setw(16)
+            << (reference ? result.variant + " *" : result.variant) << std::right << std::setw(12)
+            << result.mismatches << std::fixed << std::setprecision(2) << std::setw(12) << result.ns_per_key
+            << std::setw(12) << 1e3 / result.ns_per_key << "\n";
+    }
+    std::cout << "\n* reference for its check\n";
+
+    std::cout << "\nFastest agreeing variant:\n";
+    for (size_t i = 0; i < results.size();)
+    {
+        const Result* fastest = nullptr;
+        size_t j = i;
+        for (; j < results.size() && results[j].check == results[i].check; ++j)
+        {
+            if (results[j].mismatches == 0 && (!fastest || results[j].ns_per_key < fastest->ns_per_key))
+            {
+                fastest = &results[j];
+            }
+        }
+        std::cout << "  " << std::left << std::setw(18) << results[i].check
+            << (fastest ? fastest->variant : std::string("-")) << "\n";
+        i = j;
+    }
+}
+
+void write_json(std::ostream& out, const std::vector<Result>& results, const Settings& settings)
+{
+    out << "{\n";
+    out << "  \"version\": \"" << DIFFBENCH_VERSION << "\",\n";
+    out << "  \"simd_level\": \"" << enigma::simd_level_name(enigma::simd_level()) << "\",\n";
+    out << "  \"hardware_threads\": " << std::thread::hardware_concurrency() << ",\n";
+    out << "  \"records\": " << settings.records << ",\n";
+    out << "  \"seed\": " << settings.seed << ",\n";
+    out << "  \"results\": [\n";
+    out << std::setprecision(6);
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const auto& result = results[i];
+        out << "    {\"check\": \"" << result.check << "\", \"variant\": \"" << result.variant << "\", \"keys\": "
+            << result.keys << ", \"mismatches\": " << result.mismatches << ", \"ns_per_key\": " << result.ns_per_key
+            << ", \"keys_per_second\": " << 1e9 / result.ns_per_key << "}" << (i + 1 < results.size() ? "," : "")
+            << "\n";
+    }
+    out << "  ]\n}\n";
+}
+
+void display_help()
+{
+    std::cout << "Usage: enigma_diffbench [options]\n"
+        << "  --records N  Random records per algorithm (default 1000000)\n"
+        << "  --seed N     Random seed (default 1)\n"
+        << "  --quick      20000 records, one pass per variant (used by the test suite)\n"
+        << "  --json FILE  Also write results as JSON to FILE (- for stdout)\n"
+        << "  -h, --help   Show this help\n"
+        << "Exits with status 1 if any variant disagrees with the reference.\n";
+}
+
+bool parse_number(const char* text, unsigned long long& value)
+{
+    char* end = nullptr;
+    value = std::strtoull(text, &end, 10);
+    return end != text && *end == '\0';
+}
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    Settings settings;
+    bool records_given = false;
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string_view arg = argv[i];
+        const bool has_value = i + 1 < argc;
+        unsigned long long value = 0;
+        if (arg == "-h" || arg == "--help")
+        {
+            display_help();
+            return 0;
+        }
+        if (arg == "--quick")
+        {
+            settings.quick = true;
+        }
+        else if (arg == "--records" && has_value && parse_number(argv[i + 1], value) && value > 0)
+        {
+            settings.records = static_cast<size_t>(value);
+            records_given = true;
+            ++i;
+        }
+        else if (arg == "--seed" && has_value && parse_number(argv[i + 1], value) && value <= UINT32_MAX)
+        {
+            settings.seed = static_cast<uint32_t>(value);
+            ++i;
+        }
+        else if (arg == "--json" && has_value)
+        {
+            settings.json_path = argv[++i];
+        }
+        else
+        {
+            std::cerr << "Error: unknown or incomplete option " << arg << "\n";
+            display_help();
+            return 1;
+        }
+    }
+    if (settings.quick && !records_given) settings.records = 20'000;
+    const int passes = settings.quick ? 1 : 3;
+
+    std::mt19937_64 rng(settings.seed);
+    const Records nettool = make_records(true, settings.records, rng);
+    const Records enigma2 = make_records(false, settings.records, rng);
+    std::string batch_output;
+    std::vector<Result> results;
+    const std::vector<char> nettool_keys = run_check(nettool_encrypt(nettool, batch_output), passes, results);
+    run_check(nettool_decrypt(nettool_keys), passes, results);
+    const std::vector<char> enigma2_keys = run_check(enigma2_encrypt(enigma2, batch_output), passes, results);
+    run_check(enigma2_decrypt(enigma2_keys), passes, results);
+
+    const bool agreed = std::all_of(results.begin(), results.end(), [](const Result& r) { return r.mismatches == 0; });
+    if (settings.json_path == "-")
+    {
+        write_json(std::cout, results, settings);
+    }
+    else
+    {
+        print_table(results, settings);
+        if (!settings.json_path.empty())
+        {
+            std::ofstream json(settings.json_path);
+            write_json(json, results, settings);
+            if (!json)
+            {
+                std::cerr << "Error: cannot write " << settings.json_path << "\n";
+                return 1;
+            }
+        }
+    }
+    if (!agreed)
+    {
+        std::cerr << "Error: variants disagree with the reference\n";
+        return 1;
+    }
+    return 0;
+}
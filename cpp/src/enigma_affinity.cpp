@@ -0,0 +1,123 @@
+// File: enigma_affinity.cpp
+// Author: Kris Armstrong
+// Version: 3.0.0
+// Last Modified: 2026-10-14
+// Description: NUMA-grouped CPU lists and thread pinning for the thread pool and the server.
+// License: MIT
+
+#include "enigma_affinity.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <utility>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace enigma
+{
+#ifdef __linux__
+namespace
+{
+static_assert(sizeof(cpu_set_t) <= 128);
+
+// Calls add(cpu) for each CPU of a sysfs cpulist such as "0-3,8-11".
+template <typename Add>
+void parse_cpu_list(const char* text, Add&& add)
+{
+    while (*text >= '0' && *text <= '9')
+    {
+        char* end = nullptr;
+        const unsigned long first = std::strtoul(text, &end, 10);
+        unsigned long last = first;
+        if (*end == '-') last = std::strtoul(end + 1, &end, 10);
+        for (unsigned long cpu = first; cpu <= last && cpu < CPU_SETSIZE; ++cpu) add(static_cast<unsigned>(cpu));
+        text = *end == ',' ? end + 1 : end;
+    }
+}
+
+// NUMA node of every CPU, from /sys/devices/system/node/node*/cpulist;
+// CPUs the files do not list stay on node 0.
+std::vector<unsigned> cpu_nodes()
+{
+    std::vector<unsigned> nodes(CPU_SETSIZE, 0);
+    // Node numbers can have gaps, so probe past missing ones.
+    for (unsigned node = 0, missing = 0; missing < 64; ++node)
+    {
+        const std::string path = "/sys/devices/system/node/node" + std::to_string(node) + "/cpulist";
+        std::FILE* file = std::fopen(path.c_str(), "r");
+        if (!file)
+        {
+            ++missing;
+            continue;
+        }
+        missing = 0;
+        char list[4096];
+        if (std::fgets(list, sizeof(list), file)) parse_cpu_list(list, [&](unsigned cpu) { nodes[cpu] = node; });
+        std::fclose(file);
+    }
+    return nodes;
+}
+} // namespace
+
+std::vector<unsigned> affinity_cpus()
+{
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) return {};
+    const std::vector<unsigned> nodes = cpu_nodes();
+    std::vector<std::pair<unsigned, unsigned>> placed; // (node, cpu)
+    for (unsigned cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+    {
+        if (CPU_ISSET(cpu, &allowed)) placed.emplace_back(nodes[cpu], cpu);
+    }
+    std::sort(placed.begin(), placed.end());
+    std::vector<unsigned> cpus;
+    cpus.reserve(placed.size());
+    for (const auto& [node, cpu] : placed) cpus.push_back(cpu);
+    return cpus;
+}
+
+bool pin_current_thread(unsigned cpu) noexcept
+{
+    if (cpu >= CPU_SETSIZE) return false;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+}
+
+ScopedPin::ScopedPin(unsigned cpu) noexcept
+{
+    auto* saved = reinterpret_cast<cpu_set_t*>(saved_);
+    pinned_ = pthread_getaffinity_np(pthread_self(), sizeof(cpu_set_t), saved) == 0 && pin_current_thread(cpu);
+}
+
+ScopedPin::~ScopedPin()
+{
+    if (pinned_) pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), reinterpret_cast<cpu_set_t*>(saved_));
+}
+#else
+std::vector<unsigned> affinity_cpus()
+{
+    return {};
+}
+
+bool pin_current_thread(unsigned) noexcept
+{
+    return false;
+}
+
+ScopedPin::ScopedPin(unsigned) noexcept
+{
+}
+
+ScopedPin::~ScopedPin()
+{
+}
+#endif
+} // namespace enigma
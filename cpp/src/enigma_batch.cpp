@@ -0,0 +1,1222 @@
+// File: enigma_batch.cpp
+// Author: Kris Armstrong
+// Version: 3.0.0
+// Last Modified: 2026-10-14
+// Description: Batch key generation and verification from newline-delimited records.
+// License: MIT
+
+#include "enigma_batch.h"
+#include "enigma_engine.h"
+#include "enigma_output.h"
+#include "enigma_range.h"
+#include "enigma_ring.h"
+#include "enigma_simd.h"
+#include "enigma_stats.h"
+#include "enigma_thread_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define ENIGMA_HAVE_MMAP 1
+#endif
+
+namespace enigma
+{
+namespace
+{
+constexpr size_t PIPELINE_BLOCK_SIZE = 256 * 1024;
+constexpr size_t PIPELINE_BLOCKS_PER_THREAD = 4;
+constexpr size_t BINARY_KEY_OFFSET = 16; // of BinaryKeyRecord::key
+constexpr size_t MAX_FIELDS = 4;
+constexpr int ETHERSCOPE_PRODUCT_CODE = 6963;
+constexpr int LINKRUNNER_PRODUCT_CODE = 7001;
+
+bool is_blank(char c) noexcept
+{
+    return c == ' ' || c == '\t';
+}
+
+std::string_view trim(std::string_view text) noexcept
+{
+    while (!text.empty() && (is_blank(text.front()) || text.front() == '\r')) text.remove_prefix(1);
+    while (!text.empty() && (is_blank(text.back()) || text.back() == '\r')) text.remove_suffix(1);
+    return text;
+}
+
+// Splits record into at most MAX_FIELDS fields. A comma separates fields
+// (surrounding blanks ignored); runs of blanks separate fields too. Returns
+// the field count, or MAX_FIELDS + 1 if there are too many.
+size_t split_fields(std::string_view record, std::array<std::string_view, MAX_FIELDS>& fields) noexcept
+{
+    record = trim(record);
+    size_t count = 0;
+    size_t pos = 0;
+    while (pos <= record.size())
+    {
+        size_t end = pos;
+        while (end < record.size() && record[end] != ',' && !is_blank(record[end])) ++end;
+        if (count == MAX_FIELDS) return MAX_FIELDS + 1;
+        fields[count++] = record.substr(pos, end - pos);
+        while (end < record.size() && is_blank(record[end])) ++end;
+        if (end < record.size() && record[end] == ',')
+        {
+            ++end;
+            while (end < record.size() && is_blank(record[end])) ++end;
+        }
+        else if (end == record.size())
+        {
+            break;
+        }
+        pos = end;
+    }
+    return count;
+}
+
+// The first field of record, as split_fields() would return it.
+std::string_view first_field(std::string_view record) noexcept
+{
+    record = trim(record);
+    size_t end = 0;
+    while (end < record.size() && record[end] != ',' && !is_blank(record[end])) ++end;
+    return record.substr(0, end);
+}
+
+// Parses a short unsigned decimal field. Returns -1 when field is empty,
+// has non-digits or more than four digits.
+int parse_small_number(std::string_view field) noexcept
+{
+    if (field.size() > 4 || !detail::all_digits(field)) return -1;
+    int value = 0;
+    for (char c : field) value = value * 10 + (c - '0');
+    return value;
+}
+
+// One parsed record: mode is 'n', 'e' or 'l'.
+struct Record
+{
+    char mode = 0;
+    std::string_view serial;
+    int option = -1;
+    int product = -1;
+};
+
+Status parse_record(std::string_view line, Record& record) noexcept
+{
+    std::array<std::string_view, MAX_FIELDS> fields;
+    const size_t count = split_fields(line, fields);
+    if (count < 3 || count > MAX_FIELDS) return Status::malformed_record;
+
+    std::string_view mode = fields[0];
+    if (mode.size() == 2 && mode.front() == '-') mode.remove_prefix(1);
+    if (mode.size() != 1) return Status::invalid_mode;
+    record.serial = fields[1];
+    record.option = parse_small_number(fields[2]);
+
+    switch (mode.front())
+    {
+    case 'n':
+    case 'N':
+        if (count != 3) return Status::malformed_record;
+        record.mode = 'n';
+        return Status::ok;
+    case 'e':
+    case 'E':
+    case 'l':
+    case 'L':
+        record.mode = (mode.front() == 'e' || mode.front() == 'E') ? 'e' : 'l';
+        record.product = record.mode == 'e' ? ETHERSCOPE_PRODUCT_CODE : LINKRUNNER_PRODUCT_CODE;
+        if (count == MAX_FIELDS)
+        {
+            record.product = parse_small_number(fields[3]);
+            if (record.product < 0) return Status::invalid_product;
+        }
+        return Status::ok;
+    default:
+        return Status::invalid_mode;
+    }
+}
+
+// Start of the next line of input and the line before it, without its newline.
+std::string_view next_line(std::string_view& input) noexcept
+{
+    const char* newline = static_cast<const char*>(std::memchr(input.data(), '\n', input.size()));
+    const size_t line_length = newline ? static_cast<size_t>(newline - input.data()) : input.size();
+    const std::string_view line = input.substr(0, line_length);
+    input.remove_prefix(newline ? line_length + 1 : line_length);
+    return line;
+}
+
+// Drops the first line of input when is_header() takes it for the batch header.
+template <typename IsHeader>
+void skip_header(std::string_view& input, IsHeader&& is_header) noexcept
+{
+    std::string_view rest = input;
+    if (is_header(next_line(rest))) input = rest;
+}
+
+// Verification headers name the key column rather than the mode.
+bool is_verify_header(std::string_view record) noexcept
+{
+    const std::string_view field = first_field(record);
+    return field == "key" || field == "KEY";
+}
+
+void decode_nettool(std::string_view key, std::string_view serial, int option, VerifiedKey& result) noexcept
+{
+    if (key == "bladerules")
+    {
+        result.outcome = VerifyOutcome::valid;
+        return;
+    }
+    std::array<char, ENIGMA_C_KEY_LENGTH> plain{};
+    stats::count(stats::Counter::keys_decrypted);
+    // The layout nettool_option_key() encrypts: '0', the option digit, then
+    // the serial reversed in digits 2-11.
+    if (NetToolEngine::decrypt(key, plain) != Status::ok || plain[0] != '0')
+    {
+        result.outcome = VerifyOutcome::invalid_key;
+        return;
+    }
+    result.kind = 'n';
+    for (size_t i = 0; i < SERIAL_NUMBER_SIZE_ENIGMAC; ++i)
+    {
+        result.serial[i] = plain[ENIGMA_C_KEY_LENGTH - 1 - i];
+    }
+    result.serial_length = SERIAL_NUMBER_SIZE_ENIGMAC;
+    result.option = detail::parse_leading_int(std::string_view(plain.data() + 1, 1));
+    if (result.serial_view() != serial) result.outcome = VerifyOutcome::serial_mismatch;
+    else if (result.option < 0 || result.option != option) result.outcome = VerifyOutcome::option_mismatch;
+    else result.outcome = VerifyOutcome::valid;
+}
+
+void decode_enigma2(std::string_view key, int product, std::string_view serial, int option,
+                    VerifiedKey& result) noexcept
+{
+    DecodedKey decoded;
+    stats::count(stats::Counter::keys_decrypted);
+    const Status status = Enigma2Engine::decrypt(key, decoded.layout);
+    if (status != Status::ok)
+    {
+        result.outcome = status == Status::checksum_mismatch ? VerifyOutcome::checksum_mismatch
+                                                             : VerifyOutcome::invalid_key;
+        return;
+    }
+    result.kind = 'e';
+    result.product = decoded.product();
+    std::copy_n(decoded.serial().begin(), SERIAL_NUMBER_SIZE_ENIGMA2, result.serial.begin());
+    result.serial_length = SERIAL_NUMBER_SIZE_ENIGMA2;
+    result.option = decoded.option();
+    if (product >= 0 && result.product != product) result.outcome = VerifyOutcome::product_mismatch;
+    else if (result.serial_view() != serial) result.outcome = VerifyOutcome::serial_mismatch;
+    else if (result.option < 0 || result.option != option) result.outcome = VerifyOutcome::option_mismatch;
+    else result.outcome = VerifyOutcome::valid;
+}
+
+// Appends value as exactly Width zero-padded digits.
+template <size_t Width>
+void append_number(std::string& output, int value)
+{
+    std::array<char, Width> digits{};
+    detail::write_padded(digits.data(), value, Width);
+    output.append(digits.data(), Width);
+}
+
+// Appends text as a JSON string literal. Keys come straight from the input,
+// so anything may need escaping.
+void append_json_string(std::string& output, std::string_view text)
+{
+    output.push_back('"');
+    for (const char c : text)
+    {
+        if (c == '"' || c == '\\')
+        {
+            output.push_back('\\');
+            output.push_back(c);
+        }
+        else if (static_cast<unsigned char>(c) < 0x20)
+        {
+            output.append("\\u00");
+            output.push_back(detail::hex_digit((c >> 4) & 0x0F));
+            output.push_back(detail::hex_digit(c & 0x0F));
+        }
+        else
+        {
+            output.push_back(c);
+        }
+    }
+    output.push_back('"');
+}
+
+void store_le(char* out, uint64_t value, size_t bytes) noexcept
+{
+    for (size_t i = 0; i < bytes; ++i) out[i] = static_cast<char>(value >> (8 * i));
+}
+
+uint64_t load_le(const char* data, size_t bytes) noexcept
+{
+    uint64_t value = 0;
+    for (size_t i = 0; i < bytes; ++i) value |= static_cast<uint64_t>(static_cast<unsigned char>(data[i])) << (8 * i);
+    return value;
+}
+
+// Appends the BinaryKeyRecord for record with an all-zero key and returns
+// the offset of its key field.
+size_t append_binary_record(std::string& output, const Record& record, Status status)
+{
+    std::array<char, sizeof(BinaryKeyRecord)> out{};
+    uint64_t serial = 0;
+    if (pack_serial(record.serial, serial) != Status::ok) serial = 0;
+    store_le(out.data(), serial, 8);
+    store_le(out.data() + 8, record.mode == 'n' || record.product < 0 ? 0 : static_cast<uint64_t>(record.product), 2);
+    store_le(out.data() + 10, record.option < 0 ? 0 : static_cast<uint64_t>(record.option), 2);
+    out[12] = record.mode;
+    out[13] = static_cast<char>(status);
+    output.append(out.data(), out.size());
+    return output.size() - (sizeof(BinaryKeyRecord) - BINARY_KEY_OFFSET);
+}
+
+// Writes the packed form of a text key (from the cache) at out.
+void store_packed_key(char* out, const CacheValue& key, char algorithm) noexcept
+{
+    if (algorithm == 'n')
+    {
+        PackedNetToolKey packed;
+        if (pack_nettool_key(std::string_view(key.data(), ENIGMA_C_KEY_LENGTH), packed) == Status::ok)
+        {
+            store_le(out, packed.nibbles, 8);
+        }
+        return;
+    }
+    PackedEnigma2Key packed;
+    if (pack_enigma2_key(std::string_view(key.data(), KEY_LENGTH), packed) == Status::ok)
+    {
+        std::memcpy(out, packed.symbols.data(), KEY_LENGTH);
+    }
+}
+
+void accumulate(BatchStats& total, const BatchStats& part) noexcept
+{
+    total.records += part.records;
+    total.errors += part.errors;
+    total.cache_hits += part.cache_hits;
+    total.cache_misses += part.cache_misses;
+}
+
+// Splits input into chunks at line boundaries and runs
+// process(chunk, out, position) on pool, one output string per chunk; only
+// the first chunk starts the batch.
+template <typename Process>
+BatchStats process_parallel(std::string_view input, ThreadPool& pool, std::vector<std::string>& chunk_outputs,
+                            size_t chunk_size, Process&& process)
+{
+    std::vector<std::string_view> chunks;
+    while (!input.empty())
+    {
+        size_t end = std::min(std::max<size_t>(chunk_size, 1), input.size());
+        const char* newline = static_cast<const char*>(
+            std::memchr(input.data() + end - 1, '\n', input.size() - end + 1));
+        end = newline ? static_cast<size_t>(newline - input.data()) + 1 : input.size();
+        chunks.push_back(input.substr(0, end));
+        input.remove_prefix(end);
+    }
+
+    chunk_outputs.resize(chunks.size());
+    std::vector<BatchStats> chunk_stats(chunks.size());
+    pool.parallel_for(chunks.size(), [&](size_t i)
+    {
+        chunk_outputs[i].clear();
+        chunk_stats[i] = process(chunks[i], chunk_outputs[i],
+                                 i == 0 ? BatchPosition::start : BatchPosition::continuation);
+    });
+
+    BatchStats stats;
+    for (const auto& chunk : chunk_stats) accumulate(stats, chunk);
+    return stats;
+}
+
+template <size_t N>
+constexpr std::array<char, N> filled_array(char c)
+{
+    std::array<char, N> result{};
+    result.fill(c);
+    return result;
+}
+
+// Collects records and encrypts them together with the struct-of-arrays
+// kernels, one block per algorithm. Each record reserves its place in
+// output when it is added and is filled in on flush(), so output order is
+// unchanged. With a cache, each encrypted key is also stored under the tag
+// it was added with. In binary format the caller appends each record's
+// BinaryKeyRecord first, and flush() fills in its key field.
+class KeyBlock
+{
+public:
+    KeyBlock(std::string& output, KeyFormat format, KeyCache* cache) : output_(output), format_(format), cache_(cache)
+    {
+    }
+
+    void add_nettool(const std::array<char, ENIGMA_C_KEY_LENGTH>& plain_key, const CacheKey& tag = {})
+    {
+        for (size_t position = 0; position < ENIGMA_C_KEY_LENGTH; ++position)
+        {
+            nettool_digits_[position * BLOCK_KEYS + nettool_count_] = static_cast<uint8_t>(plain_key[position] - '0');
+        }
+        nettool_tags_[nettool_count_] = tag;
+        nettool_offsets_[nettool_count_++] = reserve(ENIGMA_C_KEY_LENGTH);
+        if (nettool_count_ == BLOCK_KEYS) flush_nettool();
+    }
+
+    void add_enigma2(const std::array<char, KEY_LENGTH>& plain_key, const CacheKey& tag = {})
+    {
+        for (size_t position = 0; position < KEY_LENGTH; ++position)
+        {
+            enigma2_plain_[position * BLOCK_KEYS + enigma2_count_] = plain_key[position];
+        }
+        enigma2_tags_[enigma2_count_] = tag;
+        enigma2_offsets_[enigma2_count_++] = reserve(KEY_LENGTH);
+        if (enigma2_count_ == BLOCK_KEYS) flush_enigma2();
+    }
+
+    void flush() noexcept
+    {
+        flush_nettool();
+        flush_enigma2();
+    }
+
+private:
+    static constexpr size_t BLOCK_KEYS = 64; // one AVX-512 vector, two AVX2 ones, four SSSE3/NEON ones
+
+    size_t reserve(size_t length)
+    {
+        if (format_ == KeyFormat::binary) return output_.size() - (sizeof(BinaryKeyRecord) - BINARY_KEY_OFFSET);
+        const size_t offset = output_.size();
+        output_.append(length, '0');
+        return offset;
+    }
+
+    // Unused lanes hold stale input from the previous block; encrypting them
+    // costs less than narrowing the kernels to the keys actually present.
+    void flush_nettool() noexcept
+    {
+        if (nettool_count_ == 0) return;
+        enigma_c_encrypt_soa(nettool_digits_.data(), nettool_keys_.data(), ENIGMA_C_KEY_LENGTH, BLOCK_KEYS);
+        for (size_t key = 0; key < nettool_count_; ++key)
+        {
+            char* out = output_.data() + nettool_offsets_[key];
+            if (format_ == KeyFormat::binary)
+            {
+                uint64_t nibbles = 0;
+                for (size_t position = 0; position < ENIGMA_C_KEY_LENGTH; ++position)
+                {
+                    nibbles |= static_cast<uint64_t>(nettool_keys_[position * BLOCK_KEYS + key]) << (4 * position);
+                }
+                store_le(out, nibbles, 8);
+                if (!cache_) continue;
+                // The cache holds text, as the server serves it.
+                CacheValue value{};
+                for (size_t position = 0; position < ENIGMA_C_KEY_LENGTH; ++position)
+                {
+                    value[position] = detail::hex_digit(nettool_keys_[position * BLOCK_KEYS + key]);
+                }
+                cache_->insert(nettool_tags_[key], value);
+                continue;
+            }
+            for (size_t position = 0; position < ENIGMA_C_KEY_LENGTH; ++position)
+            {
+                out[position] = detail::hex_digit(nettool_keys_[position * BLOCK_KEYS + key]);
+            }
+            if (cache_) store(nettool_tags_[key], out, ENIGMA_C_KEY_LENGTH);
+        }
+        nettool_count_ = 0;
+    }
+
+    void flush_enigma2() noexcept
+    {
+        if (enigma2_count_ == 0) return;
+        enigma2_c_encrypt_soa(enigma2_plain_.data(), enigma2_keys_.data(), BLOCK_KEYS);
+        for (size_t key = 0; key < enigma2_count_; ++key)
+        {
+            char* out = output_.data() + enigma2_offsets_[key];
+            CacheValue text{};
+            for (size_t position = 0; position < KEY_LENGTH; ++position)
+            {
+                text[position] = enigma2_keys_[position * BLOCK_KEYS + key];
+            }
+            if (format_ == KeyFormat::binary)
+            {
+                for (size_t half = 0; half < KEY_LENGTH; half += 8)
+                {
+                    detail::store_word(detail::symbol_values(detail::load_word(text.data() + half)), out + half);
+                }
+            }
+            else
+            {
+                std::copy(text.begin(), text.end(), out);
+            }
+            if (cache_) cache_->insert(enigma2_tags_[key], text);
+        }
+        enigma2_count_ = 0;
+    }
+
+    void store(const CacheKey& tag, const char* key, size_t length) noexcept
+    {
+        CacheValue value{};
+        std::copy_n(key, length, value.begin());
+        cache_->insert(tag, value);
+    }
+
+    std::string& output_;
+    KeyFormat format_;
+    KeyCache* cache_;
+    std::array<uint8_t, ENIGMA_C_KEY_LENGTH * BLOCK_KEYS> nettool_digits_{};
+    std::array<uint8_t, ENIGMA_C_KEY_LENGTH * BLOCK_KEYS> nettool_keys_{};
+    std::array<size_t, BLOCK_KEYS> nettool_offsets_{};
+    std::array<CacheKey, BLOCK_KEYS> nettool_tags_{};
+    size_t nettool_count_ = 0;
+    // Zero-filled lanes would break the kernels' 0-9/A-Z precondition.
+    std::array<char, KEY_LENGTH * BLOCK_KEYS> enigma2_plain_ = filled_array<KEY_LENGTH * BLOCK_KEYS>('0');
+    std::array<char, KEY_LENGTH * BLOCK_KEYS> enigma2_keys_{};
+    std::array<size_t, BLOCK_KEYS> enigma2_offsets_{};
+    std::array<CacheKey, BLOCK_KEYS> enigma2_tags_{};
+    size_t enigma2_count_ = 0;
+};
+} // namespace
+
+bool is_batch_skip_line(std::string_view record) noexcept
+{
+    record = trim(record);
+    return record.empty() || record.front() == '#';
+}
+
+bool is_batch_header(std::string_view record) noexcept
+{
+    const std::string_view field = first_field(record);
+    return field == "mode" || field == "MODE";
+}
+
+Status generate_record_key(std::string_view line, KeyBuffer& key, size_t& key_length) noexcept
+{
+    return generate_record_key(line, key, key_length, nullptr);
+}
+
+Status generate_record_key(std::string_view line, KeyBuffer& key, size_t& key_length, KeyCache* cache) noexcept
+{
+    Record record;
+    Status status = parse_record(line, record);
+    if (status != Status::ok) return status;
+
+    // Validate before looking up, so the tag is only built from good fields.
+    std::array<char, ENIGMA_C_KEY_LENGTH> nettool_key{};
+    std::array<char, KEY_LENGTH> enigma2_key{};
+    status = record.mode == 'n' ? detail::nettool_plain_key(record.serial, record.option, nettool_key)
+                                : detail::enigma2_plain_key(record.product, record.serial, record.option, enigma2_key);
+    if (status != Status::ok) return status;
+
+    const char algorithm = record.mode == 'n' ? 'n' : 'e';
+    key_length = algorithm == 'n' ? ENIGMA_C_KEY_LENGTH : KEY_LENGTH;
+    CacheKey tag{};
+    if (cache)
+    {
+        tag = generation_cache_key(algorithm, record.product, record.serial, record.option);
+        if (const auto cached = cache->find(tag))
+        {
+            key = *cached;
+            return Status::ok;
+        }
+    }
+    // The mode picks the engine; its length and tables are then fixed.
+    key.fill(0);
+    stats::count(stats::Counter::keys_encrypted);
+    status = algorithm == 'n'
+                 ? NetToolEngine::encrypt(std::string_view(nettool_key.data(), nettool_key.size()),
+                                          std::span<char, ENIGMA_C_KEY_LENGTH>(key.data(), ENIGMA_C_KEY_LENGTH))
+                 : Enigma2Engine::encrypt(std::string_view(enigma2_key.data(), enigma2_key.size()), key);
+    if (status == Status::ok && cache) cache->insert(tag, key);
+    return status;
+}
+
+BatchStats generate_batch(std::string_view input, std::string& output, KeyCache* cache)
+{
+    return generate_batch(input, output, KeyFormat::text, cache);
+}
+
+BatchStats generate_batch(std::string_view input, std::string& output, KeyFormat format, KeyCache* cache,
+                          BatchPosition position)
+{
+    BatchStats stats;
+    if (position == BatchPosition::start) skip_header(input, is_batch_header);
+    KeyBlock block(output, format, cache);
+    std::array<char, ENIGMA_C_KEY_LENGTH> nettool_key{};
+    std::array<char, KEY_LENGTH> enigma2_key{};
+    const bool binary = format == KeyFormat::binary;
+    while (!input.empty())
+    {
+        const std::string_view line = next_line(input);
+        Record record;
+        Status status = parse_record(line, record);
+        if (status != Status::ok && is_batch_skip_line(line)) continue;
+        ++stats.records;
+        if (status == Status::ok)
+        {
+            status = record.mode == 'n'
+                         ? detail::nettool_plain_key(record.serial, record.option, nettool_key)
+                         : detail::enigma2_plain_key(record.product, record.serial, record.option, enigma2_key);
+        }
+        const size_t binary_key = binary ? append_binary_record(output, record, status) : 0;
+        if (status == Status::ok)
+        {
+            const char algorithm = record.mode == 'n' ? 'n' : 'e';
+            CacheKey tag;
+            if (cache)
+            {
+                tag = generation_cache_key(algorithm, record.product, record.serial, record.option);
+                if (const auto cached = cache->find(tag))
+                {
+                    ++stats.cache_hits;
+                    if (binary)
+                    {
+                        store_packed_key(output.data() + binary_key, *cached, algorithm);
+                        continue;
+                    }
+                    output.append(cached->data(), algorithm == 'n' ? ENIGMA_C_KEY_LENGTH : KEY_LENGTH);
+                    output.push_back('\n');
+                    continue;
+                }
+                ++stats.cache_misses;
+            }
+            if (algorithm == 'n')
+            {
+                block.add_nettool(nettool_key, tag);
+            }
+            else
+            {
+                block.add_enigma2(enigma2_key, tag);
+            }
+        }
+        if (status != Status::ok)
+        {
+            ++stats.errors;
+            if (binary) continue;
+            output.append("error: ");
+            output.append(status_message(status));
+        }
+        if (!binary) output.push_back('\n');
+    }
+    block.flush();
+    return stats;
+}
+
+std::array<char, sizeof(BinaryKeyHeader)> encode_binary_key_header() noexcept
+{
+    const BinaryKeyHeader header;
+    std::array<char, sizeof(BinaryKeyHeader)> data{};
+    std::copy(header.magic.begin(), header.magic.end(), data.begin());
+    store_le(data.data() + 8, header.version, 4);
+    store_le(data.data() + 12, header.record_size, 4);
+    return data;
+}
+
+BinaryKeyRecord decode_binary_key_record(const char* data) noexcept
+{
+    BinaryKeyRecord record;
+    record.serial = load_le(data, 8);
+    record.product = static_cast<uint16_t>(load_le(data + 8, 2));
+    record.option = static_cast<uint16_t>(load_le(data + 10, 2));
+    record.mode = data[12];
+    record.status = static_cast<uint8_t>(data[13]);
+    std::memcpy(record.key.data(), data + BINARY_KEY_OFFSET, record.key.size());
+    return record;
+}
+
+BatchStats generate_batch_parallel(std::string_view input, ThreadPool& pool, std::vector<std::string>& chunk_outputs,
+                                   size_t chunk_size)
+{
+    return process_parallel(input, pool, chunk_outputs, chunk_size,
+                            [](std::string_view chunk, std::string& output, BatchPosition position)
+                            {
+                                return generate_batch(chunk, output, KeyFormat::text, nullptr, position);
+                            });
+}
+
+BatchStats generate_batch_parallel(std::string_view input, ThreadPool& pool, std::vector<std::string>& chunk_outputs,
+                                   std::span<const std::unique_ptr<KeyCache>> caches, size_t chunk_size)
+{
+    return process_parallel(input, pool, chunk_outputs, chunk_size,
+                            [caches](std::string_view chunk, std::string& output, BatchPosition position)
+                            {
+                                return generate_batch(chunk, output, KeyFormat::text,
+                                                      caches[ThreadPool::thread_index()].get(), position);
+                            });
+}
+
+const char* verify_outcome_name(VerifyOutcome outcome) noexcept
+{
+    switch (outcome)
+    {
+    case VerifyOutcome::valid:
+        return "valid";
+    case VerifyOutcome::malformed_record:
+        return "malformed_record";
+    case VerifyOutcome::invalid_key:
+        return "invalid_key";
+    case VerifyOutcome::checksum_mismatch:
+        return "checksum_mismatch";
+    case VerifyOutcome::product_mismatch:
+        return "product_mismatch";
+    case VerifyOutcome::serial_mismatch:
+        return "serial_mismatch";
+    case VerifyOutcome::option_mismatch:
+        return "option_mismatch";
+    }
+    return "unknown";
+}
+
+VerifiedKey verify_record_key(std::string_view record) noexcept
+{
+    VerifiedKey result;
+    std::array<std::string_view, MAX_FIELDS> fields;
+    const size_t count = split_fields(record, fields);
+    if (count == 0 || count > MAX_FIELDS) return result;
+    result.key = fields[0];
+    if (count < 3) return result;
+    const int option = parse_small_number(fields[2]);
+    const int product = count == MAX_FIELDS ? parse_small_number(fields[3]) : -1;
+    if (option < 0 || (count == MAX_FIELDS && product < 0)) return result;
+
+    if (result.key.size() == KEY_LENGTH) decode_enigma2(result.key, product, fields[1], option, result);
+    else if (count == 3) decode_nettool(result.key, fields[1], option, result);
+    return result;
+}
+
+void append_verify_result(std::string& output, const VerifiedKey& result, VerifyFormat format)
+{
+    if (format == VerifyFormat::tsv)
+    {
+        output.append(result.key);
+        output.push_back('\t');
+        output.append(verify_outcome_name(result.outcome));
+        output.push_back('\t');
+        if (result.product >= 0) append_number<PRODUCT_CODE_SIZE>(output, result.product);
+        output.push_back('\t');
+        output.append(result.serial_view());
+        output.push_back('\t');
+        if (result.option >= 0 && result.kind == 'e') append_number<OPTION_CODE_SIZE>(output, result.option);
+        else if (result.option >= 0) append_number<1>(output, result.option);
+        output.push_back('\n');
+        return;
+    }
+    output.append("{\"key\":");
+    append_json_string(output, result.key);
+    output.append(result.valid() ? ",\"valid\":true" : ",\"valid\":false");
+    if (result.product >= 0)
+    {
+        output.append(",\"product\":");
+        output.append(std::to_string(result.product));
+    }
+    if (result.serial_length > 0)
+    {
+        output.append(",\"serial\":");
+        append_json_string(output, result.serial_view());
+    }
+    if (result.option >= 0)
+    {
+        output.append(",\"option\":");
+        output.append(std::to_string(result.option));
+    }
+    if (!result.valid())
+    {
+        output.append(",\"reason\":\"");
+        output.append(verify_outcome_name(result.outcome));
+        output.push_back('"');
+    }
+    output.append("}\n");
+}
+
+BatchStats verify_batch(std::string_view input, std::string& output, VerifyFormat format, BatchPosition position)
+{
+    BatchStats stats;
+    if (position == BatchPosition::start) skip_header(input, is_verify_header);
+    while (!input.empty())
+    {
+        const std::string_view line = next_line(input);
+        if (is_batch_skip_line(line)) continue;
+        const VerifiedKey result = verify_record_key(line);
+        ++stats.records;
+        if (!result.valid()) ++stats.errors;
+        append_verify_result(output, result, format);
+    }
+    return stats;
+}
+
+BatchStats verify_batch_parallel(std::string_view input, ThreadPool& pool, std::vector<std::string>& chunk_outputs,
+                                 VerifyFormat format, size_t chunk_size)
+{
+    return process_parallel(input, pool, chunk_outputs, chunk_size,
+                            [format](std::string_view chunk, std::string& output, BatchPosition position)
+                            {
+                                return verify_batch(chunk, output, format, position);
+                            });
+}
+
+namespace
+{
+constexpr size_t NUMERIC_BLOCK_KEYS = 64;        // as KeyBlock
+constexpr size_t NUMERIC_TASK_KEYS = 16 * 1024;  // records per generate_keys() task
+
+// Writes the plain NetTool layout ("0", option, serial reversed) into one
+// lane of a struct-of-arrays block. On failure the lane is left as it was.
+Status lay_out_nettool(uint64_t serial, int32_t option, uint8_t* lane) noexcept
+{
+    if (serial > NETTOOL_MAX_SERIAL) return Status::invalid_serial;
+    if (option < 0 || option > NETTOOL_MAX_OPTION) return Status::invalid_option;
+    lane[0] = 0;
+    lane[NUMERIC_BLOCK_KEYS] = static_cast<uint8_t>(option);
+    for (size_t i = 0; i < SERIAL_NUMBER_SIZE_ENIGMAC; ++i, serial /= 10)
+    {
+        lane[(2 + i) * NUMERIC_BLOCK_KEYS] = static_cast<uint8_t>(serial % 10);
+    }
+    return Status::ok;
+}
+
+// The same for the Enigma2C layout "00PPPPSSSSSSSOOO".
+Status lay_out_enigma2(int product, uint64_t serial, int32_t option, char* lane) noexcept
+{
+    if (product < 0 || product > MAX_PRODUCT_CODE) return Status::invalid_product;
+    if (serial > ENIGMA2_MAX_SERIAL) return Status::invalid_serial;
+    if (option < 0 || option > ENIGMA2_MAX_OPTION) return Status::invalid_option;
+    const auto put = [lane](uint64_t value, size_t location, size_t length)
+    {
+        for (size_t i = location + length; i-- > location; value /= 10)
+        {
+            lane[i * NUMERIC_BLOCK_KEYS] = static_cast<char>('0' + value % 10);
+        }
+    };
+    put(static_cast<uint64_t>(product), PRODUCT_LOCATION, PRODUCT_CODE_SIZE);
+    put(serial, SERIAL_LOCATION, SERIAL_NUMBER_SIZE_ENIGMA2);
+    put(static_cast<uint64_t>(option), OPTION_LOCATION, OPTION_CODE_SIZE);
+    return Status::ok;
+}
+
+// generate_keys() for records [first, last) of already checked arguments.
+size_t generate_key_span(char mode, int product, std::span<const uint64_t> serials, std::span<const int32_t> options,
+                         std::span<char> keys, std::span<Status> statuses, size_t first, size_t last) noexcept
+{
+    const bool nettool = mode == 'n';
+    const size_t length = generated_key_length(mode);
+    std::array<uint8_t, ENIGMA_C_KEY_LENGTH * NUMERIC_BLOCK_KEYS> digits{};
+    std::array<uint8_t, ENIGMA_C_KEY_LENGTH * NUMERIC_BLOCK_KEYS> nibbles{};
+    // Zero-filled lanes would break the kernels' 0-9/A-Z precondition.
+    std::array<char, KEY_LENGTH * NUMERIC_BLOCK_KEYS> plain = filled_array<KEY_LENGTH * NUMERIC_BLOCK_KEYS>('0');
+    std::array<char, KEY_LENGTH * NUMERIC_BLOCK_KEYS> cipher{};
+    std::array<Status, NUMERIC_BLOCK_KEYS> lane_status{};
+    size_t failures = 0;
+    for (size_t begin = first; begin < last; begin += NUMERIC_BLOCK_KEYS)
+    {
+        const size_t count = std::min(NUMERIC_BLOCK_KEYS, last - begin);
+        for (size_t lane = 0; lane < count; ++lane)
+        {
+            const uint64_t serial = serials[begin + lane];
+            const int32_t option = options.size() == 1 ? options[0] : options[begin + lane];
+            lane_status[lane] = nettool ? lay_out_nettool(serial, option, digits.data() + lane)
+                                        : lay_out_enigma2(product, serial, option, plain.data() + lane);
+        }
+        // As in KeyBlock, lanes past count (and failed ones) encrypt stale input.
+        if (nettool)
+        {
+            enigma_c_encrypt_soa(digits.data(), nibbles.data(), ENIGMA_C_KEY_LENGTH, NUMERIC_BLOCK_KEYS);
+        }
+        else
+        {
+            enigma2_c_encrypt_soa(plain.data(), cipher.data(), NUMERIC_BLOCK_KEYS);
+        }
+        for (size_t lane = 0; lane < count; ++lane)
+        {
+            char* out = keys.data() + (begin + lane) * length;
+            if (!statuses.empty()) statuses[begin + lane] = lane_status[lane];
+            if (lane_status[lane] != Status::ok)
+            {
+                std::fill_n(out, length, '\0');
+                ++failures;
+                continue;
+            }
+            for (size_t position = 0; position < length; ++position)
+            {
+                out[position] = nettool ? detail::hex_digit(nibbles[position * NUMERIC_BLOCK_KEYS + lane])
+                                        : cipher[position * NUMERIC_BLOCK_KEYS + lane];
+            }
+        }
+    }
+    return failures;
+}
+} // namespace
+
+size_t generated_key_length(char mode) noexcept
+{
+    if (mode == 'n') return ENIGMA_C_KEY_LENGTH;
+    return mode == 'e' || mode == 'l' ? KEY_LENGTH : 0;
+}
+
+size_t generate_keys(char mode, int product, std::span<const uint64_t> serials, std::span<const int32_t> options,
+                     std::span<char> keys, std::span<Status> statuses, unsigned jobs)
+{
+    const size_t count = serials.size();
+    const size_t length = generated_key_length(mode);
+    Status failure = Status::ok;
+    if (length == 0)
+    {
+        failure = Status::invalid_mode;
+    }
+    else if (options.size() != 1 && options.size() != count)
+    {
+        failure = Status::invalid_option;
+    }
+    else if (keys.size() < count * length || (!statuses.empty() && statuses.size() < count))
+    {
+        failure = Status::buffer_too_small;
+    }
+    if (failure != Status::ok)
+    {
+        std::fill_n(statuses.begin(), std::min(count, statuses.size()), failure);
+        return count;
+    }
+    if (product < 0) product = mode == 'l' ? LINKRUNNER_PRODUCT_CODE : ETHERSCOPE_PRODUCT_CODE;
+
+    const size_t tasks = (count + NUMERIC_TASK_KEYS - 1) / NUMERIC_TASK_KEYS;
+    if (jobs == 1 || tasks <= 1) return generate_key_span(mode, product, serials, options, keys, statuses, 0, count);
+    ThreadPool pool(jobs);
+    std::atomic<size_t> failures{0};
+    pool.parallel_for(tasks, [&](size_t task)
+    {
+        const size_t first = task * NUMERIC_TASK_KEYS;
+        const size_t last = std::min(count, first + NUMERIC_TASK_KEYS);
+        failures += generate_key_span(mode, product, serials, options, keys, statuses, first, last);
+    });
+    return failures;
+}
+
+namespace
+{
+// One cache per pool thread when options ask for one, else none. Each is
+// built by the thread that uses it, so its memory is local to that thread.
+std::vector<std::unique_ptr<KeyCache>> make_caches(ThreadPool& pool, const BatchOptions& options)
+{
+    std::vector<std::unique_ptr<KeyCache>> caches;
+    if (options.cache_entries == 0 || options.task != BatchTask::generate) return caches;
+    caches.resize(pool.size());
+    pool.for_each_thread([&](size_t i) { caches[i] = std::make_unique<KeyCache>(options.cache_entries); });
+    return caches;
+}
+
+// Output callable for run_pipeline().
+auto stream_writer(std::FILE* output)
+{
+    return [output](std::string_view data)
+    {
+        return data.empty() || std::fwrite(data.data(), 1, data.size(), output) == data.size();
+    };
+}
+
+// Writes the BinaryKeyHeader when options ask for binary keys.
+template <typename Write>
+bool write_preamble(const BatchOptions& options, Write&& write)
+{
+    if (options.task != BatchTask::generate || options.output != KeyFormat::binary) return true;
+    const auto header = encode_binary_key_header();
+    return write(std::string_view(header.data(), header.size()));
+}
+
+// A slice of input ending at a line boundary, and the output it produced.
+// Blocks are allocated once per run and recycled, so their buffers keep
+// their capacity.
+struct PipelineBlock
+{
+    std::vector<char> buffer; // input bytes when reading a stream
+    std::string_view input;   // records: in buffer, or in a mapped file
+    size_t end = 0;           // offset just past input in the whole input
+    std::string output;
+    BatchStats stats;
+    uint32_t sequence = 0;
+    bool last = false; // nothing follows this block
+};
+
+// Runs a batch as three stages joined by BoundedQueues. A reader thread
+// fills free blocks with read(block), which returns false once block holds
+// the end of the input; the pool threads process blocks in whatever order
+// they arrive; a writer thread puts them back in order, hands each to
+// write(block) and frees it for the reader. With a fixed number of blocks,
+// a slow writer leaves the reader waiting for a free block. After a write
+// fails the reader stops and the blocks already read are drained unwritten.
+template <typename Read, typename Write>
+BatchStats run_pipeline(const BatchOptions& options, Read&& read, Write&& write)
+{
+    ThreadPool pool(options.jobs, options.affinity);
+    const auto caches = make_caches(pool, options);
+    const size_t block_count = PIPELINE_BLOCKS_PER_THREAD * pool.size() + 2;
+    std::vector<PipelineBlock> blocks(block_count);
+    BoundedQueue<PipelineBlock*> free_blocks(block_count);
+    BoundedQueue<PipelineBlock*> work(block_count + pool.size());
+    BoundedQueue<PipelineBlock*> done(block_count);
+    for (auto& block : blocks) free_blocks.push(&block);
+    std::atomic<bool> write_failed{false};
+
+    std::thread reader([&]
+    {
+        for (uint32_t sequence = 0;; ++sequence)
+        {
+            PipelineBlock* block = free_blocks.pop();
+            block->sequence = sequence;
+            block->input = {};
+            {
+                const stats::ScopedTimer timer(stats::Timer::batch_read);
+                block->last = write_failed.load(std::memory_order_relaxed) || !read(*block);
+            }
+            work.push(block);
+            if (block->last) break;
+        }
+        for (unsigned i = 0; i < pool.size(); ++i) work.push(nullptr);
+    });
+
+    BatchStats stats;
+    std::thread writer([&]
+    {
+        std::vector<PipelineBlock*> pending(block_count, nullptr);
+        for (uint32_t next = 0; true;)
+        {
+            PipelineBlock* block = done.pop();
+            pending[block->sequence % block_count] = block;
+            while (PipelineBlock* ready = pending[next % block_count])
+            {
+                pending[next++ % block_count] = nullptr;
+                accumulate(stats, ready->stats);
+                stats::count(stats::Counter::batch_records, ready->stats.records);
+                stats::count(stats::Counter::batch_errors, ready->stats.errors);
+                if (!write_failed.load(std::memory_order_relaxed))
+                {
+                    const stats::ScopedTimer timer(stats::Timer::batch_write);
+                    if (!write(*ready)) write_failed.store(true, std::memory_order_relaxed);
+                }
+                const bool last = ready->last;
+                free_blocks.push(ready);
+                if (last) return;
+            }
+        }
+    });
+
+    pool.for_each_thread([&](size_t thread)
+    {
+        KeyCache* cache = caches.empty() ? nullptr : caches[thread].get();
+        while (PipelineBlock* block = work.pop())
+        {
+            block->output.clear();
+            {
+                const stats::ScopedTimer timer(stats::Timer::batch_compute);
+                const BatchPosition position =
+                    block->sequence == 0 ? BatchPosition::start : BatchPosition::continuation;
+                block->stats = options.task == BatchTask::verify
+                                   ? verify_batch(block->input, block->output, options.format, position)
+                                   : generate_batch(block->input, block->output, options.output, cache, position);
+            }
+            done.push(block);
+        }
+    });
+    reader.join();
+    writer.join();
+    stats.io_error = write_failed.load(std::memory_order_relaxed);
+    return stats;
+}
+
+// run_batch() with write(std::string_view) -> bool as the output.
+template <typename Write>
+BatchStats run_batch_stream(std::FILE* input, const BatchOptions& options, Write&& write)
+{
+    if (!write_preamble(options, write))
+    {
+        BatchStats failed;
+        failed.io_error = true;
+        return failed;
+    }
+    std::vector<char> carry; // an incomplete line left over from the previous block
+    bool read_error = false;
+    const auto read = [&](PipelineBlock& block)
+    {
+        std::vector<char>& buffer = block.buffer;
+        buffer.resize(std::max(PIPELINE_BLOCK_SIZE, 2 * carry.size()));
+        std::copy(carry.begin(), carry.end(), buffer.begin());
+        size_t filled = carry.size();
+        bool at_eof = false;
+        // Read until the block holds a complete line, doubling it for long ones.
+        while (true)
+        {
+            const size_t got = std::fread(buffer.data() + filled, 1, buffer.size() - filled, input);
+            const bool newline = std::memchr(buffer.data() + filled, '\n', got) != nullptr;
+            filled += got;
+            if (got == 0)
+            {
+                at_eof = true;
+                read_error = std::ferror(input) != 0;
+                break;
+            }
+            if (newline) break;
+            if (filled == buffer.size()) buffer.resize(2 * buffer.size());
+        }
+
+        size_t usable = filled;
+        if (!at_eof)
+        {
+            const auto last_newline = std::find(std::make_reverse_iterator(buffer.begin() + filled),
+                                                std::make_reverse_iterator(buffer.begin()), '\n');
+            usable = static_cast<size_t>(std::distance(buffer.begin(), last_newline.base()));
+        }
+        carry.assign(buffer.begin() + usable, buffer.begin() + filled);
+        block.input = std::string_view(buffer.data(), usable);
+        return !at_eof;
+    };
+    BatchStats stats = run_pipeline(options, read, [&](const PipelineBlock& block) { return write(block.output); });
+    if (read_error) stats.io_error = true;
+    return stats;
+}
+} // namespace
+
+BatchStats run_batch(std::FILE* input, std::FILE* output, const BatchOptions& options)
+{
+    BatchStats stats = run_batch_stream(input, options, stream_writer(output));
+    if (std::fflush(output) != 0) stats.io_error = true;
+    return stats;
+}
+
+BatchStats run_batch(std::FILE* input, OutputFile& output, const BatchOptions& options)
+{
+    return run_batch_stream(input, options, [&output](std::string_view data) { return output.write(data); });
+}
+
+#ifdef ENIGMA_HAVE_MMAP
+namespace
+{
+// Read-only mapping of a whole file, unmapped on destruction.
+class MappedFile
+{
+public:
+    MappedFile(const char* data, size_t size) : data_(data), size_(size) {}
+    ~MappedFile() { munmap(const_cast<char*>(data_), size_); }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    std::string_view view() const noexcept { return {data_, size_}; }
+
+    void advise(int advice) const noexcept { madvise(const_cast<char*>(data_), size_, advice); }
+
+    // Drops the pages backing [0, end) once they have been written, so a
+    // multi-gigabyte manifest does not stay resident behind the cursor.
+    void release_before(size_t end) const noexcept
+    {
+        const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        const size_t aligned = end / page * page;
+        if (aligned > 0) madvise(const_cast<char*>(data_), aligned, MADV_DONTNEED);
+    }
+
+private:
+    const char* data_;
+    size_t size_;
+};
+
+// The reader hands out slices of the mapping, so no input is copied.
+template <typename Write>
+BatchStats run_batch_mapped(const MappedFile& file, const BatchOptions& options, Write&& write)
+{
+    if (!write_preamble(options, write))
+    {
+        BatchStats failed;
+        failed.io_error = true;
+        return failed;
+    }
+    const std::string_view data = file.view();
+    file.advise(MADV_SEQUENTIAL);
+    size_t pos = 0;
+    const auto read = [&](PipelineBlock& block)
+    {
+        // Extend each block to the end of the line it cuts through.
+        size_t end = std::min(pos + PIPELINE_BLOCK_SIZE, data.size());
+        if (end < data.size())
+        {
+            const size_t newline = data.find('\n', end - 1);
+            end = newline == std::string_view::npos ? data.size() : newline + 1;
+        }
+        block.input = data.substr(pos, end - pos);
+        block.end = end;
+        pos = end;
+        return pos < data.size();
+    };
+    return run_pipeline(options, read, [&](const PipelineBlock& block)
+    {
+        const bool written = write(block.output);
+        file.release_before(block.end);
+        return written;
+    });
+}
+} // namespace
+#endif
+
+namespace
+{
+// run_batch_file() with run(FILE*) for streamed input and
+// run_mapped(MappedFile&) for mapped input.
+template <typename Run, typename RunMapped>
+std::optional<BatchStats> run_batch_path(const char* path, Run&& run, [[maybe_unused]] RunMapped&& run_mapped)
+{
+#ifdef ENIGMA_HAVE_MMAP
+    const int fd = open(path, O_RDONLY);
+    if (fd < 0) return std::nullopt;
+    struct stat info{};
+    if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0)
+    {
+        const size_t size = static_cast<size_t>(info.st_size);
+        void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data != MAP_FAILED)
+        {
+            close(fd);
+            const MappedFile file(static_cast<const char*>(data), size);
+            return run_mapped(file);
+        }
+    }
+    // Stream from the descriptor already open: reopening a FIFO would drop
+    // what its writer sent and wait for another one.
+    std::FILE* input = fdopen(fd, "rb");
+    if (!input)
+    {
+        close(fd);
+        return std::nullopt;
+    }
+#else
+    std::FILE* input = std::fopen(path, "rb");
+    if (!input) return std::nullopt;
+#endif
+    const BatchStats stats = run(input);
+    std::fclose(input);
+    return stats;
+}
+} // namespace
+
+std::optional<BatchStats> run_batch_file(const char* path, std::FILE* output, const BatchOptions& options)
+{
+    const auto write = stream_writer(output);
+    auto stats = run_batch_path(path, [&](std::FILE* input) { return run_batch_stream(input, options, write); },
+                                [&](const auto& file) { return run_batch_mapped(file, options, write); });
+    if (stats && std::fflush(output) != 0) stats->io_error = true;
+    return stats;
+}
+
+std::optional<BatchStats> run_batch_file(const char* path, OutputFile& output, const BatchOptions& options)
+{
+    const auto write = [&output](std::string_view data) { return output.write(data); };
+    return run_batch_path(path, [&](std::FILE* input) { return run_batch_stream(input, options, write); },
+                          [&](const auto& file) { return run_batch_mapped(file, options, write); });
+}
+} // namespace enigma
@@ -0,0 +1,111 @@
+// File: enigma_c_api.cpp
+// Author: Kris Armstrong
+// Version: 3.0.0
+// Last Modified: 2026-10-14
+// Description: extern "C" entry points of the enigma_c shared library.
+// License: MIT
+
+#include "enigma_c_api.h"
+
+#include "enigma_batch.h"
+
+#include <cstring>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace
+{
+using enigma::Status;
+
+static_assert(ENIGMA_STATUS_OK == static_cast<int>(Status::ok));
+static_assert(ENIGMA_STATUS_CHECKSUM_MISMATCH == static_cast<int>(Status::checksum_mismatch));
+static_assert(ENIGMA_STATUS_INVALID_PRODUCT == static_cast<int>(Status::invalid_product));
+
+constexpr int LAST_STATUS = ENIGMA_STATUS_INVALID_PRODUCT;
+
+std::string_view text(const char* value) noexcept
+{
+    return value ? std::string_view(value) : std::string_view();
+}
+} // namespace
+
+extern "C" {
+void enigma_c_encrypt(const char* input_key, char* output_key, size_t len)
+{
+    if (!output_key) return;
+    const Status status = input_key ? enigma::enigma_c_encrypt({input_key, len}, {output_key, len})
+                                    : Status::invalid_length;
+    output_key[status == Status::ok ? len : 0] = '\0';
+}
+
+void enigma_c_decrypt(const char* input_key, char* output_key, size_t len)
+{
+    if (!output_key) return;
+    const Status status = input_key ? enigma::enigma_c_decrypt({input_key, len}, {output_key, len})
+                                    : Status::invalid_length;
+    output_key[status == Status::ok ? len : 0] = '\0';
+}
+
+int enigma_c_check_option_key(int option, const char* key, const char* serial_number)
+{
+    return enigma::enigma_c_check_option_key(option, text(key), text(serial_number)) ? 1 : 0;
+}
+
+void enigma2_c_encrypt(const char* input_key, char* output_key)
+{
+    if (!output_key) return;
+    const Status status = enigma::enigma2_c_encrypt(text(input_key), {output_key, enigma::KEY_LENGTH});
+    output_key[status == Status::ok ? enigma::KEY_LENGTH : 0] = '\0';
+}
+
+void enigma2_c_decrypt(const char* input_key, char* output_key)
+{
+    if (!output_key) return;
+    const Status status = enigma::enigma2_c_decrypt(text(input_key), {output_key, enigma::KEY_LENGTH});
+    output_key[status == Status::ok ? enigma::KEY_LENGTH : 0] = '\0';
+}
+
+int enigma2_c_check_option_key(int option, const char* key)
+{
+    return enigma::enigma2_c_check_option_key(option, text(key)) ? 1 : 0;
+}
+
+size_t enigma_key_length(char mode)
+{
+    return enigma::generated_key_length(mode);
+}
+
+size_t enigma_generate_many(char mode, int product, const uint64_t* serials, size_t count, const int32_t* options,
+                            size_t option_count, char* keys, size_t keys_size, uint8_t* statuses, unsigned jobs)
+{
+    if (count == 0) return 0;
+    if (!serials || !options || !keys)
+    {
+        if (statuses) std::memset(statuses, ENIGMA_STATUS_BUFFER_TOO_SMALL, count);
+        return count;
+    }
+    std::vector<Status> record_statuses;
+    try
+    {
+        if (statuses) record_statuses.resize(count);
+        const size_t failures = enigma::generate_keys(mode, product, {serials, count}, {options, option_count},
+                                                      {keys, keys_size}, record_statuses, jobs);
+        for (size_t i = 0; i < record_statuses.size(); ++i) statuses[i] = static_cast<uint8_t>(record_statuses[i]);
+        return failures;
+    }
+    catch (...)
+    {
+        // Out of memory, or the threads could not be started: report every
+        // record as failed rather than let the exception cross the C ABI.
+        if (statuses) std::memset(statuses, ENIGMA_STATUS_BUFFER_TOO_SMALL, count);
+        return count;
+    }
+}
+
+const char* enigma_status_message(int status)
+{
+    if (status < ENIGMA_STATUS_OK || status > LAST_STATUS) return "Unknown status";
+    return enigma::status_message(static_cast<Status>(status));
+}
+}
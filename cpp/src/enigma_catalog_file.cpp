@@ -0,0 +1,595 @@
+// File: enigma_catalog_file.cpp
+// Author: Kris Armstrong
+// Version: 3.0.0
+// Last Modified: 2026-10-14
+// Description: Runtime catalog loading from JSON with a memory-mapped binary index cache.
+// License: MIT
+
+#include "enigma_catalog_file.h"
+#include "enigma_v300_pure_cpp.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define ENIGMA_HAVE_MMAP 1
+#endif
+
+namespace enigma
+{
+namespace
+{
+// Binary index layout, in host byte order (the magic doubles as an
+// endianness check): header, products, options, menu, string pool.
+constexpr char INDEX_MAGIC[8] = {'E', 'N', 'I', 'G', 'C', 'A', 'T', '1'};
+constexpr uint32_t INDEX_VERSION = 1;
+
+struct IndexHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t product_count;
+    uint32_t option_count;
+    uint32_t menu_count;
+    uint64_t source_size;
+    int64_t source_mtime;
+    uint64_t strings_size;
+};
+
+struct IndexProduct
+{
+    uint32_t code;
+    uint32_t abbr_offset;
+    uint32_t abbr_length;
+    uint32_t name_offset;
+    uint32_t name_length;
+};
+
+struct IndexOption
+{
+    uint16_t product;
+    uint16_t code;
+    uint32_t desc_offset;
+    uint32_t desc_length;
+};
+
+// Product and option records as parsed from JSON.
+struct SourceOption
+{
+    int code = -1;
+    std::string desc;
+};
+
+struct SourceProduct
+{
+    int code = -1;
+    std::string abbr;
+    std::string name;
+    std::vector<SourceOption> options;
+};
+
+// Recursive-descent reader for the subset of JSON a catalog uses. Unknown
+// keys are skipped, whatever their value.
+class JsonReader
+{
+public:
+    explicit JsonReader(std::string_view text) : text_(text) {}
+
+    bool parse(std::vector<SourceProduct>& products)
+    {
+        if (!parse_object([&](const std::string& key)
+        {
+            if (key != "products") return skip_value();
+            return parse_array([&] { return parse_product(products.emplace_back()); });
+        }))
+        {
+            return false;
+        }
+        skip_space();
+        return pos_ == text_.size() || fail("unexpected text after the catalog");
+    }
+
+    const std::string& error() const noexcept { return error_; }
+
+private:
+    bool fail(const std::string& message)
+    {
+        if (error_.empty())
+        {
+            const auto line = 1 + std::count(text_.begin(), text_.begin() + static_cast<std::ptrdiff_t>(
+                                                 std::min(pos_, text_.size())), '\n');
+            error_ = "line " + std::to_string(line) + ": " + message;
+        }
+        return false;
+    }
+
+    void skip_space()
+    {
+        while (pos_ < text_.size() && (text_[pos_] == ' ' || text_[pos_] == '\t' || text_[pos_] == '\n' ||
+                                       text_[pos_] == '\r'))
+        {
+            ++pos_;
+        }
+    }
+
+    bool consume(char c)
+    {
+        skip_space();
+        if (pos_ < text_.size() && text_[pos_] == c)
+        {
+            ++pos_;
+            return true;
+        }
+        return false;
+    }
+
+    bool expect(char c)
+    {
+        return consume(c) || fail(std::string("expected '") + c + "'");
+    }
+
+    template <typename OnMember>
+    bool parse_object(OnMember&& on_member)
+    {
+        if (!expect('{')) return false;
+        if (consume('}')) return true;
+        do
+        {
+            std::string key;
+            if (!parse_string(key) || !expect(':') || !on_member(key)) return false;
+        }
+        while (consume(','));
+        return expect('}');
+    }
+
+    template <typename OnElement>
+    bool parse_array(OnElement&& on_element)
+    {
+        if (!expect('[')) return false;
+        if (consume(']')) return true;
+        do
+        {
+            if (!on_element()) return false;
+        }
+        while (consume(','));
+        return expect(']');
+    }
+
+    bool parse_string(std::string& out)
+    {
+        skip_space();
+        if (pos_ >= text_.size() || text_[pos_] != '"') return fail("expected a string");
+        ++pos_;
+        out.clear();
+        while (pos_ < text_.size() && text_[pos_] != '"')
+        {
+            const char c = text_[pos_++];
+            if (static_cast<unsigned char>(c) < 0x20) return fail("control character in string");
+            if (c != '\\')
+            {
+                out.push_back(c);
+                continue;
+            }
+            if (pos_ >= text_.size()) break;
+            const char escape = text_[pos_++];
+            switch (escape)
+            {
+            case '"': out.push_back('"'); break;
+            case '\\': out.push_back('\\'); break;
+            case '/': out.push_back('/'); break;
+            case 'b': out.push_back('\b'); break;
+            case 'f': out.push_back('\f'); break;
+            case 'n': out.push_back('\n'); break;
+            case 'r': out.push_back('\r'); break;
+            case 't': out.push_back('\t'); break;
+            case 'u':
+            {
+                unsigned code = 0;
+                if (!parse_hex4(code)) return false;
+                if (code >= 0xD800 && code <= 0xDBFF)
+                {
+                    unsigned low = 0;
+                    if (pos_ + 1 >= text_.size() || text_[pos_] != '\\' || text_[pos_ + 1] != 'u')
+                    {
+                        return fail("unpaired surrogate in string");
+                    }
+                    pos_ += 2;
+                    if (!parse_hex4(low) || low < 0xDC00 || low > 0xDFFF) return fail("unpaired surrogate in string");
+                    code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                }
+                append_utf8(out, code);
+                break;
+            }
+            default:
+                return fail("invalid escape in string");
+            }
+        }
+        if (pos_ >= text_.size()) return fail("unterminated string");
+        ++pos_;
+        return true;
+    }
+
+    bool parse_hex4(unsigned& code)
+    {
+        if (pos_ + 4 > text_.size()) return fail("truncated \\u escape");
+        for (int i = 0; i < 4; ++i)
+        {
+            const int digit = detail::hex_value(text_[pos_++]);
+            if (digit < 0) return fail("invalid \\u escape");
+            code = code * 16 + static_cast<unsigned>(digit);
+        }
+        return true;
+    }
+
+    static void append_utf8(std::string& out, unsigned code)
+    {
+        if (code < 0x80)
+        {
+            out.push_back(static_cast<char>(code));
+        }
+        else if (code < 0x800)
+        {
+            out.push_back(static_cast<char>(0xC0 | (code >> 6)));
+            out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+        }
+        else if (code < 0x10000)
+        {
+            out.push_back(static_cast<char>(0xE0 | (code >> 12)));
+            out.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+        }
+        else
+        {
+            out.push_back(static_cast<char>(0xF0 | (code >> 18)));
+            out.push_back(static_cast<char>(0x80 | ((code >> 12) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+        }
+    }
+
+    // A code is a non-negative integer or a string of digits ("003").
+    bool parse_code(int& code, int max_code, const char* what)
+    {
+        skip_space();
+        std::string digits;
+        if (pos_ < text_.size() && text_[pos_] == '"')
+        {
+            if (!parse_string(digits)) return false;
+        }
+        else
+        {
+            while (pos_ < text_.size() && detail::is_digit(text_[pos_])) digits.push_back(text_[pos_++]);
+        }
+        if (!detail::all_digits(digits)) return fail(std::string("invalid ") + what);
+        code = digits.size() <= PRODUCT_CODE_SIZE ? detail::parse_leading_int(digits) : max_code + 1;
+        return code <= max_code || fail(std::string(what) + " out of range");
+    }
+
+    bool skip_value()
+    {
+        skip_space();
+        if (pos_ >= text_.size()) return fail("expected a value");
+        std::string ignored;
+        switch (text_[pos_])
+        {
+        case '{': return parse_object([&](const std::string&) { return skip_value(); });
+        case '[': return parse_array([&] { return skip_value(); });
+        case '"': return parse_string(ignored);
+        default:
+            break;
+        }
+        const size_t start = pos_;
+        while (pos_ < text_.size() && std::strchr("+-.0123456789eEtruefalsn", text_[pos_])) ++pos_;
+        return pos_ > start || fail("expected a value");
+    }
+
+    bool parse_product(SourceProduct& product)
+    {
+        return parse_object([&](const std::string& key)
+        {
+            if (key == "code") return parse_code(product.code, MAX_PRODUCT_CODE, "product code");
+            if (key == "abbr") return parse_string(product.abbr);
+            if (key == "name") return parse_string(product.name);
+            if (key == "options")
+            {
+                return parse_array([&]
+                {
+                    SourceOption& option = product.options.emplace_back();
+                    return parse_object([&](const std::string& option_key)
+                    {
+                        if (option_key == "code") return parse_code(option.code, ENIGMA2_MAX_OPTION, "option code");
+                        if (option_key == "desc") return parse_string(option.desc);
+                        return skip_value();
+                    });
+                });
+            }
+            return skip_value();
+        });
+    }
+
+    std::string_view text_;
+    size_t pos_ = 0;
+    std::string error_;
+};
+
+template <typename T>
+void append_bytes(std::vector<char>& out, const T& value)
+{
+    const char* bytes = reinterpret_cast<const char*>(&value);
+    out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+template <typename T>
+T read_bytes(const char* data)
+{
+    T value;
+    std::memcpy(&value, data, sizeof(T));
+    return value;
+}
+
+struct SourceStamp
+{
+    uint64_t size = 0;
+    int64_t mtime = 0;
+};
+
+bool stat_source(const std::string& path, SourceStamp& stamp)
+{
+#ifdef ENIGMA_HAVE_MMAP
+    struct stat info{};
+    if (stat(path.c_str(), &info) != 0) return false;
+    stamp.size = static_cast<uint64_t>(info.st_size);
+#if defined(__APPLE__)
+    stamp.mtime = static_cast<int64_t>(info.st_mtimespec.tv_sec) * 1000000000 + info.st_mtimespec.tv_nsec;
+#else
+    stamp.mtime = static_cast<int64_t>(info.st_mtim.tv_sec) * 1000000000 + info.st_mtim.tv_nsec;
+#endif
+    return true;
+#else
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) return false;
+    stamp.size = static_cast<uint64_t>(file.tellg());
+    return true;
+#endif
+}
+
+bool read_file(const std::string& path, std::string& contents)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return false;
+    contents.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return !file.bad();
+}
+
+// Writes index next to the source through a temporary file and a rename,
+// so a concurrent reader never sees a partial index.
+void write_index(const std::string& path, const std::vector<char>& index)
+{
+    const std::string temporary = path + ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        if (!file) return;
+        file.write(index.data(), static_cast<std::streamsize>(index.size()));
+        if (!file) return;
+    }
+    if (std::rename(temporary.c_str(), path.c_str()) != 0) std::remove(temporary.c_str());
+}
+} // namespace
+
+bool compile_catalog(std::string_view json, std::vector<char>& index, std::string& error, uint64_t source_size,
+                     int64_t source_mtime)
+{
+    std::vector<SourceProduct> products;
+    JsonReader reader(json);
+    if (!reader.parse(products))
+    {
+        error = reader.error();
+        return false;
+    }
+
+    std::vector<uint16_t> menu;
+    for (const auto& product : products)
+    {
+        if (product.code < 0) return error = "product without a code", false;
+        if (product.name.empty()) return error = "product " + std::to_string(product.code) + " has no name", false;
+        menu.push_back(static_cast<uint16_t>(product.code));
+    }
+    std::vector<const SourceProduct*> sorted;
+    for (const auto& product : products) sorted.push_back(&product);
+    std::sort(sorted.begin(), sorted.end(), [](auto* a, auto* b) { return a->code < b->code; });
+    for (size_t i = 1; i < sorted.size(); ++i)
+    {
+        if (sorted[i - 1]->code == sorted[i]->code)
+        {
+            return error = "duplicate product code " + std::to_string(sorted[i]->code), false;
+        }
+    }
+
+    std::string strings;
+    const auto intern = [&](const std::string& text, uint32_t& offset, uint32_t& length)
+    {
+        offset = static_cast<uint32_t>(strings.size());
+        length = static_cast<uint32_t>(text.size());
+        strings += text;
+    };
+    std::vector<IndexProduct> index_products;
+    std::vector<IndexOption> index_options;
+    for (const SourceProduct* product : sorted)
+    {
+        IndexProduct record{};
+        record.code = static_cast<uint32_t>(product->code);
+        intern(product->abbr, record.abbr_offset, record.abbr_length);
+        intern(product->name, record.name_offset, record.name_length);
+        index_products.push_back(record);
+
+        std::vector<const SourceOption*> options;
+        for (const auto& option : product->options)
+        {
+            if (option.code < 0)
+            {
+                return error = "option without a code in product " + std::to_string(product->code), false;
+            }
+            options.push_back(&option);
+        }
+        std::sort(options.begin(), options.end(), [](auto* a, auto* b) { return a->code < b->code; });
+        for (size_t i = 0; i < options.size(); ++i)
+        {
+            if (i > 0 && options[i - 1]->code == options[i]->code)
+            {
+                return error = "duplicate option code " + std::to_string(options[i]->code) + " in product " +
+                    std::to_string(product->code), false;
+            }
+            IndexOption option{};
+            option.product = static_cast<uint16_t>(product->code);
+            option.code = static_cast<uint16_t>(options[i]->code);
+            intern(options[i]->desc, option.desc_offset, option.desc_length);
+            index_options.push_back(option);
+        }
+    }
+
+    IndexHeader header{};
+    std::memcpy(header.magic, INDEX_MAGIC, sizeof(INDEX_MAGIC));
+    header.version = INDEX_VERSION;
+    header.product_count = static_cast<uint32_t>(index_products.size());
+    header.option_count = static_cast<uint32_t>(index_options.size());
+    header.menu_count = static_cast<uint32_t>(menu.size());
+    header.source_size = source_size;
+    header.source_mtime = source_mtime;
+    header.strings_size = strings.size();
+
+    index.clear();
+    append_bytes(index, header);
+    for (const auto& product : index_products) append_bytes(index, product);
+    for (const auto& option : index_options) append_bytes(index, option);
+    for (const uint16_t code : menu) append_bytes(index, code);
+    index.insert(index.end(), strings.begin(), strings.end());
+    return true;
+}
+
+LoadedCatalog::~LoadedCatalog()
+{
+#ifdef ENIGMA_HAVE_MMAP
+    if (mapped_) munmap(const_cast<char*>(mapped_), mapped_size_);
+#endif
+}
+
+bool LoadedCatalog::attach(const char* index, size_t size)
+{
+    if (size < sizeof(IndexHeader)) return false;
+    const auto header = read_bytes<IndexHeader>(index);
+    if (std::memcmp(header.magic, INDEX_MAGIC, sizeof(INDEX_MAGIC)) != 0 || header.version != INDEX_VERSION)
+    {
+        return false;
+    }
+    const uint64_t expected = sizeof(IndexHeader) + uint64_t{header.product_count} * sizeof(IndexProduct) +
+        uint64_t{header.option_count} * sizeof(IndexOption) + uint64_t{header.menu_count} * sizeof(uint16_t) +
+        header.strings_size;
+    if (expected != size) return false;
+
+    const char* cursor = index + sizeof(IndexHeader);
+    const char* strings = index + size - header.strings_size;
+    const auto text = [&](uint32_t offset, uint32_t length, std::string_view& out)
+    {
+        if (uint64_t{offset} + length > header.strings_size) return false;
+        out = std::string_view(strings + offset, length);
+        return true;
+    };
+
+    products_.resize(header.product_count);
+    for (auto& product : products_)
+    {
+        const auto record = read_bytes<IndexProduct>(cursor);
+        cursor += sizeof(IndexProduct);
+        if (record.code > MAX_PRODUCT_CODE) return false;
+        product.code = static_cast<uint16_t>(record.code);
+        if (!text(record.abbr_offset, record.abbr_length, product.abbr)) return false;
+        if (!text(record.name_offset, record.name_length, product.name)) return false;
+    }
+    options_.resize(header.option_count);
+    for (auto& option : options_)
+    {
+        const auto record = read_bytes<IndexOption>(cursor);
+        cursor += sizeof(IndexOption);
+        option.product = record.product;
+        option.code = record.code;
+        if (!text(record.desc_offset, record.desc_length, option.desc)) return false;
+    }
+    menu_.resize(header.menu_count);
+    for (auto& code : menu_)
+    {
+        code = read_bytes<uint16_t>(cursor);
+        cursor += sizeof(uint16_t);
+    }
+    catalog_ = Catalog(products_, options_, menu_);
+    return catalog_.is_valid();
+}
+
+std::unique_ptr<LoadedCatalog> LoadedCatalog::load(const std::string& json_path, std::string& error, bool use_cache)
+{
+    SourceStamp stamp;
+    if (!stat_source(json_path, stamp))
+    {
+        error = "cannot open " + json_path;
+        return nullptr;
+    }
+    const std::string index_path = json_path + ".cache";
+    std::unique_ptr<LoadedCatalog> loaded(new LoadedCatalog());
+
+#ifdef ENIGMA_HAVE_MMAP
+    if (use_cache)
+    {
+        const int fd = open(index_path.c_str(), O_RDONLY);
+        struct stat info{};
+        if (fd >= 0 && fstat(fd, &info) == 0 && static_cast<size_t>(info.st_size) >= sizeof(IndexHeader))
+        {
+            const size_t size = static_cast<size_t>(info.st_size);
+            void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data != MAP_FAILED)
+            {
+                loaded->mapped_ = static_cast<const char*>(data);
+                loaded->mapped_size_ = size;
+                const auto header = read_bytes<IndexHeader>(loaded->mapped_);
+                if (header.source_size == stamp.size && header.source_mtime == stamp.mtime &&
+                    loaded->attach(loaded->mapped_, size))
+                {
+                    close(fd);
+                    loaded->from_cache_ = true;
+                    return loaded;
+                }
+                // Stale or damaged: rebuild below. The destructor unmaps.
+                loaded.reset(new LoadedCatalog());
+            }
+        }
+        if (fd >= 0) close(fd);
+    }
+#endif
+
+    std::string json;
+    if (!read_file(json_path, json))
+    {
+        error = "cannot read " + json_path;
+        return nullptr;
+    }
+    std::string message;
+    if (!compile_catalog(json, loaded->owned_, message, stamp.size, stamp.mtime))
+    {
+        error = json_path + ": " + message;
+        return nullptr;
+    }
+    if (!loaded->attach(loaded->owned_.data(), loaded->owned_.size()))
+    {
+        error = json_path + ": catalog index is inconsistent";
+        return nullptr;
+    }
+    if (use_cache) write_index(index_path, loaded->owned_);
+    return loaded;
+}
+} // namespace enigma
@@ -0,0 +1,125 @@
+// File: enigma_core.cpp
+// Author: Kris Armstrong
+// Version: 3.0.0
+// Last Modified: 2026-10-14
+// Description: Out-of-line parts of enigma_core and build-time checks of the constexpr key algorithms.
+// License: MIT
+
+#include "enigma_v300_pure_cpp.h"
+#include "enigma_engine.h"
+#include "enigma_packed.h"
+#include "enigma_range.h"
+
+namespace enigma
+{
+// Reference vectors from the CLI test suite, verified on every build.
+static_assert(nettool_option_key("0003333016", 4).view() == "5dabade112dd");
+static_assert(enigma2_option_key(6963, "0000607", 7).view() == "6406257948597747");
+static_assert(enigma2_option_key(6963, "1234567", 7).view() == "9225940719507747");
+static_assert(enigma2_option_key(7001, "1234567", 2).view() == "8944937150971162");
+static_assert(enigma2_option_key(3001, "1234567", 4).view() == "8042745901759933");
+static_assert(enigma2_c_check_option_key(7, "6406257948597747"));
+static_assert(!enigma2_option_key(6963, "000060", 7));
+
+// Both EnigmaC kernels give the reference key, whichever the build selects.
+static_assert([]
+{
+    std::array<char, ENIGMA_C_KEY_LENGTH> bytewise{};
+    std::array<char, ENIGMA_C_KEY_LENGTH> wide{};
+    return detail::enigma_c_encrypt_bytewise("046103333000", bytewise) == Status::ok &&
+           detail::enigma_c_encrypt_wide("046103333000", wide) == Status::ok && bytewise == wide &&
+           detail::enigma_c_decrypt_wide(std::string_view(wide.data(), wide.size()), wide) == Status::ok &&
+           std::string_view(wide.data(), wide.size()) == "046103333000";
+}());
+
+// The compile-time engines agree with the free functions.
+static_assert([]
+{
+    std::array<char, ENIGMA_C_KEY_LENGTH> nettool{};
+    std::array<char, KEY_LENGTH> enigma2{};
+    std::array<char, KEY_LENGTH> plain{};
+    return NetToolEngine::encrypt("046103333000", nettool) == Status::ok &&
+           std::string_view(nettool.data(), nettool.size()) == "5dabade112dd" &&
+           Enigma2Engine::encrypt("0069630000607007", enigma2) == Status::ok &&
+           std::string_view(enigma2.data(), enigma2.size()) == "6406257948597747" &&
+           Enigma2Engine::decrypt("6406257948597747", plain) == Status::ok &&
+           std::string_view(plain.data() + 2, KEY_LENGTH - 2) == "69630000607007" &&
+           Enigma2Engine::decrypt("6406257948597748", plain) == Status::checksum_mismatch &&
+           NetToolEngine::encrypt("04610333300", nettool) == Status::invalid_length;
+}());
+
+// The packed forms produce the same keys and checks.
+static_assert([]
+{
+    PackedNetToolKey key;
+    std::array<char, ENIGMA_C_KEY_LENGTH> text{};
+    if (nettool_option_key(3333016, 4, key) != Status::ok) return false;
+    format_nettool_key(key, text);
+    return std::string_view(text.data(), text.size()) == "5dabade112dd";
+}());
+static_assert([]
+{
+    // enigma_c_check_option_key() reads the serial reversed from digits 0-9.
+    std::array<char, ENIGMA_C_KEY_LENGTH> text{};
+    PackedNetToolKey key;
+    if (enigma_c_encrypt("610333300004", text) != Status::ok) return false;
+    const std::string_view view(text.data(), text.size());
+    return pack_nettool_key(view, key) == Status::ok && enigma_c_check_option_key(4, view, "0003333016") &&
+           enigma_c_check_option_key(4, key, 3333016) && !enigma_c_check_option_key(5, key, 3333016);
+}());
+static_assert([]
+{
+    PackedEnigma2Key key;
+    std::array<char, KEY_LENGTH> text{};
+    if (enigma2_option_key(6963, 607, 7, key) != Status::ok) return false;
+    format_enigma2_key(key, text);
+    return std::string_view(text.data(), text.size()) == "6406257948597747" && enigma2_c_check_option_key(7, key);
+}());
+
+// So do the range cursors, across a carry through every serial digit.
+static_assert([]
+{
+    NetToolKeyRange range;
+    if (range.start(3333016, 4) != Status::ok || range.key() != "5dabade112dd") return false;
+    if (range.start(999999998, 4) != Status::ok) return false;
+    return range.advance() && range.advance() && range.key() == nettool_option_key("1000000000", 4).view();
+}());
+static_assert([]
+{
+    Enigma2KeyRange range;
+    if (range.start(6963, 607, 7) != Status::ok || range.key() != "6406257948597747") return false;
+    if (range.start(7001, 999998, 2) != Status::ok) return false;
+    return range.advance() && range.advance() && range.key() == enigma2_option_key(7001, "1000000", 2).view() &&
+           range.start(6963, 10000000, 7) == Status::invalid_serial && range.serial() == 1000000;
+}());
+
+const char* status_message(Status status) noexcept
+{
+    switch (status)
+    {
+    case Status::ok:
+        return "OK";
+    case Status::invalid_length:
+        return "Input key length must be 16";
+    case Status::non_hex:
+        return "Input contains non-hex characters";
+    case Status::invalid_character:
+        return "Input contains characters other than 0-9 and A-Z";
+    case Status::checksum_mismatch:
+        return "Decryption failed: invalid checksum";
+    case Status::buffer_too_small:
+        return "Output buffer too small";
+    case Status::malformed_record:
+        return "Record must be MODE,SERIAL,OPTION[,PRODUCT]";
+    case Status::invalid_mode:
+        return "Mode must be n, e or l";
+    case Status::invalid_serial:
+        return "Serial number must be 10 digits (n) or 7 digits (e, l)";
+    case Status::invalid_option:
+        return "Option must be 0-9 (n) or 0-999 (e, l)";
+    case Status::invalid_product:
+        return "Product code must be 0-9999";
+    }
+    return "Unknown error";
+}
+} // namespace enigma
@@ -0,0 +1,91 @@
+// File: enigma_key_cache.cpp
+// Author: Kris Armstrong
+// Version: 3.0.0
+// Last Modified: 2026-10-14
+// Description: Set-associative CLOCK cache of generated and decoded keys.
+// License: MIT
+
+#include "enigma_key_cache.h"
+
+#include <algorithm>
+#include <bit>
+
+namespace enigma
+{
+KeyCache::KeyCache(size_t entries)
+{
+    const size_t sets = std::bit_ceil(std::max<size_t>(1, (entries + WAYS - 1) / WAYS));
+    sets_ = std::make_unique<Set[]>(sets);
+    clock_ = std::make_unique<uint8_t[]>(sets);
+    set_mask_ = sets - 1;
+}
+
+size_t KeyCache::set_of(const CacheKey& key) const noexcept
+{
+    // splitmix64 finalizer over both words; serials differ in the low bits
+    uint64_t x = key.words[0] ^ std::rotl(key.words[1], 29);
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return static_cast<size_t>(x) & set_mask_;
+}
+
+std::optional<CacheValue> KeyCache::find(const CacheKey& key) noexcept
+{
+    const size_t index = set_of(key);
+    const Set& set = sets_[index];
+    for (size_t way = 0; way < WAYS; ++way)
+    {
+        if (set.entries[way].key == key)
+        {
+            clock_[index] |= static_cast<uint8_t>(1u << way);
+            bump(hits_);
+            return set.entries[way].value;
+        }
+    }
+    bump(misses_);
+    return std::nullopt;
+}
+
+void KeyCache::insert(const CacheKey& key, const CacheValue& value) noexcept
+{
+    const size_t index = set_of(key);
+    Set& set = sets_[index];
+    uint8_t clock = clock_[index];
+
+    size_t way = WAYS;
+    for (size_t i = 0; i < WAYS; ++i)
+    {
+        if (set.entries[i].key == key || set.entries[i].key == CacheKey{})
+        {
+            way = i;
+            break;
+        }
+    }
+    if (way == WAYS)
+    {
+        // Second chance: clear marked entries under the hand until an
+        // unmarked one comes round. Ends within WAYS + 1 steps.
+        size_t hand = clock >> 4;
+        while (clock & (1u << hand))
+        {
+            clock &= static_cast<uint8_t>(~(1u << hand));
+            hand = (hand + 1) % WAYS;
+        }
+        way = hand;
+        clock = static_cast<uint8_t>((clock & 0x0f) | ((hand + 1) % WAYS) << 4);
+        bump(evictions_);
+    }
+
+    set.entries[way] = {key, value};
+    clock_[index] = static_cast<uint8_t>(clock & ~(1u << way));
+}
+
+KeyCacheStats KeyCache::stats() const noexcept
+{
+    return {hits_.load(std::memory_order_relaxed), misses_.load(std::memory_order_relaxed),
+            evictions_.load(std::memory_order_relaxed)};
+}
+} // namespace enigma
@@ -0,0 +1,175 @@
+// File: enigma_output.cpp
+// Author: Kris Armstrong
+// Version: 3.0.0
+// Last Modified: 2026-10-14
+// Description: Buffered, block-aligned batch output with optional direct I/O.
+// License: MIT
+
+#include "enigma_output.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <new>
+
+#include <fcntl.h>
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#else
+#include <io.h>
+#endif
+
+namespace enigma
+{
+namespace
+{
+int open_file(const char* path, int flags) noexcept
+{
+#if defined(__unix__) || defined(__APPLE__)
+    return ::open(path, flags, 0644);
+#else
+    return ::_open(path, flags, 0644);
+#endif
+}
+
+long write_file(int fd, const char* data, size_t length) noexcept
+{
+#if defined(__unix__) || defined(__APPLE__)
+    return static_cast<long>(::write(fd, data, length));
+#else
+    return ::_write(fd, data, static_cast<unsigned>(length));
+#endif
+}
+
+int close_file(int fd) noexcept
+{
+#if defined(__unix__) || defined(__APPLE__)
+    return ::close(fd);
+#else
+    return ::_close(fd);
+#endif
+}
+} // namespace
+
+void OutputFile::AlignedDelete::operator()(char* buffer) const noexcept
+{
+    ::operator delete[](buffer, std::align_val_t{BLOCK_SIZE});
+}
+
+OutputFile::OutputFile(int fd, bool owned, bool direct)
+    : fd_(fd), owned_(owned), direct_(direct),
+      buffer_(static_cast<char*>(::operator new[](BUFFER_SIZE, std::align_val_t{BLOCK_SIZE})))
+{
+}
+
+OutputFile::OutputFile(int fd) : OutputFile(fd, false, false) {}
+
+OutputFile::~OutputFile()
+{
+    if (owned_ && fd_ >= 0) close_file(fd_);
+}
+
+std::unique_ptr<OutputFile> OutputFile::open(const char* path, bool direct, std::string& error)
+{
+    int flags = O_WRONLY | O_CREAT | O_TRUNC;
+#ifdef O_BINARY
+    flags |= O_BINARY;
+#endif
+    int fd = -1;
+    bool bypass = false;
+#ifdef O_DIRECT
+    if (direct)
+    {
+        fd = open_file(path, flags | O_DIRECT);
+        bypass = fd >= 0;
+    }
+#endif
+    if (fd < 0) fd = open_file(path, flags);
+    if (fd < 0)
+    {
+        error = std::strerror(errno);
+        return nullptr;
+    }
+#ifdef F_NOCACHE
+    if (direct) bypass = fcntl(fd, F_NOCACHE, 1) == 0;
+#endif
+    return std::unique_ptr<OutputFile>(new OutputFile(fd, true, bypass));
+}
+
+bool OutputFile::disable_direct() noexcept
+{
+    if (!direct_) return false;
+    direct_ = false;
+#ifdef O_DIRECT
+    const int flags = fcntl(fd_, F_GETFL);
+    return flags >= 0 && fcntl(fd_, F_SETFL, flags & ~O_DIRECT) == 0;
+#elif defined(F_NOCACHE)
+    return fcntl(fd_, F_NOCACHE, 0) == 0;
+#else
+    return true;
+#endif
+}
+
+// Writes the first length bytes of the buffer; length is a multiple of
+// BLOCK_SIZE unless this is the last write.
+bool OutputFile::write_out(size_t length) noexcept
+{
+    size_t done = 0;
+    while (done < length && !failed_)
+    {
+        const long written = write_file(fd_, buffer_.get() + done, length - done);
+        if (written > 0)
+        {
+            done += static_cast<size_t>(written);
+        }
+        else if (written < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        else if (written < 0 && errno == EINVAL && disable_direct())
+        {
+            continue; // accepted at open() but not for writes; carry on buffered
+        }
+        else
+        {
+            failed_ = true;
+        }
+    }
+    return !failed_;
+}
+
+bool OutputFile::write(std::string_view data) noexcept
+{
+    while (!data.empty() && !failed_)
+    {
+        const size_t take = std::min(data.size(), BUFFER_SIZE - filled_);
+        std::memcpy(buffer_.get() + filled_, data.data(), take);
+        filled_ += take;
+        data.remove_prefix(take);
+        if (filled_ == BUFFER_SIZE && write_out(BUFFER_SIZE)) filled_ = 0;
+    }
+    return !failed_;
+}
+
+bool OutputFile::close() noexcept
+{
+    if (filled_ > 0)
+    {
+        // Whole blocks can still go direct; the tail cannot.
+        const size_t aligned = filled_ / BLOCK_SIZE * BLOCK_SIZE;
+        if (direct_ && aligned > 0 && write_out(aligned))
+        {
+            std::memmove(buffer_.get(), buffer_.get() + aligned, filled_ - aligned);
+            filled_ -= aligned;
+        }
+        if (filled_ % BLOCK_SIZE != 0 && direct_ && !disable_direct()) failed_ = true;
+        if (write_out(filled_)) filled_ = 0;
+    }
+    if (owned_ && fd_ >= 0)
+    {
+        if (close_file(fd_) != 0) failed_ = true;
+        fd_ = -1;
+    }
+    return !failed_;
+}
+} // namespace enigma
@@ -0,0 +1,290 @@
+// File: enigma_python.cpp
+// Author: Kris Armstrong
+// Version: 3.0.0
+// Last Modified: 2026-10-14
+// Description: enigma_native CPython extension: vectorised key generation over buffers.
+// License: MIT
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include "enigma_batch.h"
+
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+namespace
+{
+// Integers from a Python argument: a C-contiguous buffer of any integer
+// format (NumPy arrays, array.array, memoryview) or an iterable of ints.
+// 64-bit serial buffers are used in place; everything else is converted.
+// Values that do not fit T become Invalid, so the record fails in
+// generate_keys() instead of wrapping into a valid one.
+template <typename T, T Invalid>
+class IntegerArray
+{
+public:
+    IntegerArray() = default;
+    IntegerArray(const IntegerArray&) = delete;
+    IntegerArray& operator=(const IntegerArray&) = delete;
+
+    ~IntegerArray()
+    {
+        if (view_.obj) PyBuffer_Release(&view_);
+    }
+
+    // Returns false with a Python exception set.
+    bool load(PyObject* object, const char* name)
+    {
+        if (PyLong_Check(object))
+        {
+            if (!append(PyLong_AsLongLong(object), name, 0)) return false;
+            data_ = values_.data();
+            size_ = 1;
+            return true;
+        }
+        if (PyObject_CheckBuffer(object)) return load_buffer(object, name);
+        PyObject* sequence = PySequence_Fast(object, name);
+        if (!sequence) return false;
+        const Py_ssize_t size = PySequence_Fast_GET_SIZE(sequence);
+        values_.reserve(static_cast<size_t>(size));
+        for (Py_ssize_t i = 0; i < size; ++i)
+        {
+            if (!append(PyLong_AsLongLong(PySequence_Fast_GET_ITEM(sequence, i)), name, static_cast<size_t>(i)))
+            {
+                Py_DECREF(sequence);
+                return false;
+            }
+        }
+        Py_DECREF(sequence);
+        data_ = values_.data();
+        size_ = values_.size();
+        return true;
+    }
+
+    std::span<const T> span() const noexcept { return {data_, size_}; }
+
+private:
+    static T convert(long long value) noexcept
+    {
+        if constexpr (std::is_unsigned_v<T>)
+        {
+            return value < 0 ? Invalid : static_cast<T>(value);
+        }
+        else
+        {
+            return value < std::numeric_limits<T>::min() || value > std::numeric_limits<T>::max()
+                       ? Invalid : static_cast<T>(value);
+        }
+    }
+
+    // Appends the result of PyLong_AsLongLong(). A Python int too large for
+    // long long fails its record like any other out-of-range value; other
+    // conversion errors propagate.
+    bool append(long long value, const char* name, size_t index)
+    {
+        if (value == -1 && PyErr_Occurred())
+        {
+            if (!PyErr_ExceptionMatches(PyExc_OverflowError))
+            {
+                if (PyErr_ExceptionMatches(PyExc_TypeError))
+                {
+                    PyErr_Format(PyExc_TypeError, "%s[%zu] is not an integer", name, index);
+                }
+                return false;
+            }
+            PyErr_Clear();
+            values_.push_back(Invalid);
+            return true;
+        }
+        values_.push_back(convert(value));
+        return true;
+    }
+
+    bool load_buffer(PyObject* object, const char* name)
+    {
+        if (PyObject_GetBuffer(object, &view_, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT) != 0) return false;
+        const char* format = view_.format ? view_.format : "B";
+        if (*format == '@' || *format == '=' || *format == '<') ++format;
+        const size_t count = view_.itemsize > 0 ? static_cast<size_t>(view_.len / view_.itemsize) : 0;
+        const char kind = std::strlen(format) == 1 ? *format : 0;
+        const bool is_signed = kind == 'b' || kind == 'h' || kind == 'i' || kind == 'l' || kind == 'q' || kind == 'n';
+        const bool is_unsigned = kind == 'B' || kind == 'H' || kind == 'I' || kind == 'L' || kind == 'Q' || kind == 'N';
+        if (!is_signed && !is_unsigned)
+        {
+            PyErr_Format(PyExc_TypeError, "%s must hold integers, not buffer format '%s'", name, format);
+            return false;
+        }
+        // uint64 serials (and int64 ones, whose negatives read as too large)
+        // need no copy.
+        if (sizeof(T) == 8 && view_.itemsize == 8)
+        {
+            data_ = static_cast<const T*>(view_.buf);
+            size_ = count;
+            return true;
+        }
+        values_.resize(count);
+        const auto* bytes = static_cast<const unsigned char*>(view_.buf);
+        for (size_t i = 0; i < count; ++i)
+        {
+            values_[i] = is_signed ? convert(read_signed(bytes + i * view_.itemsize, view_.itemsize))
+                                   : convert_unsigned(read_unsigned(bytes + i * view_.itemsize, view_.itemsize));
+        }
+        data_ = values_.data();
+        size_ = count;
+        return true;
+    }
+
+    template <typename V>
+    static V read(const unsigned char* item) noexcept
+    {
+        V value;
+        std::memcpy(&value, item, sizeof(V));
+        return value;
+    }
+
+    static long long read_signed(const unsigned char* item, Py_ssize_t size) noexcept
+    {
+        switch (size)
+        {
+        case 1:
+            return read<int8_t>(item);
+        case 2:
+            return read<int16_t>(item);
+        case 4:
+            return read<int32_t>(item);
+        default:
+            return read<int64_t>(item);
+        }
+    }
+
+    static unsigned long long read_unsigned(const unsigned char* item, Py_ssize_t size) noexcept
+    {
+        switch (size)
+        {
+        case 1:
+            return read<uint8_t>(item);
+        case 2:
+            return read<uint16_t>(item);
+        case 4:
+            return read<uint32_t>(item);
+        default:
+            return read<uint64_t>(item);
+        }
+    }
+
+    static T convert_unsigned(unsigned long long value) noexcept
+    {
+        return value > static_cast<unsigned long long>(std::numeric_limits<T>::max()) ? Invalid : static_cast<T>(value);
+    }
+
+    Py_buffer view_{};
+    std::vector<T> values_;
+    const T* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+using SerialArray = IntegerArray<uint64_t, std::numeric_limits<uint64_t>::max()>;
+using OptionArray = IntegerArray<int32_t, -1>;
+
+PyObject* generate_many(PyObject*, PyObject* args, PyObject* kwargs)
+{
+    static const char* keywords[] = {"serials", "options", "mode", "product", "jobs", "strict", nullptr};
+    PyObject* serials_object = nullptr;
+    PyObject* options_object = nullptr;
+    const char* mode = "n";
+    int product = -1;
+    unsigned jobs = 1;
+    int strict = 1;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OO|siIp", const_cast<char**>(keywords), &serials_object,
+                                     &options_object, &mode, &product, &jobs, &strict))
+    {
+        return nullptr;
+    }
+    const size_t length = std::strlen(mode) == 1 ? enigma::generated_key_length(mode[0]) : 0;
+    if (length == 0)
+    {
+        PyErr_Format(PyExc_ValueError, "mode must be 'n', 'e' or 'l', not '%s'", mode);
+        return nullptr;
+    }
+    SerialArray serials;
+    OptionArray options;
+    if (!serials.load(serials_object, "serials") || !options.load(options_object, "options")) return nullptr;
+    const size_t count = serials.span().size();
+    if (options.span().size() != 1 && options.span().size() != count)
+    {
+        PyErr_Format(PyExc_ValueError, "options has %zu values for %zu serials", options.span().size(), count);
+        return nullptr;
+    }
+
+    PyObject* result = PyBytes_FromStringAndSize(nullptr, static_cast<Py_ssize_t>(count * length));
+    if (!result) return nullptr;
+    std::vector<enigma::Status> statuses;
+    bool failed_to_run = false;
+    Py_BEGIN_ALLOW_THREADS
+    try
+    {
+        statuses.resize(count);
+        enigma::generate_keys(mode[0], product, serials.span(), options.span(),
+                              {PyBytes_AS_STRING(result), count * length}, statuses, jobs);
+    }
+    catch (...)
+    {
+        failed_to_run = true;
+    }
+    Py_END_ALLOW_THREADS
+    if (failed_to_run)
+    {
+        Py_DECREF(result);
+        PyErr_SetString(PyExc_MemoryError, "could not allocate or start key generation");
+        return nullptr;
+    }
+    if (strict)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (statuses[i] == enigma::Status::ok) continue;
+            Py_DECREF(result);
+            PyErr_Format(PyExc_ValueError, "record %zu: %s", i, enigma::status_message(statuses[i]));
+            return nullptr;
+        }
+    }
+    return result;
+}
+
+PyObject* key_length(PyObject*, PyObject* args)
+{
+    const char* mode = nullptr;
+    if (!PyArg_ParseTuple(args, "s", &mode)) return nullptr;
+    return PyLong_FromSize_t(std::strlen(mode) == 1 ? enigma::generated_key_length(mode[0]) : 0);
+}
+
+PyMethodDef METHODS[] = {
+    {"generate_many", reinterpret_cast<PyCFunction>(reinterpret_cast<void (*)()>(generate_many)),
+     METH_VARARGS | METH_KEYWORDS,
+     "generate_many(serials, options, mode='n', product=-1, jobs=1, strict=True) -> bytes\n\n"
+     "Keys for every serial, back to back with no separators: key_length(mode)\n"
+     "bytes each, so numpy.frombuffer(result, dtype=f'S{key_length(mode)}') views\n"
+     "them as an array. serials and options are integer buffers (NumPy arrays,\n"
+     "array.array) or iterables of ints; options may also be a single int.\n"
+     "product applies to modes 'e' and 'l' (-1 = the mode's default). The GIL\n"
+     "is released while keys are generated on jobs threads (0 = all). With\n"
+     "strict=False, failed records get NUL keys instead of raising ValueError."},
+    {"key_length", key_length, METH_VARARGS, "key_length(mode) -> int: 12 for 'n', 16 for 'e' and 'l', else 0."},
+    {nullptr, nullptr, 0, nullptr},
+};
+
+PyModuleDef MODULE = {
+    PyModuleDef_HEAD_INIT, "enigma_native", "Native key generation from enigma_core.", -1, METHODS,
+    nullptr, nullptr, nullptr, nullptr,
+};
+} // namespace
+
+PyMODINIT_FUNC PyInit_enigma_native()
+{
+    return PyModule_Create(&MODULE);
+}
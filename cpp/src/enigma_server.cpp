@@ -0,0 +1,794 @@
+// File: enigma_server.cpp
+// Author: Kris Armstrong
+// Version: 3.0.0
+// Last Modified: 2026-10-14
+// Description: Line-protocol key service over Unix domain sockets and TCP.
+// License: MIT
+
+#include "enigma_server.h"
+#include "enigma_affinity.h"
+#include "enigma_batch.h"
+#include "enigma_engine.h"
+#include "enigma_stats.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <sys/epoll.h>
+#define ENIGMA_SERVER_EPOLL 1
+#ifndef EPOLLEXCLUSIVE
+#define EPOLLEXCLUSIVE 0 // kernels before 4.5 wake every worker; one wins the accept()
+#endif
+#else
+#include <poll.h>
+#endif
+
+namespace enigma
+{
+namespace
+{
+#ifdef MSG_NOSIGNAL
+constexpr int SEND_FLAGS = MSG_NOSIGNAL;
+#else
+constexpr int SEND_FLAGS = 0;
+#endif
+
+bool set_nonblocking(int fd) noexcept
+{
+    const int flags = fcntl(fd, F_GETFL, 0);
+    return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0 && fcntl(fd, F_SETFD, FD_CLOEXEC) == 0;
+}
+
+std::string_view trim_line(std::string_view text) noexcept
+{
+    while (!text.empty() && (text.front() == ' ' || text.front() == '\t')) text.remove_prefix(1);
+    while (!text.empty() && (text.back() == ' ' || text.back() == '\t' || text.back() == '\r')) text.remove_suffix(1);
+    return text;
+}
+
+void append_error(std::string& response, std::string_view message)
+{
+    response.append("ERR\t");
+    response.append(message);
+    response.push_back('\n');
+}
+
+void append_decoded(std::string& response, std::string_view key, const Catalog& catalog, KeyCache* cache)
+{
+    DecodedKey decoded;
+    const CacheKey tag = decode_cache_key(key);
+    const auto cached = cache && key.size() == KEY_LENGTH ? cache->find(tag) : std::nullopt;
+    if (cached)
+    {
+        decoded.layout = *cached;
+    }
+    else
+    {
+        stats::count(stats::Counter::keys_decrypted);
+        const Status status = Enigma2Engine::decrypt(key, decoded.layout);
+        if (status != Status::ok)
+        {
+            append_error(response, status_message(status));
+            return;
+        }
+        if (cache) cache->insert(tag, decoded.layout);
+    }
+    const std::string_view layout = decoded.view();
+    const ProductInfo* product = catalog.find_product(decoded.product());
+    response.append("OK\t");
+    response.append(layout.substr(PRODUCT_LOCATION, PRODUCT_CODE_SIZE));
+    response.push_back('\t');
+    response.append(decoded.serial());
+    response.push_back('\t');
+    response.append(layout.substr(OPTION_LOCATION, OPTION_CODE_SIZE));
+    response.push_back('\t');
+    response.append(product ? product->name : "Unknown");
+    response.push_back('\n');
+}
+
+int close_with_error(int fd, std::string& error, const std::string& message)
+{
+    error = message + ": " + std::strerror(errno);
+    if (fd >= 0) close(fd);
+    return -1;
+}
+
+int listen_unix(const std::string& path, std::string& error)
+{
+    sockaddr_un address{};
+    if (path.empty() || path.size() >= sizeof(address.sun_path))
+    {
+        error = "invalid Unix socket path";
+        return -1;
+    }
+    address.sun_family = AF_UNIX;
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+    const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return close_with_error(fd, error, "socket");
+    // Replace a socket left behind by an earlier instance, but nothing else.
+    struct stat info{};
+    if (lstat(path.c_str(), &info) == 0 && S_ISSOCK(info.st_mode)) unlink(path.c_str());
+    if (bind(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0)
+    {
+        return close_with_error(fd, error, "cannot bind " + path);
+    }
+    if (::listen(fd, SOMAXCONN) != 0) return close_with_error(fd, error, "listen");
+    return fd;
+}
+
+int listen_tcp(std::string host, const std::string& port, std::string& bound_port, std::string& error)
+{
+    if (host.size() >= 2 && host.front() == '[' && host.back() == ']') host = host.substr(1, host.size() - 2);
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE;
+    addrinfo* addresses = nullptr;
+    if (const int result = getaddrinfo(host.empty() ? nullptr : host.c_str(), port.c_str(), &hints, &addresses))
+    {
+        error = "cannot resolve " + host + ": " + gai_strerror(result);
+        return -1;
+    }
+    int fd = -1;
+    for (const addrinfo* candidate = addresses; candidate; candidate = candidate->ai_next)
+    {
+        fd = socket(candidate->ai_family, candidate->ai_socktype, candidate->ai_protocol);
+        if (fd < 0) continue;
+        const int on = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+        if (bind(fd, candidate->ai_addr, candidate->ai_addrlen) == 0 && ::listen(fd, SOMAXCONN) == 0) break;
+        close(fd);
+        fd = -1;
+    }
+    freeaddrinfo(addresses);
+    if (fd < 0) return close_with_error(fd, error, "cannot bind " + host + ":" + port);
+
+    sockaddr_storage bound{};
+    socklen_t length = sizeof(bound);
+    getsockname(fd, reinterpret_cast<sockaddr*>(&bound), &length);
+    const uint16_t number = bound.ss_family == AF_INET6 ? reinterpret_cast<const sockaddr_in6&>(bound).sin6_port
+                                                        : reinterpret_cast<const sockaddr_in&>(bound).sin_port;
+    bound_port = std::to_string(ntohs(number));
+    return fd;
+}
+
+// Fixed-capacity byte ring. Counters run freely and are masked on access,
+// so the capacity must be a power of two.
+class ByteRing
+{
+public:
+    explicit ByteRing(size_t capacity) : data_(std::make_unique<char[]>(capacity)), mask_(capacity - 1) {}
+
+    size_t size() const noexcept { return tail_ - head_; }
+    size_t space() const noexcept { return mask_ + 1 - size(); }
+
+    // The readable bytes (or the free space) as up to two iovecs; returns how many.
+    int readable(iovec (&spans)[2]) const noexcept { return spans_of(head_, size(), spans); }
+    int writable(iovec (&spans)[2]) const noexcept { return spans_of(tail_, space(), spans); }
+
+    void produce(size_t count) noexcept { tail_ += count; }
+    void consume(size_t count) noexcept { head_ += count; }
+    void clear() noexcept { head_ = tail_ = 0; }
+
+    // Offset from the front of the first c within limit bytes, or npos.
+    size_t find(char c, size_t limit) const noexcept
+    {
+        iovec spans[2];
+        const int count = spans_of(head_, std::min(limit, size()), spans);
+        size_t offset = 0;
+        for (int i = 0; i < count; ++i)
+        {
+            const void* found = std::memchr(spans[i].iov_base, c, spans[i].iov_len);
+            if (found) return offset + static_cast<size_t>(static_cast<const char*>(found) -
+                                                           static_cast<const char*>(spans[i].iov_base));
+            offset += spans[i].iov_len;
+        }
+        return std::string_view::npos;
+    }
+
+    // The first length bytes, copied into scratch only if they wrap.
+    std::string_view front(size_t length, char* scratch) const noexcept
+    {
+        iovec spans[2];
+        const int count = spans_of(head_, length, spans);
+        if (count == 1) return {static_cast<const char*>(spans[0].iov_base), length};
+        std::memcpy(scratch, spans[0].iov_base, spans[0].iov_len);
+        std::memcpy(scratch + spans[0].iov_len, spans[1].iov_base, spans[1].iov_len);
+        return {scratch, length};
+    }
+
+    // Appends text, which must fit in space().
+    void append(std::string_view text) noexcept
+    {
+        iovec spans[2];
+        const int count = spans_of(tail_, text.size(), spans);
+        for (int i = 0; i < count; ++i)
+        {
+            std::memcpy(spans[i].iov_base, text.data(), spans[i].iov_len);
+            text.remove_prefix(spans[i].iov_len);
+        }
+        tail_ += spans[0].iov_len + (count > 1 ? spans[1].iov_len : 0);
+    }
+
+private:
+    int spans_of(size_t start, size_t length, iovec (&spans)[2]) const noexcept
+    {
+        const size_t offset = start & mask_;
+        const size_t first = std::min(length, mask_ + 1 - offset);
+        spans[0] = {data_.get() + offset, first};
+        if (first == length) return 1;
+        spans[1] = {data_.get(), length - first};
+        return 2;
+    }
+
+    std::unique_ptr<char[]> data_;
+    size_t mask_;
+    size_t head_ = 0;
+    size_t tail_ = 0;
+};
+
+// Sized so a full request line always fits in the input ring and a
+// response of any length fits in the output one.
+constexpr size_t INPUT_RING_SIZE = 4 * MAX_REQUEST_LINE;
+constexpr size_t OUTPUT_RING_SIZE = 16 * MAX_REQUEST_LINE;
+constexpr size_t MAX_RESPONSE_LINE = MAX_REQUEST_LINE + 256;
+static_assert(OUTPUT_RING_SIZE >= 2 * MAX_RESPONSE_LINE);
+
+// Closed connections each thread keeps, rings included, for reuse by the
+// next accept: up to 1.25 MiB per thread.
+constexpr size_t MAX_IDLE_CONNECTIONS = 16;
+
+// Accepts per wakeup of the (level-triggered) listening socket. A client
+// that reconnects as fast as it is answered would otherwise keep the accept
+// loop busy, starving the hangups that return connections to the idle list.
+constexpr size_t ACCEPTS_PER_WAKE = MAX_IDLE_CONNECTIONS;
+
+struct Connection
+{
+    explicit Connection(int socket) : fd(socket) {}
+    ~Connection()
+    {
+        if (fd >= 0) close(fd);
+    }
+    Connection(const Connection&) = delete;
+    Connection& operator=(const Connection&) = delete;
+
+    // Readies a closed connection for a newly accepted socket.
+    void reopen(int socket) noexcept
+    {
+        fd = socket;
+        input.clear();
+        output.clear();
+        readable = true;
+        writable = true;
+        peer_closed = false;
+        closing = false;
+    }
+
+    int fd;
+    ByteRing input{INPUT_RING_SIZE};
+    ByteRing output{OUTPUT_RING_SIZE};
+    bool readable = true;  // edge-triggered: true until a read hits EAGAIN
+    bool writable = true;  // likewise for writes
+    bool peer_closed = false;
+    bool closing = false;  // answer what is queued, then close
+    size_t index = 0;      // position in its worker's connection list
+};
+
+// Per-thread buffers and cache shared by all of a worker's connections.
+struct Scratch
+{
+    std::array<char, MAX_REQUEST_LINE + 1> line{};
+    std::string response;
+    std::unique_ptr<KeyCache> cache;
+};
+
+void append_stats(std::string& response, const KeyCacheStats& stats)
+{
+    response.append("OK\t");
+    response.append(std::to_string(stats.hits));
+    response.push_back('\t');
+    response.append(std::to_string(stats.misses));
+    response.push_back('\t');
+    response.append(std::to_string(stats.evictions));
+    response.push_back('\n');
+}
+
+// HTTP response to "GET PATH HTTP/1.x": the Prometheus text exposition for
+// /metrics, 404 for anything else or when built without ENIGMA_STATS.
+void append_http_metrics(std::string& response, std::string_view request)
+{
+    const std::string_view path = request.substr(4, request.find(' ', 4) - 4);
+    const bool found = stats::enabled && (path == "/metrics" || path.starts_with("/metrics?"));
+    std::string body;
+    if (found) stats::append_prometheus(body, stats::snapshot());
+    else body = stats::enabled ? "Not found; metrics are at /metrics\n" : "Built without ENIGMA_STATS\n";
+    response.append(found ? "HTTP/1.0 200 OK\r\n" : "HTTP/1.0 404 Not Found\r\n");
+    response.append("Content-Type: text/plain; version=0.0.4\r\nContent-Length: ");
+    response.append(std::to_string(body.size()));
+    response.append("\r\nConnection: close\r\n\r\n");
+    response.append(body);
+}
+
+// Reads until EAGAIN or the input ring is full.
+bool fill(Connection& connection) noexcept
+{
+    bool progress = false;
+    while (connection.readable && !connection.peer_closed && connection.input.space() > 0)
+    {
+        iovec spans[2];
+        const int count = connection.input.writable(spans);
+        const ssize_t received = readv(connection.fd, spans, count);
+        if (received > 0)
+        {
+            connection.input.produce(static_cast<size_t>(received));
+            progress = true;
+        }
+        else if (received == 0)
+        {
+            connection.peer_closed = true;
+        }
+        else if (errno == EAGAIN || errno == EWOULDBLOCK)
+        {
+            connection.readable = false;
+        }
+        else if (errno != EINTR)
+        {
+            connection.peer_closed = true;
+            connection.closing = true;
+        }
+    }
+    return progress;
+}
+
+// Answers complete request lines while the output ring has room for one
+// more response. A scrape is answered whole, so it waits until the responses
+// queued before it have drained.
+bool answer(Connection& connection, Scratch& scratch, const Catalog& catalog, const Server& server)
+{
+    bool progress = false;
+    while (!connection.closing && connection.output.space() >= MAX_RESPONSE_LINE)
+    {
+        const size_t newline = connection.input.find('\n', MAX_REQUEST_LINE + 1);
+        if (newline == std::string_view::npos)
+        {
+            if (connection.input.size() > MAX_REQUEST_LINE)
+            {
+                connection.output.append("ERR\tRequest line too long\n");
+                connection.closing = true;
+            }
+            break;
+        }
+        const std::string_view request = connection.input.front(newline, scratch.line.data());
+        if (request.starts_with("GET ") && connection.output.size() > 0) break;
+        scratch.response.clear();
+        const stats::ScopedTimer timer(stats::Timer::server_request);
+        bool keep_open = true;
+        size_t limit = MAX_RESPONSE_LINE;
+        if (trim_line(request) == "STATS")
+        {
+            append_stats(scratch.response, server.cache_stats());
+        }
+        else if (request.starts_with("GET "))
+        {
+            // A scrape is the connection's only request; the rest of its
+            // headers are ignored.
+            append_http_metrics(scratch.response, trim_line(request));
+            if (scratch.response.size() > connection.output.space())
+            {
+                scratch.response.assign("HTTP/1.0 503 Service Unavailable\r\nContent-Length: 0\r\n"
+                                        "Connection: close\r\n\r\n");
+            }
+            keep_open = false;
+            limit = scratch.response.size();
+        }
+        else
+        {
+            keep_open = handle_request(request, scratch.response, catalog, scratch.cache.get());
+        }
+        stats::count(stats::Counter::server_requests);
+        if (scratch.response.starts_with("ERR")) stats::count(stats::Counter::server_errors);
+        connection.input.consume(newline + 1);
+        connection.output.append(std::string_view(scratch.response).substr(0, limit));
+        if (!keep_open) connection.closing = true;
+        progress = true;
+    }
+    return progress;
+}
+
+// Writes queued responses, both ring segments in one call, until EAGAIN.
+bool drain(Connection& connection) noexcept
+{
+    bool progress = false;
+    while (connection.writable && connection.output.size() > 0)
+    {
+        iovec spans[2];
+        msghdr message{};
+        message.msg_iov = spans;
+        message.msg_iovlen = static_cast<decltype(message.msg_iovlen)>(connection.output.readable(spans));
+        const ssize_t written = sendmsg(connection.fd, &message, SEND_FLAGS);
+        if (written > 0)
+        {
+            connection.output.consume(static_cast<size_t>(written));
+            progress = true;
+        }
+        else if (written < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        {
+            connection.writable = false;
+        }
+        else if (written < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        else
+        {
+            connection.closing = true;
+            connection.output.consume(connection.output.size());
+        }
+    }
+    return progress;
+}
+
+// Runs a connection until it would block. Returns false once it is done
+// and should be closed.
+bool service(Connection& connection, Scratch& scratch, const Catalog& catalog, const Server& server)
+{
+    while (fill(connection) | answer(connection, scratch, catalog, server) | drain(connection))
+    {
+    }
+    if (connection.peer_closed && connection.input.find('\n', connection.input.size()) == std::string_view::npos)
+    {
+        connection.closing = true;
+    }
+    return !(connection.closing && connection.output.size() == 0);
+}
+} // namespace
+
+bool handle_request(std::string_view request, std::string& response, const Catalog& catalog, KeyCache* cache)
+{
+    request = trim_line(request);
+    const size_t space = request.find_first_of(" \t");
+    const std::string_view verb = request.substr(0, space);
+    const std::string_view payload = space == std::string_view::npos ? std::string_view() : trim_line(
+        request.substr(space + 1));
+
+    if (verb == "GEN")
+    {
+        KeyBuffer key{};
+        size_t key_length = 0;
+        const Status status = generate_record_key(payload, key, key_length, cache);
+        if (status != Status::ok)
+        {
+            append_error(response, status_message(status));
+            return true;
+        }
+        response.append("OK\t");
+        response.append(key.data(), key_length);
+        response.push_back('\n');
+    }
+    else if (verb == "VERIFY")
+    {
+        response.append("OK\t");
+        append_verify_result(response, verify_record_key(payload), VerifyFormat::tsv);
+    }
+    else if (verb == "DECODE")
+    {
+        append_decoded(response, payload, catalog, cache);
+    }
+    else if (verb == "PING")
+    {
+        response.append("OK\tPONG\n");
+    }
+    else if (verb == "QUIT")
+    {
+        response.append("OK\tBYE\n");
+        return false;
+    }
+    else
+    {
+        append_error(response, "Unknown command; expected GEN, VERIFY, DECODE, PING, STATS or QUIT");
+    }
+    return true;
+}
+
+struct Server::Worker
+{
+    Worker() { idle.reserve(MAX_IDLE_CONNECTIONS); }
+
+    Scratch scratch;
+    std::atomic<const KeyCache*> cache{nullptr}; // scratch.cache once built, for cache_stats()
+    std::vector<std::unique_ptr<Connection>> connections;
+    std::vector<std::unique_ptr<Connection>> idle; // closed, kept for acquire()
+#ifdef ENIGMA_SERVER_EPOLL
+    int epoll_fd = -1;
+
+    ~Worker() { reset(); }
+#endif
+
+    // Runs on the worker's own thread before it serves, so that its buffers
+    // are allocated and first written there (on its NUMA node when pinned).
+    void prepare(size_t cache_entries)
+    {
+        scratch.response.reserve(MAX_RESPONSE_LINE);
+        if (cache_entries == 0 || scratch.cache) return;
+        scratch.cache = std::make_unique<KeyCache>(cache_entries);
+        cache.store(scratch.cache.get(), std::memory_order_release);
+    }
+
+    // A connection for an accepted socket, reusing an idle one (and its
+    // rings) when there is one, so steady-state serving allocates nothing
+    // per connection either.
+    std::unique_ptr<Connection> acquire(int fd)
+    {
+        if (idle.empty()) return std::make_unique<Connection>(fd);
+        std::unique_ptr<Connection> connection = std::move(idle.back());
+        idle.pop_back();
+        connection->reopen(fd);
+        return connection;
+    }
+
+    // Closes the socket and keeps the connection for reuse if there is room.
+    void release(std::unique_ptr<Connection> connection) noexcept
+    {
+        if (connection->fd >= 0) close(connection->fd);
+        connection->fd = -1;
+        if (idle.size() < MAX_IDLE_CONNECTIONS) idle.push_back(std::move(connection));
+    }
+
+    // Closes every connection; the cache survives for the next run().
+    void reset()
+    {
+        connections.clear();
+#ifdef ENIGMA_SERVER_EPOLL
+        if (epoll_fd >= 0) close(epoll_fd);
+        epoll_fd = -1;
+#endif
+    }
+
+    void add(std::unique_ptr<Connection> connection)
+    {
+        connection->index = connections.size();
+        connections.push_back(std::move(connection));
+    }
+
+    void remove(Connection& connection)
+    {
+        const size_t index = connection.index;
+        std::unique_ptr<Connection> removed = std::move(connections[index]);
+        if (index + 1 < connections.size())
+        {
+            connections[index] = std::move(connections.back());
+            connections[index]->index = index;
+        }
+        connections.pop_back();
+        release(std::move(removed));
+    }
+};
+
+Server::Server(const ServerOptions& options) : options_(options)
+{
+    unsigned threads = options.threads;
+#ifdef ENIGMA_SERVER_EPOLL
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+#else
+    threads = 1;
+#endif
+    for (unsigned i = 0; i < threads; ++i) workers_.push_back(std::make_unique<Worker>());
+}
+
+std::unique_ptr<Server> Server::listen(const ServerOptions& options, std::string& error)
+{
+    std::unique_ptr<Server> server(new Server(options));
+    const std::string_view address = options.address;
+    if (address.substr(0, 5) == "unix:")
+    {
+        server->unix_path_ = std::string(address.substr(5));
+        server->listen_fd_ = listen_unix(server->unix_path_, error);
+        if (server->listen_fd_ < 0) server->unix_path_.clear();
+        server->address_ = options.address;
+    }
+    else if (address.substr(0, 4) == "tcp:" && address.rfind(':') > 3)
+    {
+        const size_t colon = address.rfind(':');
+        const std::string host(address.substr(4, colon - 4));
+        std::string port;
+        server->listen_fd_ = listen_tcp(host, std::string(address.substr(colon + 1)), port, error);
+        server->address_ = "tcp:" + host + ":" + port;
+    }
+    else
+    {
+        error = "address must be unix:PATH or tcp:HOST:PORT";
+        return nullptr;
+    }
+    if (server->listen_fd_ < 0) return nullptr;
+    if (!set_nonblocking(server->listen_fd_) || pipe(server->wake_fds_) != 0 ||
+        !set_nonblocking(server->wake_fds_[0]) || !set_nonblocking(server->wake_fds_[1]))
+    {
+        error = std::string("cannot set up the listening socket: ") + std::strerror(errno);
+        return nullptr;
+    }
+    return server;
+}
+
+Server::~Server()
+{
+    if (listen_fd_ >= 0) close(listen_fd_);
+    for (const int fd : wake_fds_)
+    {
+        if (fd >= 0) close(fd);
+    }
+    if (!unix_path_.empty()) unlink(unix_path_.c_str());
+}
+
+void Server::stop() noexcept
+{
+    const char byte = 1;
+    [[maybe_unused]] const ssize_t written = write(wake_fds_[1], &byte, 1);
+}
+
+KeyCacheStats Server::cache_stats() const noexcept
+{
+    KeyCacheStats total;
+    for (const auto& worker : workers_)
+    {
+        const KeyCache* cache = worker->cache.load(std::memory_order_acquire);
+        if (!cache) continue;
+        const KeyCacheStats stats = cache->stats();
+        total.hits += stats.hits;
+        total.misses += stats.misses;
+        total.evictions += stats.evictions;
+    }
+    return total;
+}
+
+
+void Server::run()
+{
+    const std::vector<unsigned> cpus = options_.affinity ? affinity_cpus() : std::vector<unsigned>{};
+    std::optional<ScopedPin> pin;
+    if (!cpus.empty()) pin.emplace(cpus[0]);
+    const auto start = [&](size_t i)
+    {
+        if (!cpus.empty() && i > 0) pin_current_thread(cpus[i % cpus.size()]);
+        workers_[i]->prepare(options_.cache_entries);
+        serve(*workers_[i]);
+    };
+    std::vector<std::thread> pool;
+    for (size_t i = 1; i < workers_.size(); ++i) pool.emplace_back([&start, i] { start(i); });
+    start(0);
+    for (auto& thread : pool) thread.join();
+    for (auto& worker : workers_) worker->reset();
+
+    char drain_buffer[64];
+    while (read(wake_fds_[0], drain_buffer, sizeof(drain_buffer)) > 0)
+    {
+    }
+}
+
+#ifdef ENIGMA_SERVER_EPOLL
+// Every worker waits on the listening socket (EPOLLEXCLUSIVE wakes one of
+// them per connection) and on the wake pipe, which is left full so that all
+// of them see it. Accepted connections stay on the accepting worker and are
+// registered edge-triggered.
+void Server::serve(Worker& worker)
+{
+    worker.epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (worker.epoll_fd < 0) return;
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.ptr = nullptr;
+    epoll_ctl(worker.epoll_fd, EPOLL_CTL_ADD, wake_fds_[0], &event);
+    event.events = EPOLLIN | EPOLLEXCLUSIVE;
+    event.data.ptr = &worker;
+    epoll_ctl(worker.epoll_fd, EPOLL_CTL_ADD, listen_fd_, &event);
+
+    std::array<epoll_event, 256> events;
+    while (true)
+    {
+        const int ready = epoll_wait(worker.epoll_fd, events.data(), static_cast<int>(events.size()), -1);
+        if (ready < 0 && errno != EINTR) return;
+        for (int i = 0; i < ready; ++i)
+        {
+            void* const source = events[i].data.ptr;
+            if (source == nullptr) return;
+            if (source == &worker)
+            {
+                int fd;
+                for (size_t accepted = 0;
+                     accepted < ACCEPTS_PER_WAKE && (fd = accept(listen_fd_, nullptr, nullptr)) >= 0; ++accepted)
+                {
+                    auto connection = worker.acquire(fd);
+                    const int on = 1;
+                    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on)); // fails harmlessly on Unix sockets
+                    epoll_event registration{};
+                    registration.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+                    registration.data.ptr = connection.get();
+                    // The first edge may have fired before registration.
+                    if (!set_nonblocking(fd) || epoll_ctl(worker.epoll_fd, EPOLL_CTL_ADD, fd, &registration) != 0 ||
+                        !service(*connection, worker.scratch, *options_.catalog, *this))
+                    {
+                        worker.release(std::move(connection));
+                        continue;
+                    }
+                    worker.add(std::move(connection));
+                }
+                continue;
+            }
+            Connection& connection = *static_cast<Connection*>(source);
+            if (events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) connection.readable = true;
+            if (events[i].events & (EPOLLOUT | EPOLLHUP | EPOLLERR)) connection.writable = true;
+            if (!service(connection, worker.scratch, *options_.catalog, *this)) worker.remove(connection);
+        }
+    }
+}
+#else
+void Server::serve(Worker& worker)
+{
+    std::vector<pollfd> fds;
+    while (true)
+    {
+        fds.clear();
+        fds.push_back({wake_fds_[0], POLLIN, 0});
+        fds.push_back({listen_fd_, POLLIN, 0});
+        for (const auto& connection : worker.connections)
+        {
+            short events = 0;
+            if (!connection->closing && !connection->peer_closed && connection->input.space() > 0) events |= POLLIN;
+            if (connection->output.size() > 0) events |= POLLOUT;
+            fds.push_back({connection->fd, events, 0});
+        }
+        if (poll(fds.data(), fds.size(), -1) < 0)
+        {
+            if (errno == EINTR) continue;
+            return;
+        }
+        if (fds[0].revents) return;
+
+        // Walk backwards so remove() only moves connections already visited.
+        for (size_t i = worker.connections.size(); i-- > 0;)
+        {
+            Connection& connection = *worker.connections[i];
+            const short revents = fds[i + 2].revents;
+            if (revents == 0) continue;
+            connection.readable = (revents & (POLLIN | POLLHUP | POLLERR)) != 0;
+            connection.writable = (revents & (POLLOUT | POLLHUP | POLLERR)) != 0;
+            if (!service(connection, worker.scratch, *options_.catalog, *this)) worker.remove(connection);
+        }
+        if (fds[1].revents & POLLIN)
+        {
+            int fd;
+            while ((fd = accept(listen_fd_, nullptr, nullptr)) >= 0)
+            {
+                auto connection = worker.acquire(fd);
+                if (!set_nonblocking(fd))
+                {
+                    worker.release(std::move(connection));
+                    continue;
+                }
+                const int on = 1;
+                setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on)); // fails harmlessly on Unix sockets
+                worker.add(std::move(connection));
+            }
+        }
+    }
+}
+#endif
+} // namespace enigma
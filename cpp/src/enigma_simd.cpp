@@ -0,0 +1,231 @@
+// File: enigma_simd.cpp
+// Author: Kris Armstrong
+// Version: 3.0.0
+// Last Modified: 2026-10-14
+// Description: Scalar struct-of-arrays kernels and runtime selection of the vector kernels.
+// License: MIT
+
+#include "enigma_simd.h"
+#include "enigma_simd_kernels.h"
+#include "enigma_stats.h"
+#include "enigma_tables.h"
+
+#include <array>
+#include <string_view>
+
+namespace enigma
+{
+namespace detail
+{
+void enigma_c_encrypt_scalar(const uint8_t* input, uint8_t* output, size_t positions, size_t keys,
+                             size_t first) noexcept
+{
+    for (size_t key = first; key < keys; ++key)
+    {
+        uint8_t value = 0;
+        for (size_t position = 0; position < positions; ++position)
+        {
+            const size_t at = position * keys + key;
+            value ^= ENIGMA_C_ROTOR[(input[at] + position) & 0x0F];
+            output[at] = value;
+        }
+    }
+}
+
+void enigma_c_decrypt_scalar(const uint8_t* input, uint8_t* output, size_t positions, size_t keys,
+                             size_t first) noexcept
+{
+    for (size_t key = first; key < keys; ++key)
+    {
+        uint8_t previous = 0;
+        for (size_t position = 0; position < positions; ++position)
+        {
+            const size_t at = position * keys + key;
+            const uint8_t value = input[at] & 0x0F;
+            output[at] = static_cast<uint8_t>((ENIGMA_C_ROTOR_INVERSE[value ^ previous] - position) & 0x0F);
+            previous = value;
+        }
+    }
+}
+
+// The scalar Enigma2C kernels transpose each key and run the single-key
+// function, so the vector kernels are always compared against the real thing.
+void enigma2_c_encrypt_scalar(const char* input, char* output, size_t keys, size_t first) noexcept
+{
+    std::array<char, KEY_LENGTH> plain{};
+    std::array<char, KEY_LENGTH> key{};
+    for (size_t k = first; k < keys; ++k)
+    {
+        for (size_t position = 0; position < KEY_LENGTH; ++position) plain[position] = input[position * keys + k];
+        (void)enigma2_c_encrypt(std::string_view(plain.data(), plain.size()), key);
+        for (size_t position = 0; position < KEY_LENGTH; ++position) output[position * keys + k] = key[position];
+    }
+}
+
+void enigma2_c_decrypt_scalar(const char* input, char* output, uint8_t* checksum_ok, size_t keys,
+                              size_t first) noexcept
+{
+    std::array<char, KEY_LENGTH> key{};
+    std::array<char, KEY_LENGTH> plain{};
+    for (size_t k = first; k < keys; ++k)
+    {
+        for (size_t position = 0; position < KEY_LENGTH; ++position) key[position] = input[position * keys + k];
+        const Status status = enigma2_c_decrypt(std::string_view(key.data(), key.size()), plain);
+        checksum_ok[k] = status == Status::ok ? 1 : 0;
+        for (size_t position = 0; position < KEY_LENGTH; ++position) output[position * keys + k] = plain[position];
+    }
+}
+} // namespace detail
+
+namespace
+{
+SimdLevel detect_simd_level() noexcept
+{
+#if defined(ENIGMA_SIMD_X86) && (defined(__GNUC__) || defined(__clang__))
+    if (__builtin_cpu_supports("avx512bw")) return SimdLevel::avx512;
+    if (__builtin_cpu_supports("avx2")) return SimdLevel::avx2;
+    if (__builtin_cpu_supports("ssse3")) return SimdLevel::ssse3;
+#elif defined(ENIGMA_SIMD_NEON)
+    return SimdLevel::neon; // Advanced SIMD is mandatory on AArch64
+#endif
+    return SimdLevel::scalar;
+}
+} // namespace
+
+const char* simd_level_name(SimdLevel level) noexcept
+{
+    switch (level)
+    {
+    case SimdLevel::scalar: return "scalar";
+    case SimdLevel::ssse3: return "ssse3";
+    case SimdLevel::avx2: return "avx2";
+    case SimdLevel::avx512: return "avx512";
+    case SimdLevel::neon: return "neon";
+    }
+    return "unknown";
+}
+
+bool simd_level_supported(SimdLevel level) noexcept
+{
+    switch (level)
+    {
+    case SimdLevel::scalar:
+        return true;
+    case SimdLevel::ssse3:
+    case SimdLevel::avx2:
+    case SimdLevel::avx512:
+        // Each x86 level implies the ones below it.
+        return simd_level() != SimdLevel::neon && simd_level() >= level;
+    case SimdLevel::neon:
+        return simd_level() == level;
+    }
+    return false;
+}
+
+SimdLevel simd_level() noexcept
+{
+    static const SimdLevel level = detect_simd_level();
+    return level;
+}
+
+void enigma_c_encrypt_soa(const uint8_t* input, uint8_t* output, size_t positions, size_t keys) noexcept
+{
+    const stats::ScopedTimer timer(stats::Timer::encrypt_block);
+    stats::count(stats::Counter::keys_encrypted, keys);
+    enigma_c_encrypt_soa(simd_level(), input, output, positions, keys);
+}
+
+void enigma_c_decrypt_soa(const uint8_t* input, uint8_t* output, size_t positions, size_t keys) noexcept
+{
+    const stats::ScopedTimer timer(stats::Timer::decrypt_block);
+    stats::count(stats::Counter::keys_decrypted, keys);
+    enigma_c_decrypt_soa(simd_level(), input, output, positions, keys);
+}
+
+void enigma_c_encrypt_soa(SimdLevel level, const uint8_t* input, uint8_t* output, size_t positions,
+                          size_t keys) noexcept
+{
+    size_t done = 0;
+    switch (level)
+    {
+#ifdef ENIGMA_SIMD_X86
+    case SimdLevel::ssse3: done = detail::enigma_c_encrypt_ssse3(input, output, positions, keys); break;
+    case SimdLevel::avx2: done = detail::enigma_c_encrypt_avx2(input, output, positions, keys); break;
+    case SimdLevel::avx512: done = detail::enigma_c_encrypt_avx512(input, output, positions, keys); break;
+#endif
+#ifdef ENIGMA_SIMD_NEON
+    case SimdLevel::neon: done = detail::enigma_c_encrypt_neon(input, output, positions, keys); break;
+#endif
+    default: break;
+    }
+    detail::enigma_c_encrypt_scalar(input, output, positions, keys, done);
+}
+
+void enigma_c_decrypt_soa(SimdLevel level, const uint8_t* input, uint8_t* output, size_t positions,
+                          size_t keys) noexcept
+{
+    size_t done = 0;
+    switch (level)
+    {
+#ifdef ENIGMA_SIMD_X86
+    case SimdLevel::ssse3: done = detail::enigma_c_decrypt_ssse3(input, output, positions, keys); break;
+    case SimdLevel::avx2: done = detail::enigma_c_decrypt_avx2(input, output, positions, keys); break;
+    case SimdLevel::avx512: done = detail::enigma_c_decrypt_avx512(input, output, positions, keys); break;
+#endif
+#ifdef ENIGMA_SIMD_NEON
+    case SimdLevel::neon: done = detail::enigma_c_decrypt_neon(input, output, positions, keys); break;
+#endif
+    default: break;
+    }
+    detail::enigma_c_decrypt_scalar(input, output, positions, keys, done);
+}
+
+void enigma2_c_encrypt_soa(const char* input, char* output, size_t keys) noexcept
+{
+    const stats::ScopedTimer timer(stats::Timer::encrypt_block);
+    stats::count(stats::Counter::keys_encrypted, keys);
+    enigma2_c_encrypt_soa(simd_level(), input, output, keys);
+}
+
+void enigma2_c_decrypt_soa(const char* input, char* output, uint8_t* checksum_ok, size_t keys) noexcept
+{
+    const stats::ScopedTimer timer(stats::Timer::decrypt_block);
+    stats::count(stats::Counter::keys_decrypted, keys);
+    enigma2_c_decrypt_soa(simd_level(), input, output, checksum_ok, keys);
+}
+
+void enigma2_c_encrypt_soa(SimdLevel level, const char* input, char* output, size_t keys) noexcept
+{
+    size_t done = 0;
+    switch (level)
+    {
+#ifdef ENIGMA_SIMD_X86
+    case SimdLevel::avx2: done = detail::enigma2_c_encrypt_avx2(input, output, keys); break;
+    case SimdLevel::avx512: done = detail::enigma2_c_encrypt_avx512(input, output, keys); break;
+#endif
+#ifdef ENIGMA_SIMD_NEON
+    case SimdLevel::neon: done = detail::enigma2_c_encrypt_neon(input, output, keys); break;
+#endif
+    default: break;
+    }
+    detail::enigma2_c_encrypt_scalar(input, output, keys, done);
+}
+
+void enigma2_c_decrypt_soa(SimdLevel level, const char* input, char* output, uint8_t* checksum_ok,
+                           size_t keys) noexcept
+{
+    size_t done = 0;
+    switch (level)
+    {
+#ifdef ENIGMA_SIMD_X86
+    case SimdLevel::avx2: done = detail::enigma2_c_decrypt_avx2(input, output, checksum_ok, keys); break;
+    case SimdLevel::avx512: done = detail::enigma2_c_decrypt_avx512(input, output, checksum_ok, keys); break;
+#endif
+#ifdef ENIGMA_SIMD_NEON
+    case SimdLevel::neon: done = detail::enigma2_c_decrypt_neon(input, output, checksum_ok, keys); break;
+#endif
+    default: break;
+    }
+    detail::enigma2_c_decrypt_scalar(input, output, checksum_ok, keys, done);
+}
+} // namespace enigma
@@ -0,0 +1,215 @@
+// File: enigma_simd_avx2.cpp
+// Author: Kris Armstrong
+// Version: 3.0.0
+// Last Modified: 2026-10-14
+// Description: AVX2 struct-of-arrays EnigmaC and Enigma2C kernels, 32 keys per vector. Built with -mavx2.
+// License: MIT
+
+#include "enigma_simd_kernels.h"
+#include "enigma_tables.h"
+
+#include <immintrin.h>
+
+namespace enigma
+{
+namespace detail
+{
+namespace
+{
+constexpr size_t LANES = 32;
+
+// vpshufb looks up within each 128-bit half, so both halves get the table.
+__m256i load_table(const std::array<uint8_t, 16>& table) noexcept
+{
+    return _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(table.data())));
+}
+
+__m256i broadcast16(const uint8_t* table) noexcept
+{
+    return _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(table)));
+}
+
+__m256i set(uint8_t value) noexcept
+{
+    return _mm256_set1_epi8(static_cast<char>(value));
+}
+
+// x mod m for x < 2 * m, without a branch or a division: when x < m,
+// x - m wraps around to something larger than x and min keeps x.
+__m256i reduce(__m256i x, uint8_t m) noexcept
+{
+    return _mm256_min_epu8(x, _mm256_sub_epi8(x, set(m)));
+}
+
+// table[index] for index 0-15. Larger indices give unspecified values.
+__m256i lookup16(const std::array<uint8_t, 32>& table, __m256i index) noexcept
+{
+    return _mm256_shuffle_epi8(broadcast16(table.data()), index);
+}
+
+// table[index] for index 0-31. vpshufb zeroes a byte whose index has bit 7
+// set, so each half of the table only answers for its own indices.
+__m256i lookup32(const std::array<uint8_t, 32>& table, __m256i index) noexcept
+{
+    const __m256i high = _mm256_cmpgt_epi8(index, set(15));
+    const __m256i low_index = _mm256_or_si256(index, _mm256_and_si256(high, set(0x80)));
+    return _mm256_or_si256(_mm256_shuffle_epi8(broadcast16(table.data()), low_index),
+                           _mm256_shuffle_epi8(broadcast16(table.data() + 16), _mm256_sub_epi8(index, set(16))));
+}
+
+__m256i load(const char* input) noexcept
+{
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(input));
+}
+
+void store(char* output, __m256i value) noexcept
+{
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(output), value);
+}
+
+// All ones in lanes holding '0'-'9'; the rest hold 'A'-'Z'.
+__m256i digit_mask(__m256i c) noexcept
+{
+    return _mm256_cmpgt_epi8(set('A'), c);
+}
+
+// Character value: c - '0' for digits, c - 'A' for letters.
+__m256i char_value(__m256i c, __m256i digit) noexcept
+{
+    return _mm256_sub_epi8(c, _mm256_blendv_epi8(set('A'), set('0'), digit));
+}
+} // namespace
+
+size_t enigma_c_encrypt_avx2(const uint8_t* input, uint8_t* output, size_t positions, size_t keys) noexcept
+{
+    const __m256i rotor = load_table(ENIGMA_C_ROTOR);
+    const __m256i nibble = _mm256_set1_epi8(0x0F);
+    const size_t vector_keys = keys / LANES * LANES;
+    for (size_t key = 0; key < vector_keys; key += LANES)
+    {
+        __m256i value = _mm256_setzero_si256();
+        for (size_t position = 0; position < positions; ++position)
+        {
+            const size_t at = position * keys + key;
+            const __m256i digit = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(input + at));
+            // (digit + position) % 16, then ROTOR[...] for all 32 lanes at once.
+            const __m256i index = _mm256_and_si256(
+                _mm256_add_epi8(digit, _mm256_set1_epi8(static_cast<char>(position))), nibble);
+            value = _mm256_xor_si256(value, _mm256_shuffle_epi8(rotor, index));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(output + at), value);
+        }
+    }
+    return vector_keys;
+}
+
+size_t enigma_c_decrypt_avx2(const uint8_t* input, uint8_t* output, size_t positions, size_t keys) noexcept
+{
+    const __m256i inverse = load_table(ENIGMA_C_ROTOR_INVERSE);
+    const __m256i nibble = _mm256_set1_epi8(0x0F);
+    const size_t vector_keys = keys / LANES * LANES;
+    for (size_t key = 0; key < vector_keys; key += LANES)
+    {
+        __m256i previous = _mm256_setzero_si256();
+        for (size_t position = 0; position < positions; ++position)
+        {
+            const size_t at = position * keys + key;
+            const __m256i value = _mm256_and_si256(
+                _mm256_loadu_si256(reinterpret_cast<const __m256i*>(input + at)), nibble);
+            const __m256i plain = _mm256_shuffle_epi8(inverse, _mm256_xor_si256(value, previous));
+            const __m256i digit = _mm256_and_si256(
+                _mm256_sub_epi8(plain, _mm256_set1_epi8(static_cast<char>(position))), nibble);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(output + at), digit);
+            previous = value;
+        }
+    }
+    return vector_keys;
+}
+
+size_t enigma2_c_encrypt_avx2(const char* input, char* output, size_t keys) noexcept
+{
+    const size_t vector_keys = keys / LANES * LANES;
+    for (size_t key = 0; key < vector_keys; key += LANES)
+    {
+        // Checksum over positions 2-15, kept mod 100.
+        __m256i checksum = set(1);
+        for (size_t i = 2; i < KEY_LENGTH; ++i)
+        {
+            const __m256i c = load(input + i * keys + key);
+            const __m256i t = char_value(c, digit_mask(c));
+            checksum = reduce(_mm256_add_epi8(checksum, lookup32(CHECKSUM_STEP_100[i], t)), 100);
+        }
+        // 100 - checksum is 1-100; its last two decimal digits go in positions 0 and 1.
+        __m256i ones = _mm256_sub_epi8(set(100), checksum);
+        __m256i tens = _mm256_setzero_si256();
+        for (int n = 0; n < 10; ++n)
+        {
+            const __m256i carry = _mm256_cmpgt_epi8(ones, set(9));
+            ones = _mm256_sub_epi8(ones, _mm256_and_si256(carry, set(10)));
+            tens = _mm256_sub_epi8(tens, carry);
+        }
+        tens = reduce(tens, 10);
+
+        __m256i running_10 = _mm256_setzero_si256();
+        __m256i running_26 = _mm256_setzero_si256();
+        for (size_t i = 0; i < KEY_LENGTH; ++i)
+        {
+            __m256i digit = _mm256_set1_epi8(-1);
+            __m256i t = i == 0 ? ones : tens;
+            if (i >= 2)
+            {
+                const __m256i c = load(input + i * keys + key);
+                digit = digit_mask(c);
+                t = char_value(c, digit);
+            }
+            // (t + MAX_CHECK_SUM - running) % m; MAX_CHECK_SUM is a multiple of both moduli.
+            const __m256i index_10 = reduce(_mm256_add_epi8(_mm256_sub_epi8(t, running_10), set(10)), 10);
+            const __m256i index_26 = reduce(_mm256_add_epi8(_mm256_sub_epi8(t, running_26), set(26)), 26);
+            const __m256i as_digit = _mm256_add_epi8(lookup16(ENIGMA2_E_ROTOR_10_PADDED, index_10), set('0'));
+            const __m256i as_letter = _mm256_add_epi8(lookup32(ENIGMA2_E_ROTOR_26_PADDED, index_26), set('A'));
+            store(output + i * keys + key, _mm256_blendv_epi8(as_letter, as_digit, digit));
+            running_10 = reduce(_mm256_add_epi8(running_10, lookup32(CHECKSUM_STEP_10[i], t)), 10);
+            running_26 = reduce(_mm256_add_epi8(running_26, lookup32(CHECKSUM_STEP_26[i], t)), 26);
+        }
+    }
+    return vector_keys;
+}
+
+size_t enigma2_c_decrypt_avx2(const char* input, char* output, uint8_t* checksum_ok, size_t keys) noexcept
+{
+    const size_t vector_keys = keys / LANES * LANES;
+    for (size_t key = 0; key < vector_keys; key += LANES)
+    {
+        __m256i checksum_10 = _mm256_setzero_si256();
+        __m256i checksum_26 = _mm256_setzero_si256();
+        __m256i checksum_100 = _mm256_setzero_si256();
+        __m256i second = _mm256_setzero_si256();
+        for (size_t i = 0; i < KEY_LENGTH; ++i)
+        {
+            const __m256i c = load(input + i * keys + key);
+            const __m256i digit = digit_mask(c);
+            const __m256i t_10 = reduce(
+                _mm256_add_epi8(lookup16(ENIGMA2_D_ROTOR_10_PADDED, _mm256_sub_epi8(c, set('0'))), checksum_10), 10);
+            const __m256i t_26 = reduce(
+                _mm256_add_epi8(lookup32(ENIGMA2_D_ROTOR_26_PADDED, _mm256_sub_epi8(c, set('A'))), checksum_26), 26);
+            const __m256i t = _mm256_blendv_epi8(t_26, t_10, digit);
+            const __m256i plain = _mm256_add_epi8(t, _mm256_blendv_epi8(set('A'), set('0'), digit));
+            store(output + i * keys + key, plain);
+            if (i == 1) second = plain;
+            checksum_10 = reduce(_mm256_add_epi8(checksum_10, lookup32(CHECKSUM_STEP_10[i], t)), 10);
+            checksum_26 = reduce(_mm256_add_epi8(checksum_26, lookup32(CHECKSUM_STEP_26[i], t)), 26);
+            checksum_100 = reduce(_mm256_add_epi8(checksum_100, lookup32(CHECKSUM_STEP_100[i], t)), 100);
+        }
+        // checksum += 8 * (plain[1] - '0'), with plain[1] - '0' up to 42, so
+        // 8 * v mod 100 is computed as 4 * (2 * v mod 25) to stay in a byte.
+        const __m256i value = _mm256_sub_epi8(second, set('0'));
+        __m256i twice = _mm256_add_epi8(value, value);
+        for (int n = 0; n < 3; ++n) twice = reduce(twice, 25);
+        const __m256i eight_times = _mm256_slli_epi16(twice, 2); // twice < 25, so no bits cross bytes
+        const __m256i total = reduce(_mm256_add_epi8(checksum_100, eight_times), 100);
+        const __m256i ok = _mm256_and_si256(_mm256_cmpeq_epi8(total, _mm256_setzero_si256()), set(1));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(checksum_ok + key), ok);
+    }
+    return vector_keys;
+}
+} // namespace detail
+} // namespace enigma
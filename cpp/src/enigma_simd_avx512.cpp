@@ -0,0 +1,206 @@
+// File: enigma_simd_avx512.cpp
+// Author: Kris Armstrong
+// Version: 3.0.0
+// Last Modified: 2026-10-14
+// Description: AVX-512BW struct-of-arrays EnigmaC and Enigma2C kernels, 64 keys per vector. Built with -mavx512bw.
+// License: MIT
+
+#include "enigma_simd_kernels.h"
+#include "enigma_tables.h"
+
+#include <immintrin.h>
+
+namespace enigma
+{
+namespace detail
+{
+namespace
+{
+constexpr size_t LANES = 64;
+
+// vpshufb looks up within each 128-bit quarter, so every quarter gets the table.
+__m512i broadcast16(const uint8_t* table) noexcept
+{
+    return _mm512_broadcast_i32x4(_mm_loadu_si128(reinterpret_cast<const __m128i*>(table)));
+}
+
+__m512i set(uint8_t value) noexcept
+{
+    return _mm512_set1_epi8(static_cast<char>(value));
+}
+
+// x mod m for x < 2 * m, without a branch or a division: when x < m,
+// x - m wraps around to something larger than x and min keeps x.
+__m512i reduce(__m512i x, uint8_t m) noexcept
+{
+    return _mm512_min_epu8(x, _mm512_sub_epi8(x, set(m)));
+}
+
+// table[index] for index 0-15. Larger indices give unspecified values.
+__m512i lookup16(const std::array<uint8_t, 32>& table, __m512i index) noexcept
+{
+    return _mm512_shuffle_epi8(broadcast16(table.data()), index);
+}
+
+// table[index] for index 0-31: each half of the table answers for its own
+// indices and a mask picks between them.
+__m512i lookup32(const std::array<uint8_t, 32>& table, __m512i index) noexcept
+{
+    const __mmask64 high = _mm512_cmpgt_epu8_mask(index, set(15));
+    return _mm512_mask_blend_epi8(high, _mm512_shuffle_epi8(broadcast16(table.data()), index),
+                                  _mm512_shuffle_epi8(broadcast16(table.data() + 16), index));
+}
+
+__m512i load(const void* input) noexcept
+{
+    return _mm512_loadu_si512(input);
+}
+
+void store(void* output, __m512i value) noexcept
+{
+    _mm512_storeu_si512(output, value);
+}
+
+// Set for lanes holding '0'-'9'; the rest hold 'A'-'Z'.
+__mmask64 digit_mask(__m512i c) noexcept
+{
+    return _mm512_cmplt_epu8_mask(c, set('A'));
+}
+
+// Character value: c - '0' for digits, c - 'A' for letters.
+__m512i char_value(__m512i c, __mmask64 digit) noexcept
+{
+    return _mm512_sub_epi8(c, _mm512_mask_blend_epi8(digit, set('A'), set('0')));
+}
+} // namespace
+
+size_t enigma_c_encrypt_avx512(const uint8_t* input, uint8_t* output, size_t positions, size_t keys) noexcept
+{
+    const __m512i rotor = broadcast16(ENIGMA_C_ROTOR.data());
+    const __m512i nibble = set(0x0F);
+    const size_t vector_keys = keys / LANES * LANES;
+    for (size_t key = 0; key < vector_keys; key += LANES)
+    {
+        __m512i value = _mm512_setzero_si512();
+        for (size_t position = 0; position < positions; ++position)
+        {
+            const size_t at = position * keys + key;
+            // (digit + position) % 16, then ROTOR[...] for all 64 lanes at once.
+            const __m512i index = _mm512_and_si512(
+                _mm512_add_epi8(load(input + at), set(static_cast<uint8_t>(position))), nibble);
+            value = _mm512_xor_si512(value, _mm512_shuffle_epi8(rotor, index));
+            store(output + at, value);
+        }
+    }
+    return vector_keys;
+}
+
+size_t enigma_c_decrypt_avx512(const uint8_t* input, uint8_t* output, size_t positions, size_t keys) noexcept
+{
+    const __m512i inverse = broadcast16(ENIGMA_C_ROTOR_INVERSE.data());
+    const __m512i nibble = set(0x0F);
+    const size_t vector_keys = keys / LANES * LANES;
+    for (size_t key = 0; key < vector_keys; key += LANES)
+    {
+        __m512i previous = _mm512_setzero_si512();
+        for (size_t position = 0; position < positions; ++position)
+        {
+            const size_t at = position * keys + key;
+            const __m512i value = _mm512_and_si512(load(input + at), nibble);
+            const __m512i plain = _mm512_shuffle_epi8(inverse, _mm512_xor_si512(value, previous));
+            store(output + at,
+                  _mm512_and_si512(_mm512_sub_epi8(plain, set(static_cast<uint8_t>(position))), nibble));
+            previous = value;
+        }
+    }
+    return vector_keys;
+}
+
+size_t enigma2_c_encrypt_avx512(const char* input, char* output, size_t keys) noexcept
+{
+    const size_t vector_keys = keys / LANES * LANES;
+    for (size_t key = 0; key < vector_keys; key += LANES)
+    {
+        // Checksum over positions 2-15, kept mod 100.
+        __m512i checksum = set(1);
+        for (size_t i = 2; i < KEY_LENGTH; ++i)
+        {
+            const __m512i c = load(input + i * keys + key);
+            const __m512i t = char_value(c, digit_mask(c));
+            checksum = reduce(_mm512_add_epi8(checksum, lookup32(CHECKSUM_STEP_100[i], t)), 100);
+        }
+        // 100 - checksum is 1-100; its last two decimal digits go in positions 0 and 1.
+        __m512i ones = _mm512_sub_epi8(set(100), checksum);
+        __m512i tens = _mm512_setzero_si512();
+        for (int n = 0; n < 10; ++n)
+        {
+            const __mmask64 carry = _mm512_cmpgt_epu8_mask(ones, set(9));
+            ones = _mm512_mask_sub_epi8(ones, carry, ones, set(10));
+            tens = _mm512_mask_add_epi8(tens, carry, tens, set(1));
+        }
+        tens = reduce(tens, 10);
+
+        __m512i running_10 = _mm512_setzero_si512();
+        __m512i running_26 = _mm512_setzero_si512();
+        for (size_t i = 0; i < KEY_LENGTH; ++i)
+        {
+            __mmask64 digit = ~__mmask64{0};
+            __m512i t = i == 0 ? ones : tens;
+            if (i >= 2)
+            {
+                const __m512i c = load(input + i * keys + key);
+                digit = digit_mask(c);
+                t = char_value(c, digit);
+            }
+            // (t + MAX_CHECK_SUM - running) % m; MAX_CHECK_SUM is a multiple of both moduli.
+            const __m512i index_10 = reduce(_mm512_add_epi8(_mm512_sub_epi8(t, running_10), set(10)), 10);
+            const __m512i index_26 = reduce(_mm512_add_epi8(_mm512_sub_epi8(t, running_26), set(26)), 26);
+            const __m512i as_digit = _mm512_add_epi8(lookup16(ENIGMA2_E_ROTOR_10_PADDED, index_10), set('0'));
+            const __m512i as_letter = _mm512_add_epi8(lookup32(ENIGMA2_E_ROTOR_26_PADDED, index_26), set('A'));
+            store(output + i * keys + key, _mm512_mask_blend_epi8(digit, as_letter, as_digit));
+            running_10 = reduce(_mm512_add_epi8(running_10, lookup32(CHECKSUM_STEP_10[i], t)), 10);
+            running_26 = reduce(_mm512_add_epi8(running_26, lookup32(CHECKSUM_STEP_26[i], t)), 26);
+        }
+    }
+    return vector_keys;
+}
+
+size_t enigma2_c_decrypt_avx512(const char* input, char* output, uint8_t* checksum_ok, size_t keys) noexcept
+{
+    const size_t vector_keys = keys / LANES * LANES;
+    for (size_t key = 0; key < vector_keys; key += LANES)
+    {
+        __m512i checksum_10 = _mm512_setzero_si512();
+        __m512i checksum_26 = _mm512_setzero_si512();
+        __m512i checksum_100 = _mm512_setzero_si512();
+        __m512i second = _mm512_setzero_si512();
+        for (size_t i = 0; i < KEY_LENGTH; ++i)
+        {
+            const __m512i c = load(input + i * keys + key);
+            const __mmask64 digit = digit_mask(c);
+            const __m512i t_10 = reduce(
+                _mm512_add_epi8(lookup16(ENIGMA2_D_ROTOR_10_PADDED, _mm512_sub_epi8(c, set('0'))), checksum_10), 10);
+            const __m512i t_26 = reduce(
+                _mm512_add_epi8(lookup32(ENIGMA2_D_ROTOR_26_PADDED, _mm512_sub_epi8(c, set('A'))), checksum_26), 26);
+            const __m512i t = _mm512_mask_blend_epi8(digit, t_26, t_10);
+            const __m512i plain = _mm512_add_epi8(t, _mm512_mask_blend_epi8(digit, set('A'), set('0')));
+            store(output + i * keys + key, plain);
+            if (i == 1) second = plain;
+            checksum_10 = reduce(_mm512_add_epi8(checksum_10, lookup32(CHECKSUM_STEP_10[i], t)), 10);
+            checksum_26 = reduce(_mm512_add_epi8(checksum_26, lookup32(CHECKSUM_STEP_26[i], t)), 26);
+            checksum_100 = reduce(_mm512_add_epi8(checksum_100, lookup32(CHECKSUM_STEP_100[i], t)), 100);
+        }
+        // checksum += 8 * (plain[1] - '0'), with plain[1] - '0' up to 42, so
+        // 8 * v mod 100 is computed as 4 * (2 * v mod 25) to stay in a byte.
+        const __m512i value = _mm512_sub_epi8(second, set('0'));
+        __m512i twice = _mm512_add_epi8(value, value);
+        for (int n = 0; n < 3; ++n) twice = reduce(twice, 25);
+        const __m512i eight_times = _mm512_slli_epi16(twice, 2); // twice < 25, so no bits cross bytes
+        const __m512i total = reduce(_mm512_add_epi8(checksum_100, eight_times), 100);
+        const __mmask64 ok = _mm512_cmpeq_epu8_mask(total, _mm512_setzero_si512());
+        store(checksum_ok + key, _mm512_maskz_mov_epi8(ok, set(1)));
+    }
+    return vector_keys;
+}
+} // namespace detail
+} // namespace enigma
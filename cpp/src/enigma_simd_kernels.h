@@ -0,0 +1,87 @@
+//
+// Per-instruction-set kernels behind enigma_simd.h. Each one lives in its
+// own translation unit, built with the flags for its instruction set, and
+// is only called after the CPU has been checked.
+//
+// The vector kernels process whole vectors of keys and return how many
+// they handled; the dispatcher finishes the remaining keys with the scalar
+// kernel, starting at first.
+//
+
+#ifndef ENIGMA_SIMD_KERNELS_H
+#define ENIGMA_SIMD_KERNELS_H
+
+#include "enigma_v300_pure_cpp.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace enigma
+{
+namespace detail
+{
+// Rotor padded to 32 entries, so two 16-byte shuffles cover it.
+template <size_t N>
+constexpr std::array<uint8_t, 32> padded_table(const std::array<uint8_t, N>& rotor)
+{
+    static_assert(N <= 32);
+    std::array<uint8_t, 32> table{};
+    for (size_t i = 0; i < N; ++i) table[i] = rotor[i];
+    return table;
+}
+
+// Enigma2C checksum increment i + t + i * t, reduced mod Modulus, for every
+// position i and character value t. With these the kernels keep the
+// running checksum mod 10, 26 and 100 in bytes: each step adds two values
+// below Modulus, so one conditional subtraction replaces the division.
+template <unsigned Modulus>
+constexpr std::array<std::array<uint8_t, 32>, KEY_LENGTH> checksum_step_table()
+{
+    std::array<std::array<uint8_t, 32>, KEY_LENGTH> table{};
+    for (unsigned i = 0; i < KEY_LENGTH; ++i)
+    {
+        for (unsigned t = 0; t < 32; ++t) table[i][t] = static_cast<uint8_t>((i + t + i * t) % Modulus);
+    }
+    return table;
+}
+
+constexpr auto ENIGMA2_E_ROTOR_10_PADDED = padded_table(ENIGMA2_E_ROTOR_10);
+constexpr auto ENIGMA2_E_ROTOR_26_PADDED = padded_table(ENIGMA2_E_ROTOR_26);
+constexpr auto ENIGMA2_D_ROTOR_10_PADDED = padded_table(ENIGMA2_D_ROTOR_10);
+constexpr auto ENIGMA2_D_ROTOR_26_PADDED = padded_table(ENIGMA2_D_ROTOR_26);
+constexpr auto CHECKSUM_STEP_10 = checksum_step_table<10>();
+constexpr auto CHECKSUM_STEP_26 = checksum_step_table<26>();
+constexpr auto CHECKSUM_STEP_100 = checksum_step_table<100>();
+
+void enigma_c_encrypt_scalar(const uint8_t* input, uint8_t* output, size_t positions, size_t keys,
+                             size_t first) noexcept;
+void enigma_c_decrypt_scalar(const uint8_t* input, uint8_t* output, size_t positions, size_t keys,
+                             size_t first) noexcept;
+void enigma2_c_encrypt_scalar(const char* input, char* output, size_t keys, size_t first) noexcept;
+void enigma2_c_decrypt_scalar(const char* input, char* output, uint8_t* checksum_ok, size_t keys,
+                              size_t first) noexcept;
+
+#ifdef ENIGMA_SIMD_X86
+size_t enigma_c_encrypt_ssse3(const uint8_t* input, uint8_t* output, size_t positions, size_t keys) noexcept;
+size_t enigma_c_decrypt_ssse3(const uint8_t* input, uint8_t* output, size_t positions, size_t keys) noexcept;
+size_t enigma_c_encrypt_avx2(const uint8_t* input, uint8_t* output, size_t positions, size_t keys) noexcept;
+size_t enigma_c_decrypt_avx2(const uint8_t* input, uint8_t* output, size_t positions, size_t keys) noexcept;
+size_t enigma2_c_encrypt_avx2(const char* input, char* output, size_t keys) noexcept;
+size_t enigma2_c_decrypt_avx2(const char* input, char* output, uint8_t* checksum_ok, size_t keys) noexcept;
+size_t enigma_c_encrypt_avx512(const uint8_t* input, uint8_t* output, size_t positions, size_t keys) noexcept;
+size_t enigma_c_decrypt_avx512(const uint8_t* input, uint8_t* output, size_t positions, size_t keys) noexcept;
+size_t enigma2_c_encrypt_avx512(const char* input, char* output, size_t keys) noexcept;
+size_t enigma2_c_decrypt_avx512(const char* input, char* output, uint8_t* checksum_ok, size_t keys) noexcept;
+#endif
+
+#ifdef ENIGMA_SIMD_NEON
+size_t enigma_c_encrypt_neon(const uint8_t* input, uint8_t* output, size_t positions, size_t keys) noexcept;
+size_t enigma_c_decrypt_neon(const uint8_t* input, uint8_t* output, size_t positions, size_t keys) noexcept;
+size_t enigma2_c_encrypt_neon(const char* input, char* output, size_t keys) noexcept;
+size_t enigma2_c_decrypt_neon(const char* input, char* output, uint8_t* checksum_ok, size_t keys) noexcept;
+#endif
+} // namespace detail
+} // namespace enigma
+
+#endif //ENIGMA_SIMD_KERNELS_H
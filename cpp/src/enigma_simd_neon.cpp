@@ -0,0 +1,185 @@
+// File: enigma_simd_neon.cpp
+// Author: Kris Armstrong
+// Version: 3.0.0
+// Last Modified: 2026-10-14
+// Description: AArch64 NEON struct-of-arrays EnigmaC and Enigma2C kernels, 16 keys per vector.
+// License: MIT
+
+#include "enigma_simd_kernels.h"
+#include "enigma_tables.h"
+
+#include <arm_neon.h>
+
+namespace enigma
+{
+namespace detail
+{
+namespace
+{
+constexpr size_t LANES = 16;
+
+// x mod m for x < 2 * m, without a branch or a division: when x < m,
+// x - m wraps around to something larger than x and min keeps x.
+uint8x16_t reduce(uint8x16_t x, uint8_t m) noexcept
+{
+    return vminq_u8(x, vsubq_u8(x, vdupq_n_u8(m)));
+}
+
+// table[index] for index 0-15; larger indices give 0.
+uint8x16_t lookup16(const std::array<uint8_t, 32>& table, uint8x16_t index) noexcept
+{
+    return vqtbl1q_u8(vld1q_u8(table.data()), index);
+}
+
+// table[index] for index 0-31; larger indices give 0.
+uint8x16_t lookup32(const std::array<uint8_t, 32>& table, uint8x16_t index) noexcept
+{
+    const uint8x16x2_t halves = {{vld1q_u8(table.data()), vld1q_u8(table.data() + 16)}};
+    return vqtbl2q_u8(halves, index);
+}
+
+uint8x16_t load(const char* input) noexcept
+{
+    return vld1q_u8(reinterpret_cast<const uint8_t*>(input));
+}
+
+// All ones in lanes holding '0'-'9'; the rest hold 'A'-'Z'.
+uint8x16_t digit_mask(uint8x16_t c) noexcept
+{
+    return vcltq_u8(c, vdupq_n_u8('A'));
+}
+
+// Character value: c - '0' for digits, c - 'A' for letters.
+uint8x16_t char_value(uint8x16_t c, uint8x16_t digit) noexcept
+{
+    return vsubq_u8(c, vbslq_u8(digit, vdupq_n_u8('0'), vdupq_n_u8('A')));
+}
+} // namespace
+
+size_t enigma_c_encrypt_neon(const uint8_t* input, uint8_t* output, size_t positions, size_t keys) noexcept
+{
+    const uint8x16_t rotor = vld1q_u8(ENIGMA_C_ROTOR.data());
+    const uint8x16_t nibble = vdupq_n_u8(0x0F);
+    const size_t vector_keys = keys / LANES * LANES;
+    for (size_t key = 0; key < vector_keys; key += LANES)
+    {
+        uint8x16_t value = vdupq_n_u8(0);
+        for (size_t position = 0; position < positions; ++position)
+        {
+            const size_t at = position * keys + key;
+            // (digit + position) % 16, then ROTOR[...] for all 16 lanes at once.
+            const uint8x16_t index = vandq_u8(vaddq_u8(vld1q_u8(input + at),
+                                                       vdupq_n_u8(static_cast<uint8_t>(position))), nibble);
+            value = veorq_u8(value, vqtbl1q_u8(rotor, index));
+            vst1q_u8(output + at, value);
+        }
+    }
+    return vector_keys;
+}
+
+size_t enigma_c_decrypt_neon(const uint8_t* input, uint8_t* output, size_t positions, size_t keys) noexcept
+{
+    const uint8x16_t inverse = vld1q_u8(ENIGMA_C_ROTOR_INVERSE.data());
+    const uint8x16_t nibble = vdupq_n_u8(0x0F);
+    const size_t vector_keys = keys / LANES * LANES;
+    for (size_t key = 0; key < vector_keys; key += LANES)
+    {
+        uint8x16_t previous = vdupq_n_u8(0);
+        for (size_t position = 0; position < positions; ++position)
+        {
+            const size_t at = position * keys + key;
+            const uint8x16_t value = vandq_u8(vld1q_u8(input + at), nibble);
+            const uint8x16_t plain = vqtbl1q_u8(inverse, veorq_u8(value, previous));
+            vst1q_u8(output + at, vandq_u8(vsubq_u8(plain, vdupq_n_u8(static_cast<uint8_t>(position))), nibble));
+            previous = value;
+        }
+    }
+    return vector_keys;
+}
+
+size_t enigma2_c_encrypt_neon(const char* input, char* output, size_t keys) noexcept
+{
+    const size_t vector_keys = keys / LANES * LANES;
+    for (size_t key = 0; key < vector_keys; key += LANES)
+    {
+        // Checksum over positions 2-15, kept mod 100.
+        uint8x16_t checksum = vdupq_n_u8(1);
+        for (size_t i = 2; i < KEY_LENGTH; ++i)
+        {
+            const uint8x16_t c = load(input + i * keys + key);
+            const uint8x16_t t = char_value(c, digit_mask(c));
+            checksum = reduce(vaddq_u8(checksum, lookup32(CHECKSUM_STEP_100[i], t)), 100);
+        }
+        // 100 - checksum is 1-100; its last two decimal digits go in positions 0 and 1.
+        uint8x16_t ones = vsubq_u8(vdupq_n_u8(100), checksum);
+        uint8x16_t tens = vdupq_n_u8(0);
+        for (int n = 0; n < 10; ++n)
+        {
+            const uint8x16_t carry = vcgtq_u8(ones, vdupq_n_u8(9));
+            ones = vsubq_u8(ones, vandq_u8(carry, vdupq_n_u8(10)));
+            tens = vsubq_u8(tens, carry);
+        }
+        tens = reduce(tens, 10);
+
+        uint8x16_t running_10 = vdupq_n_u8(0);
+        uint8x16_t running_26 = vdupq_n_u8(0);
+        for (size_t i = 0; i < KEY_LENGTH; ++i)
+        {
+            uint8x16_t digit = vdupq_n_u8(0xFF);
+            uint8x16_t t = i == 0 ? ones : tens;
+            if (i >= 2)
+            {
+                const uint8x16_t c = load(input + i * keys + key);
+                digit = digit_mask(c);
+                t = char_value(c, digit);
+            }
+            // (t + MAX_CHECK_SUM - running) % m; MAX_CHECK_SUM is a multiple of both moduli.
+            const uint8x16_t index_10 = reduce(vaddq_u8(vsubq_u8(t, running_10), vdupq_n_u8(10)), 10);
+            const uint8x16_t index_26 = reduce(vaddq_u8(vsubq_u8(t, running_26), vdupq_n_u8(26)), 26);
+            const uint8x16_t as_digit = vaddq_u8(lookup16(ENIGMA2_E_ROTOR_10_PADDED, index_10), vdupq_n_u8('0'));
+            const uint8x16_t as_letter = vaddq_u8(lookup32(ENIGMA2_E_ROTOR_26_PADDED, index_26), vdupq_n_u8('A'));
+            vst1q_u8(reinterpret_cast<uint8_t*>(output + i * keys + key), vbslq_u8(digit, as_digit, as_letter));
+            running_10 = reduce(vaddq_u8(running_10, lookup32(CHECKSUM_STEP_10[i], t)), 10);
+            running_26 = reduce(vaddq_u8(running_26, lookup32(CHECKSUM_STEP_26[i], t)), 26);
+        }
+    }
+    return vector_keys;
+}
+
+size_t enigma2_c_decrypt_neon(const char* input, char* output, uint8_t* checksum_ok, size_t keys) noexcept
+{
+    const size_t vector_keys = keys / LANES * LANES;
+    for (size_t key = 0; key < vector_keys; key += LANES)
+    {
+        uint8x16_t checksum_10 = vdupq_n_u8(0);
+        uint8x16_t checksum_26 = vdupq_n_u8(0);
+        uint8x16_t checksum_100 = vdupq_n_u8(0);
+        uint8x16_t second = vdupq_n_u8(0);
+        for (size_t i = 0; i < KEY_LENGTH; ++i)
+        {
+            const uint8x16_t c = load(input + i * keys + key);
+            const uint8x16_t digit = digit_mask(c);
+            const uint8x16_t t_10 = reduce(
+                vaddq_u8(lookup16(ENIGMA2_D_ROTOR_10_PADDED, vsubq_u8(c, vdupq_n_u8('0'))), checksum_10), 10);
+            const uint8x16_t t_26 = reduce(
+                vaddq_u8(lookup32(ENIGMA2_D_ROTOR_26_PADDED, vsubq_u8(c, vdupq_n_u8('A'))), checksum_26), 26);
+            const uint8x16_t t = vbslq_u8(digit, t_10, t_26);
+            const uint8x16_t plain = vaddq_u8(t, vbslq_u8(digit, vdupq_n_u8('0'), vdupq_n_u8('A')));
+            vst1q_u8(reinterpret_cast<uint8_t*>(output + i * keys + key), plain);
+            if (i == 1) second = plain;
+            checksum_10 = reduce(vaddq_u8(checksum_10, lookup32(CHECKSUM_STEP_10[i], t)), 10);
+            checksum_26 = reduce(vaddq_u8(checksum_26, lookup32(CHECKSUM_STEP_26[i], t)), 26);
+            checksum_100 = reduce(vaddq_u8(checksum_100, lookup32(CHECKSUM_STEP_100[i], t)), 100);
+        }
+        // checksum += 8 * (plain[1] - '0'), with plain[1] - '0' up to 42, so
+        // 8 * v mod 100 is computed as 4 * (2 * v mod 25) to stay in a byte.
+        const uint8x16_t value = vsubq_u8(second, vdupq_n_u8('0'));
+        uint8x16_t twice = vaddq_u8(value, value);
+        for (int n = 0; n < 3; ++n) twice = reduce(twice, 25);
+        const uint8x16_t total = reduce(vaddq_u8(checksum_100, vshlq_n_u8(twice, 2)), 100);
+        vst1q_u8(checksum_ok + key, vandq_u8(vceqq_u8(total, vdupq_n_u8(0)), vdupq_n_u8(1)));
+    }
+    return vector_keys;
+}
+} // namespace detail
+} // namespace enigma
@@ -0,0 +1,72 @@
+// File: enigma_simd_ssse3.cpp
+// Author: Kris Armstrong
+// Version: 3.0.0
+// Last Modified: 2026-10-14
+// Description: SSSE3 struct-of-arrays EnigmaC kernel, 16 keys per pshufb. Built with -mssse3.
+// License: MIT
+
+#include "enigma_simd_kernels.h"
+#include "enigma_tables.h"
+
+#include <tmmintrin.h>
+
+namespace enigma
+{
+namespace detail
+{
+namespace
+{
+constexpr size_t LANES = 16;
+
+__m128i load_table(const std::array<uint8_t, 16>& table) noexcept
+{
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(table.data()));
+}
+} // namespace
+
+size_t enigma_c_encrypt_ssse3(const uint8_t* input, uint8_t* output, size_t positions, size_t keys) noexcept
+{
+    const __m128i rotor = load_table(ENIGMA_C_ROTOR);
+    const __m128i nibble = _mm_set1_epi8(0x0F);
+    const size_t vector_keys = keys / LANES * LANES;
+    for (size_t key = 0; key < vector_keys; key += LANES)
+    {
+        __m128i value = _mm_setzero_si128();
+        for (size_t position = 0; position < positions; ++position)
+        {
+            const size_t at = position * keys + key;
+            const __m128i digit = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + at));
+            // (digit + position) % 16, then ROTOR[...] for all 16 lanes at once.
+            const __m128i index = _mm_and_si128(
+                _mm_add_epi8(digit, _mm_set1_epi8(static_cast<char>(position))), nibble);
+            value = _mm_xor_si128(value, _mm_shuffle_epi8(rotor, index));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(output + at), value);
+        }
+    }
+    return vector_keys;
+}
+
+size_t enigma_c_decrypt_ssse3(const uint8_t* input, uint8_t* output, size_t positions, size_t keys) noexcept
+{
+    const __m128i inverse = load_table(ENIGMA_C_ROTOR_INVERSE);
+    const __m128i nibble = _mm_set1_epi8(0x0F);
+    const size_t vector_keys = keys / LANES * LANES;
+    for (size_t key = 0; key < vector_keys; key += LANES)
+    {
+        __m128i previous = _mm_setzero_si128();
+        for (size_t position = 0; position < positions; ++position)
+        {
+            const size_t at = position * keys + key;
+            const __m128i value = _mm_and_si128(
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + at)), nibble);
+            const __m128i plain = _mm_shuffle_epi8(inverse, _mm_xor_si128(value, previous));
+            const __m128i digit = _mm_and_si128(
+                _mm_sub_epi8(plain, _mm_set1_epi8(static_cast<char>(position))), nibble);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(output + at), digit);
+            previous = value;
+        }
+    }
+    return vector_keys;
+}
+} // namespace detail
+} // namespace enigma
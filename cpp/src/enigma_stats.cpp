@@ -0,0 +1,213 @@
+// File: enigma_stats.cpp
+// Author: Kris Armstrong
+// Version: 3.0.0
+// Last Modified: 2026-10-14
+// Description: Per-thread counter and histogram registry, merged into Prometheus text or a --stats summary.
+// License: MIT
+
+#include "enigma_stats.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+#ifdef ENIGMA_STATS
+#include <mutex>
+#include <vector>
+#endif
+
+namespace enigma::stats
+{
+namespace
+{
+constexpr std::array<const char*, COUNTER_COUNT> COUNTER_NAMES{
+    "keys_encrypted", "keys_decrypted", "batch_records", "batch_errors", "server_requests", "server_errors",
+};
+constexpr std::array<const char*, COUNTER_COUNT> COUNTER_HELP{
+    "Keys encrypted by the SIMD kernels (lanes, including padding) and the single-key engines.",
+    "Keys decrypted by the SIMD kernels (lanes, including padding) and the single-key engines.",
+    "Batch records that produced an output line.",
+    "Batch records whose output line was an error.",
+    "Server request lines answered.",
+    "Server requests answered with ERR.",
+};
+constexpr std::array<const char*, TIMER_COUNT> TIMER_NAMES{
+    "encrypt_block", "decrypt_block", "batch_read", "batch_compute", "batch_write", "server_request",
+};
+constexpr std::array<const char*, TIMER_COUNT> TIMER_HELP{
+    "Time per SIMD encryption kernel call.",
+    "Time per SIMD decryption kernel call.",
+    "Time to read and frame one batch pipeline block.",
+    "Time to parse and process one batch pipeline block.",
+    "Time to write one batch pipeline block.",
+    "Time to answer one server request line.",
+};
+
+// Exposed histogram bounds: powers of four from 256 ns to about 17 s. They
+// fall on bucket boundaries, so the cumulative counts are exact.
+constexpr unsigned FIRST_BOUND_BITS = 8;
+constexpr unsigned LAST_BOUND_BITS = 34;
+
+void append_format(std::string& output, const char* format, auto... values)
+{
+    char buffer[160];
+    const int length = std::snprintf(buffer, sizeof(buffer), format, values...);
+    if (length > 0) output.append(buffer, std::min(static_cast<size_t>(length), sizeof(buffer) - 1));
+}
+
+#ifdef ENIGMA_STATS
+void add_into(Snapshot& total, const detail::ThreadStats& slot) noexcept
+{
+    for (size_t i = 0; i < COUNTER_COUNT; ++i) total.counters[i] += slot.counters[i].load(std::memory_order_relaxed);
+    for (size_t t = 0; t < TIMER_COUNT; ++t)
+    {
+        const detail::Histogram& source = slot.timers[t];
+        HistogramSnapshot& target = total.timers[t];
+        target.count += source.count.load(std::memory_order_relaxed);
+        target.sum += source.sum.load(std::memory_order_relaxed);
+        target.max = std::max(target.max, source.max.load(std::memory_order_relaxed));
+        for (size_t b = 0; b < BUCKET_COUNT; ++b)
+        {
+            target.buckets[b] += source.buckets[b].load(std::memory_order_relaxed);
+        }
+    }
+}
+
+struct Registry
+{
+    std::mutex mutex;
+    std::vector<const detail::ThreadStats*> live;
+    Snapshot retired; // totals of threads that have exited
+};
+
+// Never destroyed, so threads that exit during static destruction can
+// still retire their slots.
+Registry& registry()
+{
+    static Registry* instance = new Registry;
+    return *instance;
+}
+
+struct Slot
+{
+    Slot()
+    {
+        Registry& shared = registry();
+        const std::lock_guard lock(shared.mutex);
+        shared.live.push_back(&stats);
+    }
+
+    ~Slot()
+    {
+        Registry& shared = registry();
+        const std::lock_guard lock(shared.mutex);
+        add_into(shared.retired, stats);
+        shared.live.erase(std::find(shared.live.begin(), shared.live.end(), &stats));
+    }
+
+    detail::ThreadStats stats;
+};
+#endif
+} // namespace
+
+#ifdef ENIGMA_STATS
+detail::ThreadStats& detail::local() noexcept
+{
+    thread_local Slot slot;
+    return slot.stats;
+}
+#endif
+
+uint64_t HistogramSnapshot::quantile(double q) const noexcept
+{
+    if (count == 0) return 0;
+    const auto rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(q * static_cast<double>(count))));
+    uint64_t seen = 0;
+    for (size_t b = 0; b < BUCKET_COUNT; ++b)
+    {
+        seen += buckets[b];
+        if (seen >= rank) return std::min(bucket_upper_bound(b), max);
+    }
+    return max;
+}
+
+const char* counter_name(Counter counter) noexcept
+{
+    return COUNTER_NAMES[static_cast<size_t>(counter)];
+}
+
+const char* timer_name(Timer timer) noexcept
+{
+    return TIMER_NAMES[static_cast<size_t>(timer)];
+}
+
+Snapshot snapshot()
+{
+    Snapshot total;
+#ifdef ENIGMA_STATS
+    Registry& shared = registry();
+    const std::lock_guard lock(shared.mutex);
+    total = shared.retired;
+    for (const detail::ThreadStats* slot : shared.live) add_into(total, *slot);
+#endif
+    return total;
+}
+
+void append_prometheus(std::string& output, const Snapshot& snapshot)
+{
+    for (size_t i = 0; i < COUNTER_COUNT; ++i)
+    {
+        append_format(output, "# HELP enigma_%s_total %s\n", COUNTER_NAMES[i], COUNTER_HELP[i]);
+        append_format(output, "# TYPE enigma_%s_total counter\n", COUNTER_NAMES[i]);
+        append_format(output, "enigma_%s_total %llu\n", COUNTER_NAMES[i],
+                      static_cast<unsigned long long>(snapshot.counters[i]));
+    }
+    for (size_t t = 0; t < TIMER_COUNT; ++t)
+    {
+        const HistogramSnapshot& histogram = snapshot.timers[t];
+        append_format(output, "# HELP enigma_%s_seconds %s\n", TIMER_NAMES[t], TIMER_HELP[t]);
+        append_format(output, "# TYPE enigma_%s_seconds histogram\n", TIMER_NAMES[t]);
+        uint64_t cumulative = 0;
+        size_t bucket = 0;
+        for (unsigned bits = FIRST_BOUND_BITS; bits <= LAST_BOUND_BITS; bits += 2)
+        {
+            const uint64_t bound = uint64_t{1} << bits;
+            for (; bucket < BUCKET_COUNT && bucket_upper_bound(bucket) < bound; ++bucket)
+            {
+                cumulative += histogram.buckets[bucket];
+            }
+            append_format(output, "enigma_%s_seconds_bucket{le=\"%.9g\"} %llu\n", TIMER_NAMES[t],
+                          static_cast<double>(bound) * 1e-9, static_cast<unsigned long long>(cumulative));
+        }
+        append_format(output, "enigma_%s_seconds_bucket{le=\"+Inf\"} %llu\n", TIMER_NAMES[t],
+                      static_cast<unsigned long long>(histogram.count));
+        append_format(output, "enigma_%s_seconds_sum %.9g\n", TIMER_NAMES[t],
+                      static_cast<double>(histogram.sum) * 1e-9);
+        append_format(output, "enigma_%s_seconds_count %llu\n", TIMER_NAMES[t],
+                      static_cast<unsigned long long>(histogram.count));
+    }
+}
+
+void append_summary(std::string& output, const Snapshot& snapshot)
+{
+    output.append("Stats:\n");
+    for (size_t i = 0; i < COUNTER_COUNT; ++i)
+    {
+        if (snapshot.counters[i] == 0) continue;
+        append_format(output, "  %-16s %llu\n", COUNTER_NAMES[i],
+                      static_cast<unsigned long long>(snapshot.counters[i]));
+    }
+    append_format(output, "  %-16s %10s %12s %10s %10s %10s\n", "stage", "count", "total_ms", "p50_us", "p99_us",
+                  "max_us");
+    for (size_t t = 0; t < TIMER_COUNT; ++t)
+    {
+        const HistogramSnapshot& histogram = snapshot.timers[t];
+        if (histogram.count == 0) continue;
+        append_format(output, "  %-16s %10llu %12.3f %10.3f %10.3f %10.3f\n", TIMER_NAMES[t],
+                      static_cast<unsigned long long>(histogram.count), static_cast<double>(histogram.sum) * 1e-6,
+                      static_cast<double>(histogram.quantile(0.5)) * 1e-3,
+                      static_cast<double>(histogram.quantile(0.99)) * 1e-3,
+                      static_cast<double>(histogram.max) * 1e-3);
+    }
+}
+} // namespace enigma::stats
@@ -0,0 +1,202 @@
+// File: enigma_thread_pool.cpp
+// Author: Kris Armstrong
+// Version: 3.0.0
+// Last Modified: 2026-10-14
+// Description: Fixed-size worker pool with a blocking, work-stealing parallel-for.
+// License: MIT
+
+#include "enigma_thread_pool.h"
+#include "enigma_affinity.h"
+
+#include <algorithm>
+#include <limits>
+#include <optional>
+
+namespace enigma
+{
+namespace
+{
+thread_local unsigned current_thread_index = 0;
+
+// Indices per generation, so a slice's bounds fit in 32 bits each.
+constexpr size_t MAX_GENERATION_TASKS = std::numeric_limits<uint32_t>::max();
+
+constexpr uint64_t pack(uint64_t begin, uint64_t end) noexcept
+{
+    return begin | end << 32;
+}
+
+// Makes the calling thread index 0 for one parallel_for() or
+// for_each_thread(), even when it is itself a worker of another pool.
+class CallerIndex
+{
+public:
+    CallerIndex() noexcept : saved_(current_thread_index) { current_thread_index = 0; }
+    ~CallerIndex() { current_thread_index = saved_; }
+    CallerIndex(const CallerIndex&) = delete;
+    CallerIndex& operator=(const CallerIndex&) = delete;
+
+private:
+    unsigned saved_;
+};
+} // namespace
+
+ThreadPool::ThreadPool(unsigned threads, bool pin_threads)
+{
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    if (pin_threads) cpus_ = affinity_cpus();
+    slices_ = std::make_unique<Slice[]>(threads);
+    workers_.reserve(threads - 1);
+    for (unsigned i = 1; i < threads; ++i)
+    {
+        workers_.emplace_back([this, i]
+        {
+            current_thread_index = i;
+            if (!cpus_.empty()) pin_current_thread(cpus_[i % cpus_.size()]);
+            worker_loop(i);
+        });
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    for (auto& worker : workers_) worker.join();
+}
+
+void ThreadPool::parallel_for(size_t count, const std::function<void(size_t)>& task)
+{
+    if (count == 0) return;
+    const CallerIndex caller;
+    std::optional<ScopedPin> pin;
+    if (!cpus_.empty()) pin.emplace(cpus_[0]);
+    if (workers_.empty() || count == 1)
+    {
+        for (size_t i = 0; i < count; ++i) task(i);
+        return;
+    }
+    for (size_t base = 0; base < count; base += MAX_GENERATION_TASKS)
+    {
+        start(task, base, std::min(count - base, MAX_GENERATION_TASKS), false);
+    }
+}
+
+void ThreadPool::for_each_thread(const std::function<void(size_t)>& task)
+{
+    const CallerIndex caller;
+    std::optional<ScopedPin> pin;
+    if (!cpus_.empty()) pin.emplace(cpus_[0]);
+    if (workers_.empty())
+    {
+        task(0);
+        return;
+    }
+    start(task, 0, 0, true);
+}
+
+unsigned ThreadPool::thread_index() noexcept
+{
+    return current_thread_index;
+}
+
+// Hands out count indices from base (or one call per thread), runs the
+// caller's share and waits for the workers.
+void ThreadPool::start(const std::function<void(size_t)>& task, size_t base, size_t count, bool each_thread)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        task_ = &task;
+        base_ = base;
+        each_thread_ = each_thread;
+        const uint64_t threads = size();
+        for (uint64_t t = 0; t < threads; ++t)
+        {
+            slices_[t].bounds.store(pack(count * t / threads, count * (t + 1) / threads), std::memory_order_relaxed);
+        }
+        busy_ = static_cast<unsigned>(workers_.size());
+        ++generation_;
+    }
+    wake_.notify_all();
+    if (each_thread) task(0);
+    else drain(0);
+
+    // Every worker checks in for every generation, so none can still be
+    // holding a pointer to this task when we return.
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_.wait(lock, [this] { return busy_ == 0; });
+    task_ = nullptr;
+}
+
+void ThreadPool::worker_loop(unsigned index)
+{
+    size_t seen = 0;
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true)
+    {
+        wake_.wait(lock, [&] { return stopping_ || generation_ != seen; });
+        if (stopping_) return;
+        seen = generation_;
+        lock.unlock();
+        if (each_thread_) (*task_)(index);
+        else drain(index);
+        lock.lock();
+        if (--busy_ == 0) done_.notify_all();
+    }
+}
+
+void ThreadPool::drain(unsigned index)
+{
+    // task_ and base_ are only written while no generation is in flight.
+    size_t task;
+    while (take(index, task) || steal(index, task)) (*task_)(base_ + task);
+}
+
+// Claims the first index of the thread's own slice.
+bool ThreadPool::take(unsigned index, size_t& task) noexcept
+{
+    std::atomic<uint64_t>& bounds = slices_[index].bounds;
+    uint64_t current = bounds.load(std::memory_order_relaxed);
+    while (true)
+    {
+        const uint64_t begin = current & 0xffffffff;
+        const uint64_t end = current >> 32;
+        if (begin >= end) return false;
+        if (bounds.compare_exchange_weak(current, pack(begin + 1, end), std::memory_order_relaxed))
+        {
+            task = begin;
+            return true;
+        }
+    }
+}
+
+// Moves the back half of the next non-empty slice into the thread's own,
+// which is empty, and claims its first index. Returns false once every
+// slice is empty; indices already stolen are run by their thief.
+bool ThreadPool::steal(unsigned index, size_t& task) noexcept
+{
+    const unsigned threads = size();
+    for (unsigned offset = 1; offset < threads; ++offset)
+    {
+        std::atomic<uint64_t>& bounds = slices_[(index + offset) % threads].bounds;
+        uint64_t current = bounds.load(std::memory_order_relaxed);
+        while (true)
+        {
+            const uint64_t begin = current & 0xffffffff;
+            const uint64_t end = current >> 32;
+            if (begin >= end) break;
+            const uint64_t first = end - (end - begin + 1) / 2;
+            if (bounds.compare_exchange_weak(current, pack(begin, first), std::memory_order_relaxed))
+            {
+                slices_[index].bounds.store(pack(first + 1, end), std::memory_order_relaxed);
+                task = first;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+} // namespace enigma
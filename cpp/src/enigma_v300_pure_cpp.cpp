@@ -1,283 +1,184 @@
 // File: enigma_v300_pure_cpp.cpp
 // Author: Kris Armstrong
 // Version: 3.0.0
-// Last Modified: 2025-12-25
+// Last Modified: 2026-10-14
 // Description: C++20 implementation of Fluke option key calculator with enhanced menu.
 // License: MIT
 
-#include <iostream>
+#include "enigma_v300_pure_cpp.h"
+#include "enigma_batch.h"
+#include "enigma_catalog.h"
+#include "enigma_catalog_file.h"
+#include "enigma_output.h"
+#include "enigma_packed.h"
+#include "enigma_range.h"
+#include "enigma_stats.h"
+#ifdef ENIGMA_HAVE_SERVER
+#include "enigma_server.h"
+#endif
+
+#include <array>
 #include <string>
 #include <vector>
 #include <cctype>
 #include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <concepts>
 #include <cstdlib>
-#include <iomanip>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <optional>
 
-constexpr auto SOFTWARE_VERSION = "3.0.0";
-constexpr size_t PRODUCT_CODE_SIZE = 4;
-constexpr size_t OPTION_CODE_SIZE = 3;
-constexpr size_t SERIAL_NUMBER_SIZE_ENIGMA2 = 7;
-constexpr size_t SERIAL_NUMBER_SIZE_ENIGMAC = 10;
-constexpr size_t CHECK_SUM_SIZE = 2;
-constexpr size_t KEY_LENGTH = PRODUCT_CODE_SIZE + OPTION_CODE_SIZE + SERIAL_NUMBER_SIZE_ENIGMA2 + CHECK_SUM_SIZE;
-constexpr size_t SERIAL_LOCATION = CHECK_SUM_SIZE + PRODUCT_CODE_SIZE;
-constexpr size_t PRODUCT_LOCATION = CHECK_SUM_SIZE;
-constexpr size_t OPTION_LOCATION = CHECK_SUM_SIZE + PRODUCT_CODE_SIZE + SERIAL_NUMBER_SIZE_ENIGMA2;
-constexpr int MAX_CHECK_SUM = 26000;
-
-struct ProductInfo
-{
-    std::string code;
-    std::string abbr;
-    std::string name;
-};
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#else
+#include <io.h>
+#endif
 
-const std::vector<ProductInfo> PRODUCT_TABLE = {
-    {"3001", "NTs2", "NetTool Series II"},
-    {"7001", "LRPro", "LinkRunner Pro Duo"},
-    {"6963", "Escope/MSv2", "EtherScope/MetroScope"},
-    {"6964", "OneTouch", "OneTouch AT"},
-    {"2186", "OptiView", "OptiView XG"},
-    {"1890", "ClearSight", "ClearSight Analyzer"},
-    {"1895", "iClearSight", "iClearSight Analyzer"},
-};
+constexpr auto SOFTWARE_VERSION = "3.0.0";
 
-struct OptionInfo
+// Buffered output straight to a file descriptor, in place of iostream: a
+// one-shot invocation runs no stream, locale or stdio-sync setup before
+// printing its key. Standard output is flushed before reading input and at
+// exit; standard error at the end of every line.
+class Console
 {
-    std::string code;
-    std::string desc;
-};
+public:
+    constexpr Console(int fd, bool line_buffered) noexcept : fd_(fd), line_buffered_(line_buffered) {}
+    ~Console() { flush(); }
+    Console(const Console&) = delete;
+    Console& operator=(const Console&) = delete;
 
-struct ProductOptions
-{
-    std::string product_code;
-    std::vector<OptionInfo> options;
-};
+    Console& operator<<(std::string_view text) noexcept
+    {
+        while (!text.empty())
+        {
+            if (size_ == buffer_.size()) flush();
+            const size_t count = std::min(text.size(), buffer_.size() - size_);
+            std::memcpy(buffer_.data() + size_, text.data(), count);
+            size_ += count;
+            text.remove_prefix(count);
+        }
+        if (line_buffered_ && size_ > 0 && buffer_[size_ - 1] == '\n') flush();
+        return *this;
+    }
 
-const std::vector<ProductOptions> PRODUCT_OPTIONS = {
-    {
-        "6964", {
-            {"000", "Registered"},
-            {"001", "Wired (Was Copper)"},
-            {"002", "Obsolete (was fiber)"},
-            {"003", "Wi-Fi"},
-            {"004", "Obsolete (was inline)"},
-            {"005", "Capture"},
-            {"006", "Advanced Tests"},
-            {"007", "XGR-to-ATX Upgrade"},
-            {"008", "Claimed (Cloud Tools)"},
-            {"009", "LatTests (China LAN Tests)"},
-            {"064", "XGReflector (Future)"},
-            {"065", "Performance Peer (Future)"}
-        }
-    },
-    {
-        "6963", {
-            {"000", "MetroScope Base, EtherScope LAN"},
-            {"001", "MetroScope WLAN, EtherScope WLAN"},
-            {"002", "MetroScope Multi, EtherScope ITO"},
-            {"003", "MetroScope VoIP, EtherScope Fiber"},
-            {"004", "MetroScope LT, EtherScope LT"}
-        }
-    },
-    {
-        "7001", {
-            {"000", "802.1x"},
-            {"002", "Reports"},
-            {"003", "LAN"}
-        }
-    },
-    {
-        "2186", {
-            {"000", "Wireless Analyzer Option"},
-            {"001", "Enables Network Test Ports A-D"},
-            {"002", "10Gb Ethernet Analyzer Option"},
-            {"003", "LAN / 10Gb Ethernet Analyzer Option"},
-            {"004", "NPT - Network Performance Option"},
-            {"007", "Everything"}
-        }
-    },
-    {
-        "1890", {
-            {"000", "Activation Code"},
-            {"007", "All Options"}
-        }
-    },
-    {
-        "1895", {
-            {"000", "Activation Code"},
-            {"003", "All Options"}
-        }
-    },
-    {
-        "3001", {
-            {"003", "Personalization"},
-            {"004", "VoIP"},
-            {"005", "NetSecure"},
-            {"008", "Dicom"}
-        }
-    },
-};
+    Console& operator<<(const char* text) noexcept { return *this << std::string_view(text); }
+    Console& operator<<(const std::string& text) noexcept { return *this << std::string_view(text); }
+    Console& operator<<(char c) noexcept { return *this << std::string_view(&c, 1); }
 
-const std::vector<int> ENIGMA_C_ROTOR = {5, 4, 14, 11, 1, 8, 10, 13, 7, 3, 15, 0, 2, 12, 9, 6};
-const std::vector<int> ENIGMA2_E_ROTOR_10 = {5, 4, 1, 8, 7, 3, 0, 2, 9, 6};
-const std::vector<int> ENIGMA2_E_ROTOR_26 = {
-    16, 8, 25, 5, 23, 21, 18, 17, 2, 1, 7, 24, 15, 11, 9, 6, 3, 0, 19, 12, 22, 14, 10, 4, 20, 13
-};
-const std::vector<int> ENIGMA2_D_ROTOR_10 = {6, 2, 7, 5, 1, 0, 9, 4, 3, 8};
-const std::vector<int> ENIGMA2_D_ROTOR_26 = {
-    17, 9, 8, 16, 23, 3, 15, 10, 1, 14, 22, 13, 19, 25, 21, 12, 0, 7, 6, 18, 24, 5, 20, 4, 11, 2
-};
+    template <std::integral T>
+    Console& operator<<(T value) noexcept
+    {
+        std::array<char, 24> digits{};
+        const auto end = std::to_chars(digits.data(), digits.data() + digits.size(), value).ptr;
+        return *this << std::string_view(digits.data(), static_cast<size_t>(end - digits.data()));
+    }
 
-void enigma_c_encrypt(const std::string& input_key, std::string& output_key, size_t len)
-{
-    output_key.resize(len);
-    int output_value = 0;
-    for (size_t index = 0; index < len; ++index)
+    void flush() noexcept
     {
-        char c = std::tolower(input_key.at(index));
-        if (!std::isxdigit(static_cast<unsigned char>(c)))
+        const char* data = buffer_.data();
+        size_t left = size_;
+        size_ = 0;
+        while (left > 0)
         {
-            std::cerr << "Input contains non-hex characters\n";
-            std::exit(1);
+#if defined(__unix__) || defined(__APPLE__)
+            const long written = static_cast<long>(::write(fd_, data, left));
+#else
+            const long written = ::_write(fd_, data, static_cast<unsigned>(left));
+#endif
+            if (written < 0 && errno == EINTR) continue;
+            if (written <= 0) return;
+            data += written;
+            left -= static_cast<size_t>(written);
         }
-        int input_value = (c >= '0' && c <= '9') ? (c - '0') : (c - 'a' + 10);
-        output_value = ENIGMA_C_ROTOR.at((input_value + index) % 16) ^ output_value;
-        int temp = output_value % 16;
-        // Narrowing conversion is intentional: temp is guaranteed to be in range 0-15
-        output_key.at(index) = (temp < 10) ? static_cast<char>(temp + '0') : static_cast<char>(temp - 10 + 'a');
     }
-}
 
-void enigma_c_decrypt(const std::string& input_key, std::string& output_key, size_t len)
+private:
+    int fd_;
+    bool line_buffered_;
+    size_t size_ = 0;
+    std::array<char, 4096> buffer_{};
+};
+
+constinit Console console_out(1, false);
+constinit Console console_err(2, true);
+
+// Reads one line of standard input, without its newline, after flushing any
+// prompt. Reads a byte at a time so that nothing past the line is consumed.
+// False at end of input with nothing read, like a failed std::getline().
+bool read_line(std::string& line)
 {
-    output_key.resize(len);
-    int xor_value = 0;
-    for (size_t index = 0; index < len; ++index)
+    console_out.flush();
+    line.clear();
+    while (true)
     {
-        char c = std::tolower(input_key.at(index));
-        if (!std::isxdigit(static_cast<unsigned char>(c)))
+        char c = 0;
+#if defined(__unix__) || defined(__APPLE__)
+        const long received = static_cast<long>(::read(0, &c, 1));
+#else
+        const long received = ::_read(0, &c, 1);
+#endif
+        if (received == 1)
         {
-            std::cerr << "Input contains non-hex characters\n";
-            std::exit(1);
+            if (c == '\n') return true;
+            line.push_back(c);
         }
-        int old_output = (c >= '0' && c <= '9') ? (c - '0') : (c - 'a' + 10);
-        int input_value = old_output ^ xor_value;
-        int output_value = 0;
-        for (int i = 0; i < 16; ++i)
+        else if (received < 0 && errno == EINTR)
         {
-            if (ENIGMA_C_ROTOR.at(i) == input_value)
-            {
-                output_value = i;
-                break;
-            }
+            continue;
+        }
+        else
+        {
+            return !line.empty();
         }
-        int temp = (output_value - static_cast<int>(index)) % 16;
-        if (temp < 0) temp += 16;
-        // Narrowing conversion is intentional: temp is guaranteed to be in range 0-15
-        output_key.at(index) = (temp < 10) ? static_cast<char>(temp + '0') : static_cast<char>(temp - 10 + 'a');
-        xor_value = old_output;
     }
 }
 
-bool enigma_c_check_option_key(int option, const std::string& key, const std::string& serial_number)
+// Set by --catalog FILE; the built-in catalog is used otherwise.
+std::unique_ptr<enigma::LoadedCatalog> loaded_catalog;
+
+const enigma::Catalog& catalog()
 {
-    if (key.empty())
-    {
-        std::cerr << "Key cannot be empty\n";
-        return false;
-    }
-    if (key == "bladerules") return true;
-    std::string decrypted_key;
-    enigma_c_decrypt(key, decrypted_key, 12);
-    std::string reversed_serial(10, '0'); // Fixed initialization
-    for (int i = 0; i < 10; ++i)
-    {
-        reversed_serial.at(i) = decrypted_key.at(9 - i);
-    }
-    if (reversed_serial != serial_number) return false;
-    std::string opt_str = decrypted_key.substr(10, 2);
-    int opt = std::stoi(opt_str);
-    return opt == option;
+    return loaded_catalog ? loaded_catalog->catalog() : enigma::BUILTIN_CATALOG;
 }
 
-void enigma2_c_encrypt(const std::string& input_key, std::string& output_key)
+// A product or option code printed as its fixed number of digits, e.g. 0064.
+struct PaddedCode
 {
-    if (input_key.length() != KEY_LENGTH)
-    {
-        std::cerr << "Input key length must be " << KEY_LENGTH << "\n";
-        std::exit(1);
-    }
-    output_key = input_key;
-    int checksum = 1;
-    for (size_t i = 2; i < KEY_LENGTH; ++i)
-    {
-        int temp_sum = std::isdigit(static_cast<unsigned char>(input_key.at(i)))
-                           ? (input_key.at(i) - '0')
-                           : (input_key.at(i) - 'A');
-        checksum += static_cast<int>(i) + temp_sum + (static_cast<int>(i) * temp_sum);
-    }
-    checksum = 100 - (checksum % 100);
-    output_key.at(0) = static_cast<char>((checksum % 10) + '0');
-    output_key.at(1) = static_cast<char>(((checksum / 10) % 10) + '0');
-    int running_sum = 0;
-    for (size_t i = 0; i < KEY_LENGTH; ++i)
-    {
-        int temp_sum = std::isdigit(static_cast<unsigned char>(output_key.at(i)))
-                           ? (output_key.at(i) - '0')
-                           : (output_key.at(i) - 'A');
-        if (std::isdigit(static_cast<unsigned char>(output_key.at(i))))
-        {
-            // Narrowing conversion is intentional: result is guaranteed to be in range 0-9
-            output_key.at(i) = static_cast<char>(ENIGMA2_E_ROTOR_10.at((temp_sum + MAX_CHECK_SUM - running_sum) % 10) +
-                '0');
-        }
-        else
-        {
-            // Narrowing conversion is intentional: result is guaranteed to be in range 0-25
-            output_key.at(i) = static_cast<char>('A' + ENIGMA2_E_ROTOR_26.at(
-                (temp_sum + MAX_CHECK_SUM - running_sum) % 26));
-        }
-        running_sum += static_cast<int>(i) + temp_sum + (static_cast<int>(i) * temp_sum);
-    }
+    int value;
+    int width;
+};
+
+std::string code_text(int value, int width)
+{
+    std::string text = std::to_string(value);
+    if (text.size() < static_cast<size_t>(width)) text.insert(0, static_cast<size_t>(width) - text.size(), '0');
+    return text;
 }
 
-void enigma2_c_decrypt(const std::string& input_key, std::string& output_key)
+Console& operator<<(Console& out, PaddedCode code)
 {
-    if (input_key.length() != KEY_LENGTH)
-    {
-        std::cerr << "Input key length must be " << KEY_LENGTH << "\n";
-        std::exit(1);
-    }
-    output_key = input_key;
-    int checksum = 0;
-    for (size_t i = 0; i < KEY_LENGTH; ++i)
-    {
-        int temp_sum = std::isdigit(static_cast<unsigned char>(output_key.at(i)))
-                           ? (ENIGMA2_D_ROTOR_10.at(output_key.at(i) - '0') + checksum) % 10
-                           : (ENIGMA2_D_ROTOR_26.at(output_key.at(i) - 'A') + checksum) % 26;
-        output_key.at(i) = std::isdigit(static_cast<unsigned char>(output_key.at(i)))
-                               ? static_cast<char>(temp_sum + '0')
-                               : static_cast<char>('A' + temp_sum);
-        checksum += static_cast<int>(i) + temp_sum + (static_cast<int>(i) * temp_sum);
-    }
-    checksum += 8 * (output_key.at(1) - '0');
-    if (checksum % 100 != 0) output_key.clear();
+    return out << code_text(code.value, code.width);
 }
 
-bool enigma2_c_check_option_key(int option, const std::string& key)
+// Parses a code of exactly width digits; -1 for anything else.
+int parse_code(std::string_view text, size_t width)
 {
-    if (key.empty())
-    {
-        std::cerr << "Key cannot be empty\n";
-        return false;
-    }
-    std::string decrypted_key;
-    enigma2_c_decrypt(key, decrypted_key);
-    if (decrypted_key.empty()) return false;
-    std::string opt_str = decrypted_key.substr(OPTION_LOCATION, OPTION_CODE_SIZE);
-    int opt = std::stoi(opt_str);
-    return opt == option;
+    if (text.size() != width || !enigma::detail::all_digits(text)) return -1;
+    return enigma::detail::parse_leading_int(text);
+}
+
+// Parses a count of 1 to max_digits digits into value; false for anything else.
+bool parse_count(const char* text, size_t max_digits, size_t& value)
+{
+    const std::string_view digits = text ? text : "";
+    if (digits.empty() || digits.size() > max_digits || !enigma::detail::all_digits(digits)) return false;
+    value = std::stoull(std::string(digits));
+    return true;
 }
 
 int get_menu_choice(const std::string& prompt, int min_val, int max_val)
@@ -286,29 +187,31 @@ int get_menu_choice(const std::string& prompt, int min_val, int max_val)
     std::string input;
     while (true)
     {
-        std::cout << prompt;
-        std::getline(std::cin, input);
+        console_out << prompt;
+        read_line(input);
         try
         {
             choice = std::stoi(input);
             if (choice >= min_val && choice <= max_val) return choice;
-            std::cout << "Invalid choice, please try again.\n";
+            console_out << "Invalid choice, please try again.\n";
         }
         catch (const std::exception&)
         {
-            std::cout << "Invalid input, please enter a number.\n";
+            console_out << "Invalid input, please enter a number.\n";
         }
     }
 }
 
 bool product_code_menu(std::string& product_code, std::string& option_code)
 {
-    std::cout << "\n--- Product Code Menu ---\n";
-    for (size_t i = 0; i < PRODUCT_TABLE.size(); ++i)
+    console_out << "\n--- Product Code Menu ---\n";
+    const auto menu = catalog().menu();
+    for (size_t i = 0; i < menu.size(); ++i)
     {
-        std::cout << (i + 1) << ". " << PRODUCT_TABLE.at(i).code << " - " << PRODUCT_TABLE.at(i).name << "\n";
+        console_out << (i + 1) << ". " << PaddedCode{menu[i], 4} << " - " << catalog().find_product(menu[i])->name
+            << "\n";
     }
-    std::cout << "8. Custom Product Code\n0. Exit\n";
+    console_out << "8. Custom Product Code\n0. Exit\n";
     int choice = get_menu_choice("Choose your option: ", 0, 8);
     if (choice == 0) return false;
 
@@ -316,54 +219,46 @@ bool product_code_menu(std::string& product_code, std::string& option_code)
     {
         while (true)
         {
-            std::cout << "Enter Product Code (4 digits): ";
+            console_out << "Enter Product Code (4 digits): ";
             std::string input;
-            std::getline(std::cin, input);
+            read_line(input);
             if (input.length() == 4 && std::all_of(input.begin(), input.end(), ::isdigit))
             {
                 product_code = input;
                 break;
             }
-            std::cout << "Product code must be 4 digits.\n";
+            console_out << "Product code must be 4 digits.\n";
         }
         while (true)
         {
-            std::cout << "Enter Option Code (3 digits): ";
+            console_out << "Enter Option Code (3 digits): ";
             std::string input;
-            std::getline(std::cin, input);
+            read_line(input);
             if (input.length() == 3 && std::all_of(input.begin(), input.end(), ::isdigit))
             {
                 option_code = input;
                 break;
             }
-            std::cout << "Option code must be 3 digits.\n";
+            console_out << "Option code must be 3 digits.\n";
         }
         return true;
     }
 
-    const ProductInfo& product = PRODUCT_TABLE.at(choice - 1);
-    product_code = product.code;
-    const ProductOptions* options = nullptr;
-    for (const auto& opt : PRODUCT_OPTIONS)
+    const enigma::ProductInfo& product = *catalog().find_product(menu[choice - 1]);
+    product_code = code_text(product.code, 4);
+    const auto options = catalog().options_for(product.code);
+    if (options.empty())
     {
-        if (opt.product_code == product_code)
-        {
-            options = &opt;
-            break;
-        }
-    }
-    if (!options || options->options.empty())
-    {
-        std::cout << "No options defined for " << product.name << ".\n";
+        console_out << "No options defined for " << product.name << ".\n";
         return false;
     }
 
-    std::cout << "\n--- Options for " << product.name << " ---\n";
-    for (size_t i = 0; i < options->options.size(); ++i)
+    console_out << "\n--- Options for " << product.name << " ---\n";
+    for (size_t i = 0; i < options.size(); ++i)
     {
-        std::cout << (i + 1) << ". " << options->options.at(i).code << " - " << options->options.at(i).desc << "\n";
+        console_out << (i + 1) << ". " << PaddedCode{options[i].code, 3} << " - " << options[i].desc << "\n";
     }
-    std::cout << "8. Custom Option Code\n0. Exit\n";
+    console_out << "8. Custom Option Code\n0. Exit\n";
     int opt_choice = get_menu_choice("Choose your option: ", 0, 8);
     if (opt_choice == 0) return false;
 
@@ -371,33 +266,41 @@ bool product_code_menu(std::string& product_code, std::string& option_code)
     {
         while (true)
         {
-            std::cout << "Enter Option Code (3 digits): ";
+            console_out << "Enter Option Code (3 digits): ";
             std::string input;
-            std::getline(std::cin, input);
+            read_line(input);
             if (input.length() == 3 && std::all_of(input.begin(), input.end(), ::isdigit))
             {
                 option_code = input;
                 break;
             }
-            std::cout << "Option code must be 3 digits.\n";
+            console_out << "Option code must be 3 digits.\n";
         }
     }
     else
     {
-        option_code = options->options.at(opt_choice - 1).code;
+        option_code = code_text(options[opt_choice - 1].code, 3);
     }
     return true;
 }
 
-void print_option_key(const std::string& option_key)
+// Reports a failed key operation the way the CLI always has: message on stderr, exit status 1.
+void exit_on_error(enigma::Status status)
+{
+    if (status == enigma::Status::ok) return;
+    console_err << enigma::status_message(status) << "\n";
+    std::exit(1);
+}
+
+void print_option_key(std::string_view option_key)
 {
-    std::cout << "Option Key:";
+    console_out << "Option Key:";
     for (size_t i = 0; i < option_key.length(); ++i)
     {
-        if (i % 4 == 0) std::cout << " ";
-        std::cout << option_key.at(i);
+        if (i % 4 == 0) console_out << " ";
+        console_out << option_key.at(i);
     }
-    std::cout << "\n";
+    console_out << "\n";
 }
 
 void calculate_nettool_option_key(std::string& serial_number, int option_number)
@@ -406,44 +309,37 @@ void calculate_nettool_option_key(std::string& serial_number, int option_number)
     {
         while (true)
         {
-            std::cout << "Enter Serial Number (10 digits): ";
-            std::getline(std::cin, serial_number);
-            if (serial_number.length() == SERIAL_NUMBER_SIZE_ENIGMAC && std::all_of(
+            console_out << "Enter Serial Number (10 digits): ";
+            read_line(serial_number);
+            if (serial_number.length() == enigma::SERIAL_NUMBER_SIZE_ENIGMAC && std::all_of(
                 serial_number.begin(), serial_number.end(), ::isdigit))
                 break;
-            std::cout << "Serial number must be 10 digits.\n";
+            console_out << "Serial number must be 10 digits.\n";
         }
     }
-    if (serial_number.length() != SERIAL_NUMBER_SIZE_ENIGMAC || !std::all_of(
+    if (serial_number.length() != enigma::SERIAL_NUMBER_SIZE_ENIGMAC || !std::all_of(
         serial_number.begin(), serial_number.end(), ::isdigit))
     {
-        std::cerr << "Serial number must be 10 digits\n";
+        console_err << "Serial number must be 10 digits\n";
         std::exit(1);
     }
 
     if (option_number < 0)
     {
-        std::cout << "\nNetTool Options: 0=Inline 1=Reports/Ping 3=Personal 4=VoIP 5=SwitchWizard\n";
+        console_out << "\nNetTool Options: 0=Inline 1=Reports/Ping 3=Personal 4=VoIP 5=SwitchWizard\n";
         std::string input;
-        std::cout << "Enter Option Number (1 digit): ";
-        std::getline(std::cin, input);
+        console_out << "Enter Option Number (1 digit): ";
+        read_line(input);
         option_number = (input.length() > 0 && std::isdigit(static_cast<unsigned char>(input.at(0))))
                             ? (input.at(0) - '0')
                             : 0;
     }
     if (option_number < 0 || option_number > 9) option_number = 0;
 
-    std::string input_key = serial_number + std::to_string(option_number) + "0";
-    std::string reversed_key(12, '0');
-    for (int i = 0; i < 12; ++i)
-    {
-        reversed_key.at(i) = input_key.at(11 - i);
-    }
-
-    std::cout << "\nEncrypting with Enigma 1...\n";
-    std::string output_key;
-    enigma_c_encrypt(reversed_key, output_key, 12);
-    print_option_key(output_key);
+    console_out << "\nEncrypting with Enigma 1...\n";
+    const auto result = enigma::nettool_option_key(serial_number, option_number);
+    exit_on_error(result.status);
+    print_option_key(result.view());
 }
 
 void check_nettool_option_key(std::string& option_key)
@@ -451,49 +347,49 @@ void check_nettool_option_key(std::string& option_key)
     std::string serial_number;
     while (true)
     {
-        std::cout << "Enter Serial Number (10 digits): ";
-        std::getline(std::cin, serial_number);
-        if (serial_number.length() == SERIAL_NUMBER_SIZE_ENIGMAC && std::all_of(
+        console_out << "Enter Serial Number (10 digits): ";
+        read_line(serial_number);
+        if (serial_number.length() == enigma::SERIAL_NUMBER_SIZE_ENIGMAC && std::all_of(
             serial_number.begin(), serial_number.end(), ::isdigit))
             break;
-        std::cout << "Serial number must be 10 digits.\n";
+        console_out << "Serial number must be 10 digits.\n";
     }
 
     if (option_key.empty())
     {
         while (true)
         {
-            std::cout << "Enter Option Key (12 hex digits): ";
-            std::getline(std::cin, option_key);
+            console_out << "Enter Option Key (12 hex digits): ";
+            read_line(option_key);
             if (option_key.length() == 12 && std::all_of(option_key.begin(), option_key.end(), [](char c)
             {
                 return std::isxdigit(static_cast<unsigned char>(c));
             }))
                 break;
-            std::cout << "Option key must be 12 hex digits.\n";
+            console_out << "Option key must be 12 hex digits.\n";
         }
     }
     if (option_key.length() != 12 || !std::all_of(option_key.begin(), option_key.end(),
                                                   [](char c) { return std::isxdigit(static_cast<unsigned char>(c)); }))
     {
-        std::cerr << "Option key must be 12 hex digits\n";
+        console_err << "Option key must be 12 hex digits\n";
         std::exit(1);
     }
 
     std::string input;
-    std::cout << "Enter Option Number (1 digit): ";
-    std::getline(std::cin, input);
+    console_out << "Enter Option Number (1 digit): ";
+    read_line(input);
     int option_number = (input.length() > 0 && std::isdigit(static_cast<unsigned char>(input.at(0))))
                             ? (input.at(0) - '0')
                             : 0;
     if (option_number < 0 || option_number > 9) option_number = 0;
 
-    std::cout << "\nEnigmaC::checkOptionKey()...\n";
-    std::cout << "serialNum: " << serial_number << "\n";
-    std::cout << "optionKey: " << option_key << "\n";
-    std::cout << "optionNum: 0x" << std::hex << option_number << std::dec << "\n";
-    bool result = enigma_c_check_option_key(option_number, option_key, serial_number);
-    std::cout << "Option " << (result ? "valid" : "invalid") << "\n";
+    console_out << "\nEnigmaC::checkOptionKey()...\n";
+    console_out << "serialNum: " << serial_number << "\n";
+    console_out << "optionKey: " << option_key << "\n";
+    console_out << "optionNum: 0x" << option_number << "\n"; // 0-9, the same in hex
+    bool result = enigma::enigma_c_check_option_key(option_number, option_key, serial_number);
+    console_out << "Option " << (result ? "valid" : "invalid") << "\n";
 }
 
 void calculate_enigma2_option_key(std::string& serial_number, int option_number, int product_code, bool assume_escope)
@@ -515,22 +411,22 @@ void calculate_enigma2_option_key(std::string& serial_number, int option_number,
     {
         while (true)
         {
-            std::cout << "Enter Serial Number (7 digits): ";
-            std::getline(std::cin, serial_number);
-            if (serial_number.length() == SERIAL_NUMBER_SIZE_ENIGMA2 && std::all_of(
+            console_out << "Enter Serial Number (7 digits): ";
+            read_line(serial_number);
+            if (serial_number.length() == enigma::SERIAL_NUMBER_SIZE_ENIGMA2 && std::all_of(
                 serial_number.begin(), serial_number.end(), ::isdigit))
                 break;
-            std::cout << "Serial number must be 7 digits.\n";
+            console_out << "Serial number must be 7 digits.\n";
         }
     }
-    if (serial_number.length() != SERIAL_NUMBER_SIZE_ENIGMA2 || !std::all_of(
+    if (serial_number.length() != enigma::SERIAL_NUMBER_SIZE_ENIGMA2 || !std::all_of(
         serial_number.begin(), serial_number.end(), ::isdigit))
     {
-        std::cerr << "Serial number must be 7 digits\n";
+        console_err << "Serial number must be 7 digits\n";
         std::exit(1);
     }
 
-    std::cout << "SerialNum= " << serial_number << "\n";
+    console_out << "SerialNum= " << serial_number << "\n";
 
     if (product_code_str.empty() || option_str.empty() || !assume_escope)
     {
@@ -538,7 +434,7 @@ void calculate_enigma2_option_key(std::string& serial_number, int option_number,
         std::string opt_code;
         if (!product_code_menu(prod_code, opt_code))
         {
-            std::cout << "Operation cancelled.\n";
+            console_out << "Operation cancelled.\n";
             return;
         }
         product_code_str = prod_code;
@@ -547,10 +443,10 @@ void calculate_enigma2_option_key(std::string& serial_number, int option_number,
 
     std::string input_key = "00" + product_code_str + serial_number + option_str;
 
-    std::cout << "\nEncrypting with Enigma 2...\n";
-    std::string output_key;
-    enigma2_c_encrypt(input_key, output_key);
-    print_option_key(output_key);
+    console_out << "\nEncrypting with Enigma 2...\n";
+    std::array<char, enigma::KEY_LENGTH> output_key{};
+    exit_on_error(enigma::enigma2_c_encrypt(input_key, output_key));
+    print_option_key(std::string_view(output_key.data(), output_key.size()));
 }
 
 void check_enigma2_option_key(std::string& option_key)
@@ -559,8 +455,8 @@ void check_enigma2_option_key(std::string& option_key)
     {
         while (true)
         {
-            std::cout << "Enter Option Key (16 characters): ";
-            std::getline(std::cin, option_key);
+            console_out << "Enter Option Key (16 characters): ";
+            read_line(option_key);
             if (option_key.length() == 16 && std::all_of(option_key.begin(), option_key.end(), [](char c)
             {
                 return std::isalnum(static_cast<unsigned char>(c)) && (
@@ -568,7 +464,7 @@ void check_enigma2_option_key(std::string& option_key)
                         'A' && c <= 'Z'));
             }))
                 break;
-            std::cout << "Option key must be 16 alphanumeric characters.\n";
+            console_out << "Option key must be 16 alphanumeric characters.\n";
         }
     }
     if (option_key.length() != 16 || !std::all_of(option_key.begin(), option_key.end(), [](char c)
@@ -578,46 +474,30 @@ void check_enigma2_option_key(std::string& option_key)
                 <= 'Z'));
     }))
     {
-        std::cerr << "Option key must be 16 alphanumeric characters\n";
+        console_err << "Option key must be 16 alphanumeric characters\n";
         std::exit(1);
     }
 
-    std::cout << "Decrypting with Enigma 2...\n";
-    std::string decrypted_key;
-    enigma2_c_decrypt(option_key, decrypted_key);
-    if (decrypted_key.empty())
-    {
-        std::cerr << "Decryption failed: invalid checksum\n";
-        std::exit(1);
-    }
+    console_out << "Decrypting with Enigma 2...\n";
+    enigma::DecodedKey decoded;
+    exit_on_error(enigma::enigma2_c_decrypt(option_key, decoded));
 
-    std::string product_code = decrypted_key.substr(PRODUCT_LOCATION, PRODUCT_CODE_SIZE);
-    std::cout << "Product Code: " << product_code << " -> ";
-    bool found = false;
-    for (const auto& product : PRODUCT_TABLE)
-    {
-        if (product.code == product_code)
-        {
-            std::cout << product.name << "\n";
-            found = true;
-            break;
-        }
-    }
-    if (!found) std::cout << "Unknown\n";
-    std::string serial = decrypted_key.substr(SERIAL_LOCATION, SERIAL_NUMBER_SIZE_ENIGMA2);
-    std::cout << "SerialNumber: " << serial << "\n";
-    std::string option = decrypted_key.substr(OPTION_LOCATION, OPTION_CODE_SIZE);
-    std::cout << "OptionNumber: " << option << "\n";
+    const std::string_view layout = decoded.view();
+    console_out << "Product Code: " << layout.substr(enigma::PRODUCT_LOCATION, enigma::PRODUCT_CODE_SIZE) << " -> ";
+    const enigma::ProductInfo* product = catalog().find_product(decoded.product());
+    console_out << (product ? product->name : "Unknown") << "\n";
+    console_out << "SerialNumber: " << decoded.serial() << "\n";
+    console_out << "OptionNumber: " << layout.substr(enigma::OPTION_LOCATION, enigma::OPTION_CODE_SIZE) << "\n";
 }
 
 bool main_menu()
 {
-    std::cout << "\n--- Enigma " << SOFTWARE_VERSION << " Main Menu ---\n";
-    std::cout << "1. Generate NetTool 10/100 Option Key\n";
-    std::cout << "2. Check NetTool 10/100 Option Key\n";
-    std::cout << "3. Generate Option Key for Other Fluke Products\n";
-    std::cout << "4. Decrypt Option Key for Other Fluke Products\n";
-    std::cout << "0. Exit\n";
+    console_out << "\n--- Enigma " << SOFTWARE_VERSION << " Main Menu ---\n";
+    console_out << "1. Generate NetTool 10/100 Option Key\n";
+    console_out << "2. Check NetTool 10/100 Option Key\n";
+    console_out << "3. Generate Option Key for Other Fluke Products\n";
+    console_out << "4. Decrypt Option Key for Other Fluke Products\n";
+    console_out << "0. Exit\n";
 
     int choice = get_menu_choice("Choose your option: ", 0, 4);
     if (choice == 0) return false;
@@ -639,14 +519,14 @@ bool main_menu()
         check_enigma2_option_key(option_key);
         return true;
     default:
-        std::cerr << "Unexpected choice value: " << choice << "\n";
+        console_err << "Unexpected choice value: " << choice << "\n";
         return false;
     }
 }
 
 void print_help(const char* prog_name)
 {
-    std::cout << "Enigma " << SOFTWARE_VERSION << " - Fluke option key utility\n"
+    console_out << "Enigma " << SOFTWARE_VERSION << " - Fluke option key utility\n"
         << "Usage:\n"
         << "  " << prog_name << " [mode] [args...]\n\n"
         << "Modes:\n"
@@ -654,55 +534,348 @@ void print_help(const char* prog_name)
         << "  -x OPTION_KEY           Check NetTool option key\n"
         << "  -e SERIAL [OPTION [PRODUCT]]  Generate EtherScope/MetroScope option key\n"
         << "  -l SERIAL OPTION        Generate LinkRunner Pro option key\n"
-        << "  -d OPTION_KEY           Decrypt EtherScope/MetroScope option key\n\n"
+        << "  -d OPTION_KEY           Decrypt EtherScope/MetroScope option key\n"
+        << "  -n|-e|-l --range START END OPTION [PRODUCT]\n"
+        << "                          Print SERIAL,KEY for every serial from START to END\n"
+        << "                          (PRODUCT for -e and -l only)\n"
+        << "  --batch [FILE] [--jobs N] [--affinity] [--cache N] [--format text|binary]\n"
+        << "          [--output PATH [--direct]] [--stats]\n"
+        << "                          Generate one key per MODE,SERIAL,OPTION[,PRODUCT] line\n"
+        << "                          of FILE (default: stdin); MODE is n, e or l.\n"
+        << "                          --jobs N uses N threads (0 = all cores); --affinity pins\n"
+        << "                          them to CPUs node by node (Linux); --cache N keeps\n"
+        << "                          up to N recent keys per thread for repeated records;\n"
+        << "                          --format binary writes 32-byte records; --direct writes\n"
+        << "                          PATH with O_DIRECT, bypassing the page cache; --stats\n"
+        << "                          prints counters and stage latencies to stderr\n"
+        << "                          (builds with ENIGMA_STATS)\n"
+        << "  --verify-batch [FILE] [--jobs N] [--affinity] [--format tsv|json] [--stats]\n"
+        << "                          Check one KEY,SERIAL,OPTION[,PRODUCT] line per key;\n"
+        << "                          prints KEY, RESULT and the decoded fields\n"
+#ifdef ENIGMA_HAVE_SERVER
+        << "  --serve unix:PATH|tcp:HOST:PORT [--jobs N] [--affinity] [--cache N]\n"
+        << "                          Answer GEN/VERIFY/DECODE request lines on a socket\n"
+        << "                          with N event-loop threads (0 = all cores; --affinity\n"
+        << "                          pins them as for --batch), caching up\n"
+        << "                          to N GEN/DECODE results per thread; GET /metrics\n"
+        << "                          over HTTP returns Prometheus metrics (ENIGMA_STATS)\n"
+#endif
+        << "\n"
         << "Utility flags:\n"
         << "  -h, --help, -?          Show this help text\n"
         << "  -V, --version           Show version information\n"
         << "  --list-products         List known product codes\n"
-        << "  --list-options CODE     List options for a product code\n\n"
+        << "  --list-options CODE     List options for a product code\n"
+        << "  --catalog FILE          Use the product catalog in JSON FILE (before any mode)\n\n"
         << "Run without arguments to launch the interactive menu.\n";
 }
 
 void print_version()
 {
-    std::cout << "Enigma " << SOFTWARE_VERSION << " - Fluke option key utility\n";
+    console_out << "Enigma " << SOFTWARE_VERSION << " - Fluke option key utility\n";
 }
 
 void list_products()
 {
-    std::cout << "Known Product Codes:\n";
-    for (const auto& product : PRODUCT_TABLE)
+    console_out << "Known Product Codes:\n";
+    for (const uint16_t code : catalog().menu())
     {
-        std::cout << "  " << product.code << " - " << product.name << "\n";
+        console_out << "  " << PaddedCode{code, 4} << " - " << catalog().find_product(code)->name << "\n";
     }
 }
 
 void list_options(const std::string& product_code)
 {
-    for (const auto& po : PRODUCT_OPTIONS)
+    const int code = parse_code(product_code, enigma::PRODUCT_CODE_SIZE);
+    const auto options = catalog().options_for(code);
+    if (options.empty())
+    {
+        console_err << "No options defined for product code " << product_code << "\n";
+        return;
+    }
+    const enigma::ProductInfo* product = catalog().find_product(code);
+    console_out << "Options for " << product_code << " (" << (product ? product->name : "Unknown") << "):\n";
+    for (const auto& option : options)
+    {
+        console_out << "  " << PaddedCode{option.code, 3} << " - " << option.desc << "\n";
+    }
+}
+
+// Parses "--batch [FILE] [--jobs N] [--cache N] [--format text|binary]" or "--verify-batch [FILE] [--jobs N]
+// [--format tsv|json]", either with [--affinity] [--output PATH [--direct]] (arguments after the mode flag), and runs
+// the batch engine.
+int run_batch_mode(int argc, char* argv[], enigma::BatchTask task)
+{
+    const char* path = "-";
+    const char* output_path = nullptr;
+    bool direct = false;
+    bool print_stats = false;
+    enigma::BatchOptions options;
+    options.task = task;
+    for (int i = 0; i < argc; ++i)
     {
-        if (po.product_code == product_code)
+        const std::string_view arg(argv[i]);
+        if (arg == "--jobs" || arg == "-j")
         {
-            std::string product_name = "Unknown";
-            for (const auto& p : PRODUCT_TABLE)
+            size_t jobs = 0;
+            if (i + 1 >= argc || !parse_count(argv[i + 1], 4, jobs))
             {
-                if (p.code == product_code)
-                {
-                    product_name = p.name;
-                    break;
-                }
+                console_err << "Error: --jobs requires a thread count (0 = all cores)\n";
+                return 1;
             }
-            std::cout << "Options for " << product_code << " (" << product_name << "):\n";
-            for (const auto& opt : po.options)
+            options.jobs = static_cast<unsigned>(jobs);
+            ++i;
+        }
+        else if (arg == "--cache" && task == enigma::BatchTask::generate)
+        {
+            if (i + 1 >= argc || !parse_count(argv[i + 1], 9, options.cache_entries))
             {
-                std::cout << "  " << opt.code << " - " << opt.desc << "\n";
+                console_err << "Error: --cache requires an entry count\n";
+                return 1;
             }
-            return;
+            ++i;
+        }
+        else if (arg == "--format" && task == enigma::BatchTask::verify)
+        {
+            const std::string_view format = i + 1 < argc ? argv[++i] : "";
+            if (format != "tsv" && format != "json")
+            {
+                console_err << "Error: --format must be tsv or json\n";
+                return 1;
+            }
+            options.format = format == "json" ? enigma::VerifyFormat::json : enigma::VerifyFormat::tsv;
+        }
+        else if (arg == "--format")
+        {
+            const std::string_view format = i + 1 < argc ? argv[++i] : "";
+            if (format != "text" && format != "binary")
+            {
+                console_err << "Error: --format must be text or binary\n";
+                return 1;
+            }
+            options.output = format == "binary" ? enigma::KeyFormat::binary : enigma::KeyFormat::text;
+        }
+        else if (arg == "--output")
+        {
+            if (i + 1 >= argc)
+            {
+                console_err << "Error: --output requires a path\n";
+                return 1;
+            }
+            output_path = argv[++i];
         }
+        else if (arg == "--direct")
+        {
+            direct = true;
+        }
+        else if (arg == "--affinity")
+        {
+            options.affinity = true;
+        }
+        else if (arg == "--stats")
+        {
+            if (!enigma::stats::enabled)
+            {
+                console_err << "Error: --stats needs a build configured with -DENIGMA_STATS=ON\n";
+                return 1;
+            }
+            print_stats = true;
+        }
+        else
+        {
+            path = argv[i];
+        }
+    }
+
+    if (direct && !output_path)
+    {
+        console_err << "Error: --direct requires --output PATH\n";
+        return 1;
+    }
+    std::unique_ptr<enigma::OutputFile> output;
+    if (output_path)
+    {
+        std::string error;
+        output = enigma::OutputFile::open(output_path, direct, error);
+        if (!output)
+        {
+            console_err << "Error: cannot create " << output_path << ": " << error << "\n";
+            return 1;
+        }
+    }
+
+    const bool from_stdin = std::string_view(path) == "-";
+    std::optional<enigma::BatchStats> result;
+    if (output)
+    {
+        result = from_stdin ? enigma::run_batch(stdin, *output, options)
+                            : enigma::run_batch_file(path, *output, options);
+    }
+    else
+    {
+        result = from_stdin ? enigma::run_batch(stdin, stdout, options)
+                            : enigma::run_batch_file(path, stdout, options);
+    }
+    if (!result)
+    {
+        console_err << "Error: cannot open " << path << "\n";
+        return 1;
+    }
+    enigma::BatchStats& stats = *result;
+    if (output && !output->close()) stats.io_error = true;
+
+    if (stats.io_error)
+    {
+        console_err << "Error: I/O failure during batch processing\n";
+        return 1;
+    }
+    if (print_stats)
+    {
+        std::string summary;
+        enigma::stats::append_summary(summary, enigma::stats::snapshot());
+        console_err << summary;
+    }
+    if (options.cache_entries > 0)
+    {
+        console_err << "Cache: " << stats.cache_hits << " hits, " << stats.cache_misses << " misses\n";
+    }
+    if (stats.errors > 0)
+    {
+        console_err << stats.errors << " of " << stats.records
+            << (task == enigma::BatchTask::verify ? " keys invalid\n" : " records failed\n");
+        return 1;
+    }
+    return 0;
+}
+
+// Writes "SERIAL,KEY" lines for every serial from first to last to out.
+template <typename Range>
+bool write_range(Range& range, uint64_t last, size_t serial_digits, enigma::OutputFile& out)
+{
+    std::array<char, 32> line{};
+    const std::string_view key = range.key();
+    line[serial_digits] = ',';
+    line[serial_digits + 1 + key.size()] = '\n';
+    const std::string_view text(line.data(), serial_digits + key.size() + 2);
+    while (true)
+    {
+        enigma::format_serial(range.serial(), serial_digits, line);
+        std::copy(range.key().begin(), range.key().end(), line.begin() + serial_digits + 1);
+        if (!out.write(text)) return false;
+        if (range.serial() == last) return true;
+        (void)range.advance();
     }
-    std::cerr << "No options defined for product code " << product_code << "\n";
 }
 
+// Runs "-n|-e|-l --range START END OPTION [PRODUCT]" (arguments after --range).
+int run_range_mode(int argc, char* argv[], bool nettool, int product_code)
+{
+    if (argc < 3 || argc > (nettool ? 3 : 4))
+    {
+        console_err << "Error: --range requires START END OPTION" << (nettool ? "" : " [PRODUCT]") << "\n";
+        return 1;
+    }
+    const size_t serial_digits = nettool ? enigma::SERIAL_NUMBER_SIZE_ENIGMAC : enigma::SERIAL_NUMBER_SIZE_ENIGMA2;
+    uint64_t first = 0;
+    uint64_t last = 0;
+    if (std::strlen(argv[0]) != serial_digits || std::strlen(argv[1]) != serial_digits ||
+        enigma::pack_serial(argv[0], first) != enigma::Status::ok ||
+        enigma::pack_serial(argv[1], last) != enigma::Status::ok)
+    {
+        console_err << "Error: " << enigma::status_message(enigma::Status::invalid_serial) << "\n";
+        return 1;
+    }
+    if (last < first)
+    {
+        console_err << "Error: --range END must not be below START\n";
+        return 1;
+    }
+    const auto parse_number = [](const char* text)
+    {
+        const size_t length = std::strlen(text);
+        return parse_code(text, length <= enigma::PRODUCT_CODE_SIZE ? length : 0);
+    };
+    const int option = parse_number(argv[2]);
+    if (argc > 3) product_code = parse_number(argv[3]);
+
+    enigma::OutputFile out(fileno(stdout));
+    bool written = false;
+    if (nettool)
+    {
+        enigma::NetToolKeyRange range;
+        exit_on_error(range.start(first, option));
+        written = write_range(range, last, serial_digits, out);
+    }
+    else
+    {
+        enigma::Enigma2KeyRange range;
+        exit_on_error(range.start(product_code, first, option));
+        written = write_range(range, last, serial_digits, out);
+    }
+    if (!out.close() || !written)
+    {
+        console_err << "Error: I/O failure during range output\n";
+        return 1;
+    }
+    return 0;
+}
+
+#ifdef ENIGMA_HAVE_SERVER
+enigma::Server* active_server = nullptr;
+
+extern "C" void stop_server(int)
+{
+    if (active_server) active_server->stop();
+}
+
+// Runs "--serve ADDRESS [--jobs N] [--affinity] [--cache N]" (arguments after --serve) until SIGINT or SIGTERM.
+int run_server_mode(int argc, char* argv[])
+{
+    enigma::ServerOptions options{argv[0], &catalog()};
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string_view arg(argv[i]);
+        if (arg == "--affinity")
+        {
+            options.affinity = true;
+            continue;
+        }
+        size_t value = 0;
+        const bool jobs = arg == "--jobs" || arg == "-j";
+        if ((!jobs && arg != "--cache") || i + 1 >= argc || !parse_count(argv[i + 1], jobs ? 4 : 9, value))
+        {
+            console_err << "Error: --serve takes ADDRESS [--jobs N] (0 = all cores) [--affinity] [--cache N]\n";
+            return 1;
+        }
+        if (jobs)
+        {
+            options.threads = static_cast<unsigned>(value);
+        }
+        else
+        {
+            options.cache_entries = value;
+        }
+        ++i;
+    }
+    std::string error;
+    const auto server = enigma::Server::listen(options, error);
+    if (!server)
+    {
+        console_err << "Error: " << error << "\n";
+        return 1;
+    }
+    active_server = server.get();
+    std::signal(SIGINT, stop_server);
+    std::signal(SIGTERM, stop_server);
+    std::signal(SIGPIPE, SIG_IGN);
+    console_out << "Listening on " << server->address() << "\n";
+    console_out.flush();
+    server->run();
+    active_server = nullptr;
+    return 0;
+}
+#endif
+
 int main(int argc, char* argv[])
 {
     std::string serial_number;
@@ -712,6 +885,26 @@ int main(int argc, char* argv[])
     int product_code = -1;
     bool assume_escope = false;
 
+    // Global catalog override, taken off the front of the arguments.
+    if (argc > 1 && std::string_view(argv[1]) == "--catalog")
+    {
+        if (argc < 3)
+        {
+            console_err << "Error: --catalog requires a file\n";
+            return 1;
+        }
+        std::string error;
+        loaded_catalog = enigma::LoadedCatalog::load(argv[2], error);
+        if (!loaded_catalog)
+        {
+            console_err << "Error: " << error << "\n";
+            return 1;
+        }
+        argv[2] = argv[0];
+        argv += 2;
+        argc -= 2;
+    }
+
     if (argc > 1)
     {
         std::string arg1(argv[1]);
@@ -747,11 +940,36 @@ int main(int argc, char* argv[])
             }
             else
             {
-                std::cerr << "Error: --list-options requires a product code\n";
+                console_err << "Error: --list-options requires a product code\n";
                 return 1;
             }
         }
 
+        // Batch generation
+        if (arg1 == "--batch")
+        {
+            return run_batch_mode(argc - 2, argv + 2, enigma::BatchTask::generate);
+        }
+
+#ifdef ENIGMA_HAVE_SERVER
+        // Key service
+        if (arg1 == "--serve")
+        {
+            if (argc < 3)
+            {
+                console_err << "Error: --serve requires unix:PATH or tcp:HOST:PORT\n";
+                return 1;
+            }
+            return run_server_mode(argc - 2, argv + 2);
+        }
+#endif
+
+        // Batch verification
+        if (arg1 == "--verify-batch")
+        {
+            return run_batch_mode(argc - 2, argv + 2, enigma::BatchTask::verify);
+        }
+
         // Mode flags
         if (arg1 == "-n")
         {
@@ -786,12 +1004,18 @@ int main(int argc, char* argv[])
             }
             catch (const std::exception&)
             {
-                std::cerr << "Unknown option: " << arg1 << "\n";
+                console_err << "Unknown option: " << arg1 << "\n";
                 print_help(argv[0]);
                 return 1;
             }
         }
 
+        // Consecutive serials
+        if (argc > 2 && std::string_view(argv[2]) == "--range" && (selection == 1 || selection == 3))
+        {
+            return run_range_mode(argc - 3, argv + 3, selection == 1, product_code);
+        }
+
         if (argc > 2)
         {
             if (selection == 4 || selection == 2)
@@ -830,7 +1054,7 @@ int main(int argc, char* argv[])
         check_enigma2_option_key(option_key);
         break;
     default:
-        std::cerr << "Invalid selection value: " << selection << "\n";
+        console_err << "Invalid selection value: " << selection << "\n";
         return 1;
     }
     return 0;
@@ -0,0 +1,48 @@
+//
+// CPU placement for pinned worker threads.
+//
+// Threads pinned in affinity_cpus() order fill one NUMA node before the
+// next, so threads with adjacent indices, which the thread pool starts on
+// adjacent slices of work, share a node. Memory a pinned thread writes
+// first lands on its own node (Linux first-touch placement), so buffers
+// that a thread allocates and fills for itself stay local without a NUMA
+// library.
+//
+// Pinning is implemented on Linux. Elsewhere affinity_cpus() is empty and
+// the pinning calls do nothing.
+//
+
+#ifndef ENIGMA_AFFINITY_H
+#define ENIGMA_AFFINITY_H
+
+#include <vector>
+
+namespace enigma
+{
+// CPUs this process may run on, grouped by NUMA node: node 0's CPUs first,
+// each node's in ascending order. One group when the node layout is
+// unknown; empty where pinning is unsupported.
+std::vector<unsigned> affinity_cpus();
+
+// Pins the calling thread to cpu. Returns false if that is unsupported or
+// refused.
+bool pin_current_thread(unsigned cpu) noexcept;
+
+// Pins the calling thread to cpu for the object's lifetime, then restores
+// the thread's previous affinity.
+class ScopedPin
+{
+public:
+    explicit ScopedPin(unsigned cpu) noexcept;
+    ~ScopedPin();
+
+    ScopedPin(const ScopedPin&) = delete;
+    ScopedPin& operator=(const ScopedPin&) = delete;
+
+private:
+    bool pinned_ = false;
+    alignas(8) unsigned char saved_[128]; // the previous cpu_set_t
+};
+} // namespace enigma
+
+#endif //ENIGMA_AFFINITY_H
@@ -0,0 +1,265 @@
+//
+// Batch key generation on top of enigma_core.
+//
+// A batch is newline-separated text, one record per line:
+//
+//     MODE,SERIAL,OPTION[,PRODUCT]
+//
+// Fields may be separated by commas, tabs or spaces. MODE is n (NetTool,
+// 10-digit serial, option 0-9), e (EtherScope, product defaults to 6963) or
+// l (LinkRunner Pro, product defaults to 7001). Blank lines, lines starting
+// with '#' and a header on the first line (first field exactly "mode" or
+// "MODE") are skipped. Every other record produces exactly one output line:
+// the key, or "error: <message>".
+//
+// Verification batches use the same framing with KEY,SERIAL,OPTION[,PRODUCT]
+// records. A 12-digit hex KEY is checked as a NetTool (EnigmaC) key, a
+// 16-character KEY as an Enigma2C key; each record produces one TSV line
+//
+//     KEY  RESULT  PRODUCT  SERIAL  OPTION
+//
+// (tab-separated, decoded fields empty when the key cannot be decoded) or
+// one JSON object per line. RESULT is "valid" or one of the reasons from
+// verify_outcome_name().
+//
+// Generation can instead write fixed-width binary records for bulk loading
+// (KeyFormat::binary): a 32-byte BinaryKeyHeader, then one 32-byte
+// BinaryKeyRecord per record in input order, errors included. Integers are
+// little-endian and every field sits at its natural alignment, so the file
+// maps straight onto the structs (or a NumPy/Arrow fixed-width schema) on
+// common hosts. The record count is (file size - 32) / 32.
+//
+
+#ifndef ENIGMA_BATCH_H
+#define ENIGMA_BATCH_H
+
+#include "enigma_key_cache.h"
+#include "enigma_v300_pure_cpp.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace enigma
+{
+struct BatchStats
+{
+    size_t records = 0; // records that produced an output line
+    size_t errors = 0;  // of which were "error: ..." lines
+    size_t cache_hits = 0;   // keys served from a KeyCache
+    size_t cache_misses = 0; // keys encrypted and added to a KeyCache
+    bool io_error = false;
+};
+
+enum class BatchTask
+{
+    generate, // MODE,SERIAL,OPTION[,PRODUCT] records to keys
+    verify,   // KEY,SERIAL,OPTION[,PRODUCT] records to verification results
+};
+
+enum class VerifyFormat
+{
+    tsv,
+    json, // JSON Lines: one object per record
+};
+
+enum class KeyFormat
+{
+    text,   // one key or "error: <message>" line per record
+    binary, // BinaryKeyHeader, then one BinaryKeyRecord per record
+};
+
+struct BinaryKeyHeader
+{
+    std::array<char, 8> magic{'E', 'N', 'I', 'G', 'M', 'A', 'K', 'B'};
+    uint32_t version = 1;
+    uint32_t record_size = 32;
+    std::array<uint8_t, 16> reserved{};
+};
+
+struct BinaryKeyRecord
+{
+    uint64_t serial = 0;  // the SERIAL field's value; 0 when it is not 1-16 digits
+    uint16_t product = 0; // Enigma2C product code; 0 for NetTool
+    uint16_t option = 0;
+    char mode = 0;        // 'n', 'e' or 'l'; 0 when the record has no valid mode
+    uint8_t status = 0;   // static_cast<uint8_t>(Status); key is all zero unless Status::ok
+    std::array<uint8_t, 2> reserved{};
+    std::array<uint8_t, KEY_LENGTH> key{}; // PackedNetToolKey::nibbles (8 bytes) or PackedEnigma2Key::symbols
+};
+
+static_assert(sizeof(BinaryKeyHeader) == 32 && sizeof(BinaryKeyRecord) == 32);
+
+struct BatchOptions
+{
+    unsigned jobs = 1; // generation threads; 0 = one per hardware thread
+    BatchTask task = BatchTask::generate;
+    VerifyFormat format = VerifyFormat::tsv; // output of BatchTask::verify
+    size_t cache_entries = 0;                // per-thread KeyCache for BatchTask::generate; 0 = none
+    KeyFormat output = KeyFormat::text;      // output of BatchTask::generate
+    bool affinity = false;                   // pin the generation threads to CPUs, grouped by NUMA node
+};
+
+// Whether the input given to generate_batch() or verify_batch() starts the
+// batch, in which case its first line may be the header. Callers that split
+// a batch into pieces pass continuation for all but the first.
+enum class BatchPosition
+{
+    start,
+    continuation,
+};
+
+enum class VerifyOutcome
+{
+    valid,
+    malformed_record, // not KEY,SERIAL,OPTION[,PRODUCT], or a non-numeric option or product
+    invalid_key,      // wrong length, or characters the algorithm does not use
+    checksum_mismatch,
+    product_mismatch,
+    serial_mismatch,
+    option_mismatch,
+};
+
+// Stable lowercase name of outcome, as written to verification output.
+const char* verify_outcome_name(VerifyOutcome outcome) noexcept;
+
+// Result of checking one verification record, with the fields its key
+// decodes to.
+struct VerifiedKey
+{
+    VerifyOutcome outcome = VerifyOutcome::malformed_record;
+    std::string_view key;    // the record's KEY field
+    char kind = 0;           // 'n' (EnigmaC) or 'e' (Enigma2C) once decoded, else 0
+    int product = -1;        // Enigma2C product code; -1 for NetTool keys or non-digits
+    int option = -1;         // -1 when the option digits are not a number
+    std::array<char, SERIAL_NUMBER_SIZE_ENIGMAC> serial{};
+    size_t serial_length = 0;
+
+    bool valid() const noexcept { return outcome == VerifyOutcome::valid; }
+    std::string_view serial_view() const noexcept { return {serial.data(), serial_length}; }
+};
+
+class OutputFile;
+class ThreadPool;
+
+// Receives the key for one record; at most KEY_LENGTH characters are used.
+using KeyBuffer = std::array<char, KEY_LENGTH>;
+
+// Generates the key for a single record line (without its newline) into key
+// and stores its length in key_length. Lines that should be skipped also
+// fail; use is_batch_skip_line() to tell them apart from real errors.
+[[nodiscard]] Status generate_record_key(std::string_view record, KeyBuffer& key, size_t& key_length) noexcept;
+
+// generate_record_key() that looks the record up in cache first and adds
+// the keys it has to encrypt. A null cache is allowed.
+[[nodiscard]] Status generate_record_key(std::string_view record, KeyBuffer& key, size_t& key_length,
+                                         KeyCache* cache) noexcept;
+
+// True for blank lines and comments.
+bool is_batch_skip_line(std::string_view record) noexcept;
+
+// True when record, as the first line of a batch, is its header: the first
+// field is exactly "mode" or "MODE".
+bool is_batch_header(std::string_view record) noexcept;
+
+// Checks a single KEY,SERIAL,OPTION[,PRODUCT] record. NetTool keys must
+// decode, in the layout nettool_option_key() generates, to SERIAL and
+// OPTION, so --batch output verifies; enigma_c_check_option_key() reads the
+// serial from digits 0-9 and does not accept generated keys. "bladerules" is
+// accepted as the master key. Enigma2C keys must pass
+// enigma2_c_check_option_key() and also decode to SERIAL (and PRODUCT, when
+// given). Each key is decrypted once.
+VerifiedKey verify_record_key(std::string_view record) noexcept;
+
+// Appends the output line for result in format, newline included.
+void append_verify_result(std::string& output, const VerifiedKey& result, VerifyFormat format);
+
+// Processes every line of input, appending one output line per record to
+// output. The last line does not need a trailing newline. output is only
+// appended to, so one string can be reused across calls. With a cache, keys
+// found there are copied instead of encrypted, and the rest are added as
+// each block of 64 is encrypted, so repeats closer together than that miss.
+BatchStats generate_batch(std::string_view input, std::string& output, KeyCache* cache = nullptr);
+
+// generate_batch() in format. Binary output is records only; the
+// BinaryKeyHeader is written by run_batch() and run_batch_file(). With
+// BatchPosition::continuation the first line is never taken for a header.
+BatchStats generate_batch(std::string_view input, std::string& output, KeyFormat format, KeyCache* cache = nullptr,
+                          BatchPosition position = BatchPosition::start);
+
+// The encoded BinaryKeyHeader, and one BinaryKeyRecord read back from the
+// 32 bytes at data.
+std::array<char, sizeof(BinaryKeyHeader)> encode_binary_key_header() noexcept;
+BinaryKeyRecord decode_binary_key_record(const char* data) noexcept;
+
+// Splits input at line boundaries into chunks of about chunk_size bytes and
+// generates them concurrently on pool. chunk_outputs is resized to the chunk
+// count and chunk_outputs[i] holds the lines for chunk i, so writing them in
+// order reproduces generate_batch(input, ...). The strings keep their
+// capacity, so reusing the vector avoids reallocating between calls.
+BatchStats generate_batch_parallel(std::string_view input, ThreadPool& pool, std::vector<std::string>& chunk_outputs,
+                                   size_t chunk_size = 256 * 1024);
+
+// generate_batch_parallel() where each pool thread uses its own cache:
+// caches[ThreadPool::thread_index()], so caches.size() must be pool.size().
+BatchStats generate_batch_parallel(std::string_view input, ThreadPool& pool, std::vector<std::string>& chunk_outputs,
+                                   std::span<const std::unique_ptr<KeyCache>> caches,
+                                   size_t chunk_size = 256 * 1024);
+
+// Verifies every line of input as verify_record_key() does, appending one
+// result line per record in format. Invalid keys count as errors. Blank
+// lines, comments and a header on the first line (first field exactly "key"
+// or "KEY") are skipped; position is as for generate_batch().
+BatchStats verify_batch(std::string_view input, std::string& output, VerifyFormat format = VerifyFormat::tsv,
+                        BatchPosition position = BatchPosition::start);
+
+// verify_batch() split across pool, with the contract of
+// generate_batch_parallel().
+BatchStats verify_batch_parallel(std::string_view input, ThreadPool& pool, std::vector<std::string>& chunk_outputs,
+                                 VerifyFormat format = VerifyFormat::tsv, size_t chunk_size = 256 * 1024);
+
+// Key length for a generation mode: ENIGMA_C_KEY_LENGTH for 'n', KEY_LENGTH
+// for 'e' and 'l', 0 for anything else.
+size_t generated_key_length(char mode) noexcept;
+
+// Keys for records that are already numbers, as the C ABI and the Python
+// module receive them: serials[i] with options[i] (or options[0] for every
+// serial when options has one element), all in one mode. product applies to
+// 'e' and 'l'; a negative one picks the mode's default. Serials are the
+// numeric value, so leading zeros need not be stored.
+//
+// Key i is written to keys[i * L, (i + 1) * L) for L = generated_key_length(mode),
+// with no separators or terminators. A record that fails gets L '\0' bytes.
+// statuses is empty or holds one Status per serial. Keys go 64 at a time
+// through the struct-of-arrays kernels, on jobs threads (0 = one per
+// hardware thread) once there are enough of them to split. Returns the
+// number of failed records; a bad mode, option count or buffer size fails
+// every record and leaves keys untouched.
+size_t generate_keys(char mode, int product, std::span<const uint64_t> serials, std::span<const int32_t> options,
+                     std::span<char> keys, std::span<Status> statuses = {}, unsigned jobs = 1);
+
+// Streams records from input to output in large blocks until EOF, using
+// options.jobs threads and running options.task on each record. Output
+// order always matches input order.
+BatchStats run_batch(std::FILE* input, std::FILE* output, const BatchOptions& options = {});
+
+// Like run_batch(), but for a named file. Regular files are memory-mapped
+// and parsed in place, so records are never copied out of the page cache;
+// other files (pipes, or platforms without mmap) fall back to run_batch().
+// Returns std::nullopt if path cannot be opened.
+std::optional<BatchStats> run_batch_file(const char* path, std::FILE* output, const BatchOptions& options = {});
+
+// run_batch() and run_batch_file() writing through output's aligned buffer.
+// output is not closed; its close() writes the last partial block.
+BatchStats run_batch(std::FILE* input, OutputFile& output, const BatchOptions& options = {});
+std::optional<BatchStats> run_batch_file(const char* path, OutputFile& output, const BatchOptions& options = {});
+} // namespace enigma
+
+#endif //ENIGMA_BATCH_H
@@ -0,0 +1,75 @@
+//
+// C ABI over enigma_core, built as the enigma_c shared library.
+//
+// The six key functions have the signatures of c/src/enigma_v300_pure_c.h,
+// so a C program (or an FFI binding) written against that header links
+// against this library unchanged. They differ only where the C front end
+// prints an error and exits: here the output is left as an empty string and
+// the caller carries on. Outputs are NUL-terminated, so they need len + 1
+// bytes for EnigmaC and 17 for Enigma2C.
+//
+// enigma_generate_many() is the typed-array batch API (generate_keys() in
+// enigma_batch.h): serials and options as integer arrays, fixed-width keys
+// out, one status byte per record.
+//
+// This header is plain C; every function is noexcept on the C++ side.
+//
+
+#ifndef ENIGMA_C_API_H
+#define ENIGMA_C_API_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Values of enigma::Status, as written to enigma_generate_many() statuses. */
+enum enigma_status
+{
+    ENIGMA_STATUS_OK = 0,
+    ENIGMA_STATUS_INVALID_LENGTH,
+    ENIGMA_STATUS_NON_HEX,
+    ENIGMA_STATUS_INVALID_CHARACTER,
+    ENIGMA_STATUS_CHECKSUM_MISMATCH,
+    ENIGMA_STATUS_BUFFER_TOO_SMALL,
+    ENIGMA_STATUS_MALFORMED_RECORD,
+    ENIGMA_STATUS_INVALID_MODE,
+    ENIGMA_STATUS_INVALID_SERIAL,
+    ENIGMA_STATUS_INVALID_OPTION,
+    ENIGMA_STATUS_INVALID_PRODUCT
+};
+
+void enigma_c_encrypt(const char* input_key, char* output_key, size_t len);
+void enigma_c_decrypt(const char* input_key, char* output_key, size_t len);
+int enigma_c_check_option_key(int option, const char* key, const char* serial_number);
+
+void enigma2_c_encrypt(const char* input_key, char* output_key);
+/* Leaves output_key empty when the key fails its checksum, as the C front end does. */
+void enigma2_c_decrypt(const char* input_key, char* output_key);
+int enigma2_c_check_option_key(int option, const char* key);
+
+/* Key length for mode 'n' (12), 'e' or 'l' (16); 0 for anything else. */
+size_t enigma_key_length(char mode);
+
+/*
+ * Writes count keys of enigma_key_length(mode) characters each, back to back
+ * and unterminated, into keys (keys_size bytes). options holds option_count
+ * values: count of them, or 1 for every serial. product applies to 'e' and
+ * 'l'; -1 picks the mode's default. statuses, if not NULL, receives one
+ * enum enigma_status per record; failed records get all-NUL keys. jobs is
+ * the thread count (0 = one per hardware thread). Returns the number of
+ * failed records.
+ */
+size_t enigma_generate_many(char mode, int product, const uint64_t* serials, size_t count, const int32_t* options,
+                            size_t option_count, char* keys, size_t keys_size, uint8_t* statuses, unsigned jobs);
+
+/* Human-readable message for an enum enigma_status value. */
+const char* enigma_status_message(int status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //ENIGMA_C_API_H
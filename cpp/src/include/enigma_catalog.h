@@ -0,0 +1,164 @@
+//
+// Product and option catalog: the Fluke product codes the tools know by
+// name, and the option codes each one defines.
+//
+// Lookups are keyed on the integer codes. Products are sorted by code and
+// options are stored flat, sorted by (product, option), so every lookup is
+// a binary search over contiguous constexpr data with no allocation. The
+// menu order shown to users is kept separately.
+//
+
+#ifndef ENIGMA_CATALOG_H
+#define ENIGMA_CATALOG_H
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+namespace enigma
+{
+struct ProductInfo
+{
+    uint16_t code;
+    std::string_view abbr;
+    std::string_view name;
+};
+
+struct OptionInfo
+{
+    uint16_t product;
+    uint16_t code;
+    std::string_view desc;
+};
+
+// A catalog is three views over sorted, contiguous tables.
+class Catalog
+{
+public:
+    constexpr Catalog(std::span<const ProductInfo> products, std::span<const OptionInfo> options,
+                      std::span<const uint16_t> menu) noexcept
+        : products_(products), options_(options), menu_(menu)
+    {
+    }
+
+    // The product with this code, or nullptr.
+    constexpr const ProductInfo* find_product(int code) const noexcept
+    {
+        const auto it = std::lower_bound(products_.begin(), products_.end(), code,
+                                         [](const ProductInfo& product, int value) { return product.code < value; });
+        return (it != products_.end() && it->code == code) ? &*it : nullptr;
+    }
+
+    // Every option defined for product, in code order; empty if none.
+    constexpr std::span<const OptionInfo> options_for(int product) const noexcept
+    {
+        const auto first = std::lower_bound(options_.begin(), options_.end(), product,
+                                            [](const OptionInfo& option, int value)
+                                            {
+                                                return option.product < value;
+                                            });
+        const auto last = std::upper_bound(first, options_.end(), product,
+                                           [](int value, const OptionInfo& option) { return value < option.product; });
+        return options_.subspan(static_cast<size_t>(first - options_.begin()), static_cast<size_t>(last - first));
+    }
+
+    // The option with this code for product, or nullptr.
+    constexpr const OptionInfo* find_option(int product, int code) const noexcept
+    {
+        const auto options = options_for(product);
+        const auto it = std::lower_bound(options.begin(), options.end(), code,
+                                         [](const OptionInfo& option, int value) { return option.code < value; });
+        return (it != options.end() && it->code == code) ? &*it : nullptr;
+    }
+
+    // Products in code order.
+    constexpr std::span<const ProductInfo> products() const noexcept { return products_; }
+
+    // Product codes in the order menus and listings show them.
+    constexpr std::span<const uint16_t> menu() const noexcept { return menu_; }
+
+    // True when the tables satisfy the ordering the lookups rely on and
+    // every menu entry names a product.
+    constexpr bool is_valid() const noexcept
+    {
+        for (size_t i = 1; i < products_.size(); ++i)
+        {
+            if (products_[i - 1].code >= products_[i].code) return false;
+        }
+        for (size_t i = 1; i < options_.size(); ++i)
+        {
+            const auto& a = options_[i - 1];
+            const auto& b = options_[i];
+            if (a.product > b.product || (a.product == b.product && a.code >= b.code)) return false;
+        }
+        return std::all_of(menu_.begin(), menu_.end(), [this](uint16_t code) { return find_product(code); });
+    }
+
+private:
+    std::span<const ProductInfo> products_;
+    std::span<const OptionInfo> options_;
+    std::span<const uint16_t> menu_;
+};
+
+namespace detail
+{
+constexpr std::array<ProductInfo, 7> BUILTIN_PRODUCTS = {{
+    {1890, "ClearSight", "ClearSight Analyzer"},
+    {1895, "iClearSight", "iClearSight Analyzer"},
+    {2186, "OptiView", "OptiView XG"},
+    {3001, "NTs2", "NetTool Series II"},
+    {6963, "Escope/MSv2", "EtherScope/MetroScope"},
+    {6964, "OneTouch", "OneTouch AT"},
+    {7001, "LRPro", "LinkRunner Pro Duo"},
+}};
+
+constexpr std::array<OptionInfo, 34> BUILTIN_OPTIONS = {{
+    {1890, 0, "Activation Code"},
+    {1890, 7, "All Options"},
+    {1895, 0, "Activation Code"},
+    {1895, 3, "All Options"},
+    {2186, 0, "Wireless Analyzer Option"},
+    {2186, 1, "Enables Network Test Ports A-D"},
+    {2186, 2, "10Gb Ethernet Analyzer Option"},
+    {2186, 3, "LAN / 10Gb Ethernet Analyzer Option"},
+    {2186, 4, "NPT - Network Performance Option"},
+    {2186, 7, "Everything"},
+    {3001, 3, "Personalization"},
+    {3001, 4, "VoIP"},
+    {3001, 5, "NetSecure"},
+    {3001, 8, "Dicom"},
+    {6963, 0, "MetroScope Base, EtherScope LAN"},
+    {6963, 1, "MetroScope WLAN, EtherScope WLAN"},
+    {6963, 2, "MetroScope Multi, EtherScope ITO"},
+    {6963, 3, "MetroScope VoIP, EtherScope Fiber"},
+    {6963, 4, "MetroScope LT, EtherScope LT"},
+    {6964, 0, "Registered"},
+    {6964, 1, "Wired (Was Copper)"},
+    {6964, 2, "Obsolete (was fiber)"},
+    {6964, 3, "Wi-Fi"},
+    {6964, 4, "Obsolete (was inline)"},
+    {6964, 5, "Capture"},
+    {6964, 6, "Advanced Tests"},
+    {6964, 7, "XGR-to-ATX Upgrade"},
+    {6964, 8, "Claimed (Cloud Tools)"},
+    {6964, 9, "LatTests (China LAN Tests)"},
+    {6964, 64, "XGReflector (Future)"},
+    {6964, 65, "Performance Peer (Future)"},
+    {7001, 0, "802.1x"},
+    {7001, 2, "Reports"},
+    {7001, 3, "LAN"},
+}};
+
+constexpr std::array<uint16_t, 7> BUILTIN_MENU = {3001, 7001, 6963, 6964, 2186, 1890, 1895};
+} // namespace detail
+
+// The catalog compiled into the tools.
+constexpr Catalog BUILTIN_CATALOG(detail::BUILTIN_PRODUCTS, detail::BUILTIN_OPTIONS, detail::BUILTIN_MENU);
+
+static_assert(BUILTIN_CATALOG.is_valid(), "built-in catalog tables must be sorted and the menu complete");
+} // namespace enigma
+
+#endif //ENIGMA_CATALOG_H
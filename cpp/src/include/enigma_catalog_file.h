@@ -0,0 +1,76 @@
+//
+// Product catalogs loaded at runtime from a JSON file, so new product and
+// option codes do not need a rebuild.
+//
+// The file looks like:
+//
+//     {"products": [
+//         {"code": 6964, "abbr": "OneTouch", "name": "OneTouch AT",
+//          "options": [{"code": 0, "desc": "Registered"}, {"code": "003", "desc": "Wi-Fi"}]}
+//     ]}
+//
+// Codes may be numbers or digit strings. Products are listed in menu order.
+// The first load compiles the file into a compact binary index next to it
+// (FILE.cache); later loads map that index read-only and only build the
+// small view arrays, so startup stays well under a millisecond even for
+// thousands of entries. The index is rebuilt whenever the JSON file's
+// size or modification time changes.
+//
+
+#ifndef ENIGMA_CATALOG_FILE_H
+#define ENIGMA_CATALOG_FILE_H
+
+#include "enigma_catalog.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace enigma
+{
+class LoadedCatalog
+{
+public:
+    // Loads the catalog in json_path, using and refreshing json_path +
+    // ".cache" when use_cache is set. A cache that cannot be written (for
+    // example a read-only directory) is not an error. Returns nullptr and
+    // sets error when the file cannot be read or is not a valid catalog.
+    static std::unique_ptr<LoadedCatalog> load(const std::string& json_path, std::string& error,
+                                               bool use_cache = true);
+
+    ~LoadedCatalog();
+    LoadedCatalog(const LoadedCatalog&) = delete;
+    LoadedCatalog& operator=(const LoadedCatalog&) = delete;
+
+    const Catalog& catalog() const noexcept { return catalog_; }
+
+    // True when this load was served from the binary index.
+    bool from_cache() const noexcept { return from_cache_; }
+
+private:
+    LoadedCatalog() = default;
+
+    // Builds the views over index (owned_ or the mapping); false if the
+    // index is truncated or inconsistent.
+    bool attach(const char* index, size_t size);
+
+    std::vector<char> owned_;             // index bytes when not mapped
+    const char* mapped_ = nullptr;        // index bytes when mapped
+    size_t mapped_size_ = 0;
+    std::vector<ProductInfo> products_;   // views into the index's string pool
+    std::vector<OptionInfo> options_;
+    std::vector<uint16_t> menu_;
+    Catalog catalog_{{}, {}, {}};
+    bool from_cache_ = false;
+};
+
+// Compiles catalog JSON text into the binary index format. The source size
+// and time are stored so the index can be checked against its file later.
+// Returns false and sets error when json is not a valid catalog.
+bool compile_catalog(std::string_view json, std::vector<char>& index, std::string& error, uint64_t source_size = 0,
+                     int64_t source_mtime = 0);
+} // namespace enigma
+
+#endif //ENIGMA_CATALOG_FILE_H
@@ -0,0 +1,254 @@
+//
+// Enigma<Algorithm, KeyLen>: both key algorithms as one class template,
+// specialised at compile time for a key length.
+//
+// An Algorithm bundles three policies:
+//
+//   Alphabet - text <-> symbols: hex digits for NetTool, 0-9 then A-Z
+//              (10-35) for Enigma2C. Both convert through 256-entry tables.
+//   Rotors   - the per-position step and the state carried between steps:
+//              the running XOR for NetTool, the running sum for Enigma2C.
+//   Checksum - fills the checksum symbols before encryption and checks the
+//              final state after decryption (nothing for NetTool).
+//
+// The key length is a template argument, so encrypt() and decrypt() check
+// it once and then run a fully unrolled loop in which every position, and
+// therefore every rotor index such as (symbol + 3) % 16, is a constant. The
+// results are those of enigma_c_encrypt()/enigma2_c_encrypt() and their
+// inverses for keys of that length; static_asserts in enigma_core.cpp and
+// the unit tests hold the two to each other.
+//
+// The batch, verification and server paths choose NetToolEngine or
+// Enigma2Engine once per record, from its mode or key length, instead of
+// testing lengths and character classes inside the loops.
+//
+
+#ifndef ENIGMA_ENGINE_H
+#define ENIGMA_ENGINE_H
+
+#include "enigma_v300_pure_cpp.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <utility>
+
+namespace enigma
+{
+namespace policy
+{
+// Hex digits, read in either case and written lowercase.
+struct HexAlphabet
+{
+    static constexpr Status invalid = Status::non_hex;
+
+    static constexpr int symbol(char c) noexcept { return detail::table_hex_value(c); }
+    static constexpr char character(unsigned symbol) noexcept { return detail::HEX_DIGITS[symbol]; }
+};
+
+// '0'-'9' as 0-9 and 'A'-'Z' as 10-35, as in the packed Enigma2C key.
+struct DigitLetterAlphabet
+{
+    static constexpr Status invalid = Status::invalid_character;
+
+    static constexpr std::array<int8_t, 256> SYMBOLS = []
+    {
+        std::array<int8_t, 256> table{};
+        table.fill(-1);
+        for (int i = 0; i < 10; ++i) table['0' + i] = static_cast<int8_t>(i);
+        for (int i = 0; i < 26; ++i) table['A' + i] = static_cast<int8_t>(10 + i);
+        return table;
+    }();
+
+    static constexpr int symbol(char c) noexcept { return SYMBOLS[static_cast<unsigned char>(c)]; }
+
+    static constexpr char character(unsigned symbol) noexcept
+    {
+        return static_cast<char>(symbol < 10 ? '0' + symbol : 'A' + symbol - 10);
+    }
+};
+
+// EnigmaC: each output nibble is the rotor image of (input + position)
+// XORed into the previous output nibble.
+struct XorChainRotors
+{
+    using State = unsigned; // previous output (key) nibble
+
+    template <size_t Index>
+    static constexpr unsigned encrypt(unsigned symbol, State& state) noexcept
+    {
+        state ^= ENIGMA_C_ROTOR[(symbol + Index) % 16];
+        return state;
+    }
+
+    template <size_t Index>
+    static constexpr unsigned decrypt(unsigned symbol, State& state) noexcept
+    {
+        const unsigned plain = (ENIGMA_C_ROTOR_INVERSE[symbol ^ state] + 16 - Index % 16) % 16;
+        state = symbol;
+        return plain;
+    }
+};
+
+// Enigma2C: digits and letters go through their own rotor, offset by the
+// running sum of the plain symbols before them.
+struct RunningSumRotors
+{
+    using State = int; // running sum of term() over the plain symbols so far
+
+    // Value within its class: 0-9 for a digit, 0-25 for a letter.
+    static constexpr int value(unsigned symbol) noexcept
+    {
+        return symbol < 10 ? static_cast<int>(symbol) : static_cast<int>(symbol) - 10;
+    }
+
+    static constexpr int term(size_t index, int value) noexcept
+    {
+        return static_cast<int>(index) + value + (static_cast<int>(index) * value);
+    }
+
+    template <size_t Index>
+    static constexpr unsigned encrypt(unsigned symbol, State& state) noexcept
+    {
+        const int plain = value(symbol);
+        const int rotor_index = plain + MAX_CHECK_SUM - state;
+        state += term(Index, plain);
+        return symbol < 10 ? ENIGMA2_E_ROTOR_10[rotor_index % 10] : 10u + ENIGMA2_E_ROTOR_26[rotor_index % 26];
+    }
+
+    template <size_t Index>
+    static constexpr unsigned decrypt(unsigned symbol, State& state) noexcept
+    {
+        const int plain = symbol < 10 ? (ENIGMA2_D_ROTOR_10[symbol] + state) % 10
+                                      : (ENIGMA2_D_ROTOR_26[symbol - 10] + state) % 26;
+        state += term(Index, plain);
+        return symbol < 10 ? static_cast<unsigned>(plain) : 10u + static_cast<unsigned>(plain);
+    }
+};
+
+struct NoChecksum
+{
+    template <size_t KeyLen>
+    static constexpr void fill(std::array<uint8_t, KeyLen>&) noexcept
+    {
+    }
+
+    template <size_t KeyLen, typename State>
+    static constexpr bool verify(const std::array<uint8_t, KeyLen>&, State) noexcept
+    {
+        return true;
+    }
+};
+
+// The Enigma2C checksum: two decimal digits in symbols 0-1 that bring the
+// running sum of the whole decrypted key to a multiple of 100.
+struct Mod100Checksum
+{
+    template <size_t KeyLen>
+    static constexpr void fill(std::array<uint8_t, KeyLen>& symbols) noexcept
+    {
+        int checksum = 1;
+        [&]<size_t... I>(std::index_sequence<I...>)
+        {
+            ((checksum += RunningSumRotors::term(I + 2, RunningSumRotors::value(symbols[I + 2]))), ...);
+        }(std::make_index_sequence<KeyLen - 2>{});
+        checksum = 100 - (checksum % 100);
+        symbols[0] = static_cast<uint8_t>(checksum % 10);
+        symbols[1] = static_cast<uint8_t>((checksum / 10) % 10);
+    }
+
+    template <size_t KeyLen>
+    static constexpr bool verify(const std::array<uint8_t, KeyLen>& plain, int running_sum) noexcept
+    {
+        // The text form adds the character code of position 1 less '0'.
+        running_sum += 8 * (plain[1] < 10 ? plain[1] : plain[1] + 7);
+        return running_sum % 100 == 0;
+    }
+};
+} // namespace policy
+
+template <typename AlphabetPolicy, typename RotorPolicy, typename ChecksumPolicy>
+struct Algorithm
+{
+    using Alphabet = AlphabetPolicy;
+    using Rotors = RotorPolicy;
+    using Checksum = ChecksumPolicy;
+};
+
+using EnigmaCAlgorithm = Algorithm<policy::HexAlphabet, policy::XorChainRotors, policy::NoChecksum>;
+using Enigma2Algorithm = Algorithm<policy::DigitLetterAlphabet, policy::RunningSumRotors, policy::Mod100Checksum>;
+
+template <typename AlgorithmT, size_t KeyLen>
+class Enigma
+{
+public:
+    using Alphabet = typename AlgorithmT::Alphabet;
+    using Rotors = typename AlgorithmT::Rotors;
+    using Checksum = typename AlgorithmT::Checksum;
+
+    static constexpr size_t key_length = KeyLen;
+
+    // Encrypts a KeyLen plain layout into key. Returns Status::invalid_length
+    // for any other length, or the alphabet's error for a bad character.
+    [[nodiscard]] static constexpr Status encrypt(std::string_view plain, std::span<char, KeyLen> key) noexcept
+    {
+        if (plain.size() != KeyLen) return Status::invalid_length;
+        std::array<uint8_t, KeyLen> symbols{};
+        if (!to_symbols(plain, symbols)) return Alphabet::invalid;
+        Checksum::fill(symbols);
+        typename Rotors::State state{};
+        for_each_position([&]<size_t I>()
+        {
+            key[I] = Alphabet::character(Rotors::template encrypt<I>(symbols[I], state));
+        });
+        return Status::ok;
+    }
+
+    // Decrypts a KeyLen key into plain. Status::checksum_mismatch leaves
+    // plain unspecified.
+    [[nodiscard]] static constexpr Status decrypt(std::string_view key, std::span<char, KeyLen> plain) noexcept
+    {
+        if (key.size() != KeyLen) return Status::invalid_length;
+        std::array<uint8_t, KeyLen> symbols{};
+        if (!to_symbols(key, symbols)) return Alphabet::invalid;
+        std::array<uint8_t, KeyLen> plain_symbols{};
+        typename Rotors::State state{};
+        for_each_position([&]<size_t I>()
+        {
+            plain_symbols[I] = static_cast<uint8_t>(Rotors::template decrypt<I>(symbols[I], state));
+            plain[I] = Alphabet::character(plain_symbols[I]);
+        });
+        return Checksum::verify(plain_symbols, state) ? Status::ok : Status::checksum_mismatch;
+    }
+
+private:
+    // Calls step.template operator()<I>() for I = 0 .. KeyLen - 1, unrolled.
+    template <typename Step>
+    static constexpr void for_each_position(Step&& step) noexcept
+    {
+        [&]<size_t... I>(std::index_sequence<I...>)
+        {
+            (step.template operator()<I>(), ...);
+        }(std::make_index_sequence<KeyLen>{});
+    }
+
+    static constexpr bool to_symbols(std::string_view text, std::array<uint8_t, KeyLen>& symbols) noexcept
+    {
+        int invalid = 0;
+        for_each_position([&]<size_t I>()
+        {
+            const int symbol = Alphabet::symbol(text[I]);
+            invalid |= symbol;
+            symbols[I] = static_cast<uint8_t>(symbol);
+        });
+        return invalid >= 0;
+    }
+};
+
+using NetToolEngine = Enigma<EnigmaCAlgorithm, ENIGMA_C_KEY_LENGTH>;
+using Enigma2Engine = Enigma<Enigma2Algorithm, KEY_LENGTH>;
+} // namespace enigma
+
+#endif //ENIGMA_ENGINE_H
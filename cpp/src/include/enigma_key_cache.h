@@ -0,0 +1,126 @@
+//
+// Bounded cache of generated and decoded keys for the batch and server
+// modes, where the same serial/option combinations come back again and
+// again.
+//
+// Requests pack into 16 bytes: (algorithm, product, serial, option) fits in
+// one 64-bit word for generation, and a decode request is its 16-character
+// key. Results are at most 16 characters too. Entries are 32 bytes, two to
+// a cache line, in an open-addressed table of four-entry sets. Each set
+// evicts with CLOCK (second chance): a hit marks its entry, and the hand
+// skips and clears marked entries before replacing one.
+//
+// A cache is not thread-safe; give each thread its own. The counters may be
+// read from any thread.
+//
+
+#ifndef ENIGMA_KEY_CACHE_H
+#define ENIGMA_KEY_CACHE_H
+
+#include "enigma_packed.h"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string_view>
+
+namespace enigma
+{
+// A packed request. All-zero is never a valid request and marks free slots.
+struct CacheKey
+{
+    uint64_t words[2] = {0, 0};
+
+    constexpr bool operator==(const CacheKey&) const noexcept = default;
+};
+
+// A cached key or decoded layout; NetTool keys use the first 12 characters.
+using CacheValue = std::array<char, KEY_LENGTH>;
+
+// Key for generating with algorithm 'n' (EnigmaC, product ignored) or 'e'
+// (Enigma2C). The serial must already be validated: digits only, 10 of them
+// for 'n' and 7 for 'e'.
+constexpr CacheKey generation_cache_key(char algorithm, int product, std::string_view serial, int option) noexcept
+{
+    uint64_t packed_serial = 0;
+    (void)pack_serial(serial, packed_serial);
+    // serial: 34 bits (10 digits), option: 10 bits, product: 14 bits, algorithm: 2 bits
+    const uint64_t kind = algorithm == 'n' ? 1 : 2;
+    const uint64_t code = algorithm == 'n' ? 0 : static_cast<uint64_t>(product);
+    return {{packed_serial | static_cast<uint64_t>(option) << 34 | code << 44 | kind << 58, 0}};
+}
+
+// Key for decoding a KEY_LENGTH Enigma2C key.
+constexpr CacheKey decode_cache_key(std::string_view key) noexcept
+{
+    CacheKey result;
+    for (size_t i = 0; i < KEY_LENGTH && i < key.size(); ++i)
+    {
+        result.words[i / 8] |= static_cast<uint64_t>(static_cast<unsigned char>(key[i])) << (8 * (i % 8));
+    }
+    return result;
+}
+
+struct KeyCacheStats
+{
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+};
+
+class KeyCache
+{
+public:
+    static constexpr size_t WAYS = 4;
+
+    // Holds at least entries results (rounded up to a power of two).
+    explicit KeyCache(size_t entries);
+
+    KeyCache(const KeyCache&) = delete;
+    KeyCache& operator=(const KeyCache&) = delete;
+
+    // The cached result for key, counting a hit or a miss.
+    std::optional<CacheValue> find(const CacheKey& key) noexcept;
+
+    // Stores value for key, evicting an older entry of its set if needed.
+    void insert(const CacheKey& key, const CacheValue& value) noexcept;
+
+    size_t capacity() const noexcept { return (set_mask_ + 1) * WAYS; }
+
+    KeyCacheStats stats() const noexcept;
+
+private:
+    struct alignas(32) Entry
+    {
+        CacheKey key;
+        CacheValue value;
+    };
+    static_assert(sizeof(Entry) == 32);
+
+    struct alignas(64) Set
+    {
+        Entry entries[WAYS];
+    };
+
+    size_t set_of(const CacheKey& key) const noexcept;
+
+    // Only the owning thread writes the counters, so plain loads and stores
+    // (no read-modify-write) are enough for readers to see whole values.
+    static void bump(std::atomic<uint64_t>& counter) noexcept
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    std::unique_ptr<Set[]> sets_;
+    std::unique_ptr<uint8_t[]> clock_; // per set: referenced bits 0-3, hand in bits 4-5
+    size_t set_mask_;
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> misses_{0};
+    std::atomic<uint64_t> evictions_{0};
+};
+} // namespace enigma
+
+#endif //ENIGMA_KEY_CACHE_H
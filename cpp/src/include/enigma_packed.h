@@ -0,0 +1,431 @@
+//
+// Packed binary forms of serials and keys, and the key algorithms on them.
+//
+// A serial is its integer value (7 digits fit a uint32_t, 10 need a
+// uint64_t). A NetTool key is a 48-bit word with hex digit i in nibble i. An
+// Enigma2C key is 16 one-byte symbols: 0-9 for digits, 10-35 for A-Z. Each
+// form is a fixed-size value with no heap storage, against 32 bytes plus any
+// allocation for a std::string.
+//
+// Text converts eight characters at a time in a 64-bit word (SWAR): one
+// range check validates every byte, and a few multiplies combine or split
+// the digits. Everything is constexpr, like the text algorithms.
+//
+// The NetTool "bladerules" master key has no packed form; only the text
+// enigma_c_check_option_key() accepts it.
+//
+
+#ifndef ENIGMA_PACKED_H
+#define ENIGMA_PACKED_H
+
+#include "enigma_v300_pure_cpp.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <string_view>
+#include <type_traits>
+
+namespace enigma
+{
+constexpr size_t MAX_PACKED_SERIAL_DIGITS = 16;
+
+struct PackedNetToolKey
+{
+    uint64_t nibbles = 0; // hex digit i in bits 4i to 4i + 3
+
+    constexpr unsigned digit(size_t index) const noexcept
+    {
+        return static_cast<unsigned>(nibbles >> (4 * index)) & 0xf;
+    }
+
+    constexpr bool operator==(const PackedNetToolKey&) const noexcept = default;
+};
+
+struct PackedEnigma2Key
+{
+    std::array<uint8_t, KEY_LENGTH> symbols{}; // 0-9 for '0'-'9', 10-35 for 'A'-'Z'
+
+    // Value of the leading digits of the length symbols at location, or -1
+    // if the first is a letter (as DecodedKey reads its fields).
+    constexpr int number(size_t location, size_t length) const noexcept
+    {
+        if (symbols[location] >= 10) return -1;
+        int value = 0;
+        for (size_t i = location; i < location + length && symbols[i] < 10; ++i) value = value * 10 + symbols[i];
+        return value;
+    }
+
+    constexpr int product() const noexcept { return number(PRODUCT_LOCATION, PRODUCT_CODE_SIZE); }
+    constexpr int serial() const noexcept { return number(SERIAL_LOCATION, SERIAL_NUMBER_SIZE_ENIGMA2); }
+    constexpr int option() const noexcept { return number(OPTION_LOCATION, OPTION_CODE_SIZE); }
+
+    constexpr bool operator==(const PackedEnigma2Key&) const noexcept = default;
+};
+
+static_assert(sizeof(PackedNetToolKey) == 8 && sizeof(PackedEnigma2Key) == KEY_LENGTH);
+
+namespace detail
+{
+constexpr uint64_t SWAR_ONES = 0x0101010101010101ULL;
+constexpr uint64_t SWAR_HIGHS = 0x8080808080808080ULL;
+
+constexpr uint64_t SWAR_ZEROS = SWAR_ONES * '0';
+
+// The eight bytes at text as a word, first in the low byte. At run time on
+// little-endian hosts this is a single load.
+constexpr uint64_t load_word(const char* text) noexcept
+{
+    if (!std::is_constant_evaluated() && std::endian::native == std::endian::little)
+    {
+        uint64_t word;
+        std::memcpy(&word, text, sizeof(word));
+        return word;
+    }
+    uint64_t word = 0;
+    for (size_t i = 0; i < 8; ++i) word |= static_cast<uint64_t>(static_cast<unsigned char>(text[i])) << (8 * i);
+    return word;
+}
+
+// The first count (at most 8) characters of text, which must have eight
+// readable bytes, in the high bytes of a word padded below with '0'.
+constexpr uint64_t load_leading(const char* text, size_t count) noexcept
+{
+    if (count == 0) return SWAR_ZEROS;
+    if (count == 8) return load_word(text);
+    return load_word(text) << (8 * (8 - count)) | SWAR_ZEROS >> (8 * count);
+}
+
+// The count (below 8) characters at text, reading no further, in the high
+// bytes of a word padded below with '0'. From four characters up this is
+// two overlapping four-byte loads.
+constexpr uint64_t load_short(const char* text, size_t count) noexcept
+{
+    if (!std::is_constant_evaluated() && std::endian::native == std::endian::little && count >= 4)
+    {
+        uint32_t first;
+        uint32_t last;
+        std::memcpy(&first, text, sizeof(first));
+        std::memcpy(&last, text + count - 4, sizeof(last));
+        const uint64_t head = static_cast<uint64_t>(first) << (8 * (8 - count)) & 0xffffffffULL;
+        return static_cast<uint64_t>(last) << 32 | head | SWAR_ZEROS >> (8 * count);
+    }
+    uint64_t word = SWAR_ZEROS;
+    for (size_t i = 0; i < count; ++i)
+    {
+        const size_t shift = 8 * (8 - count + i);
+        word = (word & ~(0xffULL << shift)) | static_cast<uint64_t>(static_cast<unsigned char>(text[i])) << shift;
+    }
+    return word;
+}
+
+constexpr void store_word(uint64_t word, char* out) noexcept
+{
+    if (!std::is_constant_evaluated() && std::endian::native == std::endian::little)
+    {
+        std::memcpy(out, &word, sizeof(word));
+        return;
+    }
+    for (size_t i = 0; i < 8; ++i) out[i] = static_cast<char>(word >> (8 * i));
+}
+
+// High bit of every byte of x strictly between low and high (high <= 128).
+// Masking off each byte's top bit first keeps borrows and carries inside it.
+constexpr uint64_t bytes_between(uint64_t x, unsigned low, unsigned high) noexcept
+{
+    const uint64_t t = x & ~SWAR_HIGHS;
+    return (SWAR_ONES * (127 + high) - t) & ~x & (t + SWAR_ONES * (127 - low)) & SWAR_HIGHS;
+}
+
+constexpr uint64_t digit_bytes(uint64_t x) noexcept
+{
+    return bytes_between(x, '0' - 1, '9' + 1);
+}
+
+// Eight ASCII digits, first in the low byte, to their value: each multiply
+// joins neighbouring lanes into one of twice the width (10 * high + low,
+// then 100 * high + low, then 10000 * high + low).
+constexpr uint64_t parse_eight_digits(uint64_t word) noexcept
+{
+    word = ((word & 0x0f0f0f0f0f0f0f0fULL) * (10 * 256 + 1)) >> 8;
+    word = ((word & 0x00ff00ff00ff00ffULL) * (100 * 65536 + 1)) >> 16;
+    return ((word & 0x0000ffff0000ffffULL) * (10000 * (1ULL << 32) + 1)) >> 32;
+}
+
+// A value below 10^8 as eight ASCII digits, first in the low byte. Divisions
+// by 100 and 10 run on every lane at once as multiply-and-shift.
+constexpr uint64_t format_eight_digits(uint64_t value) noexcept
+{
+    const uint64_t halves = value / 10000 | (value % 10000) << 32;
+    const uint64_t hundreds = (halves * 10486) >> 20 & 0x0000007f0000007fULL;
+    const uint64_t pairs = (halves - 100 * hundreds) << 16 | hundreds;
+    uint64_t tens = (pairs * 103) >> 10 & 0x000f000f000f000fULL;
+    tens |= (pairs - 10 * tens) << 8;
+    return tens + SWAR_ZEROS;
+}
+
+// Eight values 0-15, first in the low byte, to eight nibbles, first lowest.
+constexpr uint64_t pack_nibbles(uint64_t bytes) noexcept
+{
+    bytes = (bytes | bytes >> 4) & 0x00ff00ff00ff00ffULL;
+    bytes = (bytes | bytes >> 8) & 0x0000ffff0000ffffULL;
+    return (bytes | bytes >> 16) & 0xffffffffULL;
+}
+
+constexpr uint64_t unpack_nibbles(uint64_t nibbles) noexcept
+{
+    nibbles &= 0xffffffffULL;
+    nibbles = (nibbles | nibbles << 16) & 0x0000ffff0000ffffULL;
+    nibbles = (nibbles | nibbles << 8) & 0x00ff00ff00ff00ffULL;
+    return (nibbles | nibbles << 4) & 0x0f0f0f0f0f0f0f0fULL;
+}
+
+// Eight hex characters to their values, or ~0 if any is not hex.
+constexpr uint64_t hex_values(uint64_t word) noexcept
+{
+    const uint64_t hex = digit_bytes(word) | bytes_between(word, 'a' - 1, 'f' + 1) |
+                         bytes_between(word, 'A' - 1, 'F' + 1);
+    if (hex != SWAR_HIGHS) return ~0ULL;
+    // Letters have bit 6 set; their low nibble is 1-6 for a-f.
+    return (word & 0x0f0f0f0f0f0f0f0fULL) + 9 * (word >> 6 & SWAR_ONES);
+}
+
+// Values 0-15 to lowercase hex: add 39 more past '9' for the letters.
+constexpr uint64_t hex_characters(uint64_t values) noexcept
+{
+    return values + SWAR_ZEROS + 39 * ((values + SWAR_ONES * 6) >> 4 & SWAR_ONES);
+}
+
+constexpr uint64_t symbol_values(uint64_t word) noexcept
+{
+    // 'A' - '0' - 10 = 7 separates the two alphabets.
+    return word - SWAR_ZEROS - 7 * (word >> 6 & SWAR_ONES);
+}
+
+constexpr uint64_t symbol_characters(uint64_t symbols) noexcept
+{
+    return symbols + SWAR_ZEROS + 7 * ((symbols + SWAR_ONES * 118) >> 7 & SWAR_ONES);
+}
+} // namespace detail
+
+// Parses 1 to MAX_PACKED_SERIAL_DIGITS decimal digits into serial.
+[[nodiscard]] constexpr Status pack_serial(std::string_view text, uint64_t& serial) noexcept
+{
+    if (text.empty() || text.size() > MAX_PACKED_SERIAL_DIGITS) return Status::invalid_serial;
+    // The last eight digits, then whatever precedes them, left-padded with '0'.
+    uint64_t low_word = detail::SWAR_ZEROS;
+    uint64_t high_word = detail::SWAR_ZEROS;
+    if (text.size() >= 8)
+    {
+        low_word = detail::load_word(text.data() + text.size() - 8);
+        high_word = detail::load_leading(text.data(), text.size() - 8);
+    }
+    else
+    {
+        low_word = detail::load_short(text.data(), text.size());
+    }
+    if ((detail::digit_bytes(low_word) & detail::digit_bytes(high_word)) != detail::SWAR_HIGHS)
+    {
+        return Status::invalid_serial;
+    }
+    serial = detail::parse_eight_digits(high_word) * 100000000 + detail::parse_eight_digits(low_word);
+    return Status::ok;
+}
+
+// Writes serial as exactly digits (at most MAX_PACKED_SERIAL_DIGITS)
+// zero-padded decimal characters; higher digits are dropped.
+constexpr void format_serial(uint64_t serial, size_t digits, std::span<char> out) noexcept
+{
+    std::array<char, MAX_PACKED_SERIAL_DIGITS> text{};
+    detail::store_word(detail::format_eight_digits(serial / 100000000 % 100000000), text.data());
+    detail::store_word(detail::format_eight_digits(serial % 100000000), text.data() + 8);
+    std::copy_n(text.end() - static_cast<std::ptrdiff_t>(digits), digits, out.begin());
+}
+
+// Parses an ENIGMA_C_KEY_LENGTH hex key, either case.
+[[nodiscard]] constexpr Status pack_nettool_key(std::string_view text, PackedNetToolKey& key) noexcept
+{
+    if (text.size() != ENIGMA_C_KEY_LENGTH) return Status::invalid_length;
+    const uint64_t low = detail::hex_values(detail::load_word(text.data()));
+    // Characters 8-11 in the low half, '0' padding above them.
+    const uint64_t high = detail::hex_values(detail::load_word(text.data() + 4) >> 32 | detail::SWAR_ZEROS << 32);
+    if (low == ~0ULL || high == ~0ULL) return Status::non_hex;
+    key.nibbles = detail::pack_nibbles(low) | detail::pack_nibbles(high) << 32;
+    return Status::ok;
+}
+
+// Writes the ENIGMA_C_KEY_LENGTH lowercase hex characters of key.
+constexpr void format_nettool_key(const PackedNetToolKey& key, std::span<char> out) noexcept
+{
+    std::array<char, 16> text{};
+    detail::store_word(detail::hex_characters(detail::unpack_nibbles(key.nibbles)), text.data());
+    detail::store_word(detail::hex_characters(detail::unpack_nibbles(key.nibbles >> 32)), text.data() + 8);
+    std::copy_n(text.begin(), ENIGMA_C_KEY_LENGTH, out.begin());
+}
+
+// Parses a KEY_LENGTH key or layout of 0-9 and A-Z.
+[[nodiscard]] constexpr Status pack_enigma2_key(std::string_view text, PackedEnigma2Key& key) noexcept
+{
+    if (text.size() != KEY_LENGTH) return Status::invalid_length;
+    for (size_t half = 0; half < 2; ++half)
+    {
+        const uint64_t word = detail::load_word(text.data() + 8 * half);
+        if ((detail::digit_bytes(word) | detail::bytes_between(word, 'A' - 1, 'Z' + 1)) != detail::SWAR_HIGHS)
+        {
+            return Status::invalid_character;
+        }
+        const uint64_t symbols = detail::symbol_values(word);
+        for (size_t i = 0; i < 8; ++i) key.symbols[8 * half + i] = static_cast<uint8_t>(symbols >> (8 * i));
+    }
+    return Status::ok;
+}
+
+// Writes the KEY_LENGTH characters of key.
+constexpr void format_enigma2_key(const PackedEnigma2Key& key, std::span<char> out) noexcept
+{
+    for (size_t half = 0; half < 2; ++half)
+    {
+        uint64_t symbols = 0;
+        for (size_t i = 0; i < 8; ++i) symbols |= static_cast<uint64_t>(key.symbols[8 * half + i]) << (8 * i);
+        detail::store_word(detail::symbol_characters(symbols), out.data() + 8 * half);
+    }
+}
+
+// EnigmaC on a packed plain layout; see enigma_c_encrypt().
+constexpr PackedNetToolKey enigma_c_encrypt(const PackedNetToolKey& plain) noexcept
+{
+    PackedNetToolKey key;
+    unsigned output_value = 0;
+    for (size_t index = 0; index < ENIGMA_C_KEY_LENGTH; ++index)
+    {
+        output_value = ENIGMA_C_ROTOR[(plain.digit(index) + index) % 16] ^ output_value;
+        key.nibbles |= static_cast<uint64_t>(output_value % 16) << (4 * index);
+    }
+    return key;
+}
+
+// EnigmaC: inverse of the packed enigma_c_encrypt().
+constexpr PackedNetToolKey enigma_c_decrypt(const PackedNetToolKey& key) noexcept
+{
+    PackedNetToolKey plain;
+    unsigned xor_value = 0;
+    for (size_t index = 0; index < ENIGMA_C_KEY_LENGTH; ++index)
+    {
+        const unsigned old_output = key.digit(index);
+        const unsigned value = (ENIGMA_C_ROTOR_INVERSE[old_output ^ xor_value] + 16 - index % 16) % 16;
+        plain.nibbles |= static_cast<uint64_t>(value) << (4 * index);
+        xor_value = old_output;
+    }
+    return plain;
+}
+
+// enigma_c_check_option_key() on a packed key and serial.
+constexpr bool enigma_c_check_option_key(int option, const PackedNetToolKey& key, uint64_t serial) noexcept
+{
+    const PackedNetToolKey plain = enigma_c_decrypt(key);
+    // Digits 0-9 hold the serial, least significant first.
+    uint64_t decoded = 0;
+    for (size_t i = SERIAL_NUMBER_SIZE_ENIGMAC; i-- > 0;)
+    {
+        if (plain.digit(i) > 9) return false;
+        decoded = decoded * 10 + plain.digit(i);
+    }
+    if (decoded != serial || plain.digit(10) > 9) return false;
+    int opt = static_cast<int>(plain.digit(10));
+    if (plain.digit(11) <= 9) opt = opt * 10 + static_cast<int>(plain.digit(11));
+    return opt == option;
+}
+
+// nettool_option_key() for a packed serial below 10^10.
+[[nodiscard]] constexpr Status nettool_option_key(uint64_t serial, int option, PackedNetToolKey& key) noexcept
+{
+    if (serial > 9999999999ULL) return Status::invalid_serial;
+    if (option < 0 || option > NETTOOL_MAX_OPTION) return Status::invalid_option;
+    PackedNetToolKey plain;
+    plain.nibbles = static_cast<uint64_t>(option) << 4;
+    for (size_t i = 0; i < SERIAL_NUMBER_SIZE_ENIGMAC; ++i, serial /= 10)
+    {
+        plain.nibbles |= (serial % 10) << (4 * (2 + i));
+    }
+    key = enigma_c_encrypt(plain);
+    return Status::ok;
+}
+
+// Enigma2C on a packed plain layout, filling in the checksum; see
+// enigma2_c_encrypt().
+constexpr PackedEnigma2Key enigma2_c_encrypt(const PackedEnigma2Key& plain) noexcept
+{
+    PackedEnigma2Key key = plain;
+    int checksum = 1;
+    for (size_t i = 2; i < KEY_LENGTH; ++i)
+    {
+        const int temp_sum = plain.symbols[i] < 10 ? plain.symbols[i] : plain.symbols[i] - 10;
+        checksum += static_cast<int>(i) + temp_sum + (static_cast<int>(i) * temp_sum);
+    }
+    checksum = 100 - (checksum % 100);
+    key.symbols[0] = static_cast<uint8_t>(checksum % 10);
+    key.symbols[1] = static_cast<uint8_t>((checksum / 10) % 10);
+    int running_sum = 0;
+    for (size_t i = 0; i < KEY_LENGTH; ++i)
+    {
+        const bool digit = key.symbols[i] < 10;
+        const int temp_sum = digit ? key.symbols[i] : key.symbols[i] - 10;
+        const int rotor_index = temp_sum + MAX_CHECK_SUM - running_sum;
+        key.symbols[i] = digit ? ENIGMA2_E_ROTOR_10[rotor_index % 10]
+                               : static_cast<uint8_t>(10 + ENIGMA2_E_ROTOR_26[rotor_index % 26]);
+        running_sum += static_cast<int>(i) + temp_sum + (static_cast<int>(i) * temp_sum);
+    }
+    return key;
+}
+
+// Enigma2C: decrypts a packed key into plain; see enigma2_c_decrypt().
+[[nodiscard]] constexpr Status enigma2_c_decrypt(const PackedEnigma2Key& key, PackedEnigma2Key& plain) noexcept
+{
+    int checksum = 0;
+    for (size_t i = 0; i < KEY_LENGTH; ++i)
+    {
+        const bool digit = key.symbols[i] < 10;
+        const int temp_sum = digit ? (ENIGMA2_D_ROTOR_10[key.symbols[i]] + checksum) % 10
+                                   : (ENIGMA2_D_ROTOR_26[key.symbols[i] - 10] + checksum) % 26;
+        plain.symbols[i] = static_cast<uint8_t>(digit ? temp_sum : 10 + temp_sum);
+        checksum += static_cast<int>(i) + temp_sum + (static_cast<int>(i) * temp_sum);
+    }
+    // The text form adds the character code of position 1 less '0'.
+    checksum += 8 * (plain.symbols[1] < 10 ? plain.symbols[1] : plain.symbols[1] + 7);
+    return (checksum % 100 == 0) ? Status::ok : Status::checksum_mismatch;
+}
+
+// enigma2_c_check_option_key() on a packed key.
+constexpr bool enigma2_c_check_option_key(int option, const PackedEnigma2Key& key) noexcept
+{
+    PackedEnigma2Key plain;
+    if (enigma2_c_decrypt(key, plain) != Status::ok) return false;
+    const int opt = plain.option();
+    return opt >= 0 && opt == option;
+}
+
+// enigma2_option_key() for a packed serial below 10^7.
+[[nodiscard]] constexpr Status enigma2_option_key(int product, uint64_t serial, int option,
+                                                  PackedEnigma2Key& key) noexcept
+{
+    if (product < 0 || product > MAX_PRODUCT_CODE) return Status::invalid_product;
+    if (serial > 9999999) return Status::invalid_serial;
+    if (option < 0 || option > ENIGMA2_MAX_OPTION) return Status::invalid_option;
+    PackedEnigma2Key plain;
+    const auto put = [&plain](uint64_t value, size_t location, size_t length)
+    {
+        for (size_t i = location + length; i-- > location; value /= 10) plain.symbols[i] = value % 10;
+    };
+    put(static_cast<uint64_t>(product), PRODUCT_LOCATION, PRODUCT_CODE_SIZE);
+    put(serial, SERIAL_LOCATION, SERIAL_NUMBER_SIZE_ENIGMA2);
+    put(static_cast<uint64_t>(option), OPTION_LOCATION, OPTION_CODE_SIZE);
+    key = enigma2_c_encrypt(plain);
+    return Status::ok;
+}
+} // namespace enigma
+
+#endif //ENIGMA_PACKED_H
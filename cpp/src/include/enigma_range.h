@@ -0,0 +1,185 @@
+//
+// Keys for a run of consecutive serials with one option (and product).
+//
+// Generating each key from scratch re-validates and re-lays-out the plain
+// key and walks every position twice. Along a range only the low serial
+// digits change, so a range cursor keeps the plain layout and the running
+// state of each algorithm, and advance() redoes only the positions whose
+// digits changed:
+//
+//   NetTool  - the key is a running XOR of per-digit rotor terms, and the
+//              serial is stored reversed, so its changing low digits come
+//              first. advance() recomputes the terms of the changed digits
+//              and XORs the difference into the rest of the key.
+//   Enigma2C - the checksum and the running sums are sums of per-position
+//              terms. advance() recomputes the terms of the changed digits
+//              and the prefix sums after them; the checksum digits still
+//              shift every output digit, so all sixteen are looked up again.
+//
+// The cursors produce exactly the keys of nettool_option_key() and
+// enigma2_option_key(), and are constexpr like them.
+//
+
+#ifndef ENIGMA_RANGE_H
+#define ENIGMA_RANGE_H
+
+#include "enigma_v300_pure_cpp.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace enigma
+{
+constexpr uint64_t NETTOOL_MAX_SERIAL = 9999999999ULL;
+constexpr uint64_t ENIGMA2_MAX_SERIAL = 9999999;
+
+// NetTool keys for serial, serial + 1, ... with a fixed option.
+class NetToolKeyRange
+{
+public:
+    // Positions the cursor at serial. On failure the cursor is unchanged.
+    [[nodiscard]] constexpr Status start(uint64_t serial, int option) noexcept
+    {
+        if (serial > NETTOOL_MAX_SERIAL) return Status::invalid_serial;
+        if (option < 0 || option > NETTOOL_MAX_OPTION) return Status::invalid_option;
+        serial_ = serial;
+        digits_[0] = 0;
+        digits_[1] = static_cast<uint8_t>(option);
+        for (size_t i = 0; i < SERIAL_NUMBER_SIZE_ENIGMAC; ++i, serial /= 10)
+        {
+            digits_[2 + i] = static_cast<uint8_t>(serial % 10);
+        }
+        int value = 0;
+        for (size_t i = 0; i < ENIGMA_C_KEY_LENGTH; ++i)
+        {
+            value ^= term(i);
+            values_[i] = static_cast<uint8_t>(value);
+            key_[i] = detail::hex_digit(value % 16);
+        }
+        return Status::ok;
+    }
+
+    constexpr uint64_t serial() const noexcept { return serial_; }
+    constexpr std::string_view key() const noexcept { return {key_.data(), key_.size()}; }
+
+    // Moves to the next serial. Returns false, leaving the cursor unchanged,
+    // at NETTOOL_MAX_SERIAL.
+    constexpr bool advance() noexcept
+    {
+        if (serial_ == NETTOOL_MAX_SERIAL) return false;
+        ++serial_;
+        size_t last = 2; // serial digits, least significant first
+        while (last < ENIGMA_C_KEY_LENGTH - 1 && digits_[last] == 9)
+        {
+            digits_[last++] = 0;
+        }
+        ++digits_[last];
+        const int before = values_[last];
+        int value = values_[1];
+        for (size_t i = 2; i <= last; ++i)
+        {
+            value ^= term(i);
+            values_[i] = static_cast<uint8_t>(value);
+            key_[i] = detail::hex_digit(value % 16);
+        }
+        const int change = before ^ value;
+        for (size_t i = last + 1; i < ENIGMA_C_KEY_LENGTH; ++i)
+        {
+            values_[i] = static_cast<uint8_t>(values_[i] ^ change);
+            key_[i] = detail::hex_digit(values_[i] % 16);
+        }
+        return true;
+    }
+
+private:
+    constexpr int term(size_t index) const noexcept
+    {
+        return ENIGMA_C_ROTOR[(digits_[index] + index) % 16];
+    }
+
+    std::array<uint8_t, ENIGMA_C_KEY_LENGTH> digits_{}; // plain layout: "0", option, serial reversed
+    std::array<uint8_t, ENIGMA_C_KEY_LENGTH> values_{}; // running XOR after each position
+    std::array<char, ENIGMA_C_KEY_LENGTH> key_{};
+    uint64_t serial_ = 0;
+};
+
+// Enigma2C keys for serial, serial + 1, ... with a fixed product and option.
+class Enigma2KeyRange
+{
+public:
+    // Positions the cursor at serial. On failure the cursor is unchanged.
+    [[nodiscard]] constexpr Status start(int product, uint64_t serial, int option) noexcept
+    {
+        if (product < 0 || product > MAX_PRODUCT_CODE) return Status::invalid_product;
+        if (serial > ENIGMA2_MAX_SERIAL) return Status::invalid_serial;
+        if (option < 0 || option > ENIGMA2_MAX_OPTION) return Status::invalid_option;
+        serial_ = serial;
+        put(static_cast<uint64_t>(product), PRODUCT_LOCATION, PRODUCT_CODE_SIZE);
+        put(serial, SERIAL_LOCATION, SERIAL_NUMBER_SIZE_ENIGMA2);
+        put(static_cast<uint64_t>(option), OPTION_LOCATION, OPTION_CODE_SIZE);
+        update(PRODUCT_LOCATION);
+        return Status::ok;
+    }
+
+    constexpr uint64_t serial() const noexcept { return serial_; }
+    constexpr std::string_view key() const noexcept { return {key_.data(), key_.size()}; }
+
+    // Moves to the next serial. Returns false, leaving the cursor unchanged,
+    // at ENIGMA2_MAX_SERIAL.
+    constexpr bool advance() noexcept
+    {
+        if (serial_ == ENIGMA2_MAX_SERIAL) return false;
+        ++serial_;
+        // Below ENIGMA2_MAX_SERIAL the leading digit is not 9, so the carry
+        // stops there; the bound lets the compiler see it.
+        size_t first = SERIAL_LOCATION + SERIAL_NUMBER_SIZE_ENIGMA2 - 1;
+        while (first > SERIAL_LOCATION && digits_[first] == 9)
+        {
+            digits_[first--] = 0;
+        }
+        ++digits_[first];
+        update(first);
+        return true;
+    }
+
+private:
+    // What position index adds to the checksum and to every later running sum.
+    static constexpr int term(size_t index, int digit) noexcept
+    {
+        return static_cast<int>(index) + digit + (static_cast<int>(index) * digit);
+    }
+
+    constexpr void put(uint64_t value, size_t location, size_t length) noexcept
+    {
+        for (size_t i = location + length; i-- > location; value /= 10) digits_[i] = static_cast<uint8_t>(value % 10);
+    }
+
+    // Redoes the prefix sums from position first on, then the whole key.
+    constexpr void update(size_t first) noexcept
+    {
+        for (size_t i = first; i < KEY_LENGTH; ++i) prefix_[i + 1] = prefix_[i] + term(i, digits_[i]);
+        const int checksum = 100 - ((1 + prefix_[KEY_LENGTH]) % 100);
+        const int low = checksum % 10;
+        const int high = (checksum / 10) % 10;
+        key_[0] = rotor(low, 0);
+        key_[1] = rotor(high, term(0, low));
+        const int leading = term(0, low) + term(1, high);
+        for (size_t i = PRODUCT_LOCATION; i < KEY_LENGTH; ++i) key_[i] = rotor(digits_[i], leading + prefix_[i]);
+    }
+
+    static constexpr char rotor(int digit, int running_sum) noexcept
+    {
+        // Narrowing conversion is intentional: result is guaranteed to be in range 0-9
+        return static_cast<char>(ENIGMA2_E_ROTOR_10[(digit + MAX_CHECK_SUM - running_sum) % 10] + '0');
+    }
+
+    std::array<uint8_t, KEY_LENGTH> digits_{}; // plain layout from position 2: product, serial, option
+    std::array<int, KEY_LENGTH + 1> prefix_{}; // prefix_[i]: terms of positions 2 to i - 1
+    std::array<char, KEY_LENGTH> key_{};
+    uint64_t serial_ = 0;
+};
+} // namespace enigma
+
+#endif //ENIGMA_RANGE_H
@@ -0,0 +1,92 @@
+//
+// Bounded multi-producer, multi-consumer ring buffer connecting the batch
+// pipeline's stages.
+//
+// Every slot carries a sequence number, as in Vyukov's bounded queue. A
+// producer takes a ticket from tail_, waits until its slot's sequence shows
+// the slot free for that ticket, stores the value and publishes ticket + 1;
+// a consumer takes a ticket from head_, waits for ticket + 1, moves the
+// value out and frees the slot for the producer one lap later. No locks are
+// taken. A full or empty ring parks the caller in std::atomic::wait() on the
+// slot it needs, so a stage that falls behind stalls the one feeding it
+// instead of letting memory grow.
+//
+
+#ifndef ENIGMA_RING_H
+#define ENIGMA_RING_H
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+namespace enigma
+{
+template <typename T>
+class BoundedQueue
+{
+public:
+    // Holds at least capacity values (rounded up to a power of two).
+    explicit BoundedQueue(size_t capacity)
+        : slots_(std::make_unique<Slot[]>(std::bit_ceil(std::max<size_t>(capacity, 1)))),
+          mask_(static_cast<uint32_t>(std::bit_ceil(std::max<size_t>(capacity, 1)) - 1))
+    {
+        for (uint32_t i = 0; i <= mask_; ++i) slots_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    BoundedQueue(const BoundedQueue&) = delete;
+    BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+    // Appends value, waiting while the ring is full.
+    void push(T value) noexcept
+    {
+        const uint32_t ticket = tail_.fetch_add(1, std::memory_order_relaxed);
+        Slot& slot = slots_[ticket & mask_];
+        wait_for(slot, ticket);
+        slot.value = std::move(value);
+        slot.sequence.store(ticket + 1, std::memory_order_release);
+        slot.sequence.notify_all();
+    }
+
+    // Removes the oldest value, waiting while the ring is empty.
+    T pop() noexcept
+    {
+        const uint32_t ticket = head_.fetch_add(1, std::memory_order_relaxed);
+        Slot& slot = slots_[ticket & mask_];
+        wait_for(slot, ticket + 1);
+        T value = std::move(slot.value);
+        slot.sequence.store(ticket + mask_ + 1, std::memory_order_release);
+        slot.sequence.notify_all();
+        return value;
+    }
+
+    size_t capacity() const noexcept { return static_cast<size_t>(mask_) + 1; }
+
+private:
+    // Tickets and sequences wrap at 2^32; only equality is ever tested.
+    struct alignas(64) Slot
+    {
+        std::atomic<uint32_t> sequence{0};
+        T value{};
+    };
+
+    static void wait_for(const Slot& slot, uint32_t sequence) noexcept
+    {
+        for (uint32_t seen = slot.sequence.load(std::memory_order_acquire); seen != sequence;
+             seen = slot.sequence.load(std::memory_order_acquire))
+        {
+            slot.sequence.wait(seen, std::memory_order_acquire);
+        }
+    }
+
+    std::unique_ptr<Slot[]> slots_;
+    uint32_t mask_;
+    alignas(64) std::atomic<uint32_t> tail_{0};
+    alignas(64) std::atomic<uint32_t> head_{0};
+};
+} // namespace enigma
+
+#endif //ENIGMA_RING_H
@@ -0,0 +1,112 @@
+//
+// Long-running key service: answers generate, verify and decode requests
+// over a Unix domain socket or TCP, so callers skip process startup.
+//
+// The protocol is line based. Each request is one line:
+//
+//     GEN MODE,SERIAL,OPTION[,PRODUCT]     batch generation record
+//     VERIFY KEY,SERIAL,OPTION[,PRODUCT]   batch verification record
+//     DECODE KEY                           Enigma2C key
+//     PING
+//     STATS                                result cache counters: hits, misses, evictions
+//     QUIT                                 close after answering earlier requests
+//
+// and gets exactly one response line, tab-separated: "OK" followed by the
+// result fields, or "ERR" and a message. A connection whose request is
+// "GET /metrics HTTP/1.x" instead gets an HTTP response carrying the
+// enigma_stats.h counters and histograms in Prometheus text format, and is
+// closed; builds without ENIGMA_STATS answer 404. Requests may be pipelined; all of
+// the requests that arrive together are answered with a single write, in
+// order.
+//
+// A fixed set of event-loop threads serves every connection. On Linux each
+// thread waits on its own edge-triggered epoll instance and accepts its own
+// connections; elsewhere a single thread uses poll(). Each connection gets
+// fixed-size input and output rings when it is accepted, so serving a
+// request allocates nothing. Closed connections are kept per thread and
+// reused, rings included, so once warm a thread allocates nothing for new
+// connections either. With ServerOptions::cache_entries, each thread
+// also keeps a KeyCache of GEN and DECODE results. Each thread allocates
+// its own cache and buffers, so with ServerOptions::affinity, which pins
+// thread i to affinity_cpus()[i], they sit on that thread's NUMA node.
+//
+// Available on POSIX systems, where ENIGMA_HAVE_SERVER is defined.
+//
+
+#ifndef ENIGMA_SERVER_H
+#define ENIGMA_SERVER_H
+
+#include "enigma_catalog.h"
+#include "enigma_key_cache.h"
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace enigma
+{
+// Longest request line accepted; a connection sending a longer one is
+// answered with an error and closed.
+constexpr size_t MAX_REQUEST_LINE = 4096;
+
+struct ServerOptions
+{
+    std::string address;                     // "unix:PATH" or "tcp:HOST:PORT"; port 0 picks a free one
+    const Catalog* catalog = &BUILTIN_CATALOG;
+    unsigned threads = 1;                    // event-loop threads; 0 = one per hardware thread (Linux only)
+    size_t cache_entries = 0;                // per-thread GEN/DECODE result cache; 0 = none
+    bool affinity = false;                   // pin the event-loop threads to CPUs, grouped by NUMA node
+};
+
+// Appends the response line for one request line (without its newline).
+// Returns false when the connection should be closed afterwards (QUIT).
+// GEN and DECODE results are looked up in and added to cache, if given.
+// STATS is answered by the Server, not here.
+bool handle_request(std::string_view request, std::string& response, const Catalog& catalog = BUILTIN_CATALOG,
+                    KeyCache* cache = nullptr);
+
+class Server
+{
+public:
+    // Binds and listens on options.address. Returns nullptr and sets error
+    // if the address is malformed or cannot be bound.
+    static std::unique_ptr<Server> listen(const ServerOptions& options, std::string& error);
+
+    ~Server();
+    Server(const Server&) = delete;
+    Server& operator=(const Server&) = delete;
+
+    // The address actually bound, in the options.address syntax, with the
+    // real port for "tcp:HOST:0".
+    const std::string& address() const noexcept { return address_; }
+
+    // Serves connections until stop() is called, on the calling thread plus
+    // options.threads - 1 more. Connections are closed when it returns.
+    void run();
+
+    // Makes run() return after the current iteration. Safe to call from
+    // another thread or a signal handler.
+    void stop() noexcept;
+
+    // Result cache counters summed over every thread; all zero without a
+    // cache. Safe to call while run() is serving.
+    KeyCacheStats cache_stats() const noexcept;
+
+private:
+    struct Worker;
+
+    explicit Server(const ServerOptions& options);
+
+    void serve(Worker& worker);
+
+    ServerOptions options_;
+    std::string address_;
+    std::string unix_path_; // removed on destruction
+    int listen_fd_ = -1;
+    int wake_fds_[2] = {-1, -1}; // self-pipe written by stop(), never drained while running
+    std::vector<std::unique_ptr<Worker>> workers_;
+};
+} // namespace enigma
+
+#endif //ENIGMA_SERVER_H
@@ -0,0 +1,79 @@
+//
+// Struct-of-arrays EnigmaC and Enigma2C kernels that process many keys at
+// once.
+//
+// Both algorithms are a serial chain per key (each character depends on
+// the ones before it), so a single key cannot be vectorised; independent
+// keys can. The kernels below take a block of keys laid out
+// position-major:
+//
+//     input[position * keys + key]
+//
+// and write the result in the same layout. Byte-shuffle instructions
+// (pshufb, NEON tbl) serve as the rotor lookups, so every instruction
+// advances 16, 32 or 64 keys. The widest kernel the CPU supports is
+// selected at runtime; there is always a scalar fallback.
+//
+
+#ifndef ENIGMA_SIMD_H
+#define ENIGMA_SIMD_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace enigma
+{
+enum class SimdLevel
+{
+    scalar,
+    ssse3,  // 16 keys per instruction; EnigmaC only
+    avx2,   // 32 keys per instruction
+    avx512, // 64 keys per instruction (AVX-512BW)
+    neon,   // 16 keys per instruction
+};
+
+// Short lowercase name of level, for logs and benchmark output.
+const char* simd_level_name(SimdLevel level) noexcept;
+
+// True when this build contains a kernel for level and the CPU can run it.
+bool simd_level_supported(SimdLevel level) noexcept;
+
+// The level the kernels below use by default: the widest supported one,
+// detected once on first use. Enigma2C has no SSSE3 kernel; at that level
+// it runs the scalar one.
+SimdLevel simd_level() noexcept;
+
+// Encrypts keys keys of positions digits each, as enigma_c_encrypt() does
+// one at a time. Only the low four bits of each input byte are used; output
+// bytes are 0-15 (pass them through detail::hex_digit() for text). input
+// and output must not overlap.
+void enigma_c_encrypt_soa(const uint8_t* input, uint8_t* output, size_t positions, size_t keys) noexcept;
+
+// Inverse of enigma_c_encrypt_soa(), as enigma_c_decrypt() one key at a time.
+void enigma_c_decrypt_soa(const uint8_t* input, uint8_t* output, size_t positions, size_t keys) noexcept;
+
+// Same, forcing a specific kernel. level must be supported; used by the
+// tests and benchmarks to compare kernels against the scalar one.
+void enigma_c_encrypt_soa(SimdLevel level, const uint8_t* input, uint8_t* output, size_t positions,
+                          size_t keys) noexcept;
+void enigma_c_decrypt_soa(SimdLevel level, const uint8_t* input, uint8_t* output, size_t positions,
+                          size_t keys) noexcept;
+
+// Encrypts keys Enigma2C layouts of KEY_LENGTH characters, as
+// enigma2_c_encrypt() does one at a time, filling in the checksum digits at
+// positions 0 and 1. Every character must be 0-9 or A-Z; callers validate
+// first, since the kernel does not. input and output must not overlap.
+void enigma2_c_encrypt_soa(const char* input, char* output, size_t keys) noexcept;
+
+// Decrypts keys Enigma2C keys of KEY_LENGTH characters, as
+// enigma2_c_decrypt() does one at a time. checksum_ok[key] is set to 1 when
+// the key passes its checksum and 0 otherwise. Characters must be 0-9 or
+// A-Z, as for enigma2_c_encrypt_soa().
+void enigma2_c_decrypt_soa(const char* input, char* output, uint8_t* checksum_ok, size_t keys) noexcept;
+
+void enigma2_c_encrypt_soa(SimdLevel level, const char* input, char* output, size_t keys) noexcept;
+void enigma2_c_decrypt_soa(SimdLevel level, const char* input, char* output, uint8_t* checksum_ok,
+                           size_t keys) noexcept;
+} // namespace enigma
+
+#endif //ENIGMA_SIMD_H
@@ -0,0 +1,204 @@
+//
+// Optional hot-path instrumentation: event counters and latency histograms.
+//
+// Each thread records into its own slot. The hooks are single-writer
+// relaxed stores (no read-modify-write, no locks), so recording costs a
+// thread-local lookup, an add and, for a timer, two steady_clock reads.
+// snapshot() sums every live slot, plus the totals of threads that have
+// exited, while they keep recording; a snapshot is consistent per value,
+// not across values.
+//
+// Histograms are log-linear, as in HdrHistogram: each power of two of
+// nanoseconds is split into SUB_BUCKETS linear buckets, so any recorded
+// value is within 1/SUB_BUCKETS of its bucket's bounds from 1 ns to 2^64 ns.
+//
+// The hooks exist only when ENIGMA_STATS is defined (the CMake option of
+// that name). Otherwise count() and ScopedTimer are empty inline functions
+// and compile to nothing; snapshot() still links but reports zeros.
+//
+// Timers are placed around work of at least one SIMD block or one request.
+// Single keys are counted but not timed, since two clock reads would cost
+// more than the key.
+//
+
+#ifndef ENIGMA_STATS_H
+#define ENIGMA_STATS_H
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#ifdef ENIGMA_STATS
+#include <atomic>
+#include <chrono>
+#endif
+
+namespace enigma::stats
+{
+#ifdef ENIGMA_STATS
+constexpr bool enabled = true;
+#else
+constexpr bool enabled = false;
+#endif
+
+enum class Counter
+{
+    keys_encrypted,  // SIMD kernel lanes (padding included) and single keys
+    keys_decrypted,
+    batch_records,   // records that produced an output line
+    batch_errors,    // of which were error lines
+    server_requests,
+    server_errors,   // requests answered with ERR
+};
+constexpr size_t COUNTER_COUNT = 6;
+
+enum class Timer
+{
+    encrypt_block,  // one SIMD kernel call, EnigmaC or Enigma2C
+    decrypt_block,
+    batch_read,     // reading and line-framing one pipeline block
+    batch_compute,  // parsing and generating (or verifying) one block
+    batch_write,    // writing one block's output
+    server_request, // answering one request line
+};
+constexpr size_t TIMER_COUNT = 6;
+
+constexpr unsigned SUB_BUCKET_BITS = 3;
+constexpr size_t SUB_BUCKETS = size_t{1} << SUB_BUCKET_BITS;
+constexpr size_t BUCKET_COUNT = (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+// Bucket of a value in nanoseconds: values below SUB_BUCKETS have one
+// bucket each, then SUB_BUCKETS per power of two.
+constexpr size_t bucket_index(uint64_t value) noexcept
+{
+    if (value < SUB_BUCKETS) return static_cast<size_t>(value);
+    const unsigned shift = static_cast<unsigned>(std::bit_width(value)) - 1 - SUB_BUCKET_BITS;
+    return (shift + 1) * SUB_BUCKETS + static_cast<size_t>((value >> shift) & (SUB_BUCKETS - 1));
+}
+
+// Largest value that falls in bucket index.
+constexpr uint64_t bucket_upper_bound(size_t index) noexcept
+{
+    if (index < SUB_BUCKETS) return index;
+    const unsigned shift = static_cast<unsigned>(index / SUB_BUCKETS) - 1;
+    const uint64_t lower = (SUB_BUCKETS + index % SUB_BUCKETS) << shift;
+    return lower + ((uint64_t{1} << shift) - 1);
+}
+
+struct HistogramSnapshot
+{
+    uint64_t count = 0;
+    uint64_t sum = 0; // nanoseconds
+    uint64_t max = 0;
+    std::array<uint64_t, BUCKET_COUNT> buckets{};
+
+    // Upper bound of the bucket holding quantile q (0-1) of the values; 0
+    // when empty. Never above max.
+    uint64_t quantile(double q) const noexcept;
+};
+
+struct Snapshot
+{
+    std::array<uint64_t, COUNTER_COUNT> counters{};
+    std::array<HistogramSnapshot, TIMER_COUNT> timers{};
+
+    uint64_t counter(Counter c) const noexcept { return counters[static_cast<size_t>(c)]; }
+    const HistogramSnapshot& timer(Timer t) const noexcept { return timers[static_cast<size_t>(t)]; }
+};
+
+// Stable lowercase names, as used in both output formats.
+const char* counter_name(Counter counter) noexcept;
+const char* timer_name(Timer timer) noexcept;
+
+// Everything recorded so far by every thread.
+Snapshot snapshot();
+
+// Prometheus text exposition (version 0.0.4): an enigma_<name>_total
+// counter per Counter and an enigma_<name>_seconds histogram per Timer.
+void append_prometheus(std::string& output, const Snapshot& snapshot);
+
+// Human-readable summary for --stats: counters, then count, total and
+// p50/p99/max latency for each timer that recorded anything.
+void append_summary(std::string& output, const Snapshot& snapshot);
+
+#ifdef ENIGMA_STATS
+namespace detail
+{
+struct Histogram
+{
+    std::atomic<uint64_t> count{0};
+    std::atomic<uint64_t> sum{0};
+    std::atomic<uint64_t> max{0};
+    std::array<std::atomic<uint64_t>, BUCKET_COUNT> buckets{};
+};
+
+struct ThreadStats
+{
+    std::array<std::atomic<uint64_t>, COUNTER_COUNT> counters{};
+    std::array<Histogram, TIMER_COUNT> timers{};
+};
+
+// The calling thread's slot, registered on first use.
+ThreadStats& local() noexcept;
+
+// Only the owning thread writes a slot, so a plain load and store is enough
+// and readers never see a torn value.
+inline void bump(std::atomic<uint64_t>& value, uint64_t amount) noexcept
+{
+    value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+}
+
+inline void record(Timer timer, uint64_t nanoseconds) noexcept
+{
+    Histogram& histogram = local().timers[static_cast<size_t>(timer)];
+    bump(histogram.count, 1);
+    bump(histogram.sum, nanoseconds);
+    bump(histogram.buckets[bucket_index(nanoseconds)], 1);
+    if (nanoseconds > histogram.max.load(std::memory_order_relaxed))
+    {
+        histogram.max.store(nanoseconds, std::memory_order_relaxed);
+    }
+}
+} // namespace detail
+
+inline void count(Counter counter, uint64_t amount = 1) noexcept
+{
+    detail::bump(detail::local().counters[static_cast<size_t>(counter)], amount);
+}
+
+// Records the time from construction to destruction under timer.
+class ScopedTimer
+{
+public:
+    explicit ScopedTimer(Timer timer) noexcept : timer_(timer), start_(std::chrono::steady_clock::now()) {}
+
+    ~ScopedTimer()
+    {
+        const auto elapsed = std::chrono::steady_clock::now() - start_;
+        detail::record(timer_, static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+    }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    Timer timer_;
+    std::chrono::steady_clock::time_point start_;
+};
+#else
+inline void count(Counter, uint64_t = 1) noexcept
+{
+}
+
+class ScopedTimer
+{
+public:
+    explicit ScopedTimer(Timer) noexcept {}
+};
+#endif
+} // namespace enigma::stats
+
+#endif //ENIGMA_STATS_H
@@ -0,0 +1,211 @@
+//
+// Pull-based streaming over the batch engine, for coroutine callers.
+//
+// stream_batch() is a C++20 coroutine generator: it takes records from an
+// input range only as the caller asks for results, gathers up to
+// StreamOptions::block_records of them, runs the block through
+// generate_batch() (so keys are encrypted 64 at a time by the SIMD
+// kernels) or verify_batch(), and yields the block's output. The input and
+// output buffers are reused from block to block, so memory stays bounded
+// by one block whatever the length of the input, and once they have grown
+// to size no further allocation is made.
+//
+// Generator<T> is a minimal synchronous generator in the style of C++23's
+// std::generator. A coroutine-based service iterates it between its own
+// co_await points, for example sending each yielded chunk before pulling
+// the next:
+//
+//     for (std::string_view chunk : enigma::stream_batch(records))
+//     {
+//         co_await socket.write(chunk);
+//     }
+//
+// Each yielded view is valid until the generator is resumed or destroyed.
+//
+
+#ifndef ENIGMA_STREAM_H
+#define ENIGMA_STREAM_H
+
+#include "enigma_batch.h"
+
+#include <algorithm>
+#include <concepts>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <ranges>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace enigma
+{
+// Coroutine producing a sequence of T with co_yield. The body runs only
+// while the caller advances an iterator, on the caller's thread. An
+// exception thrown by the body is rethrown from begin() or operator++.
+template <typename T>
+class Generator
+{
+public:
+    struct promise_type
+    {
+        const T* value = nullptr; // the operand of the last co_yield, alive until resumed
+        std::exception_ptr exception;
+
+        Generator get_return_object() noexcept
+        {
+            return Generator(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        std::suspend_always yield_value(const T& yielded) noexcept
+        {
+            value = std::addressof(yielded);
+            return {};
+        }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { exception = std::current_exception(); }
+
+        // Generators run synchronously; there is nothing to await.
+        template <typename U>
+        std::suspend_never await_transform(U&&) = delete;
+    };
+
+    class iterator
+    {
+    public:
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+
+        iterator() = default;
+
+        const T& operator*() const noexcept { return *coroutine_.promise().value; }
+        const T* operator->() const noexcept { return coroutine_.promise().value; }
+
+        iterator& operator++()
+        {
+            resume(coroutine_);
+            return *this;
+        }
+        void operator++(int) { ++*this; }
+
+        friend bool operator==(const iterator& it, std::default_sentinel_t) noexcept
+        {
+            return !it.coroutine_ || it.coroutine_.done();
+        }
+
+    private:
+        friend class Generator;
+        explicit iterator(std::coroutine_handle<promise_type> coroutine) noexcept : coroutine_(coroutine) {}
+
+        std::coroutine_handle<promise_type> coroutine_;
+    };
+
+    Generator(Generator&& other) noexcept : coroutine_(std::exchange(other.coroutine_, {})) {}
+    Generator& operator=(Generator&& other) noexcept
+    {
+        if (this != &other)
+        {
+            if (coroutine_) coroutine_.destroy();
+            coroutine_ = std::exchange(other.coroutine_, {});
+        }
+        return *this;
+    }
+    ~Generator()
+    {
+        if (coroutine_) coroutine_.destroy();
+    }
+
+    // Runs the body to its first co_yield. Call once.
+    iterator begin()
+    {
+        if (coroutine_) resume(coroutine_);
+        return iterator(coroutine_);
+    }
+    std::default_sentinel_t end() const noexcept { return {}; }
+
+private:
+    explicit Generator(std::coroutine_handle<promise_type> coroutine) noexcept : coroutine_(coroutine) {}
+
+    static void resume(std::coroutine_handle<promise_type> coroutine)
+    {
+        coroutine.resume();
+        if (coroutine.promise().exception) std::rethrow_exception(std::exchange(coroutine.promise().exception, {}));
+    }
+
+    std::coroutine_handle<promise_type> coroutine_;
+};
+
+struct StreamOptions
+{
+    BatchTask task = BatchTask::generate;
+    KeyFormat output = KeyFormat::text;      // for BatchTask::generate
+    VerifyFormat format = VerifyFormat::tsv; // for BatchTask::verify
+    KeyCache* cache = nullptr;               // for BatchTask::generate; may be null
+    size_t block_records = 256;              // input records per yielded chunk (at least 1)
+    BatchStats* stats = nullptr;             // totals are added here as blocks complete, if given
+};
+
+namespace detail
+{
+template <std::ranges::input_range Records>
+Generator<std::string_view> stream_batch(Records records, StreamOptions options)
+{
+    if (options.task == BatchTask::generate && options.output == KeyFormat::binary)
+    {
+        const auto header = encode_binary_key_header();
+        co_yield std::string_view(header.data(), header.size());
+    }
+    const size_t block_records = std::max<size_t>(options.block_records, 1);
+    std::string input;
+    std::string output;
+    auto it = std::ranges::begin(records);
+    const auto last = std::ranges::end(records);
+    for (auto position = BatchPosition::start; it != last; position = BatchPosition::continuation)
+    {
+        input.clear();
+        for (size_t count = 0; count < block_records && it != last; ++count, ++it)
+        {
+            input.append(std::string_view(*it));
+            input.push_back('\n');
+        }
+        output.clear();
+        const BatchStats block = options.task == BatchTask::verify
+                                     ? verify_batch(input, output, options.format, position)
+                                     : generate_batch(input, output, options.output, options.cache, position);
+        if (options.stats)
+        {
+            options.stats->records += block.records;
+            options.stats->errors += block.errors;
+            options.stats->cache_hits += block.cache_hits;
+            options.stats->cache_misses += block.cache_misses;
+        }
+        if (!output.empty()) co_yield std::string_view(output);
+    }
+}
+} // namespace detail
+
+// Streams the batch output for records, an input range of one record per
+// element (anything convertible to std::string_view, without its newline).
+// Each chunk is the output of up to options.block_records records, exactly
+// as generate_batch() or verify_batch() would append it, so concatenating
+// the chunks gives run_batch()'s output for the same records; in binary
+// format the first chunk is the BinaryKeyHeader. Chunks whose records were
+// all skip lines are not yielded.
+//
+// An lvalue range is referenced, not copied, and must outlive the
+// generator; an rvalue range is moved into it. Records are read lazily, so
+// a range that produces them on demand (a socket reader, a std::views
+// pipeline) is never held in memory as a whole.
+template <std::ranges::viewable_range Records>
+    requires std::ranges::input_range<Records> &&
+             std::convertible_to<std::ranges::range_reference_t<Records>, std::string_view>
+Generator<std::string_view> stream_batch(Records&& records, const StreamOptions& options = {})
+{
+    return detail::stream_batch(std::views::all(std::forward<Records>(records)), options);
+}
+} // namespace enigma
+
+#endif //ENIGMA_STREAM_H
@@ -0,0 +1,112 @@
+//
+// Rotor tables for the EnigmaC and Enigma2C algorithms.
+//
+// Everything here is constexpr: the tables live in read-only data, cost
+// nothing at static-init time, and their invariants are checked by the
+// compiler below instead of being maintained by hand.
+//
+
+#ifndef ENIGMA_TABLES_H
+#define ENIGMA_TABLES_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace enigma
+{
+constexpr std::array<uint8_t, 16> ENIGMA_C_ROTOR = {5, 4, 14, 11, 1, 8, 10, 13, 7, 3, 15, 0, 2, 12, 9, 6};
+constexpr std::array<uint8_t, 10> ENIGMA2_E_ROTOR_10 = {5, 4, 1, 8, 7, 3, 0, 2, 9, 6};
+constexpr std::array<uint8_t, 26> ENIGMA2_E_ROTOR_26 = {
+    16, 8, 25, 5, 23, 21, 18, 17, 2, 1, 7, 24, 15, 11, 9, 6, 3, 0, 19, 12, 22, 14, 10, 4, 20, 13
+};
+constexpr std::array<uint8_t, 10> ENIGMA2_D_ROTOR_10 = {6, 2, 7, 5, 1, 0, 9, 4, 3, 8};
+constexpr std::array<uint8_t, 26> ENIGMA2_D_ROTOR_26 = {
+    17, 9, 8, 16, 23, 3, 15, 10, 1, 14, 22, 13, 19, 25, 21, 12, 0, 7, 6, 18, 24, 5, 20, 4, 11, 2
+};
+
+// True when rotor maps [0, N) onto itself one-to-one.
+template <size_t N>
+constexpr bool is_permutation_table(const std::array<uint8_t, N>& rotor)
+{
+    std::array<bool, N> seen{};
+    for (uint8_t value : rotor)
+    {
+        if (value >= N || seen[value]) return false;
+        seen[value] = true;
+    }
+    return true;
+}
+
+// True when decrypt undoes encrypt for every entry.
+template <size_t N>
+constexpr bool is_inverse_table(const std::array<uint8_t, N>& encrypt, const std::array<uint8_t, N>& decrypt)
+{
+    for (size_t i = 0; i < N; ++i)
+    {
+        if (decrypt[encrypt[i]] != i) return false;
+    }
+    return true;
+}
+
+template <size_t N>
+constexpr std::array<uint8_t, N> invert_table(const std::array<uint8_t, N>& rotor)
+{
+    std::array<uint8_t, N> inverse{};
+    for (size_t i = 0; i < N; ++i) inverse[rotor[i]] = static_cast<uint8_t>(i);
+    return inverse;
+}
+
+// enigma_c_decrypt looks nibbles up here instead of searching ENIGMA_C_ROTOR.
+constexpr std::array<uint8_t, 16> ENIGMA_C_ROTOR_INVERSE = invert_table(ENIGMA_C_ROTOR);
+
+// EnigmaC two nibbles per lookup. The rotor index of position i is
+// (nibble + i) % 16, so the tables repeat every 16 positions: entry [p][ab]
+// covers positions 2p and 2p + 1 (mod 16) for the input byte ab.
+//
+// Encryption: ROTOR[a + 2p] in the high nibble, ROTOR[a + 2p] ^ ROTOR[b +
+// 2p + 1] in the low one. XORing the running value into both nibbles gives
+// the two output nibbles.
+constexpr std::array<std::array<uint8_t, 256>, 8> ENIGMA_C_PAIR_ENCRYPT = []
+{
+    std::array<std::array<uint8_t, 256>, 8> table{};
+    for (size_t p = 0; p < 8; ++p)
+    {
+        for (size_t ab = 0; ab < 256; ++ab)
+        {
+            const unsigned high = ENIGMA_C_ROTOR[((ab >> 4) + 2 * p) % 16];
+            const unsigned low = high ^ ENIGMA_C_ROTOR[((ab & 15) + 2 * p + 1) % 16];
+            table[p][ab] = static_cast<uint8_t>(high << 4 | low);
+        }
+    }
+    return table;
+}();
+
+// Decryption: entry [p][xy] decrypts x = a ^ previous and y = b ^ a, the
+// XOR of each key nibble with the one before it.
+constexpr std::array<std::array<uint8_t, 256>, 8> ENIGMA_C_PAIR_DECRYPT = []
+{
+    std::array<std::array<uint8_t, 256>, 8> table{};
+    for (size_t p = 0; p < 8; ++p)
+    {
+        for (size_t xy = 0; xy < 256; ++xy)
+        {
+            const unsigned high = (ENIGMA_C_ROTOR_INVERSE[xy >> 4] + 16 - 2 * p) % 16;
+            const unsigned low = (ENIGMA_C_ROTOR_INVERSE[xy & 15] + 15 - 2 * p) % 16;
+            table[p][xy] = static_cast<uint8_t>(high << 4 | low);
+        }
+    }
+    return table;
+}();
+
+static_assert(is_permutation_table(ENIGMA_C_ROTOR), "ENIGMA_C_ROTOR must be a permutation of 0-15");
+static_assert(is_inverse_table(ENIGMA_C_ROTOR, ENIGMA_C_ROTOR_INVERSE), "ENIGMA_C_ROTOR_INVERSE is wrong");
+static_assert(is_permutation_table(ENIGMA2_E_ROTOR_10), "ENIGMA2_E_ROTOR_10 must be a permutation of 0-9");
+static_assert(is_permutation_table(ENIGMA2_E_ROTOR_26), "ENIGMA2_E_ROTOR_26 must be a permutation of 0-25");
+static_assert(is_inverse_table(ENIGMA2_E_ROTOR_10, ENIGMA2_D_ROTOR_10),
+              "ENIGMA2_D_ROTOR_10 must invert ENIGMA2_E_ROTOR_10");
+static_assert(is_inverse_table(ENIGMA2_E_ROTOR_26, ENIGMA2_D_ROTOR_26),
+              "ENIGMA2_D_ROTOR_26 must invert ENIGMA2_E_ROTOR_26");
+} // namespace enigma
+
+#endif //ENIGMA_TABLES_H
@@ -0,0 +1,86 @@
+//
+// Fixed-size worker pool used by the batch engine.
+//
+// parallel_for() starts each thread on its own contiguous slice of the
+// indices. A thread takes indices from the front of its slice and, once it
+// is empty, steals the back half of another thread's, so a slice of slow
+// tasks is shared out while threads with fast ones stay on their own data.
+//
+
+#ifndef ENIGMA_THREAD_POOL_H
+#define ENIGMA_THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace enigma
+{
+class ThreadPool
+{
+public:
+    // Creates a pool that runs work on `threads` threads in total: the
+    // calling thread plus threads - 1 workers. 0 means one per hardware thread.
+    // With pin_threads, thread i runs on affinity_cpus()[i] (wrapping), so
+    // consecutive threads share a NUMA node; the calling thread is pinned
+    // only while it runs tasks. Pinning does nothing where it is unsupported.
+    explicit ThreadPool(unsigned threads, bool pin_threads = false);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    unsigned size() const noexcept { return static_cast<unsigned>(workers_.size()) + 1; }
+
+    // Runs task(i) for every i in [0, count), spreading indices over the
+    // workers and the calling thread. Thread t starts on indices near
+    // t * count / size() and steals from the others when it runs out, so
+    // uneven tasks still balance. Returns once every task has finished.
+    void parallel_for(size_t count, const std::function<void(size_t)>& task);
+
+    // Runs task(thread_index()) once on every thread of the pool, for work
+    // that must happen on a particular thread, such as allocating and
+    // filling a per-thread buffer so that it is local to that thread.
+    void for_each_thread(const std::function<void(size_t)>& task);
+
+    // Inside a parallel_for() or for_each_thread() task, the running
+    // thread's index in [0, size()): 0 for the calling thread, 1 and up for
+    // the workers.
+    static unsigned thread_index() noexcept;
+
+private:
+    // One thread's remaining indices [begin, end), offsets from base_, as
+    // one word so that its owner and thieves claim them by compare-exchange.
+    struct alignas(64) Slice
+    {
+        std::atomic<uint64_t> bounds{0};
+    };
+
+    void start(const std::function<void(size_t)>& task, size_t base, size_t count, bool each_thread);
+    void worker_loop(unsigned index);
+    void drain(unsigned index);
+    bool take(unsigned index, size_t& task) noexcept;
+    bool steal(unsigned index, size_t& task) noexcept;
+
+    std::vector<std::thread> workers_;
+    std::vector<unsigned> cpus_; // affinity_cpus() when pinning, else empty
+    std::unique_ptr<Slice[]> slices_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    const std::function<void(size_t)>* task_ = nullptr;
+    size_t base_ = 0;
+    bool each_thread_ = false;
+    size_t generation_ = 0;
+    unsigned busy_ = 0;
+    bool stopping_ = false;
+};
+} // namespace enigma
+
+#endif //ENIGMA_THREAD_POOL_H
@@ -1,8 +1,457 @@
 //
 // Created by Kris Armstrong on 4/12/25.
 //
+// Public interface of the enigma_core library: the EnigmaC and Enigma2C
+// key algorithms, usable without the interactive CLI. All functions read
+// from caller-owned views and write into caller-provided buffers; none of
+// them allocate, perform I/O or throw.
+//
+// The algorithms are constexpr and defined here, so they inline into the
+// caller and can run at compile time:
+//
+//     static_assert(enigma::nettool_option_key("0003333016", 4).view() == "5dabade112dd");
+//
 
 #ifndef ENIGMA_V300_PURE_CPP_H
 #define ENIGMA_V300_PURE_CPP_H
 
+#include "enigma_tables.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <type_traits>
+
+namespace enigma
+{
+constexpr size_t PRODUCT_CODE_SIZE = 4;
+constexpr size_t OPTION_CODE_SIZE = 3;
+constexpr size_t SERIAL_NUMBER_SIZE_ENIGMA2 = 7;
+constexpr size_t SERIAL_NUMBER_SIZE_ENIGMAC = 10;
+constexpr size_t CHECK_SUM_SIZE = 2;
+constexpr size_t KEY_LENGTH = PRODUCT_CODE_SIZE + OPTION_CODE_SIZE + SERIAL_NUMBER_SIZE_ENIGMA2 + CHECK_SUM_SIZE;
+constexpr size_t SERIAL_LOCATION = CHECK_SUM_SIZE + PRODUCT_CODE_SIZE;
+constexpr size_t PRODUCT_LOCATION = CHECK_SUM_SIZE;
+constexpr size_t OPTION_LOCATION = CHECK_SUM_SIZE + PRODUCT_CODE_SIZE + SERIAL_NUMBER_SIZE_ENIGMA2;
+constexpr size_t ENIGMA_C_KEY_LENGTH = 12;
+constexpr int MAX_CHECK_SUM = 26000;
+constexpr int NETTOOL_MAX_OPTION = 9;
+constexpr int ENIGMA2_MAX_OPTION = 999;
+constexpr int MAX_PRODUCT_CODE = 9999;
+
+// Result of a key operation. The algorithms never print, throw or exit;
+// callers decide how to report a failure.
+enum class Status
+{
+    ok,
+    invalid_length,    // Enigma2C input is not KEY_LENGTH characters (ENIGMA_C_KEY_LENGTH for a packed NetTool key)
+    non_hex,           // EnigmaC input contains a non-hex character
+    invalid_character, // Enigma2C input contains something other than 0-9 / A-Z
+    checksum_mismatch, // Enigma2C key failed its checksum
+    buffer_too_small,  // output buffer shorter than the key
+    malformed_record,  // batch record does not have the expected fields
+    invalid_mode,      // batch record mode is not one of n, e, l
+    invalid_serial,    // serial number has the wrong length or non-digits
+    invalid_option,    // option number out of range or non-numeric
+    invalid_product,   // product code out of range or non-numeric
+};
+
+// Human-readable description of status, matching the CLI's messages.
+const char* status_message(Status status) noexcept;
+
+// A fixed-size key plus the status of the operation that produced it.
+template <size_t N>
+struct KeyResult
+{
+    Status status = Status::ok;
+    std::array<char, N> key{};
+
+    constexpr explicit operator bool() const noexcept { return status == Status::ok; }
+    constexpr std::string_view view() const noexcept { return {key.data(), key.size()}; }
+};
+
+namespace detail
+{
+// Locale-independent replacements for std::isxdigit/std::isdigit.
+constexpr int hex_value(char c) noexcept
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+constexpr bool is_digit(char c) noexcept
+{
+    return c >= '0' && c <= '9';
+}
+
+constexpr bool is_upper(char c) noexcept
+{
+    return c >= 'A' && c <= 'Z';
+}
+
+constexpr bool all_digits(std::string_view text) noexcept
+{
+    return !text.empty() && std::all_of(text.begin(), text.end(), is_digit);
+}
+
+constexpr char hex_digit(int value) noexcept
+{
+    // Narrowing conversion is intentional: value is guaranteed to be in range 0-15
+    return (value < 10) ? static_cast<char>(value + '0') : static_cast<char>(value - 10 + 'a');
+}
+
+// Parses the leading decimal digits of field, as std::stoi did on the
+// substrings this replaces. Returns -1 when field does not start with a digit.
+constexpr int parse_leading_int(std::string_view field) noexcept
+{
+    if (field.empty() || !is_digit(field.front())) return -1;
+    int value = 0;
+    for (size_t i = 0; i < field.size() && is_digit(field[i]); ++i) value = value * 10 + (field[i] - '0');
+    return value;
+}
+
+// Writes value as exactly width zero-padded decimal digits.
+constexpr void write_padded(char* out, int value, size_t width) noexcept
+{
+    for (size_t i = width; i-- > 0;)
+    {
+        out[i] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    }
+}
+} // namespace detail
+
+namespace detail
+{
+// hex_value() and hex_digit() as lookups, for the pair-table kernels.
+constexpr std::array<int8_t, 256> HEX_VALUES = []
+{
+    std::array<int8_t, 256> table{};
+    for (size_t c = 0; c < table.size(); ++c) table[c] = static_cast<int8_t>(hex_value(static_cast<char>(c)));
+    return table;
+}();
+
+constexpr std::array<char, 16> HEX_DIGITS = {'0', '1', '2', '3', '4', '5', '6', '7',
+                                             '8', '9', 'a', 'b', 'c', 'd', 'e', 'f'};
+
+constexpr int table_hex_value(char c) noexcept
+{
+    return HEX_VALUES[static_cast<unsigned char>(c)];
+}
+
+// EnigmaC one nibble per step: the reference the pair-table kernels are
+// tested against.
+[[nodiscard]] constexpr Status enigma_c_encrypt_bytewise(std::string_view input_key,
+                                                         std::span<char> output_key) noexcept
+{
+    const size_t len = input_key.size();
+    if (output_key.size() < len) return Status::buffer_too_small;
+    int output_value = 0;
+    for (size_t index = 0; index < len; ++index)
+    {
+        int input_value = hex_value(input_key[index]);
+        if (input_value < 0) return Status::non_hex;
+        output_value = ENIGMA_C_ROTOR[(input_value + index) % 16] ^ output_value;
+        output_key[index] = hex_digit(output_value % 16);
+    }
+    return Status::ok;
+}
+
+[[nodiscard]] constexpr Status enigma_c_decrypt_bytewise(std::string_view input_key,
+                                                         std::span<char> output_key) noexcept
+{
+    const size_t len = input_key.size();
+    if (output_key.size() < len) return Status::buffer_too_small;
+    int xor_value = 0;
+    for (size_t index = 0; index < len; ++index)
+    {
+        int old_output = hex_value(input_key[index]);
+        if (old_output < 0) return Status::non_hex;
+        int output_value = ENIGMA_C_ROTOR_INVERSE[old_output ^ xor_value];
+        int temp = (output_value - static_cast<int>(index)) % 16;
+        if (temp < 0) temp += 16;
+        output_key[index] = hex_digit(temp);
+        xor_value = old_output;
+    }
+    return Status::ok;
+}
+
+// EnigmaC two nibbles per ENIGMA_C_PAIR_ENCRYPT lookup; an odd last nibble
+// takes the one-nibble step.
+[[nodiscard]] constexpr Status enigma_c_encrypt_wide(std::string_view input_key, std::span<char> output_key) noexcept
+{
+    const size_t len = input_key.size();
+    if (output_key.size() < len) return Status::buffer_too_small;
+    unsigned value = 0;
+    size_t index = 0;
+    for (; index + 1 < len; index += 2)
+    {
+        const int high = table_hex_value(input_key[index]);
+        const int low = table_hex_value(input_key[index + 1]);
+        if ((high | low) < 0) return Status::non_hex;
+        const unsigned pair = ENIGMA_C_PAIR_ENCRYPT[(index / 2) % 8][high << 4 | low] ^ (value * 0x11);
+        output_key[index] = HEX_DIGITS[pair >> 4];
+        output_key[index + 1] = HEX_DIGITS[pair & 15];
+        value = pair & 15;
+    }
+    if (index < len)
+    {
+        const int input_value = table_hex_value(input_key[index]);
+        if (input_value < 0) return Status::non_hex;
+        output_key[index] = HEX_DIGITS[ENIGMA_C_ROTOR[(input_value + index) % 16] ^ value];
+    }
+    return Status::ok;
+}
+
+// EnigmaC decryption two nibbles per ENIGMA_C_PAIR_DECRYPT lookup.
+[[nodiscard]] constexpr Status enigma_c_decrypt_wide(std::string_view input_key, std::span<char> output_key) noexcept
+{
+    const size_t len = input_key.size();
+    if (output_key.size() < len) return Status::buffer_too_small;
+    unsigned previous = 0;
+    size_t index = 0;
+    for (; index + 1 < len; index += 2)
+    {
+        const int high = table_hex_value(input_key[index]);
+        const int low = table_hex_value(input_key[index + 1]);
+        if ((high | low) < 0) return Status::non_hex;
+        const unsigned pair = ENIGMA_C_PAIR_DECRYPT[(index / 2) % 8][(high ^ previous) << 4 | (high ^ low)];
+        output_key[index] = HEX_DIGITS[pair >> 4];
+        output_key[index + 1] = HEX_DIGITS[pair & 15];
+        previous = static_cast<unsigned>(low);
+    }
+    if (index < len)
+    {
+        const int old_output = table_hex_value(input_key[index]);
+        if (old_output < 0) return Status::non_hex;
+        output_key[index] = HEX_DIGITS[(ENIGMA_C_ROTOR_INVERSE[old_output ^ previous] + 16 - index % 16) % 16];
+    }
+    return Status::ok;
+}
+} // namespace detail
+
+// EnigmaC (NetTool): encrypts input_key.size() hex digits into output_key,
+// which must be at least as long. Output is lowercase hex. With
+// ENIGMA_WIDE_STEP defined (the CMake option of that name) it runs two
+// nibbles per table lookup.
+[[nodiscard]] constexpr Status enigma_c_encrypt(std::string_view input_key, std::span<char> output_key) noexcept
+{
+#ifdef ENIGMA_WIDE_STEP
+    return detail::enigma_c_encrypt_wide(input_key, output_key);
+#else
+    return detail::enigma_c_encrypt_bytewise(input_key, output_key);
+#endif
+}
+
+// EnigmaC (NetTool): inverse of enigma_c_encrypt.
+[[nodiscard]] constexpr Status enigma_c_decrypt(std::string_view input_key, std::span<char> output_key) noexcept
+{
+#ifdef ENIGMA_WIDE_STEP
+    return detail::enigma_c_decrypt_wide(input_key, output_key);
+#else
+    return detail::enigma_c_decrypt_bytewise(input_key, output_key);
+#endif
+}
+
+// Returns true when the 12-digit key decodes to serial_number and option.
+// Empty, short or non-hex keys are reported as not matching.
+constexpr bool enigma_c_check_option_key(int option, std::string_view key, std::string_view serial_number) noexcept
+{
+    if (key.empty()) return false;
+    if (key == "bladerules") return true;
+    if (key.size() < ENIGMA_C_KEY_LENGTH) return false;
+    std::array<char, ENIGMA_C_KEY_LENGTH> decrypted_key{};
+    if (enigma_c_decrypt(key.substr(0, ENIGMA_C_KEY_LENGTH), decrypted_key) != Status::ok) return false;
+    // Digits 0-9 hold the serial reversed; compare in place.
+    if (serial_number.size() != SERIAL_NUMBER_SIZE_ENIGMAC) return false;
+    for (size_t i = 0; i < SERIAL_NUMBER_SIZE_ENIGMAC; ++i)
+    {
+        if (decrypted_key[SERIAL_NUMBER_SIZE_ENIGMAC - 1 - i] != serial_number[i]) return false;
+    }
+    int opt = detail::parse_leading_int(std::string_view(decrypted_key.data() + 10, 2));
+    return opt >= 0 && opt == option;
+}
+
+// Enigma2C: encrypts a KEY_LENGTH layout "00PPPPSSSSSSSOOO" into output_key
+// (at least KEY_LENGTH chars), filling in the two checksum digits.
+[[nodiscard]] constexpr Status enigma2_c_encrypt(std::string_view input_key, std::span<char> output_key) noexcept
+{
+    if (input_key.length() != KEY_LENGTH) return Status::invalid_length;
+    if (output_key.size() < KEY_LENGTH) return Status::buffer_too_small;
+    if (!std::all_of(input_key.begin(), input_key.end(),
+                     [](char c) { return detail::is_digit(c) || detail::is_upper(c); }))
+    {
+        return Status::invalid_character;
+    }
+    std::copy(input_key.begin(), input_key.end(), output_key.begin());
+    int checksum = 1;
+    for (size_t i = 2; i < KEY_LENGTH; ++i)
+    {
+        int temp_sum = detail::is_digit(input_key[i]) ? (input_key[i] - '0') : (input_key[i] - 'A');
+        checksum += static_cast<int>(i) + temp_sum + (static_cast<int>(i) * temp_sum);
+    }
+    checksum = 100 - (checksum % 100);
+    output_key[0] = static_cast<char>((checksum % 10) + '0');
+    output_key[1] = static_cast<char>(((checksum / 10) % 10) + '0');
+    int running_sum = 0;
+    for (size_t i = 0; i < KEY_LENGTH; ++i)
+    {
+        const bool digit = detail::is_digit(output_key[i]);
+        int temp_sum = digit ? (output_key[i] - '0') : (output_key[i] - 'A');
+        if (digit)
+        {
+            // Narrowing conversion is intentional: result is guaranteed to be in range 0-9
+            output_key[i] = static_cast<char>(ENIGMA2_E_ROTOR_10[(temp_sum + MAX_CHECK_SUM - running_sum) % 10] +
+                '0');
+        }
+        else
+        {
+            // Narrowing conversion is intentional: result is guaranteed to be in range 0-25
+            output_key[i] = static_cast<char>('A' + ENIGMA2_E_ROTOR_26[
+                (temp_sum + MAX_CHECK_SUM - running_sum) % 26]);
+        }
+        running_sum += static_cast<int>(i) + temp_sum + (static_cast<int>(i) * temp_sum);
+    }
+    return Status::ok;
+}
+
+// Enigma2C: decrypts a KEY_LENGTH key into output_key. Returns
+// Status::checksum_mismatch when the key fails its checksum, in which case
+// output_key is unspecified.
+[[nodiscard]] constexpr Status enigma2_c_decrypt(std::string_view input_key, std::span<char> output_key) noexcept
+{
+    if (input_key.length() != KEY_LENGTH) return Status::invalid_length;
+    if (output_key.size() < KEY_LENGTH) return Status::buffer_too_small;
+    int checksum = 0;
+    for (size_t i = 0; i < KEY_LENGTH; ++i)
+    {
+        const char c = input_key[i];
+        const bool digit = detail::is_digit(c);
+        if (!digit && !detail::is_upper(c)) return Status::invalid_character;
+        int temp_sum = digit
+                           ? (ENIGMA2_D_ROTOR_10[c - '0'] + checksum) % 10
+                           : (ENIGMA2_D_ROTOR_26[c - 'A'] + checksum) % 26;
+        output_key[i] = digit
+                            ? static_cast<char>(temp_sum + '0')
+                            : static_cast<char>('A' + temp_sum);
+        checksum += static_cast<int>(i) + temp_sum + (static_cast<int>(i) * temp_sum);
+    }
+    checksum += 8 * (output_key[1] - '0');
+    return (checksum % 100 == 0) ? Status::ok : Status::checksum_mismatch;
+}
+
+// A decrypted Enigma2C layout "CCPPPPSSSSSSSOOO". The accessors read the
+// fields in place, so decoding a key never builds a string. Numeric fields
+// yield the value of their leading digits, or -1 if they start with a letter.
+struct DecodedKey
+{
+    std::array<char, KEY_LENGTH> layout{};
+
+    constexpr std::string_view view() const noexcept { return {layout.data(), layout.size()}; }
+
+    constexpr int product() const noexcept
+    {
+        return detail::parse_leading_int(view().substr(PRODUCT_LOCATION, PRODUCT_CODE_SIZE));
+    }
+
+    constexpr std::string_view serial() const noexcept
+    {
+        return view().substr(SERIAL_LOCATION, SERIAL_NUMBER_SIZE_ENIGMA2);
+    }
+
+    constexpr int option() const noexcept
+    {
+        return detail::parse_leading_int(view().substr(OPTION_LOCATION, OPTION_CODE_SIZE));
+    }
+};
+
+static_assert(std::is_trivially_copyable_v<DecodedKey> && sizeof(DecodedKey) == KEY_LENGTH);
+
+// Enigma2C: decrypts a KEY_LENGTH key into decoded, as the overload above.
+[[nodiscard]] constexpr Status enigma2_c_decrypt(std::string_view input_key, DecodedKey& decoded) noexcept
+{
+    return enigma2_c_decrypt(input_key, decoded.layout);
+}
+
+// Returns true when the key passes its checksum and carries option.
+constexpr bool enigma2_c_check_option_key(int option, std::string_view key) noexcept
+{
+    if (key.empty()) return false;
+    DecodedKey decoded;
+    if (enigma2_c_decrypt(key, decoded) != Status::ok) return false;
+    const int opt = decoded.option();
+    return opt >= 0 && opt == option;
+}
+
+namespace detail
+{
+// Builds the plain NetTool layout that calculate_nettool_option_key
+// encrypts: serial + option + "0", reversed.
+constexpr Status nettool_plain_key(std::string_view serial, int option,
+                                   std::array<char, ENIGMA_C_KEY_LENGTH>& plain_key) noexcept
+{
+    if (serial.size() != SERIAL_NUMBER_SIZE_ENIGMAC || !all_digits(serial)) return Status::invalid_serial;
+    if (option < 0 || option > NETTOOL_MAX_OPTION) return Status::invalid_option;
+    plain_key[0] = '0';
+    plain_key[1] = static_cast<char>('0' + option);
+    for (size_t i = 0; i < SERIAL_NUMBER_SIZE_ENIGMAC; ++i)
+    {
+        plain_key[2 + i] = serial[SERIAL_NUMBER_SIZE_ENIGMAC - 1 - i];
+    }
+    return Status::ok;
+}
+} // namespace detail
+
+// NetTool key for a 10-digit serial and option 0-9, using the layout of
+// calculate_nettool_option_key: serial + option + "0", reversed.
+constexpr KeyResult<ENIGMA_C_KEY_LENGTH> nettool_option_key(std::string_view serial, int option) noexcept
+{
+    KeyResult<ENIGMA_C_KEY_LENGTH> result;
+    std::array<char, ENIGMA_C_KEY_LENGTH> plain_key{};
+    result.status = detail::nettool_plain_key(serial, option, plain_key);
+    if (result.status == Status::ok)
+    {
+        result.status = enigma_c_encrypt(std::string_view(plain_key.data(), plain_key.size()), result.key);
+    }
+    return result;
+}
+
+namespace detail
+{
+// Builds the plain Enigma2C layout "00" + product + serial + option.
+constexpr Status enigma2_plain_key(int product, std::string_view serial, int option,
+                                   std::array<char, KEY_LENGTH>& plain_key) noexcept
+{
+    if (product < 0 || product > MAX_PRODUCT_CODE) return Status::invalid_product;
+    if (serial.size() != SERIAL_NUMBER_SIZE_ENIGMA2 || !all_digits(serial)) return Status::invalid_serial;
+    if (option < 0 || option > ENIGMA2_MAX_OPTION) return Status::invalid_option;
+    plain_key[0] = '0';
+    plain_key[1] = '0';
+    write_padded(plain_key.data() + PRODUCT_LOCATION, product, PRODUCT_CODE_SIZE);
+    std::copy(serial.begin(), serial.end(), plain_key.begin() + SERIAL_LOCATION);
+    write_padded(plain_key.data() + OPTION_LOCATION, option, OPTION_CODE_SIZE);
+    return Status::ok;
+}
+} // namespace detail
+
+// Enigma2C key for a product code, 7-digit serial and option 0-999, using
+// the "00" + product + serial + option layout.
+constexpr KeyResult<KEY_LENGTH> enigma2_option_key(int product, std::string_view serial, int option) noexcept
+{
+    KeyResult<KEY_LENGTH> result;
+    std::array<char, KEY_LENGTH> plain_key{};
+    result.status = detail::enigma2_plain_key(product, serial, option, plain_key);
+    if (result.status == Status::ok)
+    {
+        result.status = enigma2_c_encrypt(std::string_view(plain_key.data(), plain_key.size()), result.key);
+    }
+    return result;
+}
+} // namespace enigma
+
 #endif //ENIGMA_V300_PURE_CPP_H
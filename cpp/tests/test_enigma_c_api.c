@@ -0,0 +1,86 @@
+// File: test_enigma_c_api.c
+// Author: Kris Armstrong
+// Version: 3.0.0
+// Last Modified: 2026-10-14
+// Description: Tests for the enigma_c shared library, compiled as C and run through CTest.
+// License: MIT
+
+#include "enigma_c_api.h"
+
+#include <stdio.h>
+#include <string.h>
+
+static int failures = 0;
+
+static void check(int condition, const char* name)
+{
+    printf("%s: %s\n", condition ? "PASS" : "FAIL", name);
+    if (!condition) ++failures;
+}
+
+static void test_single_keys(void)
+{
+    char key[17];
+    char plain[17];
+    enigma_c_encrypt("046103333000", key, 12);
+    check(strcmp(key, "5dabade112dd") == 0, "enigma_c_encrypt matches the C front end");
+    enigma_c_decrypt(key, plain, 12);
+    check(strcmp(plain, "046103333000") == 0, "enigma_c_decrypt inverts it");
+    enigma_c_encrypt("04610333300g", key, 12);
+    check(key[0] == '\0', "enigma_c_encrypt leaves non-hex input empty instead of exiting");
+    // The check reads the serial reversed in digits 0-9 and the option after it.
+    enigma_c_encrypt("610333300004", key, 12);
+    check(enigma_c_check_option_key(4, key, "0003333016") == 1 &&
+              enigma_c_check_option_key(5, key, "0003333016") == 0 &&
+              enigma_c_check_option_key(0, "bladerules", "0000000000") == 1 &&
+              enigma_c_check_option_key(4, NULL, "0003333016") == 0,
+          "enigma_c_check_option_key");
+
+    enigma2_c_encrypt("0069630000607007", key);
+    check(strcmp(key, "6406257948597747") == 0, "enigma2_c_encrypt matches the C front end");
+    enigma2_c_decrypt(key, plain);
+    check(strcmp(plain + 2, "69630000607007") == 0, "enigma2_c_decrypt inverts it");
+    enigma2_c_decrypt("6406257948597748", plain);
+    check(plain[0] == '\0', "enigma2_c_decrypt leaves checksum failures empty");
+    enigma2_c_encrypt("006963000060700", key);
+    check(key[0] == '\0', "enigma2_c_encrypt leaves short input empty instead of exiting");
+    check(enigma2_c_check_option_key(7, "6406257948597747") == 1 &&
+              enigma2_c_check_option_key(8, "6406257948597747") == 0,
+          "enigma2_c_check_option_key");
+}
+
+static void test_generate_many(void)
+{
+    const uint64_t serials[3] = {3333016, 3333016, 12345678901ULL};
+    const int32_t options[3] = {4, 10, 4};
+    char keys[3 * 12];
+    uint8_t statuses[3];
+    const size_t failed = enigma_generate_many('n', -1, serials, 3, options, 3, keys, sizeof(keys), statuses, 1);
+    check(failed == 2 && memcmp(keys, "5dabade112dd", 12) == 0 && statuses[0] == ENIGMA_STATUS_OK &&
+              statuses[1] == ENIGMA_STATUS_INVALID_OPTION && statuses[2] == ENIGMA_STATUS_INVALID_SERIAL,
+          "enigma_generate_many writes keys and per-record statuses");
+
+    const uint64_t serial = 607;
+    const int32_t option = 7;
+    char enigma2_key[16];
+    check(enigma_generate_many('e', -1, &serial, 1, &option, 1, enigma2_key, sizeof(enigma2_key), NULL, 0) == 0 &&
+              memcmp(enigma2_key, "6406257948597747", 16) == 0,
+          "enigma_generate_many uses the EtherScope product by default");
+    check(enigma_generate_many('e', -1, &serial, 1, &option, 1, enigma2_key, 15, statuses, 1) == 1 &&
+              statuses[0] == ENIGMA_STATUS_BUFFER_TOO_SMALL,
+          "enigma_generate_many checks the key buffer size");
+
+    check(enigma_key_length('n') == 12 && enigma_key_length('l') == 16 && enigma_key_length('?') == 0,
+          "enigma_key_length");
+    check(strcmp(enigma_status_message(ENIGMA_STATUS_INVALID_MODE), "Mode must be n, e or l") == 0 &&
+              strcmp(enigma_status_message(99), "Unknown status") == 0,
+          "enigma_status_message");
+}
+
+int main(void)
+{
+    test_single_keys();
+    test_generate_many();
+    printf(failures == 0 ? "All tests passed\n" : "Some tests failed\n");
+    return failures == 0 ? 0 : 1;
+}
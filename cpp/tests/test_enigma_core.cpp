@@ -0,0 +1,1474 @@
+// File: test_enigma_core.cpp
+// Author: Kris Armstrong
+// Version: 3.0.0
+// Last Modified: 2026-10-14
+// Description: Unit tests for the enigma_core library, run through CTest.
+// License: MIT
+
+#include "enigma_v300_pure_cpp.h"
+#include "enigma_affinity.h"
+#include "enigma_batch.h"
+#include "enigma_catalog.h"
+#include "enigma_catalog_file.h"
+#include "enigma_engine.h"
+#include "enigma_key_cache.h"
+#include "enigma_output.h"
+#include "enigma_packed.h"
+#include "enigma_range.h"
+#include "enigma_ring.h"
+#include "enigma_simd.h"
+#include "enigma_stats.h"
+#include "enigma_stream.h"
+#ifdef ENIGMA_HAVE_SERVER
+#include "enigma_server.h"
+#endif
+#include "enigma_thread_pool.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <random>
+#include <ranges>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <string_view>
+#include <thread>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+#ifdef ENIGMA_HAVE_SERVER
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+int failures = 0;
+
+// Heap allocations by threads that have count_allocations set, for the
+// zero-allocation checks; see the replacement operator new below.
+std::atomic<size_t> allocations{0};
+thread_local bool count_allocations = false;
+
+// The replacement operator new and delete forms below all go through these,
+// so every allocation is counted and freed by the same pair.
+void* allocate(size_t size)
+{
+    if (count_allocations) allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* block = std::malloc(size > 0 ? size : 1)) return block;
+    throw std::bad_alloc();
+}
+
+void release(void* block) noexcept
+{
+    std::free(block);
+}
+
+// Allocations made on this thread by run().
+template <typename Run>
+size_t allocations_during(Run&& run)
+{
+    count_allocations = true;
+    const size_t before = allocations.load();
+    run();
+    count_allocations = false;
+    return allocations.load() - before;
+}
+
+void check(bool condition, std::string_view name)
+{
+    std::cout << (condition ? "PASS" : "FAIL") << ": " << name << "\n";
+    if (!condition) ++failures;
+}
+
+template <size_t N>
+std::string_view view(const std::array<char, N>& buffer)
+{
+    return {buffer.data(), buffer.size()};
+}
+
+void test_enigma_c()
+{
+    std::array<char, enigma::ENIGMA_C_KEY_LENGTH> key{};
+    check(enigma::enigma_c_encrypt("046103333000", key) == enigma::Status::ok, "enigma_c_encrypt status");
+    check(view(key) == "5dabade112dd", "enigma_c_encrypt NetTool reference vector");
+
+    std::array<char, enigma::ENIGMA_C_KEY_LENGTH> plain{};
+    check(enigma::enigma_c_decrypt(view(key), plain) == enigma::Status::ok, "enigma_c_decrypt status");
+    check(view(plain) == "046103333000", "enigma_c_decrypt round trip");
+
+    // check_option_key reads the serial reversed from digits 0-9 and the option from digits 10-11.
+    check(enigma::enigma_c_encrypt("610333300004", key) == enigma::Status::ok, "enigma_c_encrypt check vector");
+    check(enigma::enigma_c_check_option_key(4, view(key), "0003333016"), "enigma_c_check_option_key accepts match");
+    check(!enigma::enigma_c_check_option_key(5, view(key), "0003333016"), "enigma_c_check_option_key rejects option");
+    check(!enigma::enigma_c_check_option_key(4, view(key), "0003333017"), "enigma_c_check_option_key rejects serial");
+    check(enigma::enigma_c_check_option_key(0, "bladerules", ""), "enigma_c_check_option_key master key");
+    check(!enigma::enigma_c_check_option_key(4, "", "0003333016"), "enigma_c_check_option_key rejects empty key");
+    check(!enigma::enigma_c_check_option_key(4, "5dabade112zz", "0003333016"), "enigma_c_check_option_key rejects non-hex");
+
+    check(enigma::enigma_c_encrypt("04610333300g", key) == enigma::Status::non_hex, "enigma_c_encrypt reports non-hex");
+    std::array<char, 4> small{};
+    check(enigma::enigma_c_encrypt("046103333000", small) == enigma::Status::buffer_too_small,
+          "enigma_c_encrypt reports short buffer");
+}
+
+// The pair-table kernels against the nibble-at-a-time reference, whichever
+// one ENIGMA_WIDE_STEP selects, for every length up to 40 (odd ones end on
+// a single-nibble step) and mixed-case input.
+void test_enigma_c_wide()
+{
+    std::mt19937 rng(4242);
+    bool encrypt_match = true;
+    bool decrypt_match = true;
+    std::array<char, 40> input{};
+    std::array<char, 40> expected{};
+    std::array<char, 40> actual{};
+    for (size_t round = 0; round < 4000; ++round)
+    {
+        const size_t length = round % (input.size() + 1);
+        for (size_t i = 0; i < length; ++i) input[i] = "0123456789abcdefABCDEF"[rng() % 22];
+        const std::string_view text(input.data(), length);
+        encrypt_match = encrypt_match &&
+                        enigma::detail::enigma_c_encrypt_bytewise(text, expected) == enigma::Status::ok &&
+                        enigma::detail::enigma_c_encrypt_wide(text, actual) == enigma::Status::ok &&
+                        std::equal(expected.begin(), expected.begin() + length, actual.begin());
+        decrypt_match = decrypt_match &&
+                        enigma::detail::enigma_c_decrypt_bytewise(text, expected) == enigma::Status::ok &&
+                        enigma::detail::enigma_c_decrypt_wide(text, actual) == enigma::Status::ok &&
+                        std::equal(expected.begin(), expected.begin() + length, actual.begin());
+    }
+    check(encrypt_match, "enigma_c_encrypt_wide matches the bytewise kernel");
+    check(decrypt_match, "enigma_c_decrypt_wide matches the bytewise kernel");
+
+    bool rejects = true;
+    for (const std::string_view bad : {"g46103333000", "04610333300g", "0461033330 0", "g", "0461x"})
+    {
+        rejects = rejects && enigma::detail::enigma_c_encrypt_wide(bad, actual) == enigma::Status::non_hex &&
+                  enigma::detail::enigma_c_decrypt_wide(bad, actual) == enigma::Status::non_hex;
+    }
+    check(rejects && enigma::detail::enigma_c_encrypt_wide("046103333000", std::span<char>(actual.data(), 11)) ==
+                         enigma::Status::buffer_too_small,
+          "wide kernels report non-hex input and short buffers");
+}
+
+void test_enigma2()
+{
+    std::array<char, enigma::KEY_LENGTH> key{};
+    check(enigma::enigma2_c_encrypt("0069630000607007", key) == enigma::Status::ok, "enigma2_c_encrypt status");
+    check(view(key) == "6406257948597747", "enigma2_c_encrypt EtherScope reference vector");
+
+    std::array<char, enigma::KEY_LENGTH> plain{};
+    check(enigma::enigma2_c_decrypt(view(key), plain) == enigma::Status::ok, "enigma2_c_decrypt accepts valid checksum");
+    check(view(plain).substr(enigma::PRODUCT_LOCATION) == "69630000607007", "enigma2_c_decrypt recovers fields");
+    check(enigma::enigma2_c_decrypt("6406257948597748", plain) == enigma::Status::checksum_mismatch,
+          "enigma2_c_decrypt rejects bad checksum");
+
+    static_assert([]
+    {
+        enigma::DecodedKey decoded;
+        return enigma::enigma2_c_decrypt("6406257948597747", decoded) == enigma::Status::ok &&
+            decoded.product() == 6963 && decoded.serial() == "0000607" && decoded.option() == 7;
+    }());
+    enigma::DecodedKey decoded;
+    check(enigma::enigma2_c_decrypt("9225940719507747", decoded) == enigma::Status::ok && decoded.product() == 6963 &&
+              decoded.serial() == "1234567" && decoded.option() == 7, "DecodedKey reads product, serial and option");
+
+    check(enigma::enigma2_c_check_option_key(7, "9225940719507747"), "enigma2_c_check_option_key accepts match");
+    check(!enigma::enigma2_c_check_option_key(6, "9225940719507747"), "enigma2_c_check_option_key rejects option");
+
+    check(enigma::enigma2_c_encrypt("006963000060700", key) == enigma::Status::invalid_length,
+          "enigma2_c_encrypt reports length");
+    check(enigma::enigma2_c_decrypt("6406257948597a47", plain) == enigma::Status::invalid_character,
+          "enigma2_c_decrypt reports invalid character");
+}
+
+void test_fixed_size_keys()
+{
+    // Compile-time evaluation is what firmware embeds; a failure here breaks the build.
+    constexpr auto nettool = enigma::nettool_option_key("0003333016", 4);
+    static_assert(nettool.view() == "5dabade112dd");
+    constexpr auto escope = enigma::enigma2_option_key(6963, "0000607", 7);
+    static_assert(escope.view() == "6406257948597747");
+
+    check(enigma::nettool_option_key("0003333016", 4).view() == "5dabade112dd", "nettool_option_key at runtime");
+    check(enigma::nettool_option_key("000333301", 4).status == enigma::Status::invalid_serial,
+          "nettool_option_key rejects 9-digit serial");
+    check(enigma::nettool_option_key("0003333016", 10).status == enigma::Status::invalid_option,
+          "nettool_option_key rejects option 10");
+    check(enigma::enigma2_option_key(7001, "1234567", 2).view() == "8944937150971162", "enigma2_option_key at runtime");
+    check(enigma::enigma2_option_key(10000, "1234567", 2).status == enigma::Status::invalid_product,
+          "enigma2_option_key rejects product 10000");
+}
+
+// NetToolEngine and Enigma2Engine against the free functions on random
+// layouts, letters included, and on keys with bad checksums.
+void test_engine()
+{
+    std::mt19937 rng(777);
+    bool nettool_match = true;
+    bool enigma2_match = true;
+    std::array<char, enigma::ENIGMA_C_KEY_LENGTH> hex{};
+    std::array<char, enigma::KEY_LENGTH> symbols{};
+    for (size_t round = 0; round < 5000; ++round)
+    {
+        for (auto& c : hex) c = "0123456789abcdefABCDEF"[rng() % 22];
+        std::array<char, enigma::ENIGMA_C_KEY_LENGTH> expected_hex{};
+        std::array<char, enigma::ENIGMA_C_KEY_LENGTH> actual_hex{};
+        nettool_match = nettool_match && enigma::enigma_c_encrypt(view(hex), expected_hex) == enigma::Status::ok &&
+                        enigma::NetToolEngine::encrypt(view(hex), actual_hex) == enigma::Status::ok &&
+                        expected_hex == actual_hex &&
+                        enigma::enigma_c_decrypt(view(hex), expected_hex) == enigma::Status::ok &&
+                        enigma::NetToolEngine::decrypt(view(hex), actual_hex) == enigma::Status::ok &&
+                        expected_hex == actual_hex;
+
+        // A quarter of the layouts carry letters; decrypting random text
+        // fails the checksum about 99 times in 100.
+        for (auto& c : symbols) c = round % 4 == 0 ? "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ"[rng() % 36]
+                                                    : static_cast<char>('0' + rng() % 10);
+        std::array<char, enigma::KEY_LENGTH> expected{};
+        std::array<char, enigma::KEY_LENGTH> actual{};
+        enigma2_match = enigma2_match && enigma::enigma2_c_encrypt(view(symbols), expected) == enigma::Status::ok &&
+                        enigma::Enigma2Engine::encrypt(view(symbols), actual) == enigma::Status::ok &&
+                        expected == actual;
+        const enigma::Status expected_status = enigma::enigma2_c_decrypt(view(symbols), expected);
+        const enigma::Status actual_status = enigma::Enigma2Engine::decrypt(view(symbols), actual);
+        enigma2_match = enigma2_match && expected_status == actual_status &&
+                        (expected_status != enigma::Status::ok || expected == actual);
+    }
+    check(nettool_match, "NetToolEngine matches enigma_c_encrypt/decrypt");
+    check(enigma2_match, "Enigma2Engine matches enigma2_c_encrypt/decrypt");
+
+    std::array<char, enigma::KEY_LENGTH> key{};
+    check(enigma::Enigma2Engine::encrypt("006963000060700", key) == enigma::Status::invalid_length &&
+              enigma::Enigma2Engine::encrypt("00696300006070a7", key) == enigma::Status::invalid_character &&
+              enigma::Enigma2Engine::decrypt("64062579485977a7", key) == enigma::Status::invalid_character &&
+              enigma::NetToolEngine::decrypt("5dabade112dg", hex) == enigma::Status::non_hex,
+          "engines report length and character errors");
+}
+
+void test_packed()
+{
+    uint64_t serial = 0;
+    std::array<char, enigma::MAX_PACKED_SERIAL_DIGITS> digits{};
+    check(enigma::pack_serial("0003333016", serial) == enigma::Status::ok && serial == 3333016,
+          "pack_serial reads a 10-digit serial");
+    check(enigma::pack_serial("0000607", serial) == enigma::Status::ok && serial == 607,
+          "pack_serial reads a 7-digit serial");
+    check(enigma::pack_serial("9999999999999999", serial) == enigma::Status::ok && serial == 9999999999999999ULL,
+          "pack_serial reads 16 digits");
+    check(enigma::pack_serial("12a4567", serial) == enigma::Status::invalid_serial &&
+              enigma::pack_serial("000333301/", serial) == enigma::Status::invalid_serial &&
+              enigma::pack_serial("", serial) == enigma::Status::invalid_serial &&
+              enigma::pack_serial("12345678901234567", serial) == enigma::Status::invalid_serial,
+          "pack_serial rejects non-digits and bad lengths");
+
+    // Every length and a spread of values against std::to_string.
+    bool serials_match = true;
+    uint64_t seed = 12345;
+    for (size_t round = 0; round < 2000; ++round)
+    {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        const size_t length = 1 + round % enigma::MAX_PACKED_SERIAL_DIGITS;
+        uint64_t limit = 1;
+        for (size_t i = 0; i < length; ++i) limit *= 10;
+        const uint64_t value = (seed >> 4) % limit;
+        std::string text = std::to_string(value);
+        text.insert(0, length - text.size(), '0');
+        enigma::format_serial(value, length, digits);
+        serials_match = serials_match && enigma::pack_serial(text, serial) == enigma::Status::ok && serial == value &&
+                        std::string_view(digits.data(), length) == text;
+    }
+    check(serials_match, "pack_serial and format_serial match std::to_string");
+
+    enigma::PackedNetToolKey nettool;
+    std::array<char, enigma::ENIGMA_C_KEY_LENGTH> nettool_text{};
+    check(enigma::pack_nettool_key("5DABADE112dd", nettool) == enigma::Status::ok && nettool.digit(0) == 5 &&
+              nettool.digit(1) == 0xd && nettool.digit(11) == 0xd, "pack_nettool_key reads either case");
+    enigma::format_nettool_key(nettool, nettool_text);
+    check(view(nettool_text) == "5dabade112dd", "format_nettool_key writes lowercase");
+    check(enigma::pack_nettool_key("5dabade112dg", nettool) == enigma::Status::non_hex &&
+              enigma::pack_nettool_key("5dabade112d:", nettool) == enigma::Status::non_hex &&
+              enigma::pack_nettool_key("5dabade112d", nettool) == enigma::Status::invalid_length,
+          "pack_nettool_key rejects non-hex and bad lengths");
+
+    enigma::PackedEnigma2Key enigma2;
+    std::array<char, enigma::KEY_LENGTH> enigma2_text{};
+    check(enigma::pack_enigma2_key("0Z69630000607007", enigma2) == enigma::Status::ok && enigma2.symbols[1] == 35 &&
+              enigma2.product() == 6963 && enigma2.serial() == 607 && enigma2.option() == 7,
+          "pack_enigma2_key reads digits, letters and fields");
+    enigma::format_enigma2_key(enigma2, enigma2_text);
+    check(view(enigma2_text) == "0Z69630000607007", "format_enigma2_key round trip");
+    check(enigma::pack_enigma2_key("6406257948597a47", enigma2) == enigma::Status::invalid_character &&
+              enigma::pack_enigma2_key("640625794859774", enigma2) == enigma::Status::invalid_length,
+          "pack_enigma2_key rejects lowercase and bad lengths");
+
+    // The packed algorithms agree with the text ones on random keys.
+    bool nettool_match = true;
+    bool enigma2_match = true;
+    std::array<char, enigma::KEY_LENGTH> plain{};
+    std::array<char, enigma::KEY_LENGTH> key{};
+    for (size_t round = 0; round < 500; ++round)
+    {
+        for (size_t i = 0; i < enigma::KEY_LENGTH; ++i)
+        {
+            seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+            const unsigned symbol = static_cast<unsigned>(seed >> 33) % 36;
+            plain[i] = static_cast<char>(symbol < 10 ? '0' + symbol : 'A' + symbol - 10);
+            nettool_text[i % enigma::ENIGMA_C_KEY_LENGTH] = enigma::detail::hex_digit(symbol % 16);
+        }
+
+        (void)enigma::enigma_c_encrypt(view(nettool_text), key);
+        const std::string_view nettool_key(key.data(), enigma::ENIGMA_C_KEY_LENGTH);
+        (void)enigma::pack_nettool_key(view(nettool_text), nettool);
+        const enigma::PackedNetToolKey packed_key = enigma::enigma_c_encrypt(nettool);
+        enigma::PackedNetToolKey expected;
+        nettool_match = nettool_match && enigma::pack_nettool_key(nettool_key, expected) == enigma::Status::ok &&
+                        packed_key == expected && enigma::enigma_c_decrypt(packed_key) == nettool;
+
+        (void)enigma::enigma2_c_encrypt(view(plain), key);
+        (void)enigma::pack_enigma2_key(view(plain), enigma2);
+        const enigma::PackedEnigma2Key packed = enigma::enigma2_c_encrypt(enigma2);
+        enigma::format_enigma2_key(packed, enigma2_text);
+        enigma2_match = enigma2_match && view(enigma2_text) == view(key);
+
+        enigma::PackedEnigma2Key decrypted;
+        const bool packed_ok = enigma::enigma2_c_decrypt(packed, decrypted) == enigma::Status::ok;
+        const bool text_ok = enigma::enigma2_c_decrypt(view(key), plain) == enigma::Status::ok;
+        enigma::format_enigma2_key(decrypted, enigma2_text);
+        enigma2_match = enigma2_match && packed_ok && text_ok && view(enigma2_text) == view(plain);
+    }
+    check(nettool_match, "packed EnigmaC matches the text algorithm");
+    check(enigma2_match, "packed Enigma2C matches the text algorithm");
+
+    (void)enigma::pack_enigma2_key("6406257948597748", enigma2);
+    check(enigma::enigma2_c_decrypt(enigma2, enigma2) == enigma::Status::checksum_mismatch,
+          "packed enigma2_c_decrypt rejects bad checksum");
+
+    check(enigma::nettool_option_key(3333016, 4, nettool) == enigma::Status::ok &&
+              enigma::nettool_option_key(10000000000ULL, 4, nettool) == enigma::Status::invalid_serial &&
+              enigma::nettool_option_key(3333016, 10, nettool) == enigma::Status::invalid_option,
+          "packed nettool_option_key validates serial and option");
+    check(enigma::enigma2_option_key(7001, 1234567, 2, enigma2) == enigma::Status::ok &&
+              enigma::enigma2_c_check_option_key(2, enigma2) && !enigma::enigma2_c_check_option_key(3, enigma2) &&
+              enigma::enigma2_option_key(7001, 12345678, 2, enigma2) == enigma::Status::invalid_serial,
+          "packed enigma2_option_key round trips through the check");
+}
+
+// Walks count serials from first and compares every key with the per-key
+// function; the runs cross carries through every serial digit.
+template <typename Range, typename KeyFor>
+bool range_matches(Range& range, uint64_t count, size_t serial_digits, KeyFor key_for)
+{
+    std::array<char, enigma::MAX_PACKED_SERIAL_DIGITS> digits{};
+    for (uint64_t i = 0; i < count; ++i)
+    {
+        if (i > 0 && !range.advance()) return false;
+        enigma::format_serial(range.serial(), serial_digits, digits);
+        if (range.key() != key_for(std::string_view(digits.data(), serial_digits)).view()) return false;
+    }
+    return true;
+}
+
+void test_key_range()
+{
+    enigma::NetToolKeyRange nettool;
+    bool nettool_match = true;
+    for (const uint64_t first : {0ULL, 9999990ULL, 999999995ULL, 5000000000ULL, 9999998000ULL})
+    {
+        for (const int option : {0, 4, 9})
+        {
+            nettool_match = nettool_match && nettool.start(first, option) == enigma::Status::ok &&
+                            range_matches(nettool, 2000, enigma::SERIAL_NUMBER_SIZE_ENIGMAC,
+                                          [option](std::string_view serial)
+                                          {
+                                              return enigma::nettool_option_key(serial, option);
+                                          });
+        }
+    }
+    check(nettool_match, "NetToolKeyRange matches nettool_option_key");
+    check(nettool.serial() == enigma::NETTOOL_MAX_SERIAL && !nettool.advance() &&
+              nettool.serial() == enigma::NETTOOL_MAX_SERIAL, "NetToolKeyRange stops at the last serial");
+    check(nettool.start(10000000000ULL, 4) == enigma::Status::invalid_serial &&
+              nettool.start(3333016, 10) == enigma::Status::invalid_option &&
+              nettool.serial() == enigma::NETTOOL_MAX_SERIAL,
+          "NetToolKeyRange validates serial and option");
+
+    enigma::Enigma2KeyRange enigma2;
+    bool enigma2_match = true;
+    for (const uint64_t first : {0ULL, 99995ULL, 4999000ULL, 9998000ULL})
+    {
+        for (const auto& [product, option] : {std::pair{6963, 7}, {7001, 2}, {0, 0}, {9999, 999}})
+        {
+            enigma2_match = enigma2_match && enigma2.start(product, first, option) == enigma::Status::ok &&
+                            range_matches(enigma2, 2000, enigma::SERIAL_NUMBER_SIZE_ENIGMA2,
+                                          [product, option](std::string_view serial)
+                                          {
+                                              return enigma::enigma2_option_key(product, serial, option);
+                                          });
+        }
+    }
+    check(enigma2_match, "Enigma2KeyRange matches enigma2_option_key");
+    check(enigma2.serial() == enigma::ENIGMA2_MAX_SERIAL && !enigma2.advance(),
+          "Enigma2KeyRange stops at the last serial");
+    check(enigma2.start(10000, 607, 7) == enigma::Status::invalid_product &&
+              enigma2.start(6963, 10000000, 7) == enigma::Status::invalid_serial &&
+              enigma2.start(6963, 607, 1000) == enigma::Status::invalid_option,
+          "Enigma2KeyRange validates product, serial and option");
+}
+
+constexpr enigma::SimdLevel SIMD_LEVELS[] = {enigma::SimdLevel::scalar, enigma::SimdLevel::ssse3,
+                                             enigma::SimdLevel::avx2, enigma::SimdLevel::avx512,
+                                             enigma::SimdLevel::neon};
+
+// Every available kernel must match enigma_c_encrypt() key for key,
+// including key counts that leave a partial vector for the scalar tail.
+void test_enigma_c_soa()
+{
+    constexpr size_t positions = enigma::ENIGMA_C_KEY_LENGTH;
+    for (const size_t keys : {size_t{1}, size_t{16}, size_t{37}, size_t{64}, size_t{101}})
+    {
+        std::vector<uint8_t> digits(positions * keys);
+        uint32_t seed = 12345;
+        for (auto& digit : digits)
+        {
+            seed = seed * 1103515245 + 12345;
+            digit = static_cast<uint8_t>((seed >> 16) & 0x0F);
+        }
+
+        std::vector<uint8_t> expected(digits.size());
+        std::array<char, positions> plain{};
+        std::array<char, positions> key{};
+        for (size_t k = 0; k < keys; ++k)
+        {
+            for (size_t p = 0; p < positions; ++p) plain[p] = enigma::detail::hex_digit(digits[p * keys + k]);
+            (void)enigma::enigma_c_encrypt(view(plain), key);
+            for (size_t p = 0; p < positions; ++p)
+            {
+                expected[p * keys + k] = static_cast<uint8_t>(enigma::detail::hex_value(key[p]));
+            }
+        }
+
+        for (const auto level : SIMD_LEVELS)
+        {
+            if (!enigma::simd_level_supported(level)) continue;
+            const std::string name =
+                std::string(enigma::simd_level_name(level)) + " kernel, " + std::to_string(keys) + " keys";
+            std::vector<uint8_t> encrypted(digits.size());
+            std::vector<uint8_t> decrypted(digits.size());
+            enigma::enigma_c_encrypt_soa(level, digits.data(), encrypted.data(), positions, keys);
+            check(encrypted == expected, "enigma_c_encrypt_soa matches enigma_c_encrypt, " + name);
+            enigma::enigma_c_decrypt_soa(level, encrypted.data(), decrypted.data(), positions, keys);
+            check(decrypted == digits, "enigma_c_decrypt_soa round trip, " + name);
+        }
+    }
+    check(enigma::simd_level_supported(enigma::simd_level()), "selected SIMD level is supported");
+}
+
+// Same for Enigma2C: random 0-9/A-Z text exercises both rotors and every
+// checksum residue, and re-decrypting the encrypted keys covers the
+// passing-checksum path as well as the (mostly) failing random one.
+void test_enigma2_soa()
+{
+    constexpr size_t length = enigma::KEY_LENGTH;
+    for (const size_t keys : {size_t{1}, size_t{33}, size_t{64}, size_t{200}})
+    {
+        std::vector<char> text(length * keys);
+        uint32_t seed = 777;
+        for (auto& c : text)
+        {
+            seed = seed * 1103515245 + 12345;
+            const uint32_t value = (seed >> 16) % 36;
+            c = static_cast<char>(value < 10 ? '0' + value : 'A' + value - 10);
+        }
+
+        std::vector<char> expected_key(text.size());
+        std::vector<char> expected_plain(text.size());
+        std::vector<uint8_t> expected_ok(keys);
+        std::array<char, length> in{};
+        std::array<char, length> out{};
+        for (size_t k = 0; k < keys; ++k)
+        {
+            for (size_t p = 0; p < length; ++p) in[p] = text[p * keys + k];
+            (void)enigma::enigma2_c_encrypt(view(in), out);
+            for (size_t p = 0; p < length; ++p) expected_key[p * keys + k] = out[p];
+            expected_ok[k] = enigma::enigma2_c_decrypt(view(in), out) == enigma::Status::ok;
+            for (size_t p = 0; p < length; ++p) expected_plain[p * keys + k] = out[p];
+        }
+
+        for (const auto level : SIMD_LEVELS)
+        {
+            if (!enigma::simd_level_supported(level)) continue;
+            const std::string name =
+                std::string(enigma::simd_level_name(level)) + " kernel, " + std::to_string(keys) + " keys";
+            std::vector<char> encrypted(text.size());
+            enigma::enigma2_c_encrypt_soa(level, text.data(), encrypted.data(), keys);
+            check(encrypted == expected_key, "enigma2_c_encrypt_soa matches enigma2_c_encrypt, " + name);
+
+            std::vector<char> decrypted(text.size());
+            std::vector<uint8_t> ok(keys);
+            enigma::enigma2_c_decrypt_soa(level, text.data(), decrypted.data(), ok.data(), keys);
+            check(decrypted == expected_plain && ok == expected_ok,
+                  "enigma2_c_decrypt_soa matches enigma2_c_decrypt, " + name);
+
+            enigma::enigma2_c_decrypt_soa(level, encrypted.data(), decrypted.data(), ok.data(), keys);
+            bool round_trip = std::all_of(ok.begin(), ok.end(), [](uint8_t flag) { return flag == 1; });
+            for (size_t i = 2 * keys; i < text.size(); ++i) round_trip = round_trip && decrypted[i] == text[i];
+            check(round_trip, "enigma2_c_decrypt_soa round trip, " + name);
+        }
+    }
+}
+
+void test_catalog()
+{
+    constexpr const enigma::Catalog& catalog = enigma::BUILTIN_CATALOG;
+    static_assert(catalog.find_product(6964)->code == 6964 && catalog.find_product(6964)->name == "OneTouch AT");
+
+    const enigma::ProductInfo* link_runner = catalog.find_product(7001);
+    check(link_runner && link_runner->abbr == "LRPro", "find_product 7001");
+    check(catalog.find_product(1234) == nullptr, "find_product unknown code");
+    check(catalog.find_product(-1) == nullptr, "find_product rejects -1");
+    check(catalog.options_for(6964).size() == 12, "options_for 6964 has 12 options");
+    check(catalog.options_for(9999).empty(), "options_for unknown product is empty");
+    check(catalog.find_option(6964, 64) && catalog.find_option(6964, 64)->desc == "XGReflector (Future)",
+          "find_option 6964/064");
+    check(catalog.find_option(7001, 1) == nullptr, "find_option missing code");
+    check(catalog.menu().size() == catalog.products().size() && catalog.menu().front() == 3001,
+          "menu keeps the listing order");
+}
+
+void test_catalog_file()
+{
+    std::vector<char> index;
+    std::string error;
+    check(enigma::compile_catalog(R"({"products": [{"code": "0042", "abbr": "T", "name": "Tester \u00e9",
+        "options": [{"code": "009", "desc": "Nine"}, {"code": 3, "desc": "Three"}], "extra": [1, true]}]})",
+                                  index, error), "compile_catalog accepts string and number codes");
+    check(!enigma::compile_catalog(R"({"products": [{"code": 1, "name": "A"}, {"code": 1, "name": "B"}]})", index,
+                                   error) && error.find("duplicate product") != std::string::npos,
+          "compile_catalog rejects duplicate products");
+    check(!enigma::compile_catalog("{\"products\": [{\"code\": 10000, \"name\": \"A\"}]}", index, error) &&
+              error.find("out of range") != std::string::npos, "compile_catalog rejects 5-digit product codes");
+    check(!enigma::compile_catalog("{\"products\": [\n{\"code\": 1 \"name\": \"A\"}]}", index, error) &&
+              error.rfind("line 2:", 0) == 0, "compile_catalog reports the error line");
+
+    const std::string path = "test_enigma_core_catalog.json";
+    std::remove((path + ".cache").c_str());
+    {
+        std::ofstream file(path);
+        file << R"({"products": [{"code": 7001, "abbr": "LR", "name": "LinkRunner",
+                   "options": [{"code": 2, "desc": "Reports"}, {"code": 0, "desc": "802.1x"}]},
+                   {"code": 3001, "abbr": "NT", "name": "NetTool"}]})";
+    }
+    for (const bool cached : {false, true})
+    {
+        const auto loaded = enigma::LoadedCatalog::load(path, error);
+        check(loaded && loaded->from_cache() == cached, cached ? "second load maps the cache" : "first load compiles");
+        if (!loaded) continue;
+        const enigma::Catalog& catalog = loaded->catalog();
+        check(catalog.menu().size() == 2 && catalog.menu().front() == 7001, "loaded menu keeps file order");
+        check(catalog.find_product(3001) && catalog.find_product(3001)->name == "NetTool", "loaded find_product");
+        check(catalog.options_for(7001).size() == 2 && catalog.options_for(7001).front().code == 0 &&
+                  catalog.find_option(7001, 2)->desc == "Reports", "loaded options are sorted by code");
+    }
+    std::remove(path.c_str());
+    std::remove((path + ".cache").c_str());
+    check(!enigma::LoadedCatalog::load(path, error) && !error.empty(), "load reports a missing file");
+}
+
+void test_thread_pool()
+{
+    enigma::ThreadPool pool(4);
+    std::vector<std::atomic<int>> runs(1000);
+    pool.parallel_for(runs.size(), [&](size_t i) { runs[i].fetch_add(1); });
+    check(std::all_of(runs.begin(), runs.end(), [](const std::atomic<int>& r) { return r.load() == 1; }),
+          "parallel_for runs every index once");
+
+    // Thread 0 starts on indices 0-3 and blocks in the first, so 1-3 only
+    // run if another thread steals them.
+    enigma::ThreadPool pair(2);
+    std::mutex mutex;
+    std::condition_variable ran;
+    int stolen = 0;
+    bool blocked_first = false;
+    pair.parallel_for(8, [&](size_t i)
+    {
+        std::unique_lock lock(mutex);
+        if (i == 0)
+        {
+            blocked_first = ran.wait_for(lock, std::chrono::seconds(10), [&] { return stolen == 3; });
+        }
+        else if (i < 4)
+        {
+            ++stolen;
+            ran.notify_all();
+        }
+    });
+    check(blocked_first, "parallel_for steals queued indices from a busy thread");
+
+    std::vector<size_t> seen(pool.size(), 0);
+    pool.for_each_thread([&](size_t thread) { seen[thread] += thread == enigma::ThreadPool::thread_index() ? 1 : 2; });
+    check(std::all_of(seen.begin(), seen.end(), [](size_t count) { return count == 1; }),
+          "for_each_thread runs once on every pool thread");
+
+    const std::vector<unsigned> cpus = enigma::affinity_cpus();
+#ifdef __linux__
+    check(!cpus.empty(), "affinity_cpus lists the CPUs this process may use");
+    cpu_set_t before;
+    CPU_ZERO(&before);
+    sched_getaffinity(0, sizeof(before), &before);
+    enigma::ThreadPool pinned(3, true);
+    std::vector<int> placed(pinned.size(), -1);
+    pinned.for_each_thread([&](size_t thread) { placed[thread] = sched_getcpu(); });
+    bool on_their_cpus = true;
+    for (size_t i = 0; i < placed.size(); ++i)
+    {
+        on_their_cpus = on_their_cpus && placed[i] == static_cast<int>(cpus[i % cpus.size()]);
+    }
+    cpu_set_t after;
+    CPU_ZERO(&after);
+    sched_getaffinity(0, sizeof(after), &after);
+    check(on_their_cpus && CPU_EQUAL(&before, &after),
+          "Pinned pool threads run on affinity_cpus() in order and the caller is restored");
+#else
+    check(cpus.empty(), "affinity_cpus is empty without pinning support");
+#endif
+}
+
+void test_batch()
+{
+    std::string output;
+    const enigma::BatchStats stats = enigma::generate_batch("n,0003333016,4\n\ne, 0000607, 7, 6963\nx,1,2", output);
+    check(output == "5dabade112dd\n6406257948597747\nerror: Mode must be n, e or l\n", "generate_batch output lines");
+    check(stats.records == 3 && stats.errors == 1, "generate_batch counts records and errors");
+
+    output.clear();
+    const enigma::BatchStats header = enigma::generate_batch("mode,serial,option\nn,0003333016,4\nmode\n", output);
+    check(output == "5dabade112dd\nerror: Record must be MODE,SERIAL,OPTION[,PRODUCT]\n" && header.records == 2 && header.errors == 1,
+          "generate_batch skips a mode header on the first line only");
+    output.clear();
+    const enigma::BatchStats lookalike = enigma::generate_batch("model,123,4\nmodem\n", output);
+    check(lookalike.records == 2 && lookalike.errors == 2 && output.starts_with("error: "),
+          "generate_batch reports records that only start with mode");
+    output.clear();
+    (void)enigma::generate_batch("MODE,serial,option\n", output, enigma::KeyFormat::text, nullptr,
+                                 enigma::BatchPosition::continuation);
+    check(output.starts_with("error: "), "generate_batch takes no header in a continuation");
+
+    enigma::KeyBuffer key{};
+    size_t key_length = 0;
+    check(enigma::generate_record_key("n,0003333016,10", key, key_length) == enigma::Status::invalid_option,
+          "generate_record_key rejects NetTool option 10");
+    check(enigma::generate_record_key("e,0000607,7,69630", key, key_length) == enigma::Status::invalid_product,
+          "generate_record_key rejects 5-digit product");
+    check(enigma::generate_record_key("l,1234567", key, key_length) == enigma::Status::malformed_record,
+          "generate_record_key rejects missing option");
+
+    std::string input;
+    for (int i = 0; i < 500; ++i)
+    {
+        input += (i % 2 == 0) ? "n,000333" : "e,0000";
+        input += std::to_string(1000 + i);
+        input += (i % 7 == 0) ? ",x\n" : ",4\n";
+    }
+    std::string sequential;
+    const enigma::BatchStats expected = enigma::generate_batch(input, sequential);
+    enigma::ThreadPool pool(3);
+    std::vector<std::string> chunks;
+    const enigma::BatchStats parallel = enigma::generate_batch_parallel(input, pool, chunks, 64);
+    std::string joined;
+    for (const auto& chunk : chunks) joined += chunk;
+    check(chunks.size() > 1 && joined == sequential, "generate_batch_parallel preserves input order");
+    check(parallel.records == expected.records && parallel.errors == expected.errors,
+          "generate_batch_parallel merges stats");
+}
+
+void test_bounded_queue()
+{
+    enigma::BoundedQueue<int> queue(3);
+    check(queue.capacity() == 4, "BoundedQueue rounds its capacity up to a power of two");
+
+    // A producer blocks once the ring is full, until a consumer frees a slot.
+    std::atomic<int> pushed{0};
+    std::thread producer([&]
+    {
+        for (int i = 1; i <= 5; ++i)
+        {
+            queue.push(i);
+            pushed.store(i);
+        }
+    });
+    while (pushed.load() < 4) std::this_thread::yield();
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    const bool bounded = pushed.load() == 4;
+    const int first = queue.pop();
+    producer.join();
+    int rest = 0;
+    for (int i = 0; i < 4; ++i) rest = rest * 10 + queue.pop();
+    check(bounded && first == 1 && rest == 2345, "BoundedQueue applies backpressure and keeps FIFO order");
+
+    // Several producers and consumers: every value arrives exactly once.
+    enigma::BoundedQueue<uint32_t> shared(8);
+    constexpr uint32_t PER_PRODUCER = 20000;
+    std::atomic<uint64_t> sum{0};
+    std::vector<std::thread> threads;
+    for (uint32_t p = 0; p < 3; ++p)
+    {
+        threads.emplace_back([&shared, p]
+        {
+            for (uint32_t i = 1; i <= PER_PRODUCER; ++i) shared.push(p * PER_PRODUCER + i);
+        });
+        threads.emplace_back([&shared, &sum]
+        {
+            for (uint32_t i = 0; i < PER_PRODUCER; ++i) sum += shared.pop();
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    const uint64_t n = 3 * PER_PRODUCER;
+    check(sum.load() == n * (n + 1) / 2, "BoundedQueue delivers every value once across threads");
+}
+
+void test_pipeline()
+{
+    // Enough records for many pipeline blocks on several workers, plus a
+    // line longer than a block.
+    std::string input;
+    for (int i = 0; i < 60000; ++i)
+    {
+        input += (i % 3 == 0) ? "n,000333" : "e,0000";
+        input += std::to_string(1000 + i % 9000);
+        input += (i % 11 == 0) ? ",x\n" : ",4\n";
+    }
+    input += "# " + std::string(600 * 1024, 'c') + "\nn,0003333016,4";
+    std::string expected;
+    const enigma::BatchStats expected_stats = enigma::generate_batch(input, expected);
+
+    const std::string path = "test_enigma_core_pipeline.txt";
+    std::ofstream(path, std::ios::binary) << input;
+    bool streamed_match = true;
+    bool mapped_match = true;
+    for (const unsigned jobs : {1u, 3u})
+    {
+        enigma::BatchOptions options;
+        options.jobs = jobs;
+        std::FILE* in = std::fopen(path.c_str(), "rb");
+        std::FILE* out = std::tmpfile();
+        const enigma::BatchStats streamed = enigma::run_batch(in, out, options);
+        std::fclose(in);
+        std::string streamed_output(static_cast<size_t>(std::ftell(out)), '\0');
+        std::rewind(out);
+        streamed_output.resize(std::fread(streamed_output.data(), 1, streamed_output.size(), out));
+        std::fclose(out);
+        streamed_match = streamed_match && streamed_output == expected && !streamed.io_error &&
+                         streamed.records == expected_stats.records && streamed.errors == expected_stats.errors;
+
+        out = std::tmpfile();
+        const auto mapped = enigma::run_batch_file(path.c_str(), out, options);
+        std::string mapped_output(static_cast<size_t>(std::ftell(out)), '\0');
+        std::rewind(out);
+        mapped_output.resize(std::fread(mapped_output.data(), 1, mapped_output.size(), out));
+        std::fclose(out);
+        mapped_match = mapped_match && mapped && mapped_output == expected && mapped->records == expected_stats.records;
+    }
+    check(streamed_match, "run_batch pipeline output matches generate_batch");
+    check(mapped_match, "run_batch_file pipeline output matches generate_batch");
+
+#ifdef __linux__
+    // A failing writer stops the reader instead of hanging the pipeline.
+    if (std::FILE* full = std::fopen("/dev/full", "wb"))
+    {
+        std::setvbuf(full, nullptr, _IONBF, 0);
+        const auto failed = enigma::run_batch_file(path.c_str(), full, {});
+        std::fclose(full);
+        check(failed && failed->io_error, "run_batch_file reports write failures");
+    }
+#endif
+    std::remove(path.c_str());
+}
+
+void test_binary_output()
+{
+    std::string output;
+    const enigma::BatchStats stats =
+        enigma::generate_batch("n,0003333016,4\ne,0000607,7\n#c\nl,1234567,2,7001\ne,12345,7\n", output,
+                               enigma::KeyFormat::binary);
+    check(stats.records == 4 && stats.errors == 1 && output.size() == 4 * sizeof(enigma::BinaryKeyRecord),
+          "generate_batch writes one binary record per record");
+
+    const auto nettool = enigma::decode_binary_key_record(output.data());
+    enigma::PackedNetToolKey nettool_key;
+    (void)enigma::pack_nettool_key("5dabade112dd", nettool_key);
+    uint64_t nibbles = 0;
+    for (size_t i = 0; i < 8; ++i) nibbles |= static_cast<uint64_t>(nettool.key[i]) << (8 * i);
+    check(nettool.serial == 3333016 && nettool.product == 0 && nettool.option == 4 && nettool.mode == 'n' &&
+              nettool.status == 0 && nibbles == nettool_key.nibbles, "binary NetTool record fields and packed key");
+
+    const auto linkrunner = enigma::decode_binary_key_record(output.data() + 2 * sizeof(enigma::BinaryKeyRecord));
+    enigma::PackedEnigma2Key enigma2_key;
+    (void)enigma::pack_enigma2_key("8944937150971162", enigma2_key);
+    check(linkrunner.serial == 1234567 && linkrunner.product == 7001 && linkrunner.option == 2 &&
+              linkrunner.mode == 'l' && linkrunner.key == enigma2_key.symbols, "binary Enigma2C record");
+
+    const auto error = enigma::decode_binary_key_record(output.data() + 3 * sizeof(enigma::BinaryKeyRecord));
+    check(error.status == static_cast<uint8_t>(enigma::Status::invalid_serial) && error.serial == 12345 &&
+              error.key == std::array<uint8_t, enigma::KEY_LENGTH>{}, "binary error record carries its status");
+
+    // Cached keys are packed the same way.
+    std::string input;
+    for (int i = 0; i < 200; ++i) input += i % 2 ? "n,0003333016,4\n" : "e,0000607,7\n";
+    std::string uncached;
+    std::string cached;
+    enigma::KeyCache cache(16);
+    (void)enigma::generate_batch(input, uncached, enigma::KeyFormat::binary);
+    const enigma::BatchStats cache_stats = enigma::generate_batch(input, cached, enigma::KeyFormat::binary, &cache);
+    check(cache_stats.cache_hits > 0 && cached == uncached, "cached binary records match uncached ones");
+
+    // A file past one buffer, flushed in aligned blocks with a partial tail.
+    const std::string path = "test_enigma_core_output.bin";
+    std::string data(enigma::OutputFile::BUFFER_SIZE + 5000, '\0');
+    for (size_t i = 0; i < data.size(); ++i) data[i] = static_cast<char>(i * 7 + i / 251);
+    std::string error_text;
+    auto file = enigma::OutputFile::open(path.c_str(), true, error_text);
+    bool written = file && file->write(std::string_view(data).substr(0, 100)) &&
+                   file->write(std::string_view(data).substr(100)) && file->close();
+    std::ifstream in(path, std::ios::binary);
+    const std::string read_back((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    check(written && read_back == data, "OutputFile writes buffered and direct data intact");
+    in.close();
+    std::remove(path.c_str());
+    check(!enigma::OutputFile::open("no_such_directory/out.bin", false, error_text) && !error_text.empty(),
+          "OutputFile::open reports failures");
+}
+
+void test_generate_keys()
+{
+    const auto padded = [](uint64_t value, size_t width)
+    {
+        std::string text = std::to_string(value);
+        return std::string(width - text.size(), '0') + text;
+    };
+    // Enough serials for several parallel tasks, with 64-key blocks cut short.
+    std::mt19937_64 rng(2024);
+    std::vector<uint64_t> serials(40000 + 37);
+    std::vector<int32_t> options(serials.size());
+    for (size_t i = 0; i < serials.size(); ++i)
+    {
+        serials[i] = rng() % (enigma::NETTOOL_MAX_SERIAL + 1);
+        options[i] = static_cast<int32_t>(rng() % 10);
+    }
+    std::vector<char> keys(serials.size() * enigma::ENIGMA_C_KEY_LENGTH);
+    std::vector<enigma::Status> statuses(serials.size());
+    size_t failed = enigma::generate_keys('n', -1, serials, options, keys, statuses, 3);
+    bool nettool_match = failed == 0;
+    for (size_t i = 0; i < serials.size() && nettool_match; ++i)
+    {
+        const auto expected = enigma::nettool_option_key(padded(serials[i], 10), options[i]);
+        nettool_match = statuses[i] == enigma::Status::ok &&
+                        std::string_view(keys.data() + i * 12, 12) == expected.view();
+    }
+    check(nettool_match, "generate_keys matches nettool_option_key across threads");
+
+    std::vector<uint64_t> enigma2_serials(1000);
+    for (auto& serial : enigma2_serials) serial = rng() % (enigma::ENIGMA2_MAX_SERIAL + 1);
+    const int32_t option = 7;
+    std::vector<char> enigma2_keys(enigma2_serials.size() * enigma::KEY_LENGTH);
+    failed = enigma::generate_keys('l', -1, enigma2_serials, std::span(&option, 1), enigma2_keys);
+    bool enigma2_match = failed == 0;
+    for (size_t i = 0; i < enigma2_serials.size() && enigma2_match; ++i)
+    {
+        const auto expected = enigma::enigma2_option_key(7001, padded(enigma2_serials[i], 7), option);
+        enigma2_match = std::string_view(enigma2_keys.data() + i * 16, 16) == expected.view();
+    }
+    check(enigma2_match, "generate_keys matches enigma2_option_key with one option for every serial");
+
+    // Bad records fail on their own, with zeroed keys.
+    const std::array<uint64_t, 4> mixed_serials{607, 10000000, 607, 607};
+    const std::array<int32_t, 4> mixed_options{7, 7, 1000, -1};
+    std::array<char, 4 * enigma::KEY_LENGTH> mixed{};
+    std::array<enigma::Status, 4> mixed_statuses{};
+    failed = enigma::generate_keys('e', 6963, mixed_serials, mixed_options, mixed, mixed_statuses);
+    check(failed == 3 && std::string_view(mixed.data(), 16) == "6406257948597747" &&
+              mixed_statuses[1] == enigma::Status::invalid_serial &&
+              mixed_statuses[2] == enigma::Status::invalid_option &&
+              mixed_statuses[3] == enigma::Status::invalid_option &&
+              std::all_of(mixed.begin() + 16, mixed.end(), [](char c) { return c == '\0'; }),
+          "generate_keys fails bad records individually");
+
+    std::array<char, 2 * enigma::ENIGMA_C_KEY_LENGTH - 1> short_keys{};
+    check(enigma::generate_keys('x', -1, mixed_serials, mixed_options, mixed, mixed_statuses) == 4 &&
+              mixed_statuses[0] == enigma::Status::invalid_mode &&
+              enigma::generate_keys('n', -1, std::span(mixed_serials).first(2), mixed_options, short_keys) == 2 &&
+              enigma::generate_keys('n', -1, std::span(mixed_serials).first(2), std::span<const int32_t>(),
+                                    short_keys) == 2 &&
+              enigma::generated_key_length('n') == 12 && enigma::generated_key_length('l') == 16 &&
+              enigma::generated_key_length('x') == 0,
+          "generate_keys rejects bad modes, option counts and short buffers");
+}
+
+void test_key_cache()
+{
+    const enigma::CacheKey nettool = enigma::generation_cache_key('n', 0, "0003333016", 4);
+    const enigma::CacheKey enigma2 = enigma::generation_cache_key('e', 6963, "0000607", 7);
+    check(!(nettool == enigma2) && !(enigma2 == enigma::generation_cache_key('e', 7001, "0000607", 7)) &&
+          !(enigma2 == enigma::decode_cache_key("6406257948597747")) && !(nettool == enigma::CacheKey{}),
+          "cache keys separate algorithms, products and decodes");
+
+    enigma::KeyCache cache(10);
+    check(cache.capacity() == 16, "KeyCache rounds its capacity up to a power of two");
+    const enigma::CacheValue value{'5', 'd', 'a', 'b', 'a', 'd', 'e', '1', '1', '2', 'd', 'd'};
+    check(!cache.find(nettool), "KeyCache misses before insert");
+    cache.insert(nettool, value);
+    const auto found = cache.find(nettool);
+    check(found && *found == value, "KeyCache returns inserted values");
+    check(cache.stats().hits == 1 && cache.stats().misses == 1 && cache.stats().evictions == 0,
+          "KeyCache counts hits and misses");
+
+    // One set: the fifth key evicts the first unreferenced entry.
+    enigma::KeyCache small(enigma::KeyCache::WAYS);
+    std::array<enigma::CacheKey, enigma::KeyCache::WAYS + 1> keys;
+    for (size_t i = 0; i < keys.size(); ++i) keys[i] = enigma::generation_cache_key('n', 0, "0000000000", int(i));
+    for (size_t i = 0; i < enigma::KeyCache::WAYS; ++i) small.insert(keys[i], value);
+    (void)small.find(keys[0]);
+    small.insert(keys[enigma::KeyCache::WAYS], value);
+    check(small.stats().evictions == 1 && small.find(keys[0]) && !small.find(keys[1]) &&
+          small.find(keys[enigma::KeyCache::WAYS]), "KeyCache gives referenced entries a second chance");
+
+    enigma::KeyBuffer key{};
+    size_t key_length = 0;
+    enigma::KeyCache records(64);
+    const bool first = enigma::generate_record_key("e,0000607,7", key, key_length, &records) == enigma::Status::ok;
+    key.fill(0);
+    const bool second = enigma::generate_record_key("e,0000607,7", key, key_length, &records) == enigma::Status::ok;
+    check(first && second && std::string_view(key.data(), key_length) == "6406257948597747" &&
+          records.stats().hits == 1, "generate_record_key serves repeats from the cache");
+    check(enigma::generate_record_key("n,0003333016,10", key, key_length, &records) == enigma::Status::invalid_option,
+          "generate_record_key validates before caching");
+
+    std::string input;
+    for (int i = 0; i < 600; ++i)
+    {
+        input += (i % 2 == 0) ? "n,000333" : "e,0000";
+        input += std::to_string(1000 + i % 40);
+        input += (i % 7 == 0) ? ",x\n" : ",4\n";
+    }
+    std::string plain;
+    (void)enigma::generate_batch(input, plain);
+    std::string cached;
+    enigma::KeyCache batch_cache(256);
+    const enigma::BatchStats stats = enigma::generate_batch(input, cached, &batch_cache);
+    check(cached == plain, "generate_batch output is unchanged by the cache");
+    check(stats.cache_hits + stats.cache_misses + stats.errors == stats.records && stats.cache_misses <= 80 &&
+          stats.cache_hits == batch_cache.stats().hits, "generate_batch counts cache hits and misses");
+
+    enigma::ThreadPool pool(3);
+    std::vector<std::unique_ptr<enigma::KeyCache>> caches;
+    for (unsigned i = 0; i < pool.size(); ++i) caches.push_back(std::make_unique<enigma::KeyCache>(64));
+    std::vector<std::string> chunks;
+    const enigma::BatchStats parallel = enigma::generate_batch_parallel(input, pool, chunks, caches, 64);
+    std::string joined;
+    for (const auto& chunk : chunks) joined += chunk;
+    check(joined == plain && parallel.cache_hits > 0, "generate_batch_parallel uses one cache per thread");
+}
+
+void test_verify_batch()
+{
+    using enigma::VerifyOutcome;
+    const auto outcome = [](std::string_view record) { return enigma::verify_record_key(record).outcome; };
+    const enigma::VerifiedKey key = enigma::verify_record_key("9225940719507747,1234567,7");
+    check(key.valid() && key.kind == 'e' && key.product == 6963 && key.serial_view() == "1234567" && key.option == 7,
+          "verify_record_key decodes Enigma2C fields");
+    check(outcome("9225940719507747,1234567,7,6963") == VerifyOutcome::valid, "verify_record_key matches product");
+    check(outcome("9225940719507747,1234567,7,7001") == VerifyOutcome::product_mismatch,
+          "verify_record_key rejects product");
+    check(outcome("9225940719507747,1234568,7") == VerifyOutcome::serial_mismatch, "verify_record_key rejects serial");
+    check(outcome("9225940719507748,1234567,7") == VerifyOutcome::checksum_mismatch,
+          "verify_record_key rejects checksum");
+    check(outcome("9225940719507747,1234567") == VerifyOutcome::malformed_record, "verify_record_key needs an option");
+    check(outcome("bladerules,0,0") == VerifyOutcome::valid, "verify_record_key master key");
+    check(outcome("5dabade112zz,0003333016,4") == VerifyOutcome::invalid_key, "verify_record_key rejects non-hex");
+
+    // Generated NetTool keys verify with their serial and option only;
+    // Enigma2C keys get the verdict of enigma2_c_check_option_key().
+    const enigma::VerifiedKey generated = enigma::verify_record_key("5dabade112dd,0003333016,4");
+    check(generated.valid() && generated.kind == 'n' && generated.serial_view() == "0003333016" &&
+          generated.option == 4, "verify_record_key decodes generated NetTool keys");
+    check(outcome("5dabade112dd,0003333017,4") == VerifyOutcome::serial_mismatch,
+          "verify_record_key rejects NetTool serial");
+    bool agrees = true;
+    for (int option = 0; option < 10; ++option)
+    {
+        const auto nettool = enigma::nettool_option_key("0009876543", option);
+        for (const int checked : {option, (option + 1) % 10})
+        {
+            agrees = agrees && enigma::verify_record_key(std::string(nettool.view()) + ",0009876543," +
+                                                         std::to_string(checked)).valid() == (checked == option);
+        }
+        const auto enigma2 = enigma::enigma2_option_key(6964, "0000607", option * 37);
+        for (const int checked : {option * 37, option * 37 + 1})
+        {
+            agrees = agrees && enigma::verify_record_key(std::string(enigma2.view()) + ",0000607," +
+                                                         std::to_string(checked)).valid() ==
+                enigma::enigma2_c_check_option_key(checked, enigma2.view());
+        }
+    }
+    check(agrees, "verify_record_key accepts exactly the generated option");
+
+    // Everything --batch generates verifies.
+    std::string keys;
+    const std::string_view records = "n,0003333016,4\nn,1234567890,0\ne,0000607,7\nl,1234567,2,7001\n";
+    (void)enigma::generate_batch(records, keys);
+    std::string round_trip;
+    std::string_view fields = records;
+    std::string_view generated_keys = keys;
+    while (!fields.empty())
+    {
+        std::string_view record = fields.substr(0, fields.find('\n'));
+        fields.remove_prefix(record.size() + 1);
+        const std::string_view generated_key = generated_keys.substr(0, generated_keys.find('\n'));
+        generated_keys.remove_prefix(generated_key.size() + 1);
+        record.remove_prefix(2);
+        round_trip += std::string(generated_key) + "," + std::string(record) + "\n";
+    }
+    std::string verdicts;
+    const enigma::BatchStats verified = enigma::verify_batch(round_trip, verdicts);
+    check(verified.records == 4 && verified.errors == 0, "verify_batch accepts generate_batch keys");
+
+    std::string output;
+    const enigma::BatchStats stats = enigma::verify_batch("key,serial,option\n9225940719507747 1234567 7\n\nzz\n",
+                                                          output);
+    check(output == "9225940719507747\tvalid\t6963\t1234567\t007\nzz\tmalformed_record\t\t\t\n",
+          "verify_batch TSV lines");
+    check(stats.records == 2 && stats.errors == 1, "verify_batch counts invalid keys");
+    output.clear();
+    const enigma::BatchStats lookalike = enigma::verify_batch("KEY1234567890ABC,1234567,4\nkey,serial,option\n", output);
+    check(lookalike.records == 2 && lookalike.errors == 2 && output.starts_with("KEY1234567890ABC\t"),
+          "verify_batch reports records that only start with key");
+    output.clear();
+    (void)enigma::verify_batch("KEY,serial,option\n", output, enigma::VerifyFormat::tsv,
+                               enigma::BatchPosition::continuation);
+    check(output.starts_with("KEY\t"), "verify_batch takes no header in a continuation");
+    output.clear();
+    (void)enigma::verify_batch("9225940719507748,1234567,7\n\"\\,1,2\n", output, enigma::VerifyFormat::json);
+    check(output == "{\"key\":\"9225940719507748\",\"valid\":false,\"reason\":\"checksum_mismatch\"}\n"
+                    "{\"key\":\"\\\"\\\\\",\"valid\":false,\"reason\":\"invalid_key\"}\n",
+          "verify_batch JSON lines escape keys");
+
+    std::string input;
+    for (int i = 0; i < 300; ++i) input += "9225940719507747,1234567," + std::to_string(i % 9) + "\n";
+    std::string sequential;
+    (void)enigma::verify_batch(input, sequential);
+    enigma::ThreadPool pool(3);
+    std::vector<std::string> chunks;
+    (void)enigma::verify_batch_parallel(input, pool, chunks, enigma::VerifyFormat::tsv, 64);
+    std::string joined;
+    for (const auto& chunk : chunks) joined += chunk;
+    check(chunks.size() > 1 && joined == sequential, "verify_batch_parallel preserves input order");
+}
+void test_stream()
+{
+    std::vector<std::string> records;
+    std::string input;
+    for (int i = 0; i < 300; ++i)
+    {
+        records.push_back(i % 3 == 0 ? "n,000" + std::to_string(3333000 + i) + ",4"
+                                     : i % 3 == 1 ? "e,0000" + std::to_string(600 + i) + ",7" : "n,1,x");
+        input += records.back() + "\n";
+    }
+    std::string expected;
+    const enigma::BatchStats expected_stats = enigma::generate_batch(input, expected);
+
+    enigma::BatchStats stats;
+    std::string streamed;
+    size_t chunks = 0;
+    for (const std::string_view chunk : enigma::stream_batch(records, {.block_records = 64, .stats = &stats}))
+    {
+        streamed += chunk;
+        ++chunks;
+    }
+    check(streamed == expected && chunks == 5, "stream_batch yields generate_batch output one block at a time");
+    check(stats.records == expected_stats.records && stats.errors == expected_stats.errors,
+          "stream_batch adds up block stats");
+
+    std::string binary;
+    enigma::generate_batch(input, binary, enigma::KeyFormat::binary);
+    const auto header = enigma::encode_binary_key_header();
+    std::string streamed_binary;
+    bool header_first = false;
+    for (const std::string_view chunk : enigma::stream_batch(records, {.output = enigma::KeyFormat::binary}))
+    {
+        if (streamed_binary.empty()) header_first = chunk == std::string_view(header.data(), header.size());
+        streamed_binary += chunk;
+    }
+    check(header_first && streamed_binary.substr(header.size()) == binary, "stream_batch streams binary records");
+
+    // Records are pulled only as chunks are consumed.
+    size_t pulled = 0;
+    auto lazy = std::views::iota(0, 1'000'000) | std::views::transform([&](int i)
+    {
+        ++pulled;
+        return "n,000" + std::to_string(3333016 + i % 1000) + ",4";
+    });
+    auto generator = enigma::stream_batch(std::move(lazy), {.block_records = 100});
+    auto chunk = generator.begin();
+    check(chunk != generator.end() && chunk->starts_with("5dabade112dd\n") && pulled == 100,
+          "stream_batch reads one block of a lazy range per chunk");
+    for (int i = 0; i < 3; ++i) ++chunk; // let the buffers reach their size
+    const size_t steady = allocations_during([&]
+    {
+        for (int i = 0; i < 50; ++i) ++chunk;
+    });
+    check(steady == 0 && pulled == 5400, "stream_batch allocates nothing per block once warm");
+
+    check(enigma::stream_batch(std::vector<std::string>{"6406257948597747,0000607,7"},
+                               {.task = enigma::BatchTask::verify}).begin()->starts_with("6406257948597747\tvalid"),
+          "stream_batch verifies records");
+
+    const auto failing = []() -> enigma::Generator<int>
+    {
+        co_yield 1;
+        throw std::runtime_error("stream failed");
+    };
+    auto numbers = failing();
+    auto number = numbers.begin();
+    bool rethrown = false;
+    try
+    {
+        ++number;
+    }
+    catch (const std::runtime_error&)
+    {
+        rethrown = true;
+    }
+    check(rethrown && number == numbers.end(), "Generator rethrows from operator++");
+}
+
+void test_allocations()
+{
+    std::string input;
+    for (int i = 0; i < 2000; ++i) input += i % 3 ? "n,0003333016,4\ne,0000607,7,6963\n" : "x,1,2\n";
+    std::string output;
+    enigma::KeyCache cache(64);
+    (void)enigma::generate_batch(input, output);
+    output.clear();
+    (void)enigma::generate_batch(input, output, &cache);
+    check(allocations_during([&]
+    {
+        output.clear();
+        (void)enigma::generate_batch(input, output);
+        output.clear();
+        (void)enigma::generate_batch(input, output, &cache);
+    }) == 0, "generate_batch allocates nothing once its output has grown");
+
+    std::string keys;
+    for (int i = 0; i < 2000; ++i) keys += "9225940719507747,1234567,6\n6406257948597747,0000607,7\nzz,1,2\n";
+    std::string verified;
+    (void)enigma::verify_batch(keys, verified, enigma::VerifyFormat::json);
+    check(allocations_during([&]
+    {
+        verified.clear();
+        (void)enigma::verify_batch(keys, verified, enigma::VerifyFormat::json);
+        verified.clear();
+        (void)enigma::verify_batch(keys, verified);
+    }) == 0, "verify_batch allocates nothing once its output has grown");
+
+#ifdef ENIGMA_HAVE_SERVER
+    std::string response;
+    response.reserve(4096);
+    check(allocations_during([&]
+    {
+        for (int i = 0; i < 100; ++i)
+        {
+            response.clear();
+            (void)enigma::handle_request("GEN e,0000607,7,6963", response, enigma::BUILTIN_CATALOG, &cache);
+            (void)enigma::handle_request("VERIFY 9225940719507747,1234567,6", response);
+            (void)enigma::handle_request("DECODE 6406257948597747", response, enigma::BUILTIN_CATALOG, &cache);
+            (void)enigma::handle_request("GEN n,1,99", response);
+        }
+    }) == 0, "handle_request allocates nothing");
+#endif
+}
+
+void test_stats()
+{
+    bool buckets_ok = true;
+    for (const uint64_t value : {0ull, 7ull, 8ull, 9ull, 15ull, 16ull, 1000ull, 123456789ull, ~0ull})
+    {
+        const size_t bucket = enigma::stats::bucket_index(value);
+        buckets_ok = buckets_ok && bucket < enigma::stats::BUCKET_COUNT &&
+                     enigma::stats::bucket_upper_bound(bucket) >= value &&
+                     (bucket == 0 || enigma::stats::bucket_upper_bound(bucket - 1) < value);
+    }
+    check(buckets_ok, "stats buckets cover every value exactly once");
+    check(enigma::stats::bucket_upper_bound(enigma::stats::bucket_index(1000)) - 1000 < 1000 / 8,
+          "stats buckets stay within 1/8 of the value");
+
+    enigma::stats::HistogramSnapshot histogram;
+    for (const uint64_t value : {100ull, 200ull, 300ull, 5000ull})
+    {
+        ++histogram.buckets[enigma::stats::bucket_index(value)];
+        ++histogram.count;
+        histogram.max = std::max(histogram.max, value);
+    }
+    check(histogram.quantile(0.5) >= 200 && histogram.quantile(0.5) < 225 && histogram.quantile(0.99) == 5000 &&
+          enigma::stats::HistogramSnapshot{}.quantile(0.5) == 0, "HistogramSnapshot::quantile");
+
+    using enigma::stats::Counter;
+    using enigma::stats::Timer;
+    const enigma::stats::Snapshot before = enigma::stats::snapshot();
+    std::string input;
+    for (int i = 0; i < 1000; ++i) input += "n,0003333016,4\nn,1,2\n";
+    const std::string path = "test_enigma_core_stats.txt";
+    std::ofstream(path, std::ios::binary) << input;
+    enigma::BatchOptions options;
+    options.jobs = 3;
+    std::FILE* out = std::tmpfile();
+    (void)enigma::run_batch_file(path.c_str(), out, options);
+    std::fclose(out);
+    std::remove(path.c_str());
+    const enigma::stats::Snapshot after = enigma::stats::snapshot();
+    const auto delta = [&](Counter counter) { return after.counter(counter) - before.counter(counter); };
+    std::string text;
+    enigma::stats::append_prometheus(text, after);
+    if (enigma::stats::enabled)
+    {
+        // The pipeline's threads have exited by now, so this also checks
+        // that their totals were retired into the registry.
+        check(delta(Counter::batch_records) == 2000 && delta(Counter::batch_errors) == 1000 &&
+              delta(Counter::keys_encrypted) >= 1000, "stats merge counters from exited pipeline threads");
+        check(after.timer(Timer::batch_compute).count > before.timer(Timer::batch_compute).count &&
+              after.timer(Timer::batch_write).count > before.timer(Timer::batch_write).count,
+              "stats time the pipeline stages");
+        check(text.find("# TYPE enigma_keys_encrypted_total counter\n") != std::string::npos &&
+              text.find("enigma_batch_compute_seconds_bucket{le=\"+Inf\"} ") != std::string::npos &&
+              text.find("enigma_batch_errors_total " + std::to_string(after.counter(Counter::batch_errors)) + "\n") !=
+                  std::string::npos, "append_prometheus writes counters and histograms");
+        std::string summary;
+        enigma::stats::append_summary(summary, after);
+        check(summary.starts_with("Stats:\n") && summary.find("batch_compute") != std::string::npos,
+              "append_summary lists the recorded stages");
+    }
+    else
+    {
+        check(delta(Counter::batch_records) == 0 && after.timer(Timer::batch_compute).count == 0,
+              "stats record nothing without ENIGMA_STATS");
+        check(text.find("enigma_batch_records_total 0\n") != std::string::npos,
+              "append_prometheus still writes zeros without ENIGMA_STATS");
+    }
+}
+
+#ifdef ENIGMA_HAVE_SERVER
+void test_server()
+{
+    std::string response;
+    check(enigma::handle_request("GEN n,0003333016,4\r", response) && response == "OK\t5dabade112dd\n",
+          "handle_request GEN");
+    response.clear();
+    (void)enigma::handle_request("DECODE 6406257948597747", response);
+    check(response == "OK\t6963\t0000607\t007\tEtherScope/MetroScope\n", "handle_request DECODE");
+    response.clear();
+    (void)enigma::handle_request("VERIFY 9225940719507747,1234567,6", response);
+    check(response == "OK\t9225940719507747\toption_mismatch\t6963\t1234567\t007\n", "handle_request VERIFY");
+    response.clear();
+    (void)enigma::handle_request("GEN x,1,2", response);
+    check(response == "ERR\tMode must be n, e or l\n", "handle_request reports errors");
+    response.clear();
+    check(!enigma::handle_request("QUIT", response), "handle_request QUIT closes");
+    enigma::KeyCache cache(16);
+    std::string cached;
+    for (int i = 0; i < 2; ++i)
+    {
+        (void)enigma::handle_request("DECODE 6406257948597747", cached, enigma::BUILTIN_CATALOG, &cache);
+        (void)enigma::handle_request("GEN n,0003333016,4", cached, enigma::BUILTIN_CATALOG, &cache);
+    }
+    check(cached == "OK\t6963\t0000607\t007\tEtherScope/MetroScope\nOK\t5dabade112dd\n"
+                    "OK\t6963\t0000607\t007\tEtherScope/MetroScope\nOK\t5dabade112dd\n" &&
+          cache.stats().hits == 2, "handle_request caches GEN and DECODE results");
+
+    const std::string path = "test_enigma_core.sock";
+    std::string error;
+    const auto server = enigma::Server::listen({"unix:" + path, &enigma::BUILTIN_CATALOG, 2, 64}, error);
+    check(server != nullptr, "Server listens on a Unix socket");
+    if (!server) return;
+    std::thread serving([&] { server->run(); });
+
+    // Writes requests from another thread while reading every reply until
+    // the server closes the connection, after stalling for stall first.
+    const auto exchange_at = [](const std::string& socket_path, const std::string& requests,
+                                std::chrono::milliseconds stall = {})
+    {
+        const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        std::memcpy(address.sun_path, socket_path.c_str(), socket_path.size() + 1);
+        std::string replies;
+        if (connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == 0)
+        {
+            std::thread writer([&] { (void)write(fd, requests.data(), requests.size()); });
+            std::this_thread::sleep_for(stall);
+            char buffer[4096];
+            ssize_t received;
+            while ((received = read(fd, buffer, sizeof(buffer))) > 0)
+            {
+                replies.append(buffer, static_cast<size_t>(received));
+            }
+            writer.join();
+        }
+        close(fd);
+        return replies;
+    };
+    const auto exchange = [&](const std::string& requests, std::chrono::milliseconds stall = {})
+    {
+        return exchange_at(path, requests, stall);
+    };
+    check(exchange("PING\nGEN e,0000607,7,6963\nQUIT\nPING\n") == "OK\tPONG\nOK\t6406257948597747\nOK\tBYE\n",
+          "Server answers pipelined requests until QUIT");
+
+    // Far more than the connection's rings hold at once.
+    std::string requests;
+    std::string expected;
+    for (int i = 0; i < 20000; ++i)
+    {
+        requests += i % 2 ? "GEN n,0003333016,4\n" : "DECODE 6406257948597747\n";
+        expected += i % 2 ? "OK\t5dabade112dd\n" : "OK\t6963\t0000607\t007\tEtherScope/MetroScope\n";
+    }
+    check(exchange(requests + "QUIT\n") == expected + "OK\tBYE\n", "Server keeps order under backpressure");
+    const std::string stats = exchange("STATS\nQUIT\n");
+    check(stats.substr(0, 3) == "OK\t" && std::stoul(stats.substr(3)) >= 19998 &&
+          server->cache_stats().hits >= 19998, "Server reports cache hits");
+    check(exchange(std::string(enigma::MAX_REQUEST_LINE + 10, 'A')) == "ERR\tRequest line too long\n",
+          "Server rejects overlong lines");
+    const std::string scrape = exchange("GET /metrics HTTP/1.1\r\nHost: localhost\r\n\r\n");
+    const size_t body = scrape.find("\r\n\r\n");
+    const std::string length = "Content-Length: " + std::to_string(scrape.size() - body - 4) + "\r\n";
+    if (enigma::stats::enabled)
+    {
+        check(scrape.starts_with("HTTP/1.0 200 OK\r\n") && body != std::string::npos &&
+              scrape.find(length) != std::string::npos &&
+              scrape.find("enigma_server_requests_total ") != std::string::npos &&
+              scrape.find("enigma_server_request_seconds_count ") != std::string::npos,
+              "Server answers GET /metrics with Prometheus text");
+        check(exchange("GET / HTTP/1.0\r\n\r\n").starts_with("HTTP/1.0 404"), "Server answers other paths with 404");
+
+        // Behind pipelined responses still queued in the output ring: the
+        // stalled reader lets them back up past the socket buffer.
+        std::string pipelined;
+        for (int i = 0; i < 40000; ++i) pipelined += "GEN n,0003333016,4\n";
+        const std::string replies = exchange(pipelined + "GET /metrics HTTP/1.0\r\n\r\n",
+                                             std::chrono::milliseconds(100));
+        const size_t start = replies.find("HTTP/1.0 200 OK\r\n");
+        const size_t headers_end = replies.find("\r\n\r\n", start);
+        const size_t length_at = replies.find("Content-Length: ", start);
+        check(start == 40000 * std::string_view("OK\t5dabade112dd\n").size() && headers_end != std::string::npos &&
+              length_at < headers_end &&
+              std::stoul(replies.substr(length_at + 16)) == replies.size() - headers_end - 4,
+              "Server answers a pipelined scrape whole");
+    }
+    else
+    {
+        check(scrape.starts_with("HTTP/1.0 404"), "Server answers GET /metrics with 404 without ENIGMA_STATS");
+    }
+
+    server->stop();
+    serving.join();
+
+    // One event-loop thread, so every connection lands on the same idle list.
+    const std::string pooled_path = "test_enigma_core_pool.sock";
+    const auto pooled = enigma::Server::listen({"unix:" + pooled_path, &enigma::BUILTIN_CATALOG, 1, 64}, error);
+    if (pooled)
+    {
+        std::thread pooled_serving([&]
+        {
+            count_allocations = true;
+            pooled->run();
+        });
+        const std::string requests = "GEN n,0003333016,4\nDECODE 6406257948597747\nQUIT\n";
+        for (int i = 0; i < 3; ++i) (void)exchange_at(pooled_path, requests);
+        const size_t warm = allocations.load();
+        bool answered = true;
+        for (int i = 0; i < 20; ++i)
+        {
+            answered = answered && exchange_at(pooled_path, requests).starts_with("OK\t5dabade112dd\n");
+        }
+        check(answered && allocations.load() == warm, "Server reuses closed connections without allocating");
+        pooled->stop();
+        pooled_serving.join();
+    }
+    check(!enigma::Server::listen({"udp:1"}, error) && !error.empty(), "Server rejects unknown address schemes");
+}
+#endif
+} // namespace
+
+void* operator new(size_t size)
+{
+    return allocate(size);
+}
+
+void* operator new[](size_t size)
+{
+    return allocate(size);
+}
+
+void operator delete(void* block) noexcept
+{
+    release(block);
+}
+
+void operator delete(void* block, size_t) noexcept
+{
+    release(block);
+}
+
+void operator delete[](void* block) noexcept
+{
+    release(block);
+}
+
+void operator delete[](void* block, size_t) noexcept
+{
+    release(block);
+}
+
+int main()
+{
+    test_enigma_c();
+    test_enigma_c_wide();
+    test_enigma_c_soa();
+    test_enigma2();
+    test_enigma2_soa();
+    test_fixed_size_keys();
+    test_engine();
+    test_packed();
+    test_key_range();
+    test_catalog();
+    test_catalog_file();
+    test_thread_pool();
+    test_batch();
+    test_bounded_queue();
+    test_pipeline();
+    test_binary_output();
+    test_generate_keys();
+    test_key_cache();
+    test_verify_batch();
+    test_stream();
+    test_allocations();
+    test_stats();
+#ifdef ENIGMA_HAVE_SERVER
+    test_server();
+#endif
+    std::cout << (failures == 0 ? "All tests passed\n" : "Some tests failed\n");
+    return failures == 0 ? 0 : 1;
+}
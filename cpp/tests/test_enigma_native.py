@@ -0,0 +1,60 @@
+#!/usr/bin/env python3
+"""Tests for the enigma_native extension, run through CTest with the module on PYTHONPATH."""
+
+import array
+import unittest
+
+import enigma_native
+
+try:
+    import numpy
+except ImportError:
+    numpy = None
+
+
+class TestGenerateMany(unittest.TestCase):
+    """generate_many() against keys from the CLI and the C front end."""
+
+    def test_nettool_from_array(self):
+        keys = enigma_native.generate_many(array.array("Q", [3333016, 3333016]), array.array("i", [4, 4]))
+        self.assertEqual(keys, b"5dabade112dd" * 2)
+
+    def test_enigma2_from_list_with_one_option(self):
+        keys = enigma_native.generate_many([607, 1234567], 7, mode="e")
+        self.assertEqual(keys[:16], b"6406257948597747")
+        self.assertEqual(len(keys), 32)
+        self.assertEqual(enigma_native.generate_many([1234567], [2], mode="l", product=7001), b"8944937150971162")
+
+    def test_narrow_buffers_and_threads(self):
+        serials = array.array("I", range(3333000, 3333000 + 40000))
+        single = enigma_native.generate_many(serials, 4)
+        threaded = enigma_native.generate_many(array.array("q", serials), array.array("b", [4]), jobs=3)
+        self.assertEqual(single, threaded)
+        self.assertEqual(single[16 * 12:17 * 12], b"5dabade112dd")
+
+    def test_errors(self):
+        with self.assertRaisesRegex(ValueError, r"record 1: Option must be"):
+            enigma_native.generate_many([3333016, 3333016], [4, 10])
+        with self.assertRaisesRegex(ValueError, r"record 0: Serial number"):
+            enigma_native.generate_many([-1], 4)
+        with self.assertRaisesRegex(ValueError, r"mode must be"):
+            enigma_native.generate_many([1], 4, mode="x")
+        with self.assertRaisesRegex(ValueError, r"2 values for 3 serials"):
+            enigma_native.generate_many([1, 2, 3], [1, 2])
+        with self.assertRaises(TypeError):
+            enigma_native.generate_many(array.array("d", [1.0]), 4)
+        keys = enigma_native.generate_many([3333016, 2**70], 4, strict=False)
+        self.assertEqual(keys, b"5dabade112dd" + b"\0" * 12)
+
+    def test_key_length(self):
+        self.assertEqual([enigma_native.key_length(m) for m in "nelx"], [12, 16, 16, 0])
+
+    @unittest.skipIf(numpy is None, "numpy is not installed")
+    def test_numpy_round_trip(self):
+        serials = numpy.arange(3333016, 3333016 + 100, dtype=numpy.uint64)
+        keys = numpy.frombuffer(enigma_native.generate_many(serials, numpy.full(100, 4, dtype=numpy.int32)), "S12")
+        self.assertEqual(keys[0], b"5dabade112dd")
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -2,14 +2,14 @@
 # Comprehensive tests for Enigma V300 C++ implementation
 # Verified against V200 reference implementation
 #
-# NOTE: C++ CLI supports: -n, -x, -e, -l, -d, -?
+# NOTE: C++ CLI supports: -n, -x, -e, -l, -d, -?, --batch
 # Missing (vs C impl): --version, --help, --list-products, --list-options
 
 set -uo pipefail
 
 SCRIPT_DIR="$(cd "$(dirname "$0")" && pwd)"
 BUILD_DIR="${SCRIPT_DIR}/../build"
-ENIGMA="${BUILD_DIR}/enigma_v300_pure_cpp"
+ENIGMA="${1:-${BUILD_DIR}/enigma_v300_pure_cpp}"
 
 # Colors for output
 RED='\033[0;31m'
@@ -129,6 +129,153 @@ OPTIONS_OUTPUT=$("$ENIGMA" --list-options 6964 2>&1 || true)
 check_output "OneTouch options include Wired" "Wired" "$OPTIONS_OUTPUT"
 check_output "OneTouch options include Wi-Fi" "Wi-Fi" "$OPTIONS_OUTPUT"
 
+echo ""
+echo "--- Batch Tests ---"
+
+BATCH_INPUT=$'mode,serial,option,product\nn,0003333016,4\ne,0000607,7,6963\n# comment\n\nl 1234567 2\ne,1234567,4,3001'
+BATCH_OUTPUT=$(printf '%s\n' "$BATCH_INPUT" | "$ENIGMA" --batch 2>&1)
+EXPECTED_BATCH=$'5dabade112dd\n6406257948597747\n8944937150971162\n8042745901759933'
+if [[ "$BATCH_OUTPUT" == "$EXPECTED_BATCH" ]]; then
+    pass "Batch from stdin generates one key per record"
+else
+    fail "Batch from stdin generates one key per record" "$EXPECTED_BATCH" "$BATCH_OUTPUT"
+fi
+
+BATCH_FILE=$(mktemp)
+printf 'n,0003333016,4\r\ne,123,7\ne,0000607,7,6963' > "$BATCH_FILE"
+BATCH_OUTPUT=$("$ENIGMA" --batch "$BATCH_FILE" 2>/dev/null)
+BATCH_STATUS=$?
+rm -f "$BATCH_FILE"
+check_output "Batch from file accepts CRLF" "5dabade112dd" "$BATCH_OUTPUT"
+check_output "Batch reports bad records in place" "error: Serial number" "$BATCH_OUTPUT"
+check_output "Batch from file reads last line without newline" "6406257948597747" "$BATCH_OUTPUT"
+if [[ $BATCH_STATUS -ne 0 ]]; then
+    pass "Batch exits non-zero when a record fails"
+else
+    fail "Batch exits non-zero when a record fails" "non-zero" "$BATCH_STATUS"
+fi
+
+MISSING_OUTPUT=$("$ENIGMA" --batch /nonexistent/serials.csv 2>&1)
+check_output "Batch reports unreadable file" "cannot open" "$MISSING_OUTPUT"
+
+FIFO_DIR=$(mktemp -d)
+mkfifo "$FIFO_DIR/serials"
+printf 'n,0003333016,4\n' > "$FIFO_DIR/serials" &
+FIFO_OUTPUT=$(timeout 10 "$ENIGMA" --batch "$FIFO_DIR/serials" 2>&1)
+wait
+rm -rf "$FIFO_DIR"
+check_output "Batch reads a named pipe" "5dabade112dd" "$FIFO_OUTPUT"
+
+PARALLEL_OUTPUT=$(printf '%s\n' "$BATCH_INPUT" | "$ENIGMA" --batch - --jobs 4 2>&1)
+if [[ "$PARALLEL_OUTPUT" == "$EXPECTED_BATCH" ]]; then
+    pass "Batch with --jobs keeps input order"
+else
+    fail "Batch with --jobs keeps input order" "$EXPECTED_BATCH" "$PARALLEL_OUTPUT"
+fi
+
+PINNED_OUTPUT=$(printf '%s\n' "$BATCH_INPUT" | "$ENIGMA" --batch - --jobs 3 --affinity --cache 16 2>/dev/null)
+if [[ "$PINNED_OUTPUT" == "$EXPECTED_BATCH" ]]; then
+    pass "Batch with --affinity keeps input order"
+else
+    fail "Batch with --affinity keeps input order" "$EXPECTED_BATCH" "$PINNED_OUTPUT"
+fi
+
+HEADER_LIKE_OUTPUT=$(printf 'model,123,4\nmodem\n' | "$ENIGMA" --batch - 2>/dev/null)
+if [[ $? -ne 0 && "$HEADER_LIKE_OUTPUT" == $'error: '*$'\nerror: '* ]]; then
+    pass "Batch reports records that only start with mode"
+else
+    fail "Batch reports records that only start with mode" "two error lines" "$HEADER_LIKE_OUTPUT"
+fi
+
+CACHED_OUTPUT=$(printf '%s\n' "$BATCH_INPUT" "${BATCH_INPUT#*$'\n'}" | "$ENIGMA" --batch - --cache 64 2>/dev/null)
+if [[ "$CACHED_OUTPUT" == "$EXPECTED_BATCH"$'\n'"$EXPECTED_BATCH" ]]; then
+    pass "Batch with --cache matches uncached output"
+else
+    fail "Batch with --cache matches uncached output" "$EXPECTED_BATCH" "$CACHED_OUTPUT"
+fi
+# Keys are cached as each 64-key block is encrypted, so only repeats after the first block hit.
+CACHE_REPORT=$(for _ in $(seq 100); do echo "n,0003333016,4"; done | "$ENIGMA" --batch - --cache 64 2>&1 >/dev/null)
+check_output "Batch with --cache reports hits" "Cache: 36 hits, 64 misses" "$CACHE_REPORT"
+
+# Binary output: a 32-byte header, then one 32-byte record per input record.
+BINARY_FILE=$(mktemp)
+printf 'n,0003333016,4\ne,0000607,7\nx,1,1\n' | "$ENIGMA" --batch - --format binary --output "$BINARY_FILE" --direct \
+    2>/dev/null
+check_output "Binary batch output size" "128" "$(wc -c < "$BINARY_FILE" | tr -d ' ')"
+check_output "Binary batch output header" "ENIGMAKB" "$(head -c 8 "$BINARY_FILE")"
+check_output "Binary batch packs the NetTool key" "d5bada1e21dd" "$(od -A n -t x1 -j 48 -N 6 "$BINARY_FILE" | tr -d ' \n')"
+check_output "Binary batch records the error status" "07" "$(od -A n -t x1 -j 109 -N 1 "$BINARY_FILE" | tr -d ' \n')"
+rm -f "$BINARY_FILE"
+DIRECT_ERROR=$("$ENIGMA" --batch - --direct < /dev/null 2>&1)
+check_output "Batch --direct requires --output" "Error: --direct requires --output PATH" "$DIRECT_ERROR"
+
+# --stats needs a build configured with -DENIGMA_STATS=ON; otherwise it is refused.
+STATS_OUTPUT=$(printf 'n,0003333016,4\nx,1,1\n' | "$ENIGMA" --batch - --stats 2>&1 >/dev/null)
+if [[ "$STATS_OUTPUT" == *"Error: --stats needs"* ]]; then
+    check_output "Batch --stats is refused without ENIGMA_STATS" "-DENIGMA_STATS=ON" "$STATS_OUTPUT"
+else
+    check_output "Batch --stats prints the summary" "Stats:" "$STATS_OUTPUT"
+    check_output "Batch --stats counts error records" "batch_errors     1" "$STATS_OUTPUT"
+fi
+
+# Ranges print SERIAL,KEY and agree with --batch across digit carries.
+RANGE_OUTPUT=$("$ENIGMA" -e --range 0000605 0000608 7 2>&1)
+check_output "Range prints the reference key" "0000607,6406257948597747" "$RANGE_OUTPUT"
+RANGE_KEYS=$("$ENIGMA" -l --range 0009998 0010001 2 | cut -d, -f2)
+BATCH_KEYS=$(printf 'l,%s,2\n' 0009998 0009999 0010000 0010001 | "$ENIGMA" --batch 2>/dev/null)
+check_output "LinkRunner range matches batch keys" "$BATCH_KEYS" "$RANGE_KEYS"
+RANGE_KEYS=$("$ENIGMA" -n --range 0003332998 0003333016 4 | cut -d, -f2)
+BATCH_KEYS=$(for s in $(seq 3332998 3333016); do printf 'n,%010d,4\n' "$s"; done | "$ENIGMA" --batch 2>/dev/null)
+check_output "NetTool range matches batch keys" "$BATCH_KEYS" "$RANGE_KEYS"
+RANGE_OUTPUT=$("$ENIGMA" -e --range 0000608 0000607 7 2>&1)
+check_output "Range rejects END below START" "END must not be below START" "$RANGE_OUTPUT"
+
+VERIFY_OUTPUT=$(printf '9225940719507747,1234567,7\n9225940719507747,1234567,6\n' | "$ENIGMA" --verify-batch 2>/dev/null)
+check_output "Verify batch accepts a valid key" "$(printf '9225940719507747\tvalid\t6963\t1234567\t007')" "$VERIFY_OUTPUT"
+check_output "Verify batch reports the mismatch" "option_mismatch" "$VERIFY_OUTPUT"
+VERIFY_OUTPUT=$(printf '9225940719507747,1234567,7\n' | "$ENIGMA" --verify-batch - --format json --jobs 2 2>&1)
+check_output "Verify batch writes JSON" '"valid":true,"product":6963' "$VERIFY_OUTPUT"
+NETTOOL_KEY=$(printf 'n,0003333016,4\n' | "$ENIGMA" --batch 2>/dev/null)
+VERIFY_OUTPUT=$(printf '%s,0003333016,4\n' "$NETTOOL_KEY" | "$ENIGMA" --verify-batch 2>/dev/null)
+check_output "Verify batch accepts generated NetTool keys" "$(printf '5dabade112dd\tvalid\t\t0003333016\t4')" "$VERIFY_OUTPUT"
+VERIFY_OUTPUT=$(printf 'KEY1234567890ABC,1234567,4\n' | "$ENIGMA" --verify-batch 2>/dev/null)
+check_output "Verify batch reports keys that only start with KEY" "KEY1234567890ABC" "$VERIFY_OUTPUT"
+VERIFY_OUTPUT=$("$ENIGMA" --verify-batch - --format xml 2>&1 < /dev/null)
+check_output "Verify batch rejects unknown formats" "--format must be tsv or json" "$VERIFY_OUTPUT"
+
+SERVER_LOG=$(mktemp)
+"$ENIGMA" --serve tcp:127.0.0.1:0 --jobs 2 --affinity --cache 64 > "$SERVER_LOG" 2>&1 &
+SERVER_PID=$!
+for _ in 1 2 3 4 5 6 7 8 9 10; do
+    grep -q "Listening on" "$SERVER_LOG" && break
+    sleep 0.1
+done
+SERVER_PORT=$(sed -n 's/^Listening on tcp:.*://p' "$SERVER_LOG")
+SERVER_OUTPUT=""
+if [[ -n "$SERVER_PORT" ]] && exec 3<>"/dev/tcp/127.0.0.1/$SERVER_PORT"; then
+    printf 'GEN n,0003333016,4\nDECODE 6406257948597747\nGEN n,0003333016,4\nSTATS\nQUIT\n' >&3
+    SERVER_OUTPUT=$(cat <&3)
+    exec 3<&-
+fi
+kill "$SERVER_PID" 2>/dev/null
+wait "$SERVER_PID" 2>/dev/null
+rm -f "$SERVER_LOG"
+check_output "Server generates keys" "$(printf 'OK\t5dabade112dd')" "$SERVER_OUTPUT"
+check_output "Server decodes keys" "EtherScope/MetroScope" "$SERVER_OUTPUT"
+check_output "Server answers QUIT" "BYE" "$SERVER_OUTPUT"
+check_output "Server reports cache counters" "$(printf 'OK\t1\t2\t0')" "$SERVER_OUTPUT"
+
+CATALOG_FILE=$(mktemp)
+printf '{"products": [{"code": 1234, "abbr": "X", "name": "Custom Meter",
+    "options": [{"code": 5, "desc": "Extra"}]}]}' > "$CATALOG_FILE"
+CATALOG_OUTPUT=$("$ENIGMA" --catalog "$CATALOG_FILE" --list-products 2>&1)
+check_output "Catalog file replaces the product list" "1234 - Custom Meter" "$CATALOG_OUTPUT"
+CATALOG_OUTPUT=$("$ENIGMA" --catalog "$CATALOG_FILE" --list-options 1234 2>&1)
+check_output "Catalog file cache serves options" "005 - Extra" "$CATALOG_OUTPUT"
+rm -f "$CATALOG_FILE" "$CATALOG_FILE.cache"
+CATALOG_OUTPUT=$("$ENIGMA" --catalog /nonexistent/catalog.json --list-products 2>&1)
+check_output "Catalog file reports unreadable file" "cannot open" "$CATALOG_OUTPUT"
+
 echo ""
 echo "=== Test Summary ==="
 echo -e "Passed: ${GREEN}${PASSED}${NC}"
@@ -14,10 +14,17 @@ import argparse
 import logging
 import logging.handlers
 import sys
+from collections.abc import Iterable
 from importlib.metadata import PackageNotFoundError
 from importlib.metadata import version as _pkg_version
 from pathlib import Path
 
+try:
+    # Native core from cpp/ (enigma_native CPython extension), when built.
+    import enigma_native as _native
+except ImportError:
+    _native = None
+
 
 def _find_pyproject(start: Path) -> Path | None:
     for parent in (start, *start.parents):
@@ -359,6 +366,69 @@ def enigma2_c_check_option_key(option: int, key: str) -> bool:
     return opt == option
 
 
+DEFAULT_PRODUCT_CODES: dict[str, int] = {"e": 6963, "l": 7001}
+
+
+def generate_many(
+    serials: Iterable[int],
+    options: int | Iterable[int],
+    mode: str = "n",
+    product: int = -1,
+    jobs: int = 1,
+) -> list[str]:
+    """Generate option keys for many serials at once.
+
+    Uses the enigma_native extension (the C++ core's SIMD batch kernels) when
+    it can be imported, and the functions above otherwise; both produce the
+    same keys. For NumPy arrays or large batches, enigma_native.generate_many()
+    returns the keys as one bytes object without building strings.
+
+    Args:
+        serials: Serial numbers as integers (10 digits for NetTool, 7 for Enigma2).
+        options: One option number per serial, or a single option for all.
+        mode: "n" (NetTool), "e" (EtherScope) or "l" (LinkRunner Pro).
+        product: Enigma2 product code; -1 uses the mode's default.
+        jobs: Threads for the native core (0 = all); ignored by the fallback.
+
+    Returns:
+        One key per serial, in order.
+
+    Raises:
+        ValueError: If the mode is unknown or a record is out of range.
+    """
+    serials = list(serials)
+    options = [options] * len(serials) if isinstance(options, int) else list(options)
+    if len(options) != len(serials):
+        raise ValueError(f"options has {len(options)} values for {len(serials)} serials")
+    if mode not in ("n", "e", "l"):
+        raise ValueError(f"mode must be 'n', 'e' or 'l', not {mode!r}")
+    if _native is not None:
+        keys = _native.generate_many(serials, options, mode=mode, product=product, jobs=jobs)
+        width = _native.key_length(mode)
+        return [keys[i : i + width].decode("ascii") for i in range(0, len(keys), width)]
+
+    if mode != "n" and product < 0:
+        product = DEFAULT_PRODUCT_CODES[mode]
+    result = []
+    for index, (serial, option) in enumerate(zip(serials, options)):
+        if mode == "n":
+            if not 0 <= serial <= 9999999999 or not 0 <= option <= 9:
+                raise ValueError(f"record {index}: serial must be 10 digits and option 0-9")
+            plain_key = (str(serial).zfill(SERIAL_NUMBER_SIZE_ENIGMAC) + str(option) + "0")[::-1]
+            result.append(enigma_c_encrypt(plain_key))
+        else:
+            if not 0 <= serial <= 9999999 or not 0 <= option <= 999 or not 0 <= product <= 9999:
+                raise ValueError(f"record {index}: serial must be 7 digits, option 0-999, product 0-9999")
+            plain_key = (
+                "00"
+                + str(product).zfill(PRODUCT_CODE_SIZE)
+                + str(serial).zfill(SERIAL_NUMBER_SIZE_ENIGMA2)
+                + str(option).zfill(OPTION_CODE_SIZE)
+            )
+            result.append(enigma2_c_encrypt(plain_key))
+    return result
+
+
 def get_menu_choice(prompt: str, min_val: int, max_val: int) -> int:
     """Get a valid menu choice from user.
 
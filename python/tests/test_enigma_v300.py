@@ -30,6 +30,7 @@ from enigma_v300_functions import (
     enigma2_c_encrypt,
     enigma2_c_decrypt,
     enigma2_c_check_option_key,
+    generate_many,
     __version__,
 )
 
@@ -319,3 +320,31 @@ class TestEdgeCases:
         encrypted = enigma2_c_encrypt(input_key)
         decrypted = enigma2_c_decrypt(encrypted)
         assert decrypted[13:16] == "999"
+
+
+class TestGenerateMany:
+    """Test batch key generation (native core when built, pure Python otherwise)."""
+
+    def test_nettool_keys(self):
+        """NetTool keys match the CLI for each serial."""
+        assert generate_many([3333016, 3333016], 4) == ["5dabade112dd"] * 2
+
+    def test_enigma2_default_products(self):
+        """EtherScope and LinkRunner use their default product codes."""
+        assert generate_many([607], [7], mode="e") == ["6406257948597747"]
+        assert generate_many([1234567], [2], mode="l") == ["8944937150971162"]
+
+    def test_matches_single_key_functions(self):
+        """Every key matches enigma_c_encrypt on the reversed layout."""
+        serials = list(range(3333000, 3333200))
+        expected = [enigma_c_encrypt((str(s).zfill(10) + "3" + "0")[::-1]) for s in serials]
+        assert generate_many(serials, 3) == expected
+
+    def test_rejects_bad_records(self):
+        """Out-of-range options and unknown modes raise ValueError."""
+        with pytest.raises(ValueError):
+            generate_many([3333016], [10])
+        with pytest.raises(ValueError):
+            generate_many([3333016], 4, mode="x")
+        with pytest.raises(ValueError):
+            generate_many([1, 2], [1, 2, 3])